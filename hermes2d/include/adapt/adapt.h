@@ -194,6 +194,18 @@ namespace Hermes
       /** \param[in] A vector of refinements to apply. */
       virtual void apply_refinements(ElementToRefine* elems_to_refine, int num_elem_to_process);
 
+      /// Performs the h-refinements of a vector of refinements on the meshes (without setting orders).
+      /** Two phases:
+      *  - topology: with at least as many distinct meshes as threads, the meshes are refined in parallel, each by
+      *  a single thread, otherwise one after another, each by all threads (Mesh::refine_elements_id(): the refinements
+      *  are partitioned, the ids of the created nodes and elements are assigned by a prefix sum over the counts
+      *  of the partitions, then the partitions fill them in parallel). Either way, the resulting meshes (element and
+      *  node ids) are identical to the ones obtained by the serial apply_refinement().
+      *  - reference mappings of the curved sons (the costly part of refining a curved mesh): computed in parallel
+      *  over all sons of all meshes, also for a single mesh (see Mesh::deferred_curved_sons).
+      *  \param[in] A vector of refinements to apply. */
+      void refine_meshes(ElementToRefine* elems_to_refine, int num_elem_to_process);
+
       /// Fixes refinements of a mesh which is shared among multiple components of a multimesh.
       /** If a mesh is shared among components, it has to be refined similarly in order to avoid inconsistency.
       *  \param[in] meshes An array of meshes of components.
@@ -112,6 +112,10 @@ namespace Hermes
         }
       }
 
+      /// Discard the cached contributions of the solution-independent forms (see Form::set_solution_independent()).
+      /// Called automatically when the weak formulation, time, time step or spaces change.
+      void invalidate_solution_independent_forms();
+
       /// See Hermes::Mixins::Loggable.
       virtual void set_verbose_output(bool to_set);
 
@@ -130,6 +134,25 @@ namespace Hermes
       /// Init function. Common code for the constructors.
       void init(bool linear, bool dirichlet_lift_accordingly);
 
+      /// Assemble all selected forms on the states.
+      void assemble_states(Scalar*& coeff_vec, Traverse::State** states, unsigned int num_states, std::vector<MeshSharedPtr>& meshes);
+
+      /// Whether the contributions of solution-independent forms are assembled once and cached.
+      bool use_solution_independent_forms_cache() const;
+
+      /// Assemble the solution-dependent forms, and add the cached contributions of the solution-independent ones (assembling them if necessary).
+      void assemble_with_solution_independent_forms_cache(Scalar*& coeff_vec, Traverse::State** states, unsigned int num_states, std::vector<MeshSharedPtr>& meshes, bool matrix_structure_kept, bool vector_structure_kept);
+      /// Comparison of the contributions of the solution-independent forms assembled with two different iterates.
+      bool values_equal(Scalar* values, Scalar* other_values, unsigned int count) const;
+      /// DG assembling marks the elements as visited, which has to be reset before another pass over the states.
+      void unmark_visited_elements();
+
+      /// Cached contributions of the solution-independent forms (matrix values in the CS arrays order, rhs values).
+      Scalar* solution_independent_matrix_values;
+      unsigned int solution_independent_matrix_nnz;
+      Scalar* solution_independent_rhs_values;
+      unsigned int solution_independent_rhs_size;
+
       /// Space instances for all equations in the system.
       std::vector<SpaceSharedPtr<Scalar> > spaces;
       int spaces_size;
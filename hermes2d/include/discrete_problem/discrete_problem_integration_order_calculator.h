@@ -98,6 +98,7 @@ namespace Hermes
 
       template<typename T> friend class DiscreteProblem;
       template<typename T> friend class DiscreteProblemThreadAssembler;
+      template<typename T> friend class MatrixFreeOperator;
     };
   }
 }
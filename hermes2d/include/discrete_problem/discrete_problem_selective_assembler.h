@@ -63,27 +63,71 @@ namespace Hermes
       void set_weak_formulation(WeakFormSharedPtr<Scalar> wf);
 
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(MatrixForm<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(MatrixForm<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(MatrixFormVol<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(MatrixFormVol<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(MatrixFormSurf<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(MatrixFormSurf<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
       bool form_to_be_assembled(MatrixFormDG<Scalar>* form, Traverse::State* current_state);
 
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(VectorForm<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(VectorForm<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(VectorFormVol<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(VectorFormVol<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
-      bool form_to_be_assembled(VectorFormSurf<Scalar>* form, Traverse::State* current_state);
+      /// \param[in] apply_selection Whether the form has to pass the current form selection (not the case for the integration order).
+      bool form_to_be_assembled(VectorFormSurf<Scalar>* form, Traverse::State* current_state, bool apply_selection = true);
       /// Decides if the form will be assembled on this State.
       bool form_to_be_assembled(VectorFormDG<Scalar>* form, Traverse::State* current_state);
 
+      /// Whether the sparse structure of the CS (and block) matrices is built directly from the assembly lists
+      /// (create_sparse_structure(), the default), or through SparseMatrix::pre_add_ij() as for the other matrices.
+      /// Both give the same structure, the latter serves for comparison.
+      void use_assembly_list_pattern(bool to_set = true);
+
+      /// Selection of forms with respect to Form::is_solution_independent().
+      enum FormSelection
+      {
+        AllForms,
+        SolutionIndependentForms,
+        SolutionDependentForms,
+        NoForms
+      };
+
     protected:
+      /// Sparse structure of mat (without DG forms) built directly from the element assembly lists, instead of
+      /// the page lists of SparseMatrix::pre_add_ij(): the DOFs of all states are collected in parallel, then
+      /// the columns of the pattern are counted and filled in parallel, and handed over by SparseMatrix::alloc_with_pattern().
+      void create_sparse_structure(SparseMatrix<Scalar>* mat, std::vector<SpaceSharedPtr<Scalar> >& spaces, Traverse::State** states, unsigned int num_states, bool** blocks, int ndof);
+
+      /// Block layout of a BSRMatrix with one component per space: the unknowns at the same position of the
+      /// assembly lists of one element form a block. The spaces have to share the mesh and the element orders.
+      void create_block_layout(BSRMatrix<Scalar>* mat, std::vector<SpaceSharedPtr<Scalar> >& spaces, Traverse::State** states, unsigned int num_states, int ndof);
+
+      /// Decides if the form passes the selection.
+      bool form_selected(Form<Scalar>* form, FormSelection selection) const;
+
+      /// Remembers the pattern of cs_mat (if any) as previous_pattern, together with the spaces it was built for.
+      void set_previous_pattern(CSMatrix<Scalar>* cs_mat, const std::vector<SpaceSharedPtr<Scalar> >& spaces);
+      /// Decides if previous_pattern was built for these spaces (the same seq numbers and number of DOFs).
+      bool previous_pattern_matches(const std::vector<SpaceSharedPtr<Scalar> >& spaces, int ndof) const;
+
+      /// Currently assembled matrix / vector forms.
+      FormSelection matrix_form_selection;
+      FormSelection vector_form_selection;
+
       /// Spaces.
       unsigned int spaces_size;
 
+      /// See use_assembly_list_pattern().
+      bool assembly_list_pattern;
+
       /// Seq numbers of Space instances in spaces.
       int* sp_seq;
 
@@ -91,6 +135,10 @@ namespace Hermes
       /// If other conditions apply.
       bool matrix_structure_reusable;
       SparseMatrix<Scalar>* previous_mat;
+      /// Pattern of the last matrix created from scratch, shared by the next (CS) matrices while the structure is reusable.
+      SparsityPatternSharedPtr previous_pattern;
+      /// Seq numbers of the spaces previous_pattern was built for.
+      std::vector<int> previous_pattern_sp_seq;
       bool vector_structure_reusable;
       Vector<Scalar>* previous_rhs;
 
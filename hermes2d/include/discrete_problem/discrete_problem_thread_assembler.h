@@ -18,6 +18,7 @@
 
 #include "../weakform/weakform.h"
 #include "../shapeset/precalc.h"
+#include "../shapeset/sum_factorization.h"
 #include "../function/solution.h"
 #include "discrete_problem_helpers.h"
 #include "discrete_problem_integration_order_calculator.h"
@@ -86,6 +87,10 @@ namespace Hermes
       template<typename VectorFormType, typename Geom>
       void assemble_vector_form(VectorFormType* form, int order, Func<double>** test_fns, AsmList<Scalar>* current_als,
         int n_quadrature_points, Geom* geometry, double* jacobian_x_weights);
+      /// Vector volumetric form applied to all the test functions at once by sum factorization (affine quads, forms
+      /// providing VectorFormVol::integrand()).
+      /// \return Whether the form was assembled, if not, the test functions have to be used one by one.
+      bool assemble_vector_form_sum_factorization(VectorFormVol<Scalar>* form, AsmList<Scalar>* current_als, Func<Scalar>** u_ext_local, Func<Scalar>** ext_local);
       /// De-initialization of 1 state assembly
       void deinit_assembling_one_state();
 
@@ -104,6 +109,8 @@ namespace Hermes
 
       PrecalcShapesetAssembling** pss;
       RefMap** refmaps;
+      /// Sum factorization kernels (nullptr for spaces other than H1 and L2).
+      SumFactorizationKernel<Scalar>** sum_factorization_kernels;
       RefMap* rep_refmap;
       Solution<Scalar>** u_ext;
       std::vector<Transformable *> fns;
@@ -0,0 +1,217 @@
+/// This file is part of Hermes2D.
+///
+/// Hermes2D is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 2 of the License, or
+/// (at your option) any later version.
+///
+/// Hermes2D is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY;without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with Hermes2D. If not, see <http:///www.gnu.org/licenses/>.
+
+#ifndef __H2D_MATRIX_FREE_OPERATOR_H
+#define __H2D_MATRIX_FREE_OPERATOR_H
+
+#include "hermes_common.h"
+#include "weakform/weakform.h"
+#include "mixins2d.h"
+#include "shapeset/precalc.h"
+#include "shapeset/sum_factorization.h"
+#include "discrete_problem_selective_assembler.h"
+#include "discrete_problem_integration_order_calculator.h"
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    /// \brief The matrix of the matrix forms of a weak formulation, applied without being assembled.
+    ///
+    /// The product with a vector is computed element by element: the vector is gathered into the values of the discrete
+    /// function at the integration points (through the assembly lists), the matrix forms are applied to it against all
+    /// the test functions, and the results are scattered back. The result is the same as the product with the matrix
+    /// DiscreteProblem assembles (Dirichlet DOFs excluded, the Dirichlet lift belongs to the right-hand side), while the
+    /// storage is O(#integration points) instead of O(#nonzeros), which pays off for high polynomial degrees.
+    ///
+    /// prepare() traverses the meshes once and stores everything that does not depend on the vector - the integration
+    /// orders, the weights and physical points, the inverse reference maps and the assembly lists; it is called again
+    /// automatically when the spaces change. The states are split among the threads in contiguous blocks, each thread
+    /// stores the data of its block and sums its contributions into a private vector.
+    ///
+    /// On affine quads, the forms providing MatrixFormVol::integrand() (e.g. the default mass and diffusion forms) are
+    /// applied by sum factorization (see SumFactorizationKernel) in O(p^3) operations per element, the rest through
+    /// MatrixFormVol::value() / MatrixFormSurf::value() per test function.
+    ///
+    /// Limitations: H1 and L2 spaces, linear problems, no DG forms, no external functions. The forms get u_ext filled with
+    /// nullptr (there is no previous iterate), so a form reading u_ext (e.g. a Jacobian form with a solution-dependent
+    /// coefficient) crashes - this cannot be detected in advance, such weak formulations have to be assembled.
+    template<typename Scalar>
+    class HERMES_API MatrixFreeOperator :
+      public Hermes::Algebra::Matrix<Scalar>,
+      public Hermes::Solvers::KrylovOperator<Scalar>,
+      public Hermes::Hermes2D::Mixins::Parallel
+    {
+    public:
+      MatrixFreeOperator(WeakFormSharedPtr<Scalar> wf, std::vector<SpaceSharedPtr<Scalar> > spaces);
+      MatrixFreeOperator(WeakFormSharedPtr<Scalar> wf, SpaceSharedPtr<Scalar> space);
+      virtual ~MatrixFreeOperator();
+
+      /// Traverses the meshes and stores the vector-independent data.
+      /// Called by apply() if the spaces changed since the last call.
+      void prepare();
+
+      /// out = Matrix * in.
+      virtual void apply(const Scalar* in, Scalar* out);
+
+      /// Diagonal of the matrix (e.g. for a Jacobi preconditioner).
+      void get_diagonal(Scalar* diagonal);
+
+      /// Same as prepare().
+      virtual void alloc();
+      /// Releases the stored data.
+      virtual void free();
+      /// Not available - the matrix is never assembled.
+      virtual Scalar get(unsigned int m, unsigned int n) const;
+      /// Not available - the matrix is given by the weak formulation.
+      virtual void zero();
+      /// Not available - the matrix is given by the weak formulation.
+      virtual void add(unsigned int m, unsigned int n, Scalar v);
+      /// Not available - the matrix is never assembled.
+      virtual void export_to_file(const char *filename, const char *var_name, Hermes::Algebra::MatrixExportFormat fmt, char* number_format = "%lf");
+
+      /// Same as apply().
+      virtual void multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized = false) const;
+
+    protected:
+      /// Element (or sub-element) of one space on a state.
+      struct SpaceData
+      {
+        bool present;
+        bool const_jacobian;
+        /// Affine quad, the whole element - sum factorization possible.
+        bool tensor_product;
+        /// Inverse reference map (one or per integration point), offset to ThreadData::reals.
+        unsigned int inv_ref_map;
+        /// Assembly list (idx, dof) offset to ThreadData::ints, coef offset to ThreadData::coefs.
+        unsigned int al;
+        unsigned int coef;
+        unsigned short cnt;
+      };
+
+      /// Boundary edge of a state (only with surface matrix forms).
+      struct EdgeData
+      {
+        unsigned char isurf;
+        unsigned char np;
+        int order;
+        int edge_marker;
+        bool orientation;
+        /// Weights, x, y, nx, ny, tx, ty, offset to ThreadData::reals.
+        unsigned int geometry;
+        /// Index to ThreadData::space_data.
+        unsigned int space_data;
+      };
+
+      /// Traverse state.
+      struct StateData
+      {
+        Traverse::State* state;
+        int order;
+        unsigned char np;
+        /// Geometry - element id and marker.
+        int id;
+        int elem_marker;
+        /// Weights, x, y, offset to ThreadData::reals.
+        unsigned int geometry;
+        /// Index to ThreadData::space_data.
+        unsigned int space_data;
+        /// Index to ThreadData::edges.
+        unsigned int first_edge;
+        unsigned char num_edges;
+      };
+
+      /// Stored data and working structures of one thread.
+      struct ThreadData
+      {
+        ThreadData(MatrixFreeOperator<Scalar>* op);
+        ~ThreadData();
+
+        unsigned short spaces_size;
+        WeakFormSharedPtr<Scalar> wf;
+        PrecalcShapesetAssembling** pss;
+        RefMap** refmaps;
+        SumFactorizationKernel<Scalar>** kernels;
+
+        std::vector<double> reals;
+        std::vector<int> ints;
+        std::vector<Scalar> coefs;
+        std::vector<SpaceData> space_data;
+        std::vector<EdgeData> edges;
+        /// The longest assembly list.
+        unsigned short max_basis_size;
+
+        /// Basis functions (max_basis_size per space) and the gathered function (two parts - real and imaginary - per space).
+        Func<double>* basis;
+        Func<double>* gathered;
+        GeomVol<double> geometry;
+        GeomSurf<double> geometry_surf;
+        /// Private result.
+        Scalar* out;
+      };
+
+      /// Checks the spaces and the forms.
+      void check() const;
+      /// Whether the spaces changed since prepare().
+      bool spaces_changed() const;
+      /// Stores the data of one state (thread-local).
+      void prepare_state(ThreadData* td, Traverse::State* state, StateData* state_data, DiscreteProblemIntegrationOrderCalculator<Scalar>* order_calculator);
+      /// Sets the elements of the state to the precalculated shapesets.
+      void set_active_state(ThreadData* td, StateData* state_data);
+      /// Physical basis functions of the space at the points.
+      void init_basis(ThreadData* td, SpaceData* sd, unsigned short space_i, int order, unsigned char np);
+      /// The vector as a function of the space at the points (real and imaginary part), from the basis functions.
+      void gather(ThreadData* td, SpaceData* sd, unsigned short space_i, const Scalar* in, unsigned char np);
+      /// The vector as a function of the space at the points by sum factorization (tensor-product elements).
+      void gather_sum_factorization(ThreadData* td, SpaceData* sd, unsigned short space_i, const Scalar* in, unsigned char np);
+      /// Volumetric form applied to the gathered function against all the test functions by sum factorization.
+      /// \return Whether the form provides the integrand.
+      bool apply_form_sum_factorization(ThreadData* td, MatrixFormVol<Scalar>* form, StateData* state_data, Func<Scalar>** u_ext);
+      /// Form applied to the gathered function (trial) against the basis functions (test), or with the roles swapped
+      /// (the transposed block of a (anti)symmetric form).
+      template<typename FormType, typename Geom>
+      void apply_form(ThreadData* td, FormType* form, SpaceData* test_data, Func<double>* test_basis, Func<double>* trial, bool transposed,
+        unsigned char np, double* wt, Geom* geometry, Func<Scalar>** u_ext, double factor);
+      /// Diagonal entries of the form.
+      template<typename FormType, typename Geom>
+      void add_diagonal(ThreadData* td, FormType* form, SpaceData* data, Func<double>* basis,
+        unsigned char np, double* wt, Geom* geometry, Func<Scalar>** u_ext, double factor);
+      /// Applies the operator to the states of the thread, into its private vector.
+      /// \param[in] in The vector, nullptr for the diagonal.
+      void apply_states(int thread_number, const Scalar* in);
+      /// Runs apply_states() in parallel and sums the private vectors into out.
+      void run(const Scalar* in, Scalar* out);
+
+      /// Number of the parts of the gathered function (1 - real, 2 - complex).
+      static const unsigned char num_parts;
+
+      WeakFormSharedPtr<Scalar> wf;
+      std::vector<SpaceSharedPtr<Scalar> > spaces;
+      unsigned short spaces_size;
+      int* sp_seq;
+      bool prepared;
+
+      /// For the form selection (markers).
+      DiscreteProblemSelectiveAssembler<Scalar> selectiveAssembler;
+
+      Traverse::State** states;
+      unsigned int num_states;
+      StateData* state_data;
+      ThreadData** thread_data;
+      unsigned short max_basis_size;
+    };
+  }
+}
+#endif
@@ -81,6 +81,12 @@ namespace Hermes
         derivatives(x, y, dx, dy);
         return value(x, y);
       };
+
+      /// Function returning the values and derivatives at n points (all integration points of an element at once).
+      /// This is what the Solution uses for precalculation, the default calls value() and derivatives() point by point,
+      /// override it for evaluation over whole arrays.
+      /// \param[out] dx, dy Either both nullptr (derivatives not needed), or both arrays of length n.
+      virtual void exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const;
     };
 
     /// Serves for postprocessing of element-wise constant values (such as the error in adaptivity).
@@ -103,6 +109,9 @@ namespace Hermes
       /// Function returning the derivatives.
       virtual void derivatives(double x, double y, Scalar& dx, Scalar& dy) const;
 
+      /// The value of the active element at all points.
+      virtual void exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const;
+
       inline std::string getClassName() const { return "ExactSolutionConstantArray"; }
 
       void setArray(ValueType* valueArray);
@@ -151,6 +160,8 @@ namespace Hermes
 
       virtual void derivatives(double x, double y, Scalar& dx, Scalar& dy) const;
 
+      virtual void exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const;
+
       virtual Ord ord(double x, double y) const;
       virtual MeshFunction<Scalar>* clone() const;
 
@@ -175,6 +186,8 @@ namespace Hermes
 
       virtual void derivatives(double x, double y, Scalar& dx, Scalar& dy) const;
 
+      virtual void exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const;
+
       virtual Ord ord(double x, double y) const;
       virtual MeshFunction<Scalar>* clone() const;
     };
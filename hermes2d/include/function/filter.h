@@ -18,6 +18,7 @@
 
 #include "solution.h"
 #include <complex>
+#include <map>
 
 namespace Hermes
 {
@@ -384,6 +385,146 @@ namespace Hermes
 
       virtual void set_active_element(Element* e);
     };
+
+    template<typename Scalar> class ExpressionFilter;
+
+    /// \brief Expression over function values evaluated (fused) by ExpressionFilter.
+    /// A lightweight handle to a node of an expression tree, the nodes are shared, so the same subexpression may be used
+    /// several times, e.g.:
+    /// FilterExpression<double> u(sln_u), v(sln_v);
+    /// MeshFunctionSharedPtr<double> mag(new ExpressionFilter<double>(FilterExpression<double>::magnitude(u, v) - u));
+    /// The leaves are functions (values, or derivatives with the items H2D_FN_DX_0 etc.) and constants.
+    template<typename Scalar>
+    class HERMES_API FilterExpression
+    {
+    public:
+      /// Leaf - the value (or a derivative) of one component of a function.
+      /// \param[in] item One item (H2D_FN_VAL_0, H2D_FN_DX_0, H2D_FN_DY_0, H2D_FN_VAL_1, ...).
+      FilterExpression(MeshFunctionSharedPtr<Scalar> function, int item = H2D_FN_VAL_0);
+      /// Leaf - constant.
+      FilterExpression(Scalar constant);
+
+      FilterExpression operator+(const FilterExpression& other) const;
+      FilterExpression operator-(const FilterExpression& other) const;
+      FilterExpression operator*(const FilterExpression& other) const;
+      FilterExpression operator/(const FilterExpression& other) const;
+      FilterExpression operator-() const;
+
+      static FilterExpression square(const FilterExpression& expression);
+      static FilterExpression sqrt(const FilterExpression& expression);
+      static FilterExpression abs(const FilterExpression& expression);
+      /// sqrt(first^2 + second^2) - as in MagFilter.
+      static FilterExpression magnitude(const FilterExpression& first, const FilterExpression& second);
+
+      /// All (distinct) functions in the expression, in the order of their first appearance.
+      std::vector<MeshFunctionSharedPtr<Scalar> > get_functions() const;
+
+    protected:
+      enum Operation
+      {
+        Function,
+        Constant,
+        Sum,
+        Difference,
+        Product,
+        Quotient,
+        Negative,
+        Square,
+        SquareRoot,
+        AbsoluteValue
+      };
+
+      struct Node
+      {
+        Operation operation;
+        MeshFunctionSharedPtr<Scalar> function;
+        int item;
+        Scalar constant;
+        std::tr1::shared_ptr<Node> first, second;
+      };
+
+      FilterExpression(Operation operation, const FilterExpression* first, const FilterExpression* second);
+      void get_functions(Node* node, std::vector<MeshFunctionSharedPtr<Scalar> >& functions) const;
+
+      std::tr1::shared_ptr<Node> node;
+      friend class ExpressionFilter < Scalar > ;
+    };
+
+    /// ExpressionFilter evaluates a whole FilterExpression at once, instead of a tree of filters (e.g. MagFilter of
+    /// DiffFilters), where each filter re-evaluates its inputs and stores its own tables.
+    /// The expression is compiled into a linear program at construction:
+    /// - each distinct function is a single input of the filter (it is transformed and precalculated once),
+    /// - identical leaves (function, item) and identical subexpressions are evaluated once,
+    /// - the program runs over the integration points in batches (short loops of one operation, without branching),
+    ///   the intermediate results are kept in a few batch-sized registers.
+    /// The result is scalar, its derivatives are available (forward differentiation of the program) if no leaf is a derivative.
+    template<typename Scalar>
+    class HERMES_API ExpressionFilter : public Filter < Scalar >
+    {
+    public:
+      ExpressionFilter(const FilterExpression<Scalar>& expression);
+      virtual ~ExpressionFilter();
+
+      virtual Func<Scalar>* get_pt_value(double x, double y, bool use_MeshHashGrid = false, Element* e = nullptr);
+      virtual MeshFunction<Scalar>* clone() const;
+
+      /// Number of operations of the compiled program (leaves and constants not included).
+      int get_num_operations() const;
+      /// Number of distinct leaves (function, item).
+      int get_num_leaves() const;
+
+    protected:
+      typedef typename FilterExpression<Scalar>::Node Node;
+
+      /// Instruction of the program - operands are slots: leaves first (0 .. number of leaves - 1), then registers.
+      struct Instruction
+      {
+        typename FilterExpression<Scalar>::Operation operation;
+        int result, first, second;
+      };
+
+      /// Leaf - input function, its component and the index of the value (0 - value, 1 - dx, 2 - dy, ...).
+      struct Leaf
+      {
+        int function, item, component, value_index;
+      };
+
+      /// Collect the distinct leaves of the subtree, set the masks of the functions.
+      void add_leaves(Node* node);
+      /// Index of the leaf of the node (function), -1 if not added yet.
+      int find_leaf(Node* node) const;
+      /// Compile the subtree, returns the slot of its result.
+      int compile(Node* node, std::map<Node*, int>& compiled_nodes, std::map<std::pair<int, std::pair<int, int> >, int>& compiled_operations);
+      /// Allocation of the registers, setting of constants.
+      void init_registers();
+
+      /// Run the program.
+      /// \param[in] n Number of points.
+      /// \param[in] leaf_tables Values of the leaves (leaf_tables[3 * leaf + 0/1/2] - value/dx/dy).
+      /// \param[in] derivatives Whether to evaluate the derivatives as well.
+      /// \param[out] result Value, dx, dy.
+      void evaluate(int n, const Scalar* const* leaf_tables, bool derivatives, Scalar* result[3]);
+
+      /// Copy of the subtree with the functions replaced by their clones.
+      FilterExpression<Scalar> clone_expression(Node* node, const std::vector<MeshFunctionSharedPtr<Scalar> >& cloned_functions, std::map<Node*, FilterExpression<Scalar> >& cloned_nodes) const;
+
+      virtual void precalculate(unsigned short order, unsigned short mask);
+
+      FilterExpression<Scalar> expression;
+      std::vector<Leaf> leaves;
+      std::vector<Instruction> program;
+      /// Constants - (register, value).
+      std::vector<std::pair<int, Scalar> > constants;
+      int num_registers;
+      /// Slot of the result.
+      int result_slot;
+      /// Whether some leaf is a derivative (then the result has no derivatives).
+      bool derivative_leaves;
+      /// set_quad_order() masks of the functions (without / with derivatives of the value leaves).
+      std::vector<unsigned short> function_masks, function_masks_derivatives;
+      /// Registers (value, dx, dy planes, each num_registers x batch size).
+      std::vector<Scalar> registers;
+    };
   }
 }
 #endif
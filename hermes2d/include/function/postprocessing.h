@@ -114,6 +114,8 @@ namespace Hermes
 
       /// Integral calculator
       /// Abstract base class
+      /// The threads sum their contributions separately (compensated summation), the partial sums are then added in the
+      /// order of the threads, so that the results are reproducible for a given number of threads.
       template<typename Scalar>
       class HERMES_API IntegralCalculator :
         public Hermes::Hermes2D::Mixins::Parallel,
@@ -141,7 +143,9 @@ namespace Hermes
         std::vector<MeshFunctionSharedPtr<Scalar> > source_functions;
         int number_of_integrals;
 
-        void add_results(Scalar* results_local, Scalar* results);
+        /// Conversion of the markers (element or boundary ones) of the mesh of the first function.
+        /// \return Whether to integrate everywhere (HERMES_ANY).
+        bool get_internal_markers(std::vector<std::string> markers, bool boundary, std::vector<int>& internal_markers) const;
       };
 
       /// Volumetric integral calculator
@@ -161,6 +165,12 @@ namespace Hermes
         /// Not designed to be overriden.
         Scalar* calculate(std::vector<std::string> markers);
         using IntegralCalculator<Scalar>::calculate;
+
+        /// Evaluates several calculators (each with its own functions, integrals and orders) in one traversal of the union
+        /// of their meshes, instead of one traversal per calculate().
+        /// \param[in] markers The markers, common to all the calculators.
+        /// \return The results of the calculators (each as the result of calculate()).
+        static std::vector<Scalar*> calculate_batch(std::vector<VolumetricIntegralCalculator<Scalar>*> calculators, std::vector<std::string> markers);
       };
 
       /// Surface integral calculator
@@ -180,6 +190,12 @@ namespace Hermes
         /// Not designed to be overriden.
         Scalar* calculate(std::vector<std::string> markers);
         using IntegralCalculator<Scalar>::calculate;
+
+        /// Evaluates several calculators (each with its own functions, integrals and orders) in one traversal of the union
+        /// of their meshes, instead of one traversal per calculate().
+        /// \param[in] markers The markers, common to all the calculators.
+        /// \return The results of the calculators (each as the result of calculate()).
+        static std::vector<Scalar*> calculate_batch(std::vector<SurfaceIntegralCalculator<Scalar>*> calculators, std::vector<std::string> markers);
       };
     }
   }
@@ -123,6 +123,7 @@ namespace Hermes
       template<typename T> friend class DiscreteProblem;
       template<typename T> friend class DiscreteProblemDGAssembler;
       template<typename T> friend class DiscreteProblemThreadAssembler;
+      template<typename T> friend class MatrixFreeOperator;
       template<typename T> friend class NeighborSearch;
       friend class CurvMap;
       friend class Traverse;
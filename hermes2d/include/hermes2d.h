@@ -24,6 +24,7 @@
 #include "solver/picard_solver.h"
 #include "solver/linear_solver.h"
 #include "solver/nox_solver.h"
+#include "solver/matrix_free_solver.h"
 
 #include "boundary_conditions/essential_boundary_conditions.h"
 
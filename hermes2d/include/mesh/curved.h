@@ -141,6 +141,32 @@ namespace Hermes
       /// array of the coefficients
       double2* coeffs;
 
+      /// The same mapping as a polynomial in the reference coordinates - coefficients of L_i(xi_1) * L_j(xi_2), L_i
+      /// being the Legendre polynomials (index i * (order + 1) + j), so that RefMap evaluates it by the three-term
+      /// recurrence instead of summing the precalculated shape functions. Computed in update_refmap_coeffs(), nullptr
+      /// for too high orders.
+      double2* poly_coeffs;
+
+      /// Maximum order of the mapping with the polynomial form.
+      static const unsigned short max_poly_order = 10;
+      /// Maximum order of the mapping with the polynomial form on triangles. The interpolation there is conditioned as
+      /// that of the monomials on the equispaced lattice (~1e4 for order 6, ~1e8 for order 10), so the shape functions
+      /// are used above this order.
+      static const unsigned short max_poly_order_triangle = 6;
+
+      /// Conversion of 'coeffs' into 'poly_coeffs' - interpolation at the Chebyshev-Gauss-Lobatto points (quads),
+      /// at the equispaced lattice (triangles).
+      void calc_poly_coeffs(Element* e);
+
+      /// Legendre polynomials L_0 .. L_{n-1} at xi (and their derivatives if 'derivatives' is not nullptr).
+      static void calc_legendre(unsigned short n, double xi, double* values, double* derivatives);
+
+      /// Evaluation of the polynomial form at n points of the reference domain.
+      /// \param[out] x, y Physical coordinates.
+      /// \param[out] x_dxi_1, x_dxi_2, y_dxi_1, y_dxi_2 Jacobi matrix of the mapping, nullptr if not needed.
+      void calc_poly_ref_map(unsigned short n, const double* xi_1, const double* xi_2, double* x, double* y,
+        double* x_dxi_1, double* x_dxi_2, double* y_dxi_1, double* y_dxi_2) const;
+
       void get_mid_edge_points(Element* e, double2* pt, unsigned short n);
 
       /// Recursive calculation of the basis function N_i,k(int i, int k, double t, double* knot).
@@ -73,8 +73,6 @@ namespace Hermes
 
       /// parent id numbers
       int p1, p2;
-      /// next node in hash synonym list
-      Node* next_hash;
 
       /// Returns true if the (vertex) node is constrained.
       bool is_constrained_vertex() const;
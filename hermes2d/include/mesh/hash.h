@@ -35,6 +35,8 @@ namespace Hermes
     ///
     /// HashTable is a base class for Mesh. It serves as a container for all nodes
     /// of a mesh. Moreover, it has node searching functions based on hash tables.
+    /// The hash tables are flat arrays with open addressing (linear probing), the parent
+    /// id numbers are stored in the table itself, so that a search does not touch the nodes.
     ///
     class HERMES_API HashTable : public Hermes::Mixins::Loggable
     {
@@ -77,7 +79,7 @@ namespace Hermes
       Array<Node> nodes;
 
       /// Initializes the hash table.
-      /// \param size[in] Hash table size; must be a power of two.
+      /// \param size[in] Initial hash table size; must be a power of two. The tables grow when they get half full.
       void init(int size = H2D_DEFAULT_HASH_SIZE);
 
       /// Copies another hash table contents
@@ -95,24 +97,56 @@ namespace Hermes
       /// Removes an edge node with parent id's p1 and p2.
       void remove_edge_node(int id);
 
+      /// Inserts nodes (with their types and parents p1 <= p2 set) created directly in the array 'nodes'
+      /// into the hash tables, by num_threads threads (see Mesh::refine_elements_id()).
+      void insert_nodes(const std::vector<int>& node_ids, int num_threads);
+
       // Internal members
     private:
+      /// One slot of a hash table.
+      struct HashEntry
+      {
+        /// Parent id numbers, p1 <= p2.
+        int p1, p2;
+        /// Node id, -1 for an empty slot.
+        int id;
+      };
 
       /// Vertex node hash table
-      Node** v_table;
+      HashEntry* v_table;
       /// Edge node hash table
-      Node** e_table;
+      HashEntry* e_table;
+
+      /// Table size minus one (sizes are powers of two).
+      int v_mask, e_mask;
+      /// Number of occupied slots.
+      int v_count, e_count;
+
+      inline int hash(int p1, int p2, int mask) const
+      {
+        unsigned long long key = ((unsigned long long)(unsigned int)p1 << 32) | (unsigned int)p2;
+        return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+      }
+
+      /// Returns the id of the node with parent ids p1 <= p2 stored in the table, -1 if there is none.
+      int search_table(const HashEntry* table, int mask, int p1, int p2) const;
+
+      /// Inserts the node id with parent ids p1 <= p2 into the table, grows the table if necessary.
+      void insert_to_table(HashEntry*& table, int& mask, int& count, int p1, int p2, int id);
 
-      int mask;
+      /// Inserts the nodes of one type into the table (insert_nodes()): the table is grown at once, every thread
+      /// inserts the nodes whose home slots lie in its part of the table, the probes leaving the part are finished
+      /// afterwards, in the order of the nodes.
+      void insert_to_table(HashEntry*& table, int& mask, int& count, const std::vector<int>& node_ids, int type, int num_threads);
 
-      inline int hash(int p1, int p2) const { return (984120265 * p1 + 125965121 * p2) & mask; }
+      /// Rehashes the table to the size (a power of two).
+      void resize_table(HashEntry*& table, int& mask, int size);
 
-      /// Searches a list of hash synonyms given the first list item.
-      /// Returns the node matching the parent ids p1 and p2.
-      Node* search_list(Node* node, int p1, int p2) const;
+      /// Removes the node id with parent ids p1 <= p2 from the table.
+      void remove_from_table(HashEntry* table, int mask, int& count, int p1, int p2, int id);
 
-      /// Creates a copy of a hash synonym list.
-      void copy_list(Node** ptr, Node* node);
+      /// Allocates an empty table.
+      static HashEntry* alloc_table(int size);
 
       friend struct Node;
       friend class MeshUtil;
@@ -27,6 +27,7 @@ namespace Hermes
   {
     class Element;
     class HashTable;
+    class MeshFaceTable;
 
     template<typename Scalar> class Space;
     template<typename Scalar> class KellyTypeAdapt;
@@ -100,6 +101,11 @@ namespace Hermes
       MeshHashGrid* meshHashGrid;
 #pragma endregion
 
+#pragma region MeshFaceTable
+      /// Neighborhoods of the inner edges for the DG assembling and error calculation, see MeshFaceTable.
+      MeshFaceTable* meshFaceTable;
+#pragma endregion
+
 #pragma region MarkerArea
       double get_marker_area(int marker);
 
@@ -143,6 +149,12 @@ namespace Hermes
 
       /// For internal use.
       unsigned get_seq() const;
+
+      /// Renumbers the base elements, so that their ids follow a Hilbert space-filling curve through the element centers.
+      /// Consecutive elements (and therefore traversal states, DOFs) are then close to each other in space.
+      /// Only possible for a mesh without refinements, the mesh readers call it if the parameter spaceFillingCurveOrdering is set.
+      /// \param[out] new_ids New id of each base element, indexed by the original id.
+      void reorder_base_elements(std::vector<int>& new_ids);
 #pragma endregion
 
 #pragma region refinements
@@ -154,6 +166,15 @@ namespace Hermes
       /// refine vertically.
       void refine_element_id(int id, int refinement = 0);
 
+      /// Refines elements, the result (including all element and node ids) is the same as of calling
+      /// refine_element_id(elem_ids[i], refinements[i]) for all i in this order, but the sons and nodes
+      /// are created by num_threads threads: the refinements are split into contiguous partitions,
+      /// every partition counts the nodes / elements it creates / removes, the ids are assigned
+      /// to them in the serial order, then the partitions fill them in parallel.
+      /// Curved elements and triangles refined to quads (refinement 3) are refined by refine_element_id().
+      /// \param[in] refinements Same meaning as in refine_element_id(), -1 for an element not to be refined.
+      void refine_elements_id(const std::vector<int>& elem_ids, const std::vector<int>& refinements, int num_threads);
+
       /// Refines all elements.
       /// \param[in] refinement Same meaning as in refine_element_id().
       void refine_all_elements(int refinement = 0, bool mark_as_initial = false);
@@ -345,6 +366,13 @@ namespace Hermes
       /// straight edges.
       void refine_quad_to_quads(Element* e, int refinement = 0);
 
+      /// Internal structures of refine_elements_id(), see mesh.cpp.
+      struct ParallelRefinementKey;
+      struct ParallelRefinementEvent;
+      struct ParallelRefinementPlan;
+      struct ParallelRefinementNode;
+      class ParallelRefinement;
+
       void convert_element_to_base_id(int id);
       void convert_triangles_to_base(Element* e);
       void convert_quads_to_base(Element* e);
@@ -434,6 +462,13 @@ namespace Hermes
       /// Refinement "-1" stands for unrefinement.
       std::vector<std::pair<unsigned int, int> > refinements;
 
+      /// If not nullptr, curved sons created by refine_element() are only collected here, and the (expensive)
+      /// coefficients of their reference mappings are computed later by the caller, possibly in parallel
+      /// (see Adapt::refine_meshes()). The topology (nodes, elements, ids) is not affected by this.
+      std::vector<Element*>* deferred_curved_sons;
+      /// Computes the reference mapping coefficients of a curved son, or defers it (see deferred_curved_sons).
+      void update_curved_son(Element* son);
+
       /// Refines a quad element into four quads, or two quads (horizontally or
       /// vertically. If mesh != nullptr, the new_ elements are incorporated into
       /// the mesh. The option mesh == nullptr is used to perform adaptive numerical
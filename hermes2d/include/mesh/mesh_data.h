@@ -22,6 +22,9 @@
 # include <sstream>
 # include <vector>
 # include <cstdlib>
+# include <cstdio>
+# include <cstring>
+# include <cctype>
 # include <cassert>
 # include <map>
 
@@ -49,6 +52,17 @@ namespace Hermes
       /// Restores ';' to blank spaces
       std::string restore(std::string &str);
 
+      /// Parses the whole file from one buffer, numbers are converted in place without intermediate strings.
+      /// Returns false (and leaves the data in an undefined state) if the file uses variables or any other
+      /// construct the generic parser (parse_mesh_generic) has to handle.
+      bool parse_mesh_fast();
+
+      /// Parses the input mesh file line by line, including variables.
+      void parse_mesh_generic();
+
+      /// Clears all the data.
+      void clear();
+
     public:
       /// Map for storing variables in input mesh file
       std::map< std::string, std::vector< std::string > > vars_;
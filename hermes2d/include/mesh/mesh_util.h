@@ -83,6 +83,12 @@ namespace Hermes
       /// Loads one circular arc.
       /// \param[in] skip_check Skip check that the edge exists, in case of subdomains.
       static Arc* load_arc(MeshSharedPtr mesh, int id, Node** en, int p1, int p2, double angle, bool skip_check = false);
+
+      /// Orders points along a Hilbert space-filling curve through their bounding box.
+      /// \param[in] x, y Coordinates of the points.
+      /// \param[in] count Number of the points.
+      /// \param[out] order Indices of the points in the order along the curve, allocated by the caller.
+      static void space_filling_curve_order(const double* x, const double* y, int count, int* order);
     };
 
     class MeshHashGrid
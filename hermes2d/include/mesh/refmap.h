@@ -214,6 +214,11 @@ namespace Hermes
 
       void calc_tangent(int edge, int eo);
 
+      /// Evaluates the polynomial form of a curvilinear element's mapping (CurvMap::poly_coeffs) at the (sub-element
+      /// transformed) points of the given order, instead of summing the shape functions of the reference map.
+      /// \return false if the element has no polynomial form (the shape functions have to be used).
+      bool calc_poly_ref_map(int order, double* x, double* y, double* x_dxi_1, double* x_dxi_2, double* y_dxi_1, double* y_dxi_2);
+
       /// Finds the necessary quadrature degree needed to integrate the inverse reference mapping
       /// matrix alone. This is added to the total integration order in weak form itegrals.
       int calc_inv_ref_order();
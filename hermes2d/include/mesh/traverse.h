@@ -96,9 +96,12 @@ namespace Hermes
         template<typename Scalar> friend class DiscreteProblem;
         template<typename T> friend class DiscreteProblemDGAssembler;
         template<typename T> friend class DiscreteProblemThreadAssembler;
+        template<typename T> friend class MatrixFreeOperator;
       };
 
       /// Returns all states on the passed meshes.
+      /// If the parameter spaceFillingCurveOrdering is set, the states are ordered along a space-filling curve
+      /// through the centers of their representing elements, otherwise they follow the base elements and refinement trees.
       /// \param[in] meshes Meshes.
       /// \param[out] num Number of states.
       /// \return The states.
@@ -117,6 +120,8 @@ namespace Hermes
       void finish();
       /// Used by get_states.
       void init_transforms(State* s, unsigned char i);
+      /// Used by get_states.
+      void reorder_states(State** states, int count);
 
 #pragma region union-mesh
       static UniData** construct_union_mesh(unsigned char n, MeshSharedPtr* meshes, MeshSharedPtr unimesh);
@@ -149,6 +154,7 @@ namespace Hermes
       template<typename T> friend class DiscreteProblem;
       template<typename T> friend class DiscreteProblemDGAssembler;
       template<typename T> friend class DiscreteProblemIntegrationOrderCalculator;
+      template<typename T> friend class MatrixFreeOperator;
       template<typename T> friend class Filter;
       template<typename T> friend class SimpleFilter;
       friend class Views::Orderizer;
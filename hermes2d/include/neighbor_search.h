@@ -16,6 +16,65 @@ namespace Hermes
   {
     template<typename Scalar> class ErrorThreadCalculator;
 
+    /*** Class MeshFaceTable. ***/
+
+    /// \brief Neighborhoods of all inner edges of the active elements of a mesh.
+    /// For every (active element, edge) the table stores what NeighborSearch::set_active_edge finds by going up and down
+    /// the element tree - the neighbor elements, their local edges and orientations and the sub-element transformations.
+    /// NeighborSearch::set_active_edge copies the stored neighborhood instead of searching whenever the mesh has an up-to-date
+    /// table, so the search is done once per mesh state instead of once per assembling (error calculation).
+    /// The table is owned by the mesh and it is rebuilt (in parallel) on the first get() after the mesh seq changes,
+    /// i.e. after the mesh has been refined.
+    class HERMES_API MeshFaceTable
+    {
+    public:
+      ~MeshFaceTable();
+
+      /// Makes sure the mesh has an up-to-date table and returns it.
+      /// Not thread-safe, it is meant to be called before the (parallel) assembling.
+      static MeshFaceTable* get(MeshSharedPtr mesh);
+
+      /// One neighbor across an edge.
+      struct Face
+      {
+        /// The neighbor element.
+        Element* neighbor;
+        /// Local number of the edge on the neighbor.
+        unsigned char neighbor_edge;
+        /// Orientation of the neighbor edge with respect to the edge of the central element.
+        bool orientation;
+        /// Transformations of the central element (a go-down neighborhood), or of the neighbor (a go-up one).
+        unsigned char num_levels;
+        unsigned char transf[Transformable::H2D_MAX_TRN_LEVEL];
+      };
+
+      /// The neighbors across the edge of the element.
+      /// \param[out] num_faces Number of the neighbors.
+      /// \param[out] neighborhood_type The NeighborSearch neighborhood type.
+      /// \return nullptr if the edge is not stored (a boundary edge, an element not active when the table was built).
+      const Face* get_faces(int element_id, int edge, int& num_faces, int& neighborhood_type) const;
+
+      int get_mesh_seq() const;
+
+      /// Number of the stored neighbors (over all edges).
+      int get_num_faces() const;
+
+    private:
+      /// Builds the table of the current mesh state.
+      MeshFaceTable(MeshSharedPtr mesh);
+
+      /// For detecting changes to the mesh that would require the table to be recalculated.
+      int mesh_seq;
+
+      /// Number of element ids covered by the table.
+      int num_element_ids;
+      /// Position of the neighbors of each (element id, edge) in faces, (num_element_ids * H2D_MAX_NUMBER_EDGES + 1).
+      int* edge_faces_ptr;
+      /// Neighborhood type of each (element id, edge), -1 for the edges not stored.
+      signed char* edge_neighborhood_type;
+      Face* faces;
+    };
+
     /*** Class NeighborSearch. ***/
 
     /*!\class NeighborSearch neighbor_search.h "src/neighbor_search.h"
@@ -443,6 +502,10 @@ namespace Hermes
       /// Cleaning of internal structures before a new_ edge is set as active.
       void reset_neighb_info();
 
+      /// Fill in the neighborhood of the active edge from the face table of the mesh.
+      /// \return false if the mesh has no up-to-date table or the edge is not stored in it.
+      bool set_active_edge_from_face_table();
+
       /*** Quadrature on the active edge. ***/
       Quad2D* quad;
 
@@ -459,6 +522,7 @@ namespace Hermes
       template<typename T> friend class DiscreteProblemDGAssembler;
       template<typename T> friend class DiscreteProblemIntegrationOrderCalculator;
       template<typename T> friend class ErrorThreadCalculator<T>::DGErrorCalculator;
+      friend class MeshFaceTable;
     };
   }
 }
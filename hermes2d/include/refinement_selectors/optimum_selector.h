@@ -40,6 +40,16 @@ namespace Hermes
         /// Set the score DOF exponent.
         void set_dof_score_exponent(double exponent);
 
+        /// Returns the time (in seconds) spent in select_refinement() on elements of a given mode.
+        /** The time is summed over all threads. */
+        double get_selection_time(ElementMode2D mode) const;
+
+        /// Returns the number of elements of a given mode processed by select_refinement().
+        int get_selection_count(ElementMode2D mode) const;
+
+        /// Resets the statistics returned by get_selection_time() and get_selection_count().
+        void reset_selection_statistics();
+
       protected:
         /// Constructor.
         /** \note Parameters \a vertex_order and \a edge_bubble_order fixes the fact that a shapeset returns a valid index even though a given shape is not invalid in the space.
@@ -258,6 +268,11 @@ namespace Hermes
 
         /// Score DOF exponent. Used in evaluate_cands_score.
         double dof_score_exponent;
+
+        /// Time spent in select_refinement(). The index is a mode (ElementMode2D).
+        double selection_time[H2D_NUM_MODES];
+        /// Number of calls of select_refinement(). The index is a mode (ElementMode2D).
+        int selection_count[H2D_NUM_MODES];
       };
     }
   }
@@ -240,6 +240,26 @@ namespace Hermes
         *  If record is nullptr, the corresponding matrix has to be calculated. */
         ProjMatrixCache proj_matrix_cache[H2D_NUM_MODES];
 
+        /// A cache of diagonals of Cholesky factors of the matrices in ProjBasedSelector::proj_matrix_cache.
+        /** Matrices are factorized in place by choldc(): the lower triangle holds the factor, the upper
+        *  triangle keeps the original matrix. A matrix is usable for solving iff its diagonal here is not nullptr. */
+        typedef double* ProjMatrixDiagCache[H2DRS_MAX_ORDER + 2][H2DRS_MAX_ORDER + 2];
+
+        /// Diagonals of Cholesky factors of projection matrices. Indexed as ProjBasedSelector::proj_matrix_cache.
+        ProjMatrixDiagCache proj_matrix_diag_cache[H2D_NUM_MODES];
+
+        /// Cholesky factors of projection matrices of the leading shapes of OptimumSelector::shape_indices.
+        /** The first index is the mode, the second one is a uniform order P; the matrix is built over the first
+        *  OptimumSelector::next_order_shape[mode][P] shapes. Since the basis is hierarchic, the leading block of such
+        *  a factor is the factor of the projection matrix of any shorter prefix of the shapes, so a single factor
+        *  serves all candidate orders whose shape list is a prefix (all orders of triangles and uniform orders of quads).
+        *  Factors of lower orders are kept until destruction as other threads may still be using them. */
+        double** prefix_factor_cache[H2D_NUM_MODES][H2DRS_MAX_ORDER + 2];
+        /// Diagonals of the factors in ProjBasedSelector::prefix_factor_cache.
+        double* prefix_factor_diag_cache[H2D_NUM_MODES][H2DRS_MAX_ORDER + 2];
+        /// The highest order in ProjBasedSelector::prefix_factor_cache available for a mode. -1 if none.
+        int prefix_factor_order[H2D_NUM_MODES];
+
         /// A coefficient that multiplies error of H-candidate. The default value is ::H2DRS_DEFAULT_ERR_WEIGHT_H.
         double error_weight_h;
         /// A coefficient that multiplies error of P-candidate. The default value is ::H2DRS_DEFAULT_ERR_WEIGHT_P.
@@ -297,6 +317,8 @@ namespace Hermes
           Scalar* shape_coeffs;
           /// An encoded maximum order of the projection. If triangle, the vertical order is equal to the horizontal order.
           int max_quad_order;
+          /// A scratch array of the size ::MAX_NUMBER_FUNCTION_VALUES_FOR_SELECTORS x (number of integration points) for values of the projection.
+          Scalar* proj_values;
         };
 
         /// Integration points in the reference domain of an element of a candidate.
@@ -326,6 +348,26 @@ namespace Hermes
           TrfShapeExp& svals;
         };
 
+        /// Returns a Cholesky-factorized projection matrix for a given list of shapes.
+        /** If the list is a prefix of OptimumSelector::shape_indices, the leading block of a factor from
+        *  ProjBasedSelector::prefix_factor_cache is returned (the cache is extended up to \a max_prefix_order if needed).
+        *  Otherwise the matrix for the given order is built and factorized in ProjBasedSelector::proj_matrix_cache.
+        *  \param[in] is_prefix True if \a shape_inxs are the first \a num_shapes shapes of OptimumSelector::shape_indices.
+        *  \param[in] max_prefix_order The highest uniform order that the current element may need.
+        *  \param[out] diag The diagonal of the factor.
+        *  \return The factor to be passed to cholsl() along with \a diag and \a num_shapes. */
+        double** get_factorized_projection_matrix(const ElementMode2D mode, double3* gip_points, int num_gip_points, int order_h, int order_v, const int* shape_inxs, int num_shapes, bool is_prefix, int max_prefix_order, double*& diag);
+
+        /// Evaluates an expansion of a projection at all integration points.
+        /** The outer loop runs over shapes and the inner one over integration points, i.e. the inner loop is an axpy on
+        *  contiguous arrays which the compiler vectorizes. Use in evaluate_error_squared_subdomain() in favor of summing
+        *  the shapes point by point.
+        *  \param[in] elem_proj A projection.
+        *  \param[in] inx_expansion An index of a function expansion (f, df/dx, ...).
+        *  \param[in] num_gip_points A number of integration points.
+        *  \param[out] proj_values Values of the expansion at integration points. */
+        static void evaluate_projection_expansion(const ElemProj& elem_proj, int inx_expansion, int num_gip_points, Scalar* proj_values);
+
         /// Returns an array of values of the reference solution at integration points.
         /** The method have to set an active element and an quadrature on its own.
         *
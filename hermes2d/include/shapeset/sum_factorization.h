@@ -0,0 +1,116 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_SUM_FACTORIZATION_H
+#define __H2D_SUM_FACTORIZATION_H
+
+#include "shapeset.h"
+#include "../quadrature/quad.h"
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    /// Maximum number of points of the 1D rules the quad rules are made of.
+#define H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D 13
+
+    /// \brief Sum factorization of shape functions on quads.
+    ///
+    /// The quad shape functions of the H1 and L2 shapesets are products of 1D functions, phi(x, y) = c * X(x) * Y(y), and the
+    /// quad rules of Quad2DStd are tensor products of 1D Gauss rules. The values (and gradients) of a linear combination of
+    /// the shape functions at all the points of a rule with n x n points are then obtained by contracting one direction after
+    /// the other - O(p^3) operations instead of O(p^4) through the 2D tables. The same holds for the transposed operation,
+    /// i.e. integrating point values against all the shape functions at once (the residual of a vector form).
+    ///
+    /// The factors are found numerically from the values at the points of the rule, so that any shapeset with tensor-product
+    /// quad functions is handled, and they are cached per rule. Functions without this structure (the constrained ones, or
+    /// a general shapeset) make set_basis() fail, the caller then has to use the 2D tables.
+    /// All derivatives are with respect to the reference coordinates, the points are those of the Quad2DStd rule
+    /// (point i * n + j has the coordinates (x_i, y_j)).
+    template<typename Scalar>
+    class HERMES_API SumFactorizationKernel
+    {
+    public:
+      /// \param shapeset[in] Scalar (H1 or L2) shapeset.
+      SumFactorizationKernel(Shapeset* shapeset);
+      ~SumFactorizationKernel();
+
+      /// Sets the local basis and the rule.
+      /// \param[in] num_fns Number of the shape functions.
+      /// \param[in] indices Shape indices (e.g. AsmList::idx).
+      /// \param[in] order Index of the quad rule (of Quad2DStd).
+      /// \return Whether all the functions could be factorized, if not, the kernel can not be used for this basis.
+      bool set_basis(unsigned short num_fns, const int* indices, unsigned short order);
+
+      /// Number of points of the current rule in one direction.
+      unsigned char get_num_points_1d() const;
+
+      /// Values (and reference derivatives) of sum_k coeffs[k] * phi_k at all the points of the rule.
+      /// \param[out] dx, dy May be nullptr.
+      void evaluate(const Scalar* coeffs, Scalar* values, Scalar* dx, Scalar* dy);
+
+      /// result[k] = sum_q (f[q] * phi_k(q) + f_x[q] * dphi_k/dx(q) + f_y[q] * dphi_k/dy(q)), the weights have to be
+      /// included in f, f_x, f_y.
+      /// \param[in] f, f_x, f_y May be nullptr.
+      void integrate(const Scalar* f, const Scalar* f_x, const Scalar* f_y, Scalar* result);
+
+    protected:
+      /// One shape function as c * X(x) * Y(y).
+      struct Factorization
+      {
+        /// 0 - not calculated yet, 1 - factorized, -1 - not a product.
+        signed char state;
+        unsigned short x;
+        unsigned short y;
+        double c;
+      };
+
+      /// The 1D factors (values and derivatives at the points of the 1D rule) and factorizations for one rule.
+      struct Rule
+      {
+        unsigned char np;
+        double* points;
+        std::vector<double> factor_values;
+        std::vector<double> factor_derivatives;
+        unsigned short num_factors;
+        Factorization* fns;
+      };
+
+      /// Factorization of the shape function (into rule->fns[index]).
+      void factorize(Rule* rule, int index);
+      /// Finds the (normalized) factor among the stored ones, or stores a new one.
+      unsigned short find_factor(Rule* rule, const double* values, const double* derivatives);
+
+      Shapeset* shapeset;
+      unsigned short max_index;
+      Rule* rules[g_max_quad + 1];
+
+      /// Current basis.
+      Rule* rule;
+      unsigned short num_fns;
+      /// Functions grouped by their X factor.
+      unsigned short num_groups;
+      unsigned short group_factor[H2D_MAX_LOCAL_BASIS_SIZE];
+      unsigned short fn_group[H2D_MAX_LOCAL_BASIS_SIZE];
+      unsigned short fn_y[H2D_MAX_LOCAL_BASIS_SIZE];
+      double fn_c[H2D_MAX_LOCAL_BASIS_SIZE];
+
+      /// Partial contractions (per group and point in the y direction).
+      Scalar partial[H2D_MAX_LOCAL_BASIS_SIZE][H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+      Scalar partial_d[H2D_MAX_LOCAL_BASIS_SIZE][H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+    };
+  }
+}
+#endif
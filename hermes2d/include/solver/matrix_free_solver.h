@@ -0,0 +1,118 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file matrix_free_solver.h
+\brief Linear solver without an assembled matrix.
+*/
+#ifndef __H2D_MATRIX_FREE_SOLVER_H_
+#define __H2D_MATRIX_FREE_SOLVER_H_
+
+#include "discrete_problem/matrix_free_operator.h"
+#include "solvers/krylov_solver.h"
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    /// Krylov method of MatrixFreeSolver.
+    enum MatrixFreeKrylovMethod
+    {
+      /// Conjugate gradients - symmetric (Hermitian) positive definite problems.
+      MatrixFreeCG,
+      /// Restarted GMRES - general problems.
+      MatrixFreeGMRES
+    };
+
+    /// \brief Class for solving linear problems by a Krylov method with a MatrixFreeOperator.
+    /// Only the right-hand side is assembled (with the Dirichlet lift), the matrix is applied element by element
+    /// in every iteration. Optionally Jacobi-preconditioned by the diagonal of the operator.<br>
+    /// The same limitations as those of MatrixFreeOperator apply: the problem has to be linear, and the matrix forms must not
+    /// read u_ext (they get nullptr there, so e.g. the Jacobian forms with a solution-dependent coefficient crash).<br>
+    /// Typical usage:<br>
+    /// Hermes::Hermes2D::MatrixFreeSolver<double> solver(wf, space);<br>
+    /// solver.set_tolerance(1e-10);<br>
+    /// solver.solve();<br>
+    /// Hermes::Hermes2D::Solution<double>::vector_to_solution(solver.get_sln_vector(), space, sln);<br>
+    template <typename Scalar>
+    class HERMES_API MatrixFreeSolver : public Hermes::Mixins::Loggable, public Hermes::Mixins::TimeMeasurable
+    {
+    public:
+      MatrixFreeSolver(WeakFormSharedPtr<Scalar> wf, SpaceSharedPtr<Scalar> space);
+      MatrixFreeSolver(WeakFormSharedPtr<Scalar> wf, std::vector<SpaceSharedPtr<Scalar> > spaces);
+      virtual ~MatrixFreeSolver();
+
+      /// Solve.
+      /// \param[in] coeff_vec Initial guess, nullptr for zero.
+      void solve(Scalar* coeff_vec = nullptr);
+
+      /// Get sln vector.
+      Scalar* get_sln_vector();
+
+      /// Default: MatrixFreeCG.
+      void set_krylov_method(MatrixFreeKrylovMethod method);
+      /// Relative tolerance of the residual.
+      /// Default: 1e-8.
+      void set_tolerance(double relative_tolerance);
+      /// Default: 1000.
+      void set_max_iterations(int max_iterations);
+      /// Krylov subspace dimension of GMRES.
+      /// Default: 30.
+      void set_gmres_restart(int restart);
+      /// Jacobi preconditioning.
+      /// Default: true.
+      void use_jacobi_preconditioner(bool to_set);
+
+      /// Number of iterations of the last solve().
+      int get_num_iters() const;
+      /// Relative residual of the last solve().
+      double get_relative_residual() const;
+
+      /// The operator (e.g. to multiply by the matrix).
+      MatrixFreeOperator<Scalar>* get_operator();
+
+    protected:
+      /// Multiplication by the inverse of the diagonal.
+      class JacobiPreconditioner : public Hermes::Solvers::KrylovOperator<Scalar>
+      {
+      public:
+        JacobiPreconditioner();
+        virtual ~JacobiPreconditioner();
+        /// Takes the diagonal of the operator and inverts it, zero entries (no contribution) are replaced by one.
+        void init(MatrixFreeOperator<Scalar>* op, int size);
+        virtual void apply(const Scalar* in, Scalar* out);
+
+      protected:
+        Scalar* inverse_diagonal;
+        int size;
+      };
+
+      std::vector<SpaceSharedPtr<Scalar> > spaces;
+      WeakFormSharedPtr<Scalar> wf;
+      MatrixFreeOperator<Scalar> op;
+      JacobiPreconditioner preconditioner;
+
+      MatrixFreeKrylovMethod method;
+      double relative_tolerance;
+      int max_iterations;
+      int gmres_restart;
+      bool jacobi;
+
+      int num_iters;
+      double relative_residual;
+      Scalar* sln_vector;
+    };
+  }
+}
+#endif
@@ -68,7 +68,21 @@ namespace Hermes
     //     Jordan canonical form (I think) for better performance. This
     //     can be found, I think, in newer Butcher's papers or presentation
     //     (he has them online), and possibly in his book.
+    /// Treatment of the mass matrix with explicit Butcher's tables, see RungeKutta::set_explicit_mass_inversion().
+    enum RungeKuttaMassInversion
+    {
+      /// The whole stage system is assembled and passed to the matrix solver (as with the implicit methods).
+      HERMES_RK_MASS_FULL,
+      /// The row sums of the mass matrix are used as a diagonal (lumped) mass matrix.
+      HERMES_RK_MASS_LUMPED,
+      /// The mass matrix is block-diagonal (e.g. L2 spaces, one block per element), the blocks are factorized.
+      HERMES_RK_MASS_BLOCK_DIAGONAL
+    };
+
     /// Runge-Kutta methods implementation for time-dependent problems.
+    /// With explicit tables and HERMES_RK_MASS_LUMPED / HERMES_RK_MASS_BLOCK_DIAGONAL, the global mass matrix (CSC) is still
+    /// assembled once per set of spaces and only then lumped / split into the blocks (it is released afterwards), i.e. the assembly
+    /// and the temporary memory of the global mass matrix repeat after every change of the spaces (e.g. adaptivity).
     template<typename Scalar>
     class HERMES_API RungeKutta :
       public Hermes::Mixins::Loggable,
@@ -91,6 +105,14 @@ namespace Hermes
       void set_residual_as_solutions();
       void set_block_diagonal_jacobian();
 
+      /// Explicit time stepping without any global matrix (the Butcher's table must be explicit).
+      /// The mass matrix is assembled and inverted (lumped, or factorized block by block) once per spaces,
+      /// each stage is then one assembly of the residual of the original weak formulation (DG forms included)
+      /// followed by the local (parallel) solves. With HERMES_RK_MASS_BLOCK_DIAGONAL and L2 spaces, the previous
+      /// time level solution is projected using the factorized blocks as well.
+      /// Default: HERMES_RK_MASS_FULL (the explicit methods are treated as the implicit ones).
+      void set_explicit_mass_inversion(RungeKuttaMassInversion mass_inversion);
+
       /// Destructor.
       ~RungeKutta();
 
@@ -156,12 +178,32 @@ namespace Hermes
       /// and right-hand side F(t, Y) of the above equation, respectively.
       void create_stage_wf(unsigned int size, bool block_diagonal_jacobian);
 
+      /// Fills "stage_wf_left" with the mass matrix forms - the part of create_stage_wf() the explicit
+      /// path (see set_explicit_mass_inversion()) needs.
+      void create_mass_wf(unsigned int size);
+
       /// Updates the augmented weak formulation.
       void update_stage_wf(std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_prev);
 
       // Prepare u_ext_vec.
       void prepare_u_ext_vec();
 
+      /// Explicit stages (see set_explicit_mass_inversion()) - fills K_vector.
+      /// \param[out] coeff_vec The previous time level solution projected on the spaces.
+      void rk_explicit_stages(std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_prev, std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_new, Scalar* coeff_vec);
+
+      /// Common end of both the paths of the time step: u_{n + 1} = u_n + h \sum_{j = 1}^s b_j k_j (and the error estimate).
+      /// \param[in] coeff_vec The previous time level solution projected on the spaces, deleted here.
+      void rk_finish_time_step(Scalar* coeff_vec, std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_new, std::vector<MeshFunctionSharedPtr<Scalar> > error_fns);
+
+      /// Assembles and inverts (factorizes) the mass matrix, unless it is done for the current spaces.
+      void prepare_explicit_mass();
+
+      /// vec = M^{-1} vec using the prepared mass matrix.
+      void apply_explicit_mass_inverse(Scalar* vec) const;
+
+      void free_explicit_mass();
+
       /// Matrix for the time derivative part of the equation (left-hand side).
       Hermes::Algebra::SparseMatrix<Scalar>* matrix_left;
 
@@ -222,6 +264,27 @@ namespace Hermes
 
       ///< The filters to reinitialize in every Newton's loop
       std::vector<Filter<Scalar>*> filters_to_reinit;
+
+      /// Explicit time stepping.
+      RungeKuttaMassInversion mass_inversion;
+      /// Residual of the original weak formulation.
+      DiscreteProblem<Scalar>* explicit_dp;
+      SimpleVector<Scalar> explicit_residual;
+      /// Local L2 projection of the previous time level solution.
+      WeakFormSharedPtr<Scalar> explicit_projection_wf;
+      DiscreteProblem<Scalar>* explicit_projection_dp;
+      /// Spaces the mass matrix was prepared for.
+      std::vector<unsigned int> explicit_mass_spaces_seqs;
+      int explicit_mass_size;
+      /// Lumped - inverted diagonal.
+      Scalar* mass_diagonal_inverse;
+      /// Block-diagonal - DOFs of the blocks (CSR-like), LU factors (dense row-wise blocks) and their pivots.
+      int num_mass_blocks;
+      int* mass_block_ptr;
+      int* mass_block_dofs;
+      long long* mass_factor_ptr;
+      Scalar* mass_factors;
+      int* mass_pivots;
     };
   }
 }
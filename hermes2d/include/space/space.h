@@ -63,6 +63,7 @@ namespace Hermes
     template<typename Scalar> class DiscreteProblemDGAssembler;
     template<typename Scalar> class DiscreteProblemThreadAssembler;
     template<typename Scalar> class DiscreteProblemIntegrationOrderCalculator;
+    template<typename Scalar> class MatrixFreeOperator;
     namespace Views
     {
       template<typename Scalar> class BaseView;
@@ -242,6 +243,11 @@ namespace Hermes
 
       /// \brief Assings the degrees of freedom to all Spaces in the std::vector.
       static int assign_dofs(std::vector<SpaceSharedPtr<Scalar> > spaces);
+
+      /// \brief Flags of the element-interior (bubble) degrees of freedom of all Spaces in the std::vector.
+      /// Call after assign_dofs(), the array (of size get_num_dofs(spaces)) is to be deallocated by the caller using free_with_check().
+      /// Used for the static condensation in the solvers.
+      static bool* get_bubble_dofs(std::vector<SpaceSharedPtr<Scalar> > spaces);
 #pragma endregion
 
 #pragma region Mesh handling
@@ -513,6 +519,7 @@ namespace Hermes
       friend class DiscreteProblemDGAssembler < Scalar > ;
       friend class DiscreteProblemThreadAssembler < Scalar > ;
       friend class DiscreteProblemIntegrationOrderCalculator < Scalar > ;
+      friend class MatrixFreeOperator < Scalar > ;
     };
   }
 }
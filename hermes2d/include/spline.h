@@ -53,6 +53,11 @@ namespace Hermes
       /// One-dimensional function derivative integration order.
       Hermes::Ord derivative(Hermes::Ord x) const { return Hermes::Ord(2); };
 
+      /// Values (and derivatives) in n points at once.
+      /// The intervals are located through the lookup table built in calculate_coeffs(), the cubics are then evaluated
+      /// in a separate (vectorizable) loop.
+      void values(int n, const double* x, double* out, double* dout) const;
+
       /// Plots the spline in format for Pylab (just pairs
       /// x-coordinate and value per line). The interval of definition
       /// of the spline will be extended by "extension" both to the left
@@ -72,7 +77,7 @@ namespace Hermes
       std::vector<double> points;
 
       /// Values at the grid points.
-      std::vector<double> values;
+      std::vector<double> point_values;
 
       /// Boundary conditions.
       double bc_left, bc_right;
@@ -96,6 +101,17 @@ namespace Hermes
       /// A set of four coefficients a, b, c, d for an elementary cubic spline.
       std::vector<SplineCoeff> coeffs;
 
+      /// Lookup table for values() - a uniform grid over [point_left, point_right], each cell stores the interval
+      /// containing its left end, the right interval is then found by a short forward walk.
+      std::vector<int> interval_table;
+      double interval_table_inv_width;
+
+      /// Builds interval_table.
+      void build_interval_table();
+
+      /// Interval 'm' of a point inside [point_left, point_right] using interval_table.
+      int find_interval_in_table(double x_in) const;
+
       /// Gets derivative at a point that lies in interval 'm'.
       double get_derivative_from_interval(double x_in, int m) const;
 
@@ -187,6 +187,12 @@ namespace Hermes
         // Finish - contour triangles calculation etc.
         void finish(MeshFunctionSharedPtr<double>* sln);
 
+        /// FileExport - merges the vertices shared by the states processed on different threads (seams).
+        /// The vertices are identified by the mesh vertex, or the mesh edge and the position on it (vertices inside of
+        /// the mesh elements are never shared), and must have the same coordinates and values (discontinuities are kept).
+        /// The vertex arrays of the threads are compacted and the triangle indices made global, in time linear in the output size.
+        void merge_vertices();
+
         Traverse::State** states;
         unsigned int num_states;
 
@@ -23,6 +23,7 @@
 #endif
 #include "../quadrature/quad_all.h"
 #include "../mesh/traverse.h"
+#include "mixins2d.h"
 
 namespace Hermes
 {
@@ -30,10 +31,39 @@ namespace Hermes
   {
     namespace Views
     {
+      /// Output of one thread in Orderizer::process_space().
+      /// The buffers of all threads are merged into the Orderizer arrays in the end, the vertex indices
+      /// are shifted by the prefix sums of the vertex counts.
+      class OrderizerThreadData
+      {
+      public:
+        OrderizerThreadData();
+        ~OrderizerThreadData();
+
+        /// Allocation for the expected number of elements, resets the counts.
+        void reallocate(int number_of_elements);
+        void free();
+
+        int add_vertex(double x, double y, double val);
+        void add_triangle(int iv0, int iv1, int iv2, int marker);
+        void add_edge(int iv1, int iv2, int marker);
+
+        double3* verts;
+        int3* tris;
+        int* tri_markers;
+        int2* edges;
+        int* edge_markers;
+
+        /// Real numbers of vertices, triangles and edges
+        int vertex_count, triangle_count, edges_count;
+        /// Size of arrays of vertices, triangles and edges
+        int vertex_size, triangle_size, edges_size;
+      };
+
       /// Like the Linearizer, but generates a triangular mesh showing polynomial
       /// orders in a space, hence the funky name.
-      ///
-      class HERMES_API Orderizer
+      /// The elements are processed in parallel, each thread into its own buffers (OrderizerThreadData).
+      class HERMES_API Orderizer : public Hermes::Hermes2D::Mixins::Parallel
       {
       public:
 
@@ -52,6 +82,18 @@ namespace Hermes
         template<typename Scalar>
         void save_mesh_vtk(SpaceSharedPtr<Scalar> space, const char* file_name);
 
+        /// Saves the polynomial orders - binary VTU (VTK XML format, raw appended data).
+        template<typename Scalar>
+        void save_orders_vtu(SpaceSharedPtr<Scalar> space, const char* file_name);
+
+        /// Saves the mesh with markers - binary VTU.
+        template<typename Scalar>
+        void save_markers_vtu(SpaceSharedPtr<Scalar> space, const char* file_name);
+
+        /// Saves the mesh - edges with their markers - binary VTU.
+        template<typename Scalar>
+        void save_mesh_vtu(SpaceSharedPtr<Scalar> space, const char* file_name);
+
         /// Returns axis aligned bounding box (AABB) of vertices. Assumes lock.
         void calc_vertices_aabb(double* min_x, double* max_x,
           double* min_y, double* max_y) const;
@@ -85,12 +127,19 @@ namespace Hermes
         int2* edges;
         /// edge_markers: edge markers, ordering equal to edges
         int* edge_markers;
-        void add_edge(int iv1, int iv2, int marker);
 
-        /// Reallocation at the beginning of process_*.
-        /// Specific for Linearizer
+        /// Reallocation (of the labels) at the beginning of process_*.
         void reallocate(MeshSharedPtr mesh);
 
+        /// Merge the thread buffers into the arrays.
+        /// \param[in] element_starts The first element of each thread (num_threads_used + 1).
+        void merge(OrderizerThreadData* thread_data, int* element_starts);
+
+        /// Binary VTU output of the processed data.
+        /// \param[in] edges_as_cells The cells are the edges (otherwise the triangles).
+        /// \param[in] point_data The vertex values (orders) are saved, otherwise the cell markers.
+        void write_vtu(const char* file_name, bool edges_as_cells, bool point_data) const;
+
         char  buffer[1000];
         char* labels[11][11];
 
@@ -111,13 +160,7 @@ namespace Hermes
         /// Size of arrays of vertices, triangles and edges
         int vertex_size, triangle_size, edges_size;
 
-        void add_triangle(int iv0, int iv1, int iv2, int marker);
-
         static void calc_aabb(double* x, double* y, int stride, int num, double* min_x, double* max_x, double* min_y, double* max_y);
-
-        int add_vertex();
-
-        void make_vert(int & index, double x, double y, double val);
       };
     }
   }
@@ -27,6 +27,7 @@ namespace Hermes
     template<typename Scalar> class DiscreteProblem;
     template<typename Scalar> class DiscreteProblemSelectiveAssembler;
     template<typename Scalar> class DiscreteProblemIntegrationOrderCalculator;
+    template<typename Scalar> class MatrixFreeOperator;
     template<typename Scalar> class RungeKutta;
     template<typename Scalar> class Space;
     template<typename Scalar> class MeshFunction;
@@ -186,6 +187,9 @@ namespace Hermes
       // Checks presence of DG forms.
       bool is_DG() const;
 
+      // Checks presence of forms marked as solution-independent.
+      bool has_solution_independent_forms() const;
+
       /// Internal.
       std::vector<Form<Scalar> *> get_forms() const;
       std::vector<MatrixFormVol<Scalar> *> get_mfvol() const;
@@ -243,6 +247,7 @@ namespace Hermes
       friend class DiscreteProblemThreadAssembler < Scalar > ;
       friend class DiscreteProblemIntegrationOrderCalculator < Scalar > ;
       friend class DiscreteProblemSelectiveAssembler < Scalar > ;
+      friend class MatrixFreeOperator < Scalar > ;
       friend class RungeKutta < Scalar > ;
       friend class OGProjection < Scalar > ;
       friend class Hermes::Preconditioners::Precond < Scalar > ;
@@ -297,6 +302,15 @@ namespace Hermes
       /// scaling factor
       void setScalingFactor(double scalingFactor);
 
+      /// Marks the form as independent of the solution (u_ext).
+      /// Nonlinear solvers then assemble the form only once (for the given spaces) and reuse its contribution in all iterations.
+      /// If the form depends on time, or on external functions that change, call DiscreteProblem::invalidate_solution_independent_forms() upon their change.
+      /// Note that residual (vector) forms of linear terms do use u_ext (e.g. DefaultResidualDiffusion), only e.g. source terms may be marked.
+      /// When the contributions are cached, the forms are assembled also with a different iterate, and an exception is thrown
+      /// if the results differ.
+      void set_solution_independent(bool to_set = true);
+      bool is_solution_independent() const;
+
       unsigned int i;
 
     protected:
@@ -336,6 +350,8 @@ namespace Hermes
       void set_uExtOffset(int u_ext_offset);
       /// Form will be always multiplied (scaled) with this number.
       double scaling_factor;
+      /// See set_solution_independent().
+      bool solution_independent;
       /// For time-dependent right-hand side functions.
       /// E.g. for Runge-Kutta methods. Otherwise the one time for the whole WeakForm can be used.
       void set_current_stage_time(double time);
@@ -348,6 +364,7 @@ namespace Hermes
       friend class DiscreteProblemIntegrationOrderCalculator < Scalar > ;
       friend class DiscreteProblemSelectiveAssembler < Scalar > ;
       friend class DiscreteProblemThreadAssembler < Scalar > ;
+      friend class MatrixFreeOperator < Scalar > ;
     };
 
     /// \brief Abstract, base class for matrix form - i.e. a single integral in the bilinear form on the left hand side of the variational formulation of a (system of) PDE.<br>
@@ -389,6 +406,12 @@ namespace Hermes
       virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> **u_ext, Func<Hermes::Ord> *u, Func<Hermes::Ord> *v,
         GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+      /// The integrand for the function u written as f * v + f_x * dv/dx + f_y * dv/dy, i.e. independent of the test
+      /// function, which lets the form be applied to all the test functions at once (see MatrixFreeOperator).
+      /// \param[out] f, f_x, f_y Values at the n points (without the weights), zero on input.
+      /// \return Whether the form provides the integrand (the default implementation does not, value() is used then).
+      virtual bool integrand(int n, Func<Scalar> **u_ext, Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
       virtual MatrixFormVol* clone() const;
     };
 
@@ -464,6 +487,12 @@ namespace Hermes
       virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> **u_ext, Func<Hermes::Ord> *v, GeomVol<Hermes::Ord> *e,
         Func<Ord> **ext) const;
 
+      /// The integrand written as f * v + f_x * dv/dx + f_y * dv/dy, i.e. independent of the test function, which lets the
+      /// assembly apply the form to all the test functions at once (sum factorization on affine quads).
+      /// \param[out] f, f_x, f_y Values at the n points (without the weights), zero on input.
+      /// \return Whether the form provides the integrand (the default implementation does not, value() is used then).
+      virtual bool integrand(int n, Func<Scalar> **u_ext, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
       virtual VectorFormVol* clone() const;
     };
 
@@ -50,6 +50,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *u,
           Func<Hermes::Ord> *v, GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual MatrixFormVol<Scalar>* clone() const;
 
       private:
@@ -109,6 +111,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *u, Func<Hermes::Ord> *v,
           GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual MatrixFormVol<Scalar>* clone() const;
 
       private:
@@ -175,6 +179,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *v,
           GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual VectorFormVol<Scalar>* clone() const;
 
       private:
@@ -206,6 +212,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *v,
           GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual VectorFormVol<Scalar>* clone() const;
 
       private:
@@ -239,6 +247,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *v,
           GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual VectorFormVol<Scalar>* clone() const;
 
       private:
@@ -270,6 +280,8 @@ namespace Hermes
         virtual Hermes::Ord ord(int n, double *wt, Func<Hermes::Ord> *u_ext[], Func<Hermes::Ord> *v,
           GeomVol<Hermes::Ord> *e, Func<Ord> **ext) const;
 
+        virtual bool integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const;
+
         virtual VectorFormVol<Scalar>* clone() const;
 
       private:
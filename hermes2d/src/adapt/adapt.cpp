@@ -16,6 +16,7 @@
 #include "adapt.h"
 #include "projections/ogprojection.h"
 #include "refinement_selectors/candidates.h"
+#include "refinement_selectors/optimum_selector.h"
 #include "function/exact_solution.h"
 
 namespace Hermes
@@ -292,6 +293,14 @@ namespace Hermes
           rslns.push_back(this->errorCalculator->fine_solutions[i]);
       }
 
+      // Selection statistics per element type.
+      for (unsigned int i = 0; i < refinement_selectors.size(); i++)
+      {
+        RefinementSelectors::OptimumSelector<Scalar>* optimum_selector = dynamic_cast<RefinementSelectors::OptimumSelector<Scalar>*>(refinement_selectors[i]);
+        if (optimum_selector)
+          optimum_selector->reset_selection_statistics();
+      }
+
       // Parallel section
 #pragma omp parallel num_threads(this->num_threads_used)
       {
@@ -353,6 +362,19 @@ namespace Hermes
       // Time measurement.
       this->tick();
       this->info("\tAdaptivity: refinement selection duration: %f s.", this->last());
+      for (unsigned int i = 0; i < refinement_selectors.size(); i++)
+      {
+        // Report every selector once, even if it is shared by more components.
+        if (std::find(refinement_selectors.begin(), refinement_selectors.begin() + i, refinement_selectors[i]) != refinement_selectors.begin() + i)
+          continue;
+        RefinementSelectors::OptimumSelector<Scalar>* optimum_selector = dynamic_cast<RefinementSelectors::OptimumSelector<Scalar>*>(refinement_selectors[i]);
+        if (optimum_selector)
+        {
+          this->info("\tAdaptivity: selector %i: %i triangles in %f s, %i quads in %f s (summed over threads).", i,
+            optimum_selector->get_selection_count(HERMES_MODE_TRIANGLE), optimum_selector->get_selection_time(HERMES_MODE_TRIANGLE),
+            optimum_selector->get_selection_count(HERMES_MODE_QUAD), optimum_selector->get_selection_time(HERMES_MODE_QUAD));
+        }
+      }
 
       // Before applying, fix the shared mesh refinements.
       fix_shared_mesh_refinements(meshes, elements_to_refine, attempted_element_refinements_count, element_refinement_location, &refinement_selectors.front());
@@ -640,10 +662,139 @@ namespace Hermes
     template<typename Scalar>
     void Adapt<Scalar>::apply_refinements(ElementToRefine* elems_to_refine, int num_elem_to_process)
     {
+      // Mesh refinements first, then the (cheap) orders serially.
+      this->refine_meshes(elems_to_refine, num_elem_to_process);
+
       for (int i = 0; i < num_elem_to_process; i++)
         apply_refinement(elems_to_refine[i]);
     }
 
+    template<typename Scalar>
+    void Adapt<Scalar>::refine_meshes(ElementToRefine* elems_to_refine, int num_elem_to_process)
+    {
+      // Distinct meshes and the elements of each of them to refine, in the original order.
+      // An element refined by another component sharing the mesh is refined only once.
+      std::vector<Mesh*> refined_meshes;
+      std::vector<std::vector<int> > mesh_element_ids, mesh_refinements;
+      std::vector<std::vector<bool> > mesh_listed;
+      for (int i = 0; i < num_elem_to_process; i++)
+      {
+        const ElementToRefine& elem_ref = elems_to_refine[i];
+        if (!elem_ref.valid || elem_ref.split == H2D_REFINEMENT_P)
+          continue;
+
+        Mesh* mesh = this->spaces[elem_ref.comp]->get_mesh().get();
+        unsigned int mesh_i = std::find(refined_meshes.begin(), refined_meshes.end(), mesh) - refined_meshes.begin();
+        if (mesh_i == refined_meshes.size())
+        {
+          refined_meshes.push_back(mesh);
+          mesh_element_ids.push_back(std::vector<int>());
+          mesh_refinements.push_back(std::vector<int>());
+          mesh_listed.push_back(std::vector<bool>(mesh->get_max_element_id(), false));
+        }
+
+        Element* e = mesh->get_element(elem_ref.id);
+        if (!e->active || mesh_listed[mesh_i][elem_ref.id])
+          continue;
+        mesh_listed[mesh_i][elem_ref.id] = true;
+        mesh_element_ids[mesh_i].push_back(elem_ref.id);
+        if (elem_ref.split == H2D_REFINEMENT_H)
+          mesh_refinements[mesh_i].push_back(0);
+        else
+          mesh_refinements[mesh_i].push_back(elem_ref.split == H2D_REFINEMENT_H_ANISO_H ? 1 : 2);
+      }
+
+      if (refined_meshes.empty())
+        return;
+
+      // Curved sons of each mesh, their reference mappings are calculated in the second phase.
+      std::vector<std::vector<Element*> > curved_sons(refined_meshes.size());
+      for (unsigned int mesh_i = 0; mesh_i < refined_meshes.size(); mesh_i++)
+        refined_meshes[mesh_i]->deferred_curved_sons = &curved_sons[mesh_i];
+
+      // First phase - topology. With enough meshes, every thread refines whole meshes, otherwise the meshes
+      // are refined one after another, each by all threads (Mesh::refine_elements_id()).
+      int num_meshes = refined_meshes.size();
+      if (num_meshes < (int)this->num_threads_used)
+      {
+        try
+        {
+          for (int mesh_i = 0; mesh_i < num_meshes; mesh_i++)
+            refined_meshes[mesh_i]->refine_elements_id(mesh_element_ids[mesh_i], mesh_refinements[mesh_i], this->num_threads_used);
+        }
+        catch (Hermes::Exceptions::Exception& e)
+        {
+          this->exceptionMessageCaughtInParallelBlock = e.info();
+        }
+        catch (std::exception& e)
+        {
+          this->exceptionMessageCaughtInParallelBlock = e.what();
+        }
+      }
+      else
+      {
+#pragma omp parallel num_threads(this->num_threads_used)
+        {
+          int thread_number = omp_get_thread_num();
+          for (int mesh_i = thread_number; mesh_i < num_meshes; mesh_i += this->num_threads_used)
+          {
+            try
+            {
+              refined_meshes[mesh_i]->refine_elements_id(mesh_element_ids[mesh_i], mesh_refinements[mesh_i], 1);
+            }
+            catch (Hermes::Exceptions::Exception& e)
+            {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+              this->exceptionMessageCaughtInParallelBlock = e.info();
+            }
+            catch (std::exception& e)
+            {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+              this->exceptionMessageCaughtInParallelBlock = e.what();
+            }
+          }
+        }
+      }
+
+      std::vector<Element*> all_curved_sons;
+      for (unsigned int mesh_i = 0; mesh_i < refined_meshes.size(); mesh_i++)
+      {
+        refined_meshes[mesh_i]->deferred_curved_sons = nullptr;
+        all_curved_sons.insert(all_curved_sons.end(), curved_sons[mesh_i].begin(), curved_sons[mesh_i].end());
+      }
+
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+
+      // Second phase - reference mappings of the curved sons, independent of each other (also within one mesh).
+      int num_curved_sons = all_curved_sons.size();
+#pragma omp parallel for schedule(dynamic) num_threads(this->num_threads_used)
+      for (int i = 0; i < num_curved_sons; i++)
+      {
+        try
+        {
+          all_curved_sons[i]->cm->update_refmap_coeffs(all_curved_sons[i]);
+        }
+        catch (Hermes::Exceptions::Exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.info();
+        }
+        catch (std::exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.what();
+        }
+      }
+
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+
+      // The sequence numbers assigned in parallel depend on the scheduling, reassign them in a fixed order.
+      for (unsigned int mesh_i = 0; mesh_i < refined_meshes.size(); mesh_i++)
+        refined_meshes[mesh_i]->set_seq(g_mesh_seq++);
+    }
+
     template<typename Scalar>
     void Adapt<Scalar>::apply_refinement(const ElementToRefine& elem_ref)
     {
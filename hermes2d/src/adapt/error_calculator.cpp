@@ -16,6 +16,7 @@
 #include "adapt/error_calculator.h"
 #include "function/exact_solution.h"
 #include "adapt/error_thread_calculator.h"
+#include "neighbor_search.h"
 #include "norm_form.h"
 
 namespace Hermes
@@ -169,6 +170,13 @@ namespace Hermes
       for (int i = 0; i < this->component_count; i++)
         meshes.push_back(fine_solutions[i]->get_mesh());
 
+      // Neighborhoods of the inner edges, searched once per mesh state, before the threads use them.
+      if (!this->mfDG.empty())
+      {
+        for (unsigned int mesh_i = 0; mesh_i < meshes.size(); mesh_i++)
+          MeshFaceTable::get(meshes[mesh_i]);
+      }
+
       unsigned int num_states;
       Traverse trav(this->component_count);
       Traverse::State** states = trav.get_states(meshes, num_states);
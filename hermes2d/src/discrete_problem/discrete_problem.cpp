@@ -55,6 +55,11 @@ namespace Hermes
     {
       this->reassembled_states_reuse_linear_system = nullptr;
 
+      this->solution_independent_matrix_values = nullptr;
+      this->solution_independent_matrix_nnz = 0;
+      this->solution_independent_rhs_values = nullptr;
+      this->solution_independent_rhs_size = 0;
+
       this->spaces_size = this->spaces.size();
 
       this->nonlinear = !to_set;
@@ -84,6 +89,8 @@ namespace Hermes
 
       if (this->dirichlet_lift_rhs)
         delete this->dirichlet_lift_rhs;
+
+      this->invalidate_solution_independent_forms();
     }
 
     template<typename Scalar>
@@ -118,12 +125,14 @@ namespace Hermes
     {
       Space<Scalar>::update_essential_bc_values(spaces, time);
       this->wf->set_current_time(time);
+      this->invalidate_solution_independent_forms();
     }
 
     template<typename Scalar>
     void DiscreteProblem<Scalar>::set_time_step(double time_step)
     {
       this->wf->set_current_time_step(time_step);
+      this->invalidate_solution_independent_forms();
     }
 
     template<typename Scalar>
@@ -138,6 +147,8 @@ namespace Hermes
       Mixins::DiscreteProblemRungeKutta<Scalar>::set_RK(original_spaces_count, force_diagonal_blocks_, block_weights_);
 
       this->selectiveAssembler.set_RK(original_spaces_count, force_diagonal_blocks_, block_weights_);
+      // The blocks (diagonal ones) may differ now.
+      this->selectiveAssembler.previous_pattern.reset();
 
       for (int i = 0; i < this->num_threads_used; i++)
         this->threadAssembler[i]->set_RK(original_spaces_count, force_diagonal_blocks_, block_weights_);
@@ -156,6 +167,7 @@ namespace Hermes
 
       this->selectiveAssembler.set_weak_formulation(wf);
       this->selectiveAssembler.matrix_structure_reusable = false;
+      this->invalidate_solution_independent_forms();
     }
 
     template<typename Scalar>
@@ -271,6 +283,13 @@ namespace Hermes
       for (unsigned char i = 0; i < this->num_threads_used; i++)
         this->threadAssembler[i]->set_weak_formulation(this->wf);
 
+      // Neighborhoods of the inner edges, searched once per mesh state, before the threads use them.
+      if (this->wf->is_DG())
+      {
+        for (unsigned int mesh_i = 0; mesh_i < meshes.size(); mesh_i++)
+          MeshFaceTable::get(meshes[mesh_i]);
+      }
+
       Traverse trav(this->spaces_size);
       states = trav.get_states(meshes, num_states);
 
@@ -295,6 +314,25 @@ namespace Hermes
       // Set the matrices.
       bool result = this->set_matrix(mat) && this->set_rhs(rhs);
 
+      // Matrices storing only the lower triangle need symmetric matrix forms.
+      if (this->current_mat && this->current_mat->has_symmetric_storage())
+      {
+        std::vector<MatrixForm<Scalar>*> matrix_forms;
+        matrix_forms.insert(matrix_forms.end(), this->wf->mfvol.begin(), this->wf->mfvol.end());
+        matrix_forms.insert(matrix_forms.end(), this->wf->mfsurf.begin(), this->wf->mfsurf.end());
+        // DG forms do not declare any symmetry.
+        bool nonsymmetric_found = !this->wf->mfDG.empty();
+        for (unsigned int form_i = 0; form_i < matrix_forms.size(); form_i++)
+        {
+          if (matrix_forms[form_i]->sym == HERMES_ANTISYM)
+            throw Exceptions::Exception("DiscreteProblem: an antisymmetric matrix form cannot be assembled into a matrix with symmetric storage.");
+          if (matrix_forms[form_i]->sym == HERMES_NONSYM)
+            nonsymmetric_found = true;
+        }
+        if (nonsymmetric_found)
+          this->warn("DiscreteProblem: the matrix has symmetric storage, only the lower triangle of the nonsymmetric matrix forms is used.");
+      }
+
       // Initialize states && previous iterations.
       unsigned int num_states;
       Traverse::State** states;
@@ -304,6 +342,10 @@ namespace Hermes
       this->info("\tDiscreteProblem: Initialization: %s.", this->last_str().c_str());
       this->tick();
 
+      // The cached contributions of solution-independent forms are valid only as long as the structures are reused.
+      bool matrix_structure_kept = this->selectiveAssembler.matrix_structure_reusable && this->current_mat == this->selectiveAssembler.previous_mat;
+      bool vector_structure_kept = this->selectiveAssembler.vector_structure_reusable && this->current_rhs == this->selectiveAssembler.previous_rhs;
+
       // Creating matrix sparse structure.
       // If there are no states, return.
       if (this->selectiveAssembler.prepare_sparse_structure(this->current_mat, this->current_rhs, this->spaces, states, num_states))
@@ -315,115 +357,278 @@ namespace Hermes
         if (this->current_mat && this->reassembled_states_reuse_linear_system)
           this->reassembled_states_reuse_linear_system(states, num_states, this->current_mat, this->current_rhs, this->dirichlet_lift_rhs, coeff_vec);
 
-        Solution<Scalar>** u_ext_sln = nullptr;
-        if (this->nonlinear && coeff_vec)
+        if (this->use_solution_independent_forms_cache())
+          this->assemble_with_solution_independent_forms_cache(coeff_vec, states, num_states, meshes, matrix_structure_kept, vector_structure_kept);
+        else
+          this->assemble_states(coeff_vec, states, num_states, meshes);
+      }
+
+      this->tick();
+
+      // Deinitialize states && previous iterations.
+      this->deinit_assembling(states, num_states);
+
+      // Finish the algebraic structures for solving.
+      if (this->current_mat)
+        this->current_mat->finish();
+      if (this->current_rhs)
+        this->current_rhs->finish();
+
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+
+      Element* e;
+      for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
+      {
+        for_all_active_elements(e, spaces[space_i]->get_mesh())
         {
-          u_ext_sln = new Solution<Scalar>*[spaces_size];
-          int first_dof = 0;
-          for (int i = 0; i < this->spaces_size; i++)
-          {
-            u_ext_sln[i] = new Solution<Scalar>(spaces[i]->get_mesh());
-            Solution<Scalar>::vector_to_solution(coeff_vec, spaces[i], u_ext_sln[i], !this->rungeKutta, first_dof);
-            first_dof += spaces[i]->get_num_dofs();
-          }
+          spaces[space_i]->edata[e->id].changed_in_last_adaptation = false;
+          e->visited = false;
         }
+      }
 
-        if (num_states > 0)
+      this->tick();
+      this->info("\tDiscreteProblem: De-initialization: %s.", this->last_str().c_str());
+
+      return result;
+    }
+
+    template<typename Scalar>
+    void DiscreteProblem<Scalar>::assemble_states(Scalar*& coeff_vec, Traverse::State** states, unsigned int num_states, std::vector<MeshSharedPtr>& meshes)
+    {
+      Solution<Scalar>** u_ext_sln = nullptr;
+      if (this->nonlinear && coeff_vec)
+      {
+        u_ext_sln = new Solution<Scalar>*[spaces_size];
+        int first_dof = 0;
+        for (int i = 0; i < this->spaces_size; i++)
         {
-          // Is this a DG assembling.
-          bool is_DG = this->wf->is_DG();
+          u_ext_sln[i] = new Solution<Scalar>(spaces[i]->get_mesh());
+          Solution<Scalar>::vector_to_solution(coeff_vec, spaces[i], u_ext_sln[i], !this->rungeKutta, first_dof);
+          first_dof += spaces[i]->get_num_dofs();
+        }
+      }
+
+      if (num_states > 0)
+      {
+        // Is this a DG assembling.
+        bool is_DG = this->wf->is_DG();
 
 #pragma omp parallel num_threads(this->num_threads_used)
-          {
-            int thread_number = omp_get_thread_num();
-            int start = (num_states / this->num_threads_used) * thread_number;
-            int end = (num_states / this->num_threads_used) * (thread_number + 1);
-            if (thread_number == this->num_threads_used - 1)
-              end = num_states;
+        {
+          int thread_number = omp_get_thread_num();
+          int start = (num_states / this->num_threads_used) * thread_number;
+          int end = (num_states / this->num_threads_used) * (thread_number + 1);
+          if (thread_number == this->num_threads_used - 1)
+            end = num_states;
 
-            try
-            {
-              this->threadAssembler[thread_number]->init_assembling(u_ext_sln, spaces, this->add_dirichlet_lift);
+          try
+          {
+            this->threadAssembler[thread_number]->init_assembling(u_ext_sln, spaces, this->add_dirichlet_lift);
 
-              DiscreteProblemDGAssembler<Scalar>* dgAssembler;
-              if (is_DG)
-                dgAssembler = new DiscreteProblemDGAssembler<Scalar>(this->threadAssembler[thread_number], this->spaces, meshes);
+            DiscreteProblemDGAssembler<Scalar>* dgAssembler;
+            if (is_DG)
+              dgAssembler = new DiscreteProblemDGAssembler<Scalar>(this->threadAssembler[thread_number], this->spaces, meshes);
 
-              for (int state_i = start; state_i < end; state_i++)
-              {
-                // Exception already thrown -> exit the loop.
-                if (!this->exceptionMessageCaughtInParallelBlock.empty())
-                  break;
+            for (int state_i = start; state_i < end; state_i++)
+            {
+              // Exception already thrown -> exit the loop.
+              if (!this->exceptionMessageCaughtInParallelBlock.empty())
+                break;
 
-                Traverse::State* current_state = states[state_i];
+              Traverse::State* current_state = states[state_i];
 
-                this->threadAssembler[thread_number]->init_assembling_one_state(spaces, current_state);
+              this->threadAssembler[thread_number]->init_assembling_one_state(spaces, current_state);
 
-                this->threadAssembler[thread_number]->assemble_one_state();
+              this->threadAssembler[thread_number]->assemble_one_state();
 
-                if (is_DG)
-                {
-                  dgAssembler->init_assembling_one_state(current_state);
-                  dgAssembler->assemble_one_state();
-                  dgAssembler->deinit_assembling_one_state();
-                }
-                this->threadAssembler[thread_number]->deinit_assembling_one_state();
+              if (is_DG)
+              {
+                dgAssembler->init_assembling_one_state(current_state);
+                dgAssembler->assemble_one_state();
+                dgAssembler->deinit_assembling_one_state();
               }
+              this->threadAssembler[thread_number]->deinit_assembling_one_state();
+            }
 
-              if (is_DG)
-                delete dgAssembler;
+            if (is_DG)
+              delete dgAssembler;
 
-              this->threadAssembler[thread_number]->deinit_assembling();
-            }
-            catch (Hermes::Exceptions::Exception& e)
-            {
+            this->threadAssembler[thread_number]->deinit_assembling();
+          }
+          catch (Hermes::Exceptions::Exception& e)
+          {
 #pragma omp critical (exceptionMessageCaughtInParallelBlock)
-              this->exceptionMessageCaughtInParallelBlock = e.info();
-            }
-            catch (std::exception& e)
-            {
+            this->exceptionMessageCaughtInParallelBlock = e.info();
+          }
+          catch (std::exception& e)
+          {
 #pragma omp critical (exceptionMessageCaughtInParallelBlock)
-              this->exceptionMessageCaughtInParallelBlock = e.what();
-            }
+            this->exceptionMessageCaughtInParallelBlock = e.what();
           }
         }
+      }
+
+      if (this->nonlinear && coeff_vec)
+      {
+        for (int i = 0; i < this->spaces_size; i++)
+          delete u_ext_sln[i];
+        delete[] u_ext_sln;
+      }
+    }
+
+    template<typename Scalar>
+    bool DiscreteProblem<Scalar>::use_solution_independent_forms_cache() const
+    {
+      // Linear problems are assembled once anyway, Runge-Kutta stage forms depend on the stage time.
+      if (!this->nonlinear || this->add_dirichlet_lift || this->rungeKutta || this->reassembled_states_reuse_linear_system)
+        return false;
 
-        if (this->nonlinear && coeff_vec)
+      // The matrix contribution is added on the level of the CS arrays.
+      if (this->current_mat && !dynamic_cast<CSMatrix<Scalar>*>(this->current_mat))
+        return false;
+
+      return this->wf->has_solution_independent_forms();
+    }
+
+    template<typename Scalar>
+    void DiscreteProblem<Scalar>::assemble_with_solution_independent_forms_cache(Scalar*& coeff_vec, Traverse::State** states, unsigned int num_states, std::vector<MeshSharedPtr>& meshes, bool matrix_structure_kept, bool vector_structure_kept)
+    {
+      CSMatrix<Scalar>* cs_mat = dynamic_cast<CSMatrix<Scalar>*>(this->current_mat);
+      bool matrix_cached = cs_mat && matrix_structure_kept && this->solution_independent_matrix_values && this->solution_independent_matrix_nnz == cs_mat->get_nnz();
+      bool vector_cached = this->current_rhs && vector_structure_kept && this->solution_independent_rhs_values && this->solution_independent_rhs_size == this->current_rhs->get_size();
+
+      // 1 - solution-independent forms, where not cached yet. These go directly to the (zeroed) matrix / vector.
+      bool assemble_matrix = cs_mat && !matrix_cached;
+      bool assemble_rhs = this->current_rhs && !vector_cached;
+      if (assemble_matrix || assemble_rhs)
+      {
+        this->selectiveAssembler.matrix_form_selection = assemble_matrix ? DiscreteProblemSelectiveAssembler<Scalar>::SolutionIndependentForms : DiscreteProblemSelectiveAssembler<Scalar>::NoForms;
+        this->selectiveAssembler.vector_form_selection = assemble_rhs ? DiscreteProblemSelectiveAssembler<Scalar>::SolutionIndependentForms : DiscreteProblemSelectiveAssembler<Scalar>::NoForms;
+
+        // The cached contributions would be silently wrong for forms that in fact use u_ext (e.g. residuals of linear terms),
+        // so the forms are first assembled with a different iterate, and the two results compared.
+        Scalar* other_matrix_values = nullptr;
+        Scalar* other_rhs_values = nullptr;
+        if (coeff_vec)
         {
-          for (int i = 0; i < this->spaces_size; i++)
-            delete u_ext_sln[i];
-          delete[] u_ext_sln;
+          int ndof = Space<Scalar>::get_num_dofs(this->spaces);
+          Scalar* other_coeff_vec = malloc_with_check<Scalar>(ndof);
+          for (int i = 0; i < ndof; i++)
+            other_coeff_vec[i] = coeff_vec[i] + Scalar(1.);
+          this->assemble_states(other_coeff_vec, states, num_states, meshes);
+          free_with_check(other_coeff_vec);
+          this->unmark_visited_elements();
+
+          if (assemble_matrix)
+          {
+            other_matrix_values = malloc_with_check<Scalar>(cs_mat->get_nnz());
+            memcpy(other_matrix_values, cs_mat->get_Ax(), cs_mat->get_nnz() * sizeof(Scalar));
+            cs_mat->zero();
+          }
+          if (assemble_rhs)
+          {
+            other_rhs_values = malloc_with_check<Scalar>(this->current_rhs->get_size());
+            this->current_rhs->extract(other_rhs_values);
+            this->current_rhs->zero();
+          }
+        }
+
+        this->assemble_states(coeff_vec, states, num_states, meshes);
+
+        if (this->exceptionMessageCaughtInParallelBlock.empty())
+        {
+          if (assemble_matrix)
+          {
+            this->solution_independent_matrix_nnz = cs_mat->get_nnz();
+            this->solution_independent_matrix_values = realloc_with_check<Scalar>(this->solution_independent_matrix_values, this->solution_independent_matrix_nnz);
+            memcpy(this->solution_independent_matrix_values, cs_mat->get_Ax(), this->solution_independent_matrix_nnz * sizeof(Scalar));
+          }
+          if (assemble_rhs)
+          {
+            this->solution_independent_rhs_size = this->current_rhs->get_size();
+            this->solution_independent_rhs_values = realloc_with_check<Scalar>(this->solution_independent_rhs_values, this->solution_independent_rhs_size);
+            this->current_rhs->extract(this->solution_independent_rhs_values);
+          }
+        }
+
+        if (this->exceptionMessageCaughtInParallelBlock.empty())
+        {
+          bool matrix_independent = !other_matrix_values || this->values_equal(other_matrix_values, this->solution_independent_matrix_values, this->solution_independent_matrix_nnz);
+          bool rhs_independent = !other_rhs_values || this->values_equal(other_rhs_values, this->solution_independent_rhs_values, this->solution_independent_rhs_size);
+          if (matrix_independent && rhs_independent)
+            this->info("\tDiscreteProblem: Solution-independent forms assembled and cached.");
+          else
+          {
+            // Reported (thrown) by assemble() after the deinitialization.
+            this->invalidate_solution_independent_forms();
+            this->exceptionMessageCaughtInParallelBlock = std::string("DiscreteProblem: a ") + (matrix_independent ? "vector" : "matrix") + " form marked by set_solution_independent() depends on the solution (u_ext).";
+          }
+        }
+        free_with_check(other_matrix_values);
+        free_with_check(other_rhs_values);
+
+        if (!this->exceptionMessageCaughtInParallelBlock.empty())
+        {
+          this->selectiveAssembler.matrix_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::AllForms;
+          this->selectiveAssembler.vector_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::AllForms;
+          return;
         }
       }
 
-      this->tick();
+      // DG assembling marks the elements as visited, the second pass would skip the inner edges.
+      this->unmark_visited_elements();
 
-      // Deinitialize states && previous iterations.
-      this->deinit_assembling(states, num_states);
+      // 2 - solution-dependent forms.
+      this->selectiveAssembler.matrix_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::SolutionDependentForms;
+      this->selectiveAssembler.vector_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::SolutionDependentForms;
+      this->assemble_states(coeff_vec, states, num_states, meshes);
+      this->selectiveAssembler.matrix_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::AllForms;
+      this->selectiveAssembler.vector_form_selection = DiscreteProblemSelectiveAssembler<Scalar>::AllForms;
 
-      // Finish the algebraic structures for solving.
-      if (this->current_mat)
-        this->current_mat->finish();
-      if (this->current_rhs)
-        this->current_rhs->finish();
+      // 3 - cached contributions (the sparse structure is the same).
+      if (matrix_cached)
+      {
+        Scalar* Ax = cs_mat->get_Ax();
+        for (unsigned int i = 0; i < this->solution_independent_matrix_nnz; i++)
+          Ax[i] += this->solution_independent_matrix_values[i];
+      }
+      if (vector_cached)
+        this->current_rhs->add_vector(this->solution_independent_rhs_values);
+    }
 
-      if (!this->exceptionMessageCaughtInParallelBlock.empty())
-        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+    template<typename Scalar>
+    bool DiscreteProblem<Scalar>::values_equal(Scalar* values, Scalar* other_values, unsigned int count) const
+    {
+      // Up to the rounding errors (the order of additions depends on the threads).
+      double max_value = 0., max_difference = 0.;
+      for (unsigned int i = 0; i < count; i++)
+      {
+        max_value = std::max(max_value, std::abs(values[i]));
+        max_difference = std::max(max_difference, std::abs(values[i] - other_values[i]));
+      }
+      return max_difference <= 1e-10 * max_value;
+    }
+
+    template<typename Scalar>
+    void DiscreteProblem<Scalar>::unmark_visited_elements()
+    {
+      if (!this->wf->is_DG())
+        return;
 
       Element* e;
       for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
-      {
         for_all_active_elements(e, spaces[space_i]->get_mesh())
-        {
-          spaces[space_i]->edata[e->id].changed_in_last_adaptation = false;
           e->visited = false;
-        }
-      }
-
-      this->tick();
-      this->info("\tDiscreteProblem: De-initialization: %s.", this->last_str().c_str());
+    }
 
-      return result;
+    template<typename Scalar>
+    void DiscreteProblem<Scalar>::invalidate_solution_independent_forms()
+    {
+      free_with_check(this->solution_independent_matrix_values, true);
+      free_with_check(this->solution_independent_rhs_values, true);
+      this->solution_independent_matrix_nnz = 0;
+      this->solution_independent_rhs_size = 0;
     }
 
     template<typename Scalar>
@@ -92,10 +92,12 @@ namespace Hermes
       // init - ext
       Func<Hermes::Ord>** ext_func = this->init_ext_orders(current_wf->ext, current_wf->u_ext_fn, u_ext_func);
 
+      // The order does not depend on the form selection, so that assembling the forms in several passes
+      // (see DiscreteProblem::assemble_with_solution_independent_forms_cache()) gives the same result as one pass.
       for (unsigned short current_mfvol_i = 0; current_mfvol_i < current_wf->mfvol.size(); current_mfvol_i++)
       {
         MatrixFormVol<Scalar>* current_mfvol = current_wf->mfvol[current_mfvol_i];
-        if (!selectiveAssembler->form_to_be_assembled(current_mfvol, current_state))
+        if (!selectiveAssembler->form_to_be_assembled(current_mfvol, current_state, false))
           continue;
         current_mfvol->wf = current_wf.get();
         int orderTemp = calc_order_matrix_form(spaces, current_mfvol, current_refmaps, ext_func, u_ext_func);
@@ -106,7 +108,7 @@ namespace Hermes
       for (unsigned short current_vfvol_i = 0; current_vfvol_i < current_wf->vfvol.size(); current_vfvol_i++)
       {
         VectorFormVol<Scalar>* current_vfvol = current_wf->vfvol[current_vfvol_i];
-        if (!selectiveAssembler->form_to_be_assembled(current_vfvol, current_state))
+        if (!selectiveAssembler->form_to_be_assembled(current_vfvol, current_state, false))
           continue;
         current_vfvol->wf = current_wf.get();
         int orderTemp = calc_order_vector_form(spaces, current_vfvol, current_refmaps, ext_func, u_ext_func);
@@ -131,7 +133,7 @@ namespace Hermes
           for (unsigned short current_mfsurf_i = 0; current_mfsurf_i < current_wf->mfsurf.size(); current_mfsurf_i++)
           {
             MatrixFormSurf<Scalar>* current_mfsurf = current_wf->mfsurf[current_mfsurf_i];
-            if (!selectiveAssembler->form_to_be_assembled(current_mfsurf, current_state))
+            if (!selectiveAssembler->form_to_be_assembled(current_mfsurf, current_state, false))
               continue;
             current_mfsurf->wf = current_wf.get();
             int orderTemp = calc_order_matrix_form(spaces, current_mfsurf, current_refmaps, ext_funcSurf, u_ext_funcSurf);
@@ -142,7 +144,7 @@ namespace Hermes
           for (unsigned short current_vfsurf_i = 0; current_vfsurf_i < current_wf->vfsurf.size(); current_vfsurf_i++)
           {
             VectorFormSurf<Scalar>* current_vfsurf = current_wf->vfsurf[current_vfsurf_i];
-            if (!selectiveAssembler->form_to_be_assembled(current_vfsurf, current_state))
+            if (!selectiveAssembler->form_to_be_assembled(current_vfsurf, current_state, false))
               continue;
 
             current_vfsurf->wf = current_wf.get();
@@ -22,8 +22,11 @@ namespace Hermes
   {
     template<typename Scalar>
     DiscreteProblemSelectiveAssembler<Scalar>::DiscreteProblemSelectiveAssembler()
-      : sp_seq(nullptr),
+      : matrix_form_selection(AllForms),
+      vector_form_selection(AllForms),
+      sp_seq(nullptr),
       spaces_size(0),
+      assembly_list_pattern(true),
       matrix_structure_reusable(false),
       previous_mat(nullptr),
       vector_structure_reusable(false),
@@ -54,11 +57,42 @@ namespace Hermes
           rhs->zero();
       }
 
-      if ((!matrix_structure_reusable || (mat != this->previous_mat)) && mat)
+      CSMatrix<Scalar>* cs_mat = dynamic_cast<CSMatrix<Scalar>*>(mat);
+      BSRMatrix<Scalar>* bsr_mat = dynamic_cast<BSRMatrix<Scalar>*>(mat);
+      // Without DG forms (coupling of neighbors), the CS (and block) matrices take the pattern built directly from the assembly lists.
+      bool pattern_from_assembly_lists = this->assembly_list_pattern && (cs_mat || bsr_mat) && !(this->wf->is_DG() && !this->wf->mfDG.empty());
+
+      // Another matrix on the same spaces (and forms): it only allocates its values, the pattern is shared.
+      if (matrix_structure_reusable && mat && mat != this->previous_mat && cs_mat && this->previous_pattern_matches(spaces, ndof) && cs_mat->share_sparsity_pattern(this->previous_pattern))
+      {
+        this->info("\tDiscreteProblemSelectiveAssembler: Sparsity pattern shared.");
+      }
+      else if ((!matrix_structure_reusable || (mat != this->previous_mat)) && mat && pattern_from_assembly_lists)
+      {
+        // Spaces have changed: create the matrix from scratch.
+        matrix_structure_reusable = true;
+        mat->free();
+        bool **blocks = this->wf->get_blocks(this->force_diagonal_blocks);
+
+        if (bsr_mat && bsr_mat->get_block_size() > 1)
+          this->create_block_layout(bsr_mat, spaces, states, num_states, ndof);
+
+        this->tick();
+        this->create_sparse_structure(mat, spaces, states, num_states, blocks, ndof);
+        this->tick();
+        this->info("\tDiscreteProblemSelectiveAssembler: Sparsity pattern: %s.", this->last_str().c_str());
+
+        free_with_check(blocks, true);
+
+        this->set_previous_pattern(cs_mat, spaces);
+      }
+      else if ((!matrix_structure_reusable || (mat != this->previous_mat)) && mat)
       {
         // Spaces have changed: create the matrix from scratch.
         matrix_structure_reusable = true;
         mat->free();
+        if (bsr_mat && bsr_mat->get_block_size() > 1)
+          this->create_block_layout(bsr_mat, spaces, states, num_states, ndof);
         mat->prealloc(ndof);
 
         AsmList<Scalar>* al = malloc_with_check<AsmList<Scalar> >(spaces_size);
@@ -229,6 +263,8 @@ namespace Hermes
 
         this->tick();
         this->info("\tDiscreteProblemSelectiveAssembler: Finish: %s.", this->last_str().c_str());
+
+        this->set_previous_pattern(cs_mat, spaces);
       }
 
       // WARNING: unlike Matrix<Scalar>::alloc(), Vector<Scalar>::alloc(ndof) frees the memory occupied
@@ -244,6 +280,262 @@ namespace Hermes
       return true;
     }
 
+    /// Rows of one column of the sparsity pattern.
+    /// \param[in] marker Per-thread array (size = ndof), marker[row] == col for the rows already found in this column.
+    /// \param[out] rows The rows (unsorted), nullptr to only count them.
+    /// \return The number of rows.
+    static int sparse_structure_column(int col, unsigned int spaces_size, bool** blocks, const int* list_ptr, const int* lists,
+      const int* incidence_ptr, const int* incidences, int* marker, int* rows)
+    {
+      int count = 0;
+      for (int k = incidence_ptr[col]; k < incidence_ptr[col + 1]; k++)
+      {
+        // The column DOF belongs to the space n on this state, the rows come from all the spaces m coupled with n.
+        int state_i = incidences[k] / spaces_size;
+        int n = incidences[k] % spaces_size;
+        for (unsigned int m = 0; m < spaces_size; m++)
+        {
+          if (!blocks[m][n])
+            continue;
+          int list_i = state_i * spaces_size + m;
+          for (int q = list_ptr[list_i]; q < list_ptr[list_i + 1]; q++)
+          {
+            int row = lists[q];
+            if (marker[row] != col)
+            {
+              marker[row] = col;
+              if (rows)
+                rows[count] = row;
+              count++;
+            }
+          }
+        }
+      }
+      return count;
+    }
+
+    template<typename Scalar>
+    void DiscreteProblemSelectiveAssembler<Scalar>::create_block_layout(BSRMatrix<Scalar>* mat, std::vector<SpaceSharedPtr<Scalar> >& spaces, Traverse::State** states, unsigned int num_states, int ndof)
+    {
+      if (mat->get_block_size() != this->spaces_size)
+        throw Exceptions::Exception("BSRMatrix: the block size %i differs from the number of spaces %i.", mat->get_block_size(), this->spaces_size);
+      for (unsigned int space_i = 1; space_i < this->spaces_size; space_i++)
+        if (spaces[space_i]->get_mesh() != spaces[0]->get_mesh())
+          throw Exceptions::Exception("BSRMatrix: all the spaces have to be defined on the same mesh.");
+
+      int* dof_block = malloc_with_check<int>(ndof);
+      int* dof_component = malloc_with_check<int>(ndof);
+      for (int i = 0; i < ndof; i++)
+        dof_block[i] = -1;
+      int num_blocks = 0;
+
+      // The same positions in the assembly lists of all the spaces (the same element, the same orders) form one block.
+      AsmList<Scalar>* al = malloc_with_check<AsmList<Scalar> >(this->spaces_size);
+      for (unsigned int state_i = 0; state_i < num_states; state_i++)
+      {
+        Traverse::State* current_state = states[state_i];
+        for (unsigned int space_i = 0; space_i < this->spaces_size; space_i++)
+        {
+          spaces[space_i]->get_element_assembly_list(current_state->e[space_i], &(al[space_i]));
+          if (al[space_i].cnt != al[0].cnt)
+            throw Exceptions::Exception("BSRMatrix: the spaces differ in the orders of element %i.", current_state->e[0]->id);
+        }
+
+        for (unsigned int position = 0; position < al[0].cnt; position++)
+        {
+          int block = -1;
+          for (unsigned int space_i = 0; space_i < this->spaces_size; space_i++)
+          {
+            int dof = al[space_i].dof[position];
+            if (dof < 0 || dof_block[dof] == -1)
+              continue;
+            if (block != -1 && dof_block[dof] != block)
+              throw Exceptions::Exception("BSRMatrix: the DOF structure of the spaces differs on element %i.", current_state->e[0]->id);
+            block = dof_block[dof];
+          }
+
+          for (unsigned int space_i = 0; space_i < this->spaces_size; space_i++)
+          {
+            int dof = al[space_i].dof[position];
+            if (dof < 0 || dof_block[dof] != -1)
+              continue;
+            if (block == -1)
+              block = num_blocks++;
+            dof_block[dof] = block;
+            dof_component[dof] = space_i;
+          }
+        }
+      }
+      free_with_check(al);
+
+      // Unknowns not present in any assembly list.
+      for (int i = 0; i < ndof; i++)
+      {
+        if (dof_block[i] == -1)
+        {
+          // The spaces are numbered one after another.
+          dof_block[i] = num_blocks++;
+          dof_component[i] = 0;
+          for (int space_i = 0, first_dof = 0; space_i < (int)this->spaces_size && i >= first_dof; first_dof += spaces[space_i++]->get_num_dofs())
+            dof_component[i] = space_i;
+        }
+      }
+
+      mat->set_block_layout(ndof, num_blocks, dof_block, dof_component);
+
+      free_with_check(dof_block);
+      free_with_check(dof_component);
+    }
+
+    template<typename Scalar>
+    void DiscreteProblemSelectiveAssembler<Scalar>::create_sparse_structure(SparseMatrix<Scalar>* mat, std::vector<SpaceSharedPtr<Scalar> >& spaces, Traverse::State** states, unsigned int num_states, bool** blocks, int ndof)
+    {
+      int num_threads_used = std::max(1, std::min((int)this->num_threads_used, (int)num_states));
+
+      // DOFs of every (state, space), collected per thread (the threads process contiguous ranges of states).
+      int num_lists = num_states * this->spaces_size;
+      int* list_ptr = calloc_with_check<int>(num_lists + 1);
+      std::vector<int>* thread_lists = new std::vector<int>[num_threads_used];
+      this->exceptionMessageCaughtInParallelBlock.clear();
+#pragma omp parallel num_threads(num_threads_used)
+      {
+        int thread_number = omp_get_thread_num();
+        int start = (num_states / num_threads_used) * thread_number;
+        int end = (num_states / num_threads_used) * (thread_number + 1);
+        if (thread_number == num_threads_used - 1)
+          end = num_states;
+
+        try
+        {
+          AsmList<Scalar> al;
+          for (int state_i = start; state_i < end; state_i++)
+          {
+            for (unsigned int space_i = 0; space_i < this->spaces_size; space_i++)
+            {
+              Element* e = states[state_i]->e[space_i];
+              if (!e)
+                continue;
+              spaces[space_i]->get_element_assembly_list(e, &al);
+              for (unsigned int j = 0; j < al.cnt; j++)
+              {
+                if (al.dof[j] >= 0)
+                {
+                  thread_lists[thread_number].push_back(al.dof[j]);
+                  list_ptr[state_i * this->spaces_size + space_i + 1]++;
+                }
+              }
+            }
+          }
+        }
+        catch (Hermes::Exceptions::Exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.info();
+        }
+        catch (std::exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.what();
+        }
+      }
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+      {
+        free_with_check(list_ptr);
+        delete[] thread_lists;
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+      }
+
+      for (int list_i = 0; list_i < num_lists; list_i++)
+        list_ptr[list_i + 1] += list_ptr[list_i];
+      int* lists = malloc_with_check<int>(list_ptr[num_lists]);
+      for (int thread_i = 0; thread_i < num_threads_used; thread_i++)
+      {
+        if (thread_lists[thread_i].empty())
+          continue;
+        int start = (num_states / num_threads_used) * thread_i;
+        memcpy(lists + list_ptr[start * this->spaces_size], &thread_lists[thread_i][0], thread_lists[thread_i].size() * sizeof(int));
+      }
+      delete[] thread_lists;
+
+      // (state, space) incidences of every DOF (count, fill).
+      int* incidence_ptr = calloc_with_check<int>(ndof + 1);
+      for (int q = 0; q < list_ptr[num_lists]; q++)
+        incidence_ptr[lists[q] + 1]++;
+      for (int dof = 0; dof < ndof; dof++)
+        incidence_ptr[dof + 1] += incidence_ptr[dof];
+      int* incidences = malloc_with_check<int>(incidence_ptr[ndof]);
+      int* next = malloc_with_check<int>(ndof);
+      memcpy(next, incidence_ptr, ndof * sizeof(int));
+      for (int list_i = 0; list_i < num_lists; list_i++)
+        for (int q = list_ptr[list_i]; q < list_ptr[list_i + 1]; q++)
+          incidences[next[lists[q]]++] = list_i;
+      free_with_check(next);
+
+      // The pattern - the columns are independent, two passes (count, fill) with a marker array per thread.
+      int* pattern_ptr = calloc_with_check<int>(ndof + 1);
+      int* pattern_rows = nullptr;
+      for (int pass = 0; pass < 2; pass++)
+      {
+        if (pass == 1)
+        {
+          for (int dof = 0; dof < ndof; dof++)
+            pattern_ptr[dof + 1] += pattern_ptr[dof];
+          pattern_rows = malloc_with_check<int>(pattern_ptr[ndof]);
+        }
+
+#pragma omp parallel num_threads(num_threads_used)
+        {
+          int* marker = malloc_with_check<int>(ndof);
+          memset(marker, -1, ndof * sizeof(int));
+
+#pragma omp for schedule(dynamic, 1024)
+          for (int col = 0; col < ndof; col++)
+          {
+            if (pass == 0)
+              pattern_ptr[col + 1] = sparse_structure_column(col, this->spaces_size, blocks, list_ptr, lists, incidence_ptr, incidences, marker, nullptr);
+            else
+            {
+              int* rows = pattern_rows + pattern_ptr[col];
+              int count = sparse_structure_column(col, this->spaces_size, blocks, list_ptr, lists, incidence_ptr, incidences, marker, rows);
+              std::sort(rows, rows + count);
+            }
+          }
+
+          free_with_check(marker);
+        }
+      }
+
+      free_with_check(list_ptr);
+      free_with_check(lists);
+      free_with_check(incidence_ptr);
+      free_with_check(incidences);
+
+      mat->alloc_with_pattern(ndof, pattern_ptr, pattern_rows);
+
+      free_with_check(pattern_ptr);
+      free_with_check(pattern_rows);
+    }
+
+    template<typename Scalar>
+    void DiscreteProblemSelectiveAssembler<Scalar>::set_previous_pattern(CSMatrix<Scalar>* cs_mat, const std::vector<SpaceSharedPtr<Scalar> >& spaces)
+    {
+      this->previous_pattern = cs_mat ? cs_mat->get_sparsity_pattern() : SparsityPatternSharedPtr();
+      this->previous_pattern_sp_seq.clear();
+      for (unsigned int i = 0; i < spaces.size(); i++)
+        this->previous_pattern_sp_seq.push_back(spaces[i]->get_seq());
+    }
+
+    template<typename Scalar>
+    bool DiscreteProblemSelectiveAssembler<Scalar>::previous_pattern_matches(const std::vector<SpaceSharedPtr<Scalar> >& spaces, int ndof) const
+    {
+      if (!this->previous_pattern || this->previous_pattern->get_size() != (unsigned int)ndof || this->previous_pattern_sp_seq.size() != spaces.size())
+        return false;
+      for (unsigned int i = 0; i < spaces.size(); i++)
+        if (spaces[i]->get_seq() != this->previous_pattern_sp_seq[i])
+          return false;
+      return true;
+    }
+
     template<typename Scalar>
     void DiscreteProblemSelectiveAssembler<Scalar>::set_spaces(std::vector<SpaceSharedPtr<Scalar> > spacesToSet)
     {
@@ -270,6 +562,12 @@ namespace Hermes
       }
     }
 
+    template<typename Scalar>
+    void DiscreteProblemSelectiveAssembler<Scalar>::use_assembly_list_pattern(bool to_set)
+    {
+      this->assembly_list_pattern = to_set;
+    }
+
     template<typename Scalar>
     void DiscreteProblemSelectiveAssembler<Scalar>::set_weak_formulation(WeakFormSharedPtr<Scalar> wf_)
     {
@@ -283,8 +581,27 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixForm<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_selected(Form<Scalar>* form, FormSelection selection) const
+    {
+      switch (selection)
+      {
+      case AllForms:
+        return true;
+      case SolutionIndependentForms:
+        return form->solution_independent;
+      case SolutionDependentForms:
+        return !form->solution_independent;
+      default:
+        return false;
+      }
+    }
+
+    template<typename Scalar>
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixForm<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
+      if (apply_selection && !this->form_selected(form, this->matrix_form_selection))
+        return false;
+
       if (current_state->e[form->i] && current_state->e[form->j])
       {
         if (fabs(form->scaling_factor) < Hermes::HermesSqrtEpsilon)
@@ -301,9 +618,9 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixFormVol<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixFormVol<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
-      if (!form_to_be_assembled((MatrixForm<Scalar>*)form, current_state))
+      if (!form_to_be_assembled((MatrixForm<Scalar>*)form, current_state, apply_selection))
         return false;
 
       if (form->assembleEverywhere)
@@ -318,9 +635,9 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixFormSurf<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(MatrixFormSurf<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
-      if (!form_to_be_assembled((MatrixForm<Scalar>*)form, current_state))
+      if (!form_to_be_assembled((MatrixForm<Scalar>*)form, current_state, apply_selection))
         return false;
 
       if (current_state->rep->en[current_state->isurf]->marker == 0)
@@ -344,8 +661,10 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorForm<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorForm<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
+      if (apply_selection && !this->form_selected(form, this->vector_form_selection))
+        return false;
       if (!current_state->e[form->i])
         return false;
       if (fabs(form->scaling_factor) < Hermes::HermesSqrtEpsilon)
@@ -355,9 +674,9 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorFormVol<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorFormVol<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
-      if (!form_to_be_assembled((VectorForm<Scalar>*)form, current_state))
+      if (!form_to_be_assembled((VectorForm<Scalar>*)form, current_state, apply_selection))
         return false;
 
       if (form->assembleEverywhere)
@@ -372,9 +691,9 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorFormSurf<Scalar>* form, Traverse::State* current_state)
+    bool DiscreteProblemSelectiveAssembler<Scalar>::form_to_be_assembled(VectorFormSurf<Scalar>* form, Traverse::State* current_state, bool apply_selection)
     {
-      if (!form_to_be_assembled((VectorForm<Scalar>*)form, current_state))
+      if (!form_to_be_assembled((VectorForm<Scalar>*)form, current_state, apply_selection))
         return false;
 
       if (current_state->rep->en[current_state->isurf]->marker == 0)
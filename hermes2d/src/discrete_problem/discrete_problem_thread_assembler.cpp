@@ -26,7 +26,7 @@ namespace Hermes
   {
     template<typename Scalar>
     DiscreteProblemThreadAssembler<Scalar>::DiscreteProblemThreadAssembler(DiscreteProblemSelectiveAssembler<Scalar>* selectiveAssembler, bool nonlinear) :
-      pss(nullptr), refmaps(nullptr), u_ext(nullptr),
+      pss(nullptr), refmaps(nullptr), sum_factorization_kernels(nullptr), u_ext(nullptr),
       selectiveAssembler(selectiveAssembler), integrationOrderCalculator(selectiveAssembler),
       ext_funcs(nullptr), ext_funcs_allocated_size(0), ext_funcs_local(nullptr), ext_funcs_local_allocated_size(0),
       funcs_wf_initialized(false), funcs_space_initialized(false), spaces_size(0), nonlinear(nonlinear), reusable_DOFs(nullptr), reusable_Dirichlet(nullptr)
@@ -60,12 +60,17 @@ namespace Hermes
 
       pss = malloc_with_check<PrecalcShapesetAssembling*>(spaces_size);
       refmaps = malloc_with_check<RefMap*>(spaces_size);
+      sum_factorization_kernels = malloc_with_check<SumFactorizationKernel<Scalar>*>(spaces_size);
 
       for (unsigned int j = 0; j < spaces_size; j++)
       {
         pss[j] = new PrecalcShapesetAssembling(spaces[j]->shapeset);
         refmaps[j] = new RefMap();
         refmaps[j]->set_quad_2d(&g_quad_2d_std);
+        if (spaces[j]->get_type() == HERMES_H1_SPACE || spaces[j]->get_type() == HERMES_L2_SPACE)
+          sum_factorization_kernels[j] = new SumFactorizationKernel<Scalar>(spaces[j]->shapeset);
+        else
+          sum_factorization_kernels[j] = nullptr;
       }
     }
 
@@ -464,10 +469,13 @@ namespace Hermes
         }
       }
 
-      if (this->rungeKutta)
+      // The previous time level solution is at the back of ext, it is added to u_ext of every stage
+      // (u_ext_offset of the stage forms is stage * RK_original_spaces_count), only once - not again for the form-specific ext.
+      if (this->rungeKutta && &ext == &this->wf->ext)
       {
-        for (unsigned short ext_i = 0; ext_i < ext.size(); ext_i++)
-          u_ext_func[ext_i]->add(target_array[ext.size() - this->RK_original_spaces_count + ext_i]);
+        for (int stage_offset = 0; stage_offset + this->RK_original_spaces_count <= spaces_size; stage_offset += this->RK_original_spaces_count)
+          for (int space_i = 0; space_i < this->RK_original_spaces_count; space_i++)
+            u_ext_func[stage_offset + space_i]->add(target_array[u_ext_fns_size + ext_size - this->RK_original_spaces_count + space_i]);
       }
     }
 
@@ -690,7 +698,8 @@ namespace Hermes
     void DiscreteProblemThreadAssembler<Scalar>::assemble_vector_form(VectorFormType* form, int order, Func<double>** test_fns,
       AsmList<Scalar>* current_als_i, int n_quadrature_points, Geom* geometry, double* jacobian_x_weights)
     {
-      bool surface_form = (dynamic_cast<VectorFormVol<Scalar>*>(form) == nullptr);
+      VectorFormVol<Scalar>* form_vol = dynamic_cast<VectorFormVol<Scalar>*>(form);
+      bool surface_form = (form_vol == nullptr);
 
       Func<Scalar>** ext_local = this->ext_funcs;
       // If the user supplied custom ext functions for this form.
@@ -705,6 +714,10 @@ namespace Hermes
       if (this->rungeKutta)
         u_ext_local += form->u_ext_offset;
 
+      // All the test functions at once.
+      if (!surface_form && this->assemble_vector_form_sum_factorization(form_vol, current_als_i, u_ext_local, ext_local))
+        return;
+
       // Actual form-specific calculation.
       for (unsigned int i = 0; i < current_als_i->cnt; i++)
       {
@@ -733,6 +746,60 @@ namespace Hermes
       }
     }
 
+    template<typename Scalar>
+    bool DiscreteProblemThreadAssembler<Scalar>::assemble_vector_form_sum_factorization(VectorFormVol<Scalar>* form, AsmList<Scalar>* current_als_i, Func<Scalar>** u_ext_local, Func<Scalar>** ext_local)
+    {
+      // Affine quads, the whole element (the rule points are then a tensor product in the element's reference domain).
+      int space_i = form->i;
+      SumFactorizationKernel<Scalar>* kernel = this->sum_factorization_kernels[space_i];
+      if (!kernel || !current_state->e[space_i]->is_quad() || current_state->sub_idx[space_i] != 0 || !refmaps[space_i]->is_jacobian_const())
+        return false;
+
+      if (!kernel->set_basis(current_als_i->cnt, current_als_i->idx, this->order))
+        return false;
+
+      Scalar f[H2D_MAX_INTEGRATION_POINTS_COUNT], f_x[H2D_MAX_INTEGRATION_POINTS_COUNT], f_y[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      for (int i = 0; i < n_quadrature_points; i++)
+        f[i] = f_x[i] = f_y[i] = 0.;
+      if (!form->integrand(n_quadrature_points, u_ext_local, &this->geometry, ext_local, f, f_x, f_y))
+        return false;
+
+      // Weights, physical gradient -> reference gradient.
+      double2x2* const_inv_ref_map = refmaps[space_i]->get_const_inv_ref_map();
+      double m00 = (*const_inv_ref_map)[0][0], m01 = (*const_inv_ref_map)[0][1];
+      double m10 = (*const_inv_ref_map)[1][0], m11 = (*const_inv_ref_map)[1][1];
+      for (int i = 0; i < n_quadrature_points; i++)
+      {
+        double wt = this->jacobian_x_weights[i];
+        Scalar f_x_i = f_x[i], f_y_i = f_y[i];
+        f[i] *= wt;
+        f_x[i] = wt * (f_x_i * m00 + f_y_i * m10);
+        f_y[i] = wt * (f_x_i * m01 + f_y_i * m11);
+      }
+
+      Scalar values[H2D_MAX_LOCAL_BASIS_SIZE];
+      kernel->integrate(f, f_x, f_y, values);
+
+      for (unsigned int i = 0; i < current_als_i->cnt; i++)
+      {
+        if (current_als_i->dof[i] < 0)
+          continue;
+
+        if (this->reusable_DOFs && *this->reusable_DOFs)
+        {
+          if ((*this->reusable_DOFs)[current_als_i->dof[i]])
+            continue;
+        }
+
+        if (std::abs(current_als_i->coef[i]) < Hermes::HermesSqrtEpsilon)
+          continue;
+
+        this->current_rhs->add(current_als_i->dof[i], values[i] * form->scaling_factor * current_als_i->coef[i]);
+      }
+
+      return true;
+    }
+
     template<typename Scalar>
     void DiscreteProblemThreadAssembler<Scalar>::deinit_assembling_one_state()
     {
@@ -769,6 +836,10 @@ namespace Hermes
       for (unsigned int j = 0; j < spaces_size; j++)
         delete refmaps[j];
       free_with_check(refmaps);
+
+      for (unsigned int j = 0; j < spaces_size; j++)
+        delete sum_factorization_kernels[j];
+      free_with_check(sum_factorization_kernels);
     }
 
     template<typename Scalar>
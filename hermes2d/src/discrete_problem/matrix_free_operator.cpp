@@ -0,0 +1,887 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "discrete_problem/matrix_free_operator.h"
+#include "discrete_problem/discrete_problem_helpers.h"
+#include "mesh/traverse.h"
+#include "mesh/refmap.h"
+#include "space/space.h"
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    /// Real (part 0) or imaginary (part 1) part of a value.
+    static inline double scalar_part(double value, unsigned char part)
+    {
+      return value;
+    }
+
+    static inline double scalar_part(const std::complex<double>& value, unsigned char part)
+    {
+      return part ? value.imag() : value.real();
+    }
+
+    /// The value multiplied by 1 (part 0) or by the imaginary unit (part 1).
+    static inline double from_part(double value, unsigned char part)
+    {
+      return value;
+    }
+
+    static inline std::complex<double> from_part(const std::complex<double>& value, unsigned char part)
+    {
+      return part ? std::complex<double>(-value.imag(), value.real()) : value;
+    }
+
+    template<>
+    const unsigned char MatrixFreeOperator<double>::num_parts = 1;
+    template<>
+    const unsigned char MatrixFreeOperator<std::complex<double> >::num_parts = 2;
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>::ThreadData::ThreadData(MatrixFreeOperator<Scalar>* op) : spaces_size(op->spaces_size),
+      max_basis_size(0), basis(nullptr), out(nullptr)
+    {
+      this->wf = WeakFormSharedPtr<Scalar>(op->wf->clone());
+      this->wf->cloneMembers(op->wf);
+      this->wf->processFormMarkers(op->spaces);
+
+      this->pss = malloc_with_check<PrecalcShapesetAssembling*>(this->spaces_size);
+      this->refmaps = malloc_with_check<RefMap*>(this->spaces_size);
+      this->kernels = malloc_with_check<SumFactorizationKernel<Scalar>*>(this->spaces_size);
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        this->pss[space_i] = new PrecalcShapesetAssembling(op->spaces[space_i]->get_shapeset());
+        this->pss[space_i]->set_quad_2d(&g_quad_2d_std);
+        this->refmaps[space_i] = new RefMap();
+        this->refmaps[space_i]->set_quad_2d(&g_quad_2d_std);
+        this->kernels[space_i] = new SumFactorizationKernel<Scalar>(op->spaces[space_i]->get_shapeset());
+      }
+
+      this->gathered = new Func<double>[this->spaces_size * 2];
+    }
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>::ThreadData::~ThreadData()
+    {
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        delete this->pss[space_i];
+        delete this->refmaps[space_i];
+        delete this->kernels[space_i];
+      }
+      free_with_check(this->pss);
+      free_with_check(this->refmaps);
+      free_with_check(this->kernels);
+
+      delete[] this->basis;
+      delete[] this->gathered;
+      free_with_check(this->out);
+    }
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>::MatrixFreeOperator(WeakFormSharedPtr<Scalar> wf, std::vector<SpaceSharedPtr<Scalar> > spaces) : Matrix<Scalar>(),
+      wf(wf), spaces(spaces), spaces_size(spaces.size()), sp_seq(nullptr), prepared(false),
+      states(nullptr), num_states(0), state_data(nullptr), thread_data(nullptr), max_basis_size(0)
+    {
+      this->selectiveAssembler.set_spaces(this->spaces);
+      this->check();
+    }
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>::MatrixFreeOperator(WeakFormSharedPtr<Scalar> wf, SpaceSharedPtr<Scalar> space) : Matrix<Scalar>(),
+      wf(wf), spaces(std::vector<SpaceSharedPtr<Scalar> >(1, space)), spaces_size(1), sp_seq(nullptr), prepared(false),
+      states(nullptr), num_states(0), state_data(nullptr), thread_data(nullptr), max_basis_size(0)
+    {
+      this->selectiveAssembler.set_spaces(this->spaces);
+      this->check();
+    }
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>::~MatrixFreeOperator()
+    {
+      this->free();
+      free_with_check(this->sp_seq);
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::check() const
+    {
+      if (!this->wf)
+        throw Exceptions::Exception("MatrixFreeOperator: the weak formulation is not set.");
+      if (this->spaces_size == 0 || this->spaces_size > H2D_MAX_COMPONENTS)
+        throw Exceptions::ValueException("spaces", this->spaces_size, 1);
+
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        SpaceType type = this->spaces[space_i]->get_type();
+        if (type != HERMES_H1_SPACE && type != HERMES_L2_SPACE)
+          throw Exceptions::Exception("MatrixFreeOperator: only H1 and L2 spaces are supported.");
+      }
+
+      if (this->wf->is_DG())
+        throw Exceptions::Exception("MatrixFreeOperator: DG forms are not supported.");
+      bool ext_found = !this->wf->ext.empty() || !this->wf->u_ext_fn.empty();
+      for (unsigned int form_i = 0; form_i < this->wf->forms.size(); form_i++)
+        if (!this->wf->forms[form_i]->ext.empty() || !this->wf->forms[form_i]->u_ext_fn.empty())
+          ext_found = true;
+      if (ext_found)
+        throw Exceptions::Exception("MatrixFreeOperator: external functions are not supported.");
+    }
+
+    template<typename Scalar>
+    bool MatrixFreeOperator<Scalar>::spaces_changed() const
+    {
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        if (this->spaces[space_i]->get_seq() != this->sp_seq[space_i])
+          return true;
+      return false;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::free()
+    {
+      if (this->states)
+      {
+        for (unsigned int i = 0; i < this->num_states; i++)
+          delete this->states[i];
+        free_with_check(this->states);
+      }
+      free_with_check(this->state_data);
+      this->num_states = 0;
+
+      if (this->thread_data)
+      {
+        for (int thread_i = 0; thread_i < this->num_threads_used; thread_i++)
+          delete this->thread_data[thread_i];
+        delete[] this->thread_data;
+        this->thread_data = nullptr;
+      }
+
+      this->prepared = false;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::alloc()
+    {
+      this->prepare();
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::prepare()
+    {
+      this->check();
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        if (!this->spaces[space_i]->is_up_to_date())
+          throw Exceptions::Exception("Space is out of date, if you manually refine it, you have to call assign_dofs().");
+
+      this->free();
+
+      this->size = Space<Scalar>::get_num_dofs(this->spaces);
+      if (!this->sp_seq)
+        this->sp_seq = malloc_with_check<int>(this->spaces_size);
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        this->sp_seq[space_i] = this->spaces[space_i]->get_seq();
+
+      std::vector<MeshSharedPtr> meshes;
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        meshes.push_back(this->spaces[space_i]->get_mesh());
+      Traverse trav(this->spaces_size);
+      this->states = trav.get_states(meshes, this->num_states);
+      this->state_data = malloc_with_check<StateData>(this->num_states);
+
+      this->thread_data = new ThreadData*[this->num_threads_used];
+      for (int thread_i = 0; thread_i < this->num_threads_used; thread_i++)
+        this->thread_data[thread_i] = new ThreadData(this);
+
+      this->exceptionMessageCaughtInParallelBlock.clear();
+#pragma omp parallel num_threads(this->num_threads_used)
+      {
+        int thread_number = omp_get_thread_num();
+        int start = (this->num_states / this->num_threads_used) * thread_number;
+        int end = (this->num_states / this->num_threads_used) * (thread_number + 1);
+        if (thread_number == this->num_threads_used - 1)
+          end = this->num_states;
+
+        try
+        {
+          ThreadData* td = this->thread_data[thread_number];
+          DiscreteProblemIntegrationOrderCalculator<Scalar> order_calculator(&this->selectiveAssembler);
+          for (int state_i = start; state_i < end; state_i++)
+            this->prepare_state(td, this->states[state_i], &this->state_data[state_i], &order_calculator);
+          td->out = malloc_with_check<Scalar>(this->size);
+        }
+        catch (Hermes::Exceptions::Exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.info();
+        }
+        catch (std::exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.what();
+        }
+      }
+
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+      {
+        this->free();
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+      }
+
+      // Working basis functions for the longest assembly list.
+      this->max_basis_size = 0;
+      for (int thread_i = 0; thread_i < this->num_threads_used; thread_i++)
+        this->max_basis_size = std::max(this->max_basis_size, this->thread_data[thread_i]->max_basis_size);
+      for (int thread_i = 0; thread_i < this->num_threads_used; thread_i++)
+        this->thread_data[thread_i]->basis = new Func<double>[this->spaces_size * std::max(this->max_basis_size, (unsigned short)1)];
+
+      this->prepared = true;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::prepare_state(ThreadData* td, Traverse::State* state, StateData* state_data, DiscreteProblemIntegrationOrderCalculator<Scalar>* order_calculator)
+    {
+      state_data->state = state;
+      state_data->space_data = td->space_data.size();
+      state_data->first_edge = td->edges.size();
+      state_data->num_edges = 0;
+
+      // Elements & reference maps.
+      RefMap* rep_refmap = nullptr;
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        if (!state->e[space_i])
+          continue;
+        td->pss[space_i]->set_active_element(state->e[space_i]);
+        td->pss[space_i]->set_transform(state->sub_idx[space_i]);
+        td->refmaps[space_i]->set_active_element(state->e[space_i]);
+        td->refmaps[space_i]->force_transform(td->pss[space_i]->get_transform(), td->pss[space_i]->get_ctm());
+        rep_refmap = td->refmaps[space_i];
+      }
+
+      // Integration order - the same as DiscreteProblem uses.
+      order_calculator->current_state = state;
+      state_data->order = order_calculator->calculate_order(this->spaces, td->refmaps, td->wf);
+
+      // Geometry.
+      double jacobian_x_weights[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      state_data->np = init_geometry_points_allocated(rep_refmap, state_data->order, td->geometry, jacobian_x_weights);
+      state_data->id = td->geometry.id;
+      state_data->elem_marker = td->geometry.elem_marker;
+      unsigned char np = state_data->np;
+      state_data->geometry = td->reals.size();
+      td->reals.insert(td->reals.end(), jacobian_x_weights, jacobian_x_weights + np);
+      td->reals.insert(td->reals.end(), td->geometry.x, td->geometry.x + np);
+      td->reals.insert(td->reals.end(), td->geometry.y, td->geometry.y + np);
+
+      // Assembly lists & inverse reference maps.
+      AsmList<Scalar> al;
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        SpaceData space_data;
+        memset(&space_data, 0, sizeof(SpaceData));
+        space_data.present = (state->e[space_i] != nullptr);
+        if (space_data.present)
+        {
+          RefMap* refmap = td->refmaps[space_i];
+          this->spaces[space_i]->get_element_assembly_list(state->e[space_i], &al);
+          space_data.cnt = al.cnt;
+          space_data.al = td->ints.size();
+          td->ints.insert(td->ints.end(), al.idx, al.idx + al.cnt);
+          td->ints.insert(td->ints.end(), al.dof, al.dof + al.cnt);
+          space_data.coef = td->coefs.size();
+          td->coefs.insert(td->coefs.end(), al.coef, al.coef + al.cnt);
+          if (al.cnt > td->max_basis_size)
+            td->max_basis_size = al.cnt;
+
+          space_data.const_jacobian = refmap->is_jacobian_const();
+          space_data.tensor_product = space_data.const_jacobian && state->e[space_i]->is_quad() && state->sub_idx[space_i] == 0;
+          space_data.inv_ref_map = td->reals.size();
+          double2x2* m = space_data.const_jacobian ? refmap->get_const_inv_ref_map() : refmap->get_inv_ref_map(state_data->order);
+          for (unsigned char i = 0; i < (space_data.const_jacobian ? 1 : np); i++)
+          {
+            td->reals.push_back(m[i][0][0]);
+            td->reals.push_back(m[i][0][1]);
+            td->reals.push_back(m[i][1][0]);
+            td->reals.push_back(m[i][1][1]);
+          }
+        }
+        td->space_data.push_back(space_data);
+      }
+
+      // Boundary edges with a surface matrix form.
+      if (!state->isBnd || td->wf->mfsurf.empty())
+        return;
+
+      for (unsigned char isurf = 0; isurf < state->rep->nvert; isurf++)
+      {
+        if (!state->bnd[isurf])
+          continue;
+
+        state->isurf = isurf;
+        bool form_found = false;
+        for (unsigned short form_i = 0; form_i < td->wf->mfsurf.size(); form_i++)
+          if (this->selectiveAssembler.form_to_be_assembled(td->wf->mfsurf[form_i], state))
+            form_found = true;
+        if (!form_found)
+          continue;
+
+        EdgeData edge;
+        edge.isurf = isurf;
+        edge.order = state_data->order;
+        edge.np = init_surface_geometry_points_allocated(rep_refmap, edge.order, isurf, state->rep->marker, td->geometry_surf, jacobian_x_weights);
+        edge.edge_marker = td->geometry_surf.edge_marker;
+        edge.orientation = td->geometry_surf.orientation;
+        edge.geometry = td->reals.size();
+        GeomSurf<double>& g = td->geometry_surf;
+        td->reals.insert(td->reals.end(), jacobian_x_weights, jacobian_x_weights + edge.np);
+        td->reals.insert(td->reals.end(), g.x, g.x + edge.np);
+        td->reals.insert(td->reals.end(), g.y, g.y + edge.np);
+        td->reals.insert(td->reals.end(), g.nx, g.nx + edge.np);
+        td->reals.insert(td->reals.end(), g.ny, g.ny + edge.np);
+        td->reals.insert(td->reals.end(), g.tx, g.tx + edge.np);
+        td->reals.insert(td->reals.end(), g.ty, g.ty + edge.np);
+
+        edge.space_data = td->space_data.size();
+        for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        {
+          SpaceData space_data;
+          memset(&space_data, 0, sizeof(SpaceData));
+          space_data.present = (state->e[space_i] != nullptr);
+          if (space_data.present)
+          {
+            RefMap* refmap = td->refmaps[space_i];
+            this->spaces[space_i]->get_boundary_assembly_list(state->e[space_i], isurf, &al);
+            space_data.cnt = al.cnt;
+            space_data.al = td->ints.size();
+            td->ints.insert(td->ints.end(), al.idx, al.idx + al.cnt);
+            td->ints.insert(td->ints.end(), al.dof, al.dof + al.cnt);
+            space_data.coef = td->coefs.size();
+            td->coefs.insert(td->coefs.end(), al.coef, al.coef + al.cnt);
+
+            space_data.const_jacobian = refmap->is_jacobian_const();
+            space_data.inv_ref_map = td->reals.size();
+            double2x2* m = space_data.const_jacobian ? refmap->get_const_inv_ref_map() : refmap->get_inv_ref_map(edge.order);
+            for (unsigned char i = 0; i < (space_data.const_jacobian ? 1 : edge.np); i++)
+            {
+              td->reals.push_back(m[i][0][0]);
+              td->reals.push_back(m[i][0][1]);
+              td->reals.push_back(m[i][1][0]);
+              td->reals.push_back(m[i][1][1]);
+            }
+          }
+          td->space_data.push_back(space_data);
+        }
+
+        td->edges.push_back(edge);
+        state_data->num_edges++;
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::set_active_state(ThreadData* td, StateData* state_data)
+    {
+      Traverse::State* state = state_data->state;
+      for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+      {
+        if (!state->e[space_i])
+          continue;
+        td->pss[space_i]->set_active_element(state->e[space_i]);
+        td->pss[space_i]->set_transform(state->sub_idx[space_i]);
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::init_basis(ThreadData* td, SpaceData* sd, unsigned short space_i, int order, unsigned char np)
+    {
+      PrecalcShapesetAssembling* pss = td->pss[space_i];
+      Func<double>* basis = td->basis + space_i * this->max_basis_size;
+      const int* idx = &td->ints[sd->al];
+      const double* m = &td->reals[sd->inv_ref_map];
+
+      for (unsigned short k = 0; k < sd->cnt; k++)
+      {
+        pss->set_active_shape(idx[k]);
+        pss->set_quad_order(order);
+        const double* fn = pss->get_fn_values();
+        const double* dx = pss->get_dx_values();
+        const double* dy = pss->get_dy_values();
+
+        Func<double>* u = basis + k;
+        u->np = np;
+        u->nc = 1;
+        if (sd->const_jacobian)
+        {
+          for (unsigned char i = 0; i < np; i++)
+          {
+            u->val[i] = fn[i];
+            u->dx[i] = dx[i] * m[0] + dy[i] * m[1];
+            u->dy[i] = dx[i] * m[2] + dy[i] * m[3];
+          }
+        }
+        else
+        {
+          for (unsigned char i = 0; i < np; i++)
+          {
+            u->val[i] = fn[i];
+            u->dx[i] = dx[i] * m[4 * i] + dy[i] * m[4 * i + 1];
+            u->dy[i] = dx[i] * m[4 * i + 2] + dy[i] * m[4 * i + 3];
+          }
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::gather(ThreadData* td, SpaceData* sd, unsigned short space_i, const Scalar* in, unsigned char np)
+    {
+      Func<double>* basis = td->basis + space_i * this->max_basis_size;
+      Func<double>* parts = td->gathered + 2 * space_i;
+      const int* dof = &td->ints[sd->al + sd->cnt];
+      const Scalar* coef = &td->coefs[sd->coef];
+
+      for (unsigned char part = 0; part < num_parts; part++)
+      {
+        parts[part].np = np;
+        parts[part].nc = 1;
+        memset(parts[part].val, 0, np * sizeof(double));
+        memset(parts[part].dx, 0, np * sizeof(double));
+        memset(parts[part].dy, 0, np * sizeof(double));
+      }
+
+      for (unsigned short k = 0; k < sd->cnt; k++)
+      {
+        if (dof[k] < 0 || std::abs(coef[k]) < Hermes::HermesEpsilon)
+          continue;
+        Scalar c = in[dof[k]] * coef[k];
+        for (unsigned char part = 0; part < num_parts; part++)
+        {
+          double c_part = scalar_part(c, part);
+          if (c_part == 0.)
+            continue;
+          for (unsigned char i = 0; i < np; i++)
+          {
+            parts[part].val[i] += c_part * basis[k].val[i];
+            parts[part].dx[i] += c_part * basis[k].dx[i];
+            parts[part].dy[i] += c_part * basis[k].dy[i];
+          }
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::gather_sum_factorization(ThreadData* td, SpaceData* sd, unsigned short space_i, const Scalar* in, unsigned char np)
+    {
+      Func<double>* parts = td->gathered + 2 * space_i;
+      const int* dof = &td->ints[sd->al + sd->cnt];
+      const Scalar* coef = &td->coefs[sd->coef];
+
+      Scalar coeffs[H2D_MAX_LOCAL_BASIS_SIZE];
+      for (unsigned short k = 0; k < sd->cnt; k++)
+      {
+        if (dof[k] < 0 || std::abs(coef[k]) < Hermes::HermesEpsilon)
+          coeffs[k] = 0.;
+        else
+          coeffs[k] = in[dof[k]] * coef[k];
+      }
+
+      Scalar values[H2D_MAX_INTEGRATION_POINTS_COUNT], dx[H2D_MAX_INTEGRATION_POINTS_COUNT], dy[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      td->kernels[space_i]->evaluate(coeffs, values, dx, dy);
+
+      // Reference gradient -> physical gradient.
+      const double* m = &td->reals[sd->inv_ref_map];
+      for (unsigned char part = 0; part < num_parts; part++)
+      {
+        parts[part].np = np;
+        parts[part].nc = 1;
+        for (unsigned char i = 0; i < np; i++)
+        {
+          parts[part].val[i] = scalar_part(values[i], part);
+          parts[part].dx[i] = scalar_part(dx[i] * m[0] + dy[i] * m[1], part);
+          parts[part].dy[i] = scalar_part(dx[i] * m[2] + dy[i] * m[3], part);
+        }
+      }
+    }
+
+    template<typename Scalar>
+    bool MatrixFreeOperator<Scalar>::apply_form_sum_factorization(ThreadData* td, MatrixFormVol<Scalar>* form, StateData* state_data, Func<Scalar>** u_ext)
+    {
+      unsigned char np = state_data->np;
+      SpaceData* sd = &td->space_data[state_data->space_data + form->i];
+
+      Scalar f[H2D_MAX_INTEGRATION_POINTS_COUNT], f_x[H2D_MAX_INTEGRATION_POINTS_COUNT], f_y[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      Scalar f_part[H2D_MAX_INTEGRATION_POINTS_COUNT], f_x_part[H2D_MAX_INTEGRATION_POINTS_COUNT], f_y_part[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      for (unsigned char part = 0; part < num_parts; part++)
+      {
+        for (unsigned char i = 0; i < np; i++)
+          f_part[i] = f_x_part[i] = f_y_part[i] = 0.;
+        if (!form->integrand(np, u_ext, td->gathered + 2 * form->j + part, &td->geometry, nullptr, f_part, f_x_part, f_y_part))
+          return false;
+        for (unsigned char i = 0; i < np; i++)
+        {
+          f[i] = (part ? f[i] : Scalar(0.)) + from_part(f_part[i], part);
+          f_x[i] = (part ? f_x[i] : Scalar(0.)) + from_part(f_x_part[i], part);
+          f_y[i] = (part ? f_y[i] : Scalar(0.)) + from_part(f_y_part[i], part);
+        }
+      }
+
+      // Weights, physical gradient -> reference gradient.
+      const double* wt = &td->reals[state_data->geometry];
+      const double* m = &td->reals[sd->inv_ref_map];
+      for (unsigned char i = 0; i < np; i++)
+      {
+        Scalar f_x_i = f_x[i], f_y_i = f_y[i];
+        f[i] *= wt[i];
+        f_x[i] = wt[i] * (f_x_i * m[0] + f_y_i * m[2]);
+        f_y[i] = wt[i] * (f_x_i * m[1] + f_y_i * m[3]);
+      }
+
+      Scalar values[H2D_MAX_LOCAL_BASIS_SIZE];
+      td->kernels[form->i]->integrate(f, f_x, f_y, values);
+
+      const int* dof = &td->ints[sd->al + sd->cnt];
+      const Scalar* coef = &td->coefs[sd->coef];
+      for (unsigned short k = 0; k < sd->cnt; k++)
+      {
+        if (dof[k] < 0 || std::abs(coef[k]) < Hermes::HermesSqrtEpsilon)
+          continue;
+        td->out[dof[k]] += values[k] * form->scaling_factor * coef[k];
+      }
+
+      return true;
+    }
+
+    template<typename Scalar>
+    template<typename FormType, typename Geom>
+    void MatrixFreeOperator<Scalar>::apply_form(ThreadData* td, FormType* form, SpaceData* test_data, Func<double>* test_basis, Func<double>* trial, bool transposed,
+      unsigned char np, double* wt, Geom* geometry, Func<Scalar>** u_ext, double factor)
+    {
+      const int* dof = &td->ints[test_data->al + test_data->cnt];
+      const Scalar* coef = &td->coefs[test_data->coef];
+      for (unsigned short k = 0; k < test_data->cnt; k++)
+      {
+        if (dof[k] < 0 || std::abs(coef[k]) < Hermes::HermesSqrtEpsilon)
+          continue;
+
+        Scalar val = 0.;
+        for (unsigned char part = 0; part < num_parts; part++)
+        {
+          if (transposed)
+            val += from_part(form->value(np, wt, u_ext, test_basis + k, trial + part, geometry, nullptr), part);
+          else
+            val += from_part(form->value(np, wt, u_ext, trial + part, test_basis + k, geometry, nullptr), part);
+        }
+        td->out[dof[k]] += factor * form->scaling_factor * coef[k] * val;
+      }
+    }
+
+    template<typename Scalar>
+    template<typename FormType, typename Geom>
+    void MatrixFreeOperator<Scalar>::add_diagonal(ThreadData* td, FormType* form, SpaceData* data, Func<double>* basis,
+      unsigned char np, double* wt, Geom* geometry, Func<Scalar>** u_ext, double factor)
+    {
+      const int* dof = &td->ints[data->al + data->cnt];
+      const Scalar* coef = &td->coefs[data->coef];
+      for (unsigned short k = 0; k < data->cnt; k++)
+      {
+        if (dof[k] < 0 || std::abs(coef[k]) < Hermes::HermesSqrtEpsilon)
+          continue;
+
+        // All the functions of the list with this DOF (several ones for constrained DOFs).
+        for (unsigned short l = 0; l < data->cnt; l++)
+        {
+          if (dof[l] != dof[k] || std::abs(coef[l]) < Hermes::HermesEpsilon)
+            continue;
+          td->out[dof[k]] += factor * form->scaling_factor * coef[k] * coef[l] * form->value(np, wt, u_ext, basis + l, basis + k, geometry, nullptr);
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::apply_states(int thread_number, const Scalar* in)
+    {
+      ThreadData* td = this->thread_data[thread_number];
+      memset(td->out, 0, this->size * sizeof(Scalar));
+      bool diagonal = (in == nullptr);
+
+      // Linear forms only.
+      Func<Scalar>* u_ext[H2D_MAX_COMPONENTS];
+      for (unsigned short space_i = 0; space_i < H2D_MAX_COMPONENTS; space_i++)
+        u_ext[space_i] = nullptr;
+
+      int start = (this->num_states / this->num_threads_used) * thread_number;
+      int end = (this->num_states / this->num_threads_used) * (thread_number + 1);
+      if (thread_number == this->num_threads_used - 1)
+        end = this->num_states;
+
+      for (int state_i = start; state_i < end; state_i++)
+      {
+        StateData* state_data = &this->state_data[state_i];
+        Traverse::State* state = state_data->state;
+        unsigned char np = state_data->np;
+        this->set_active_state(td, state_data);
+
+        double* wt = &td->reals[state_data->geometry];
+        memcpy(td->geometry.x, wt + np, np * sizeof(double));
+        memcpy(td->geometry.y, wt + 2 * np, np * sizeof(double));
+        td->geometry.id = state_data->id;
+        td->geometry.elem_marker = state_data->elem_marker;
+
+        SpaceData* space_data = &td->space_data[state_data->space_data];
+        bool basis_ready[H2D_MAX_COMPONENTS], gathered_ready[H2D_MAX_COMPONENTS];
+        // 0 - not known yet, 1 - the kernel has the basis, -1 - not possible.
+        signed char kernel_ready[H2D_MAX_COMPONENTS];
+        for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+        {
+          basis_ready[space_i] = gathered_ready[space_i] = false;
+          kernel_ready[space_i] = 0;
+        }
+
+        for (unsigned short form_i = 0; form_i < td->wf->mfvol.size(); form_i++)
+        {
+          MatrixFormVol<Scalar>* form = td->wf->mfvol[form_i];
+          if (!this->selectiveAssembler.form_to_be_assembled(form, state))
+            continue;
+
+          unsigned int i = form->i, j = form->j;
+          bool tra = (i != j) && (form->sym != 0);
+
+          if (diagonal)
+          {
+            if (i != j)
+              continue;
+            if (!basis_ready[i])
+            {
+              this->init_basis(td, &space_data[i], i, state_data->order, np);
+              basis_ready[i] = true;
+            }
+            this->add_diagonal(td, form, &space_data[i], td->basis + i * this->max_basis_size, np, wt, &td->geometry, u_ext, 1.);
+            continue;
+          }
+
+          for (unsigned char side = 0; side < 2; side++)
+          {
+            unsigned int space_i = side ? j : i;
+            if (kernel_ready[space_i] == 0)
+              kernel_ready[space_i] = (space_data[space_i].tensor_product && td->kernels[space_i]->set_basis(space_data[space_i].cnt, &td->ints[space_data[space_i].al], state_data->order)) ? 1 : -1;
+          }
+
+          // The vector on the trial space (and on the test space for the transposed block).
+          for (unsigned char side = 0; side < (tra ? 2 : 1); side++)
+          {
+            unsigned int space_i = side ? i : j;
+            if (gathered_ready[space_i])
+              continue;
+            if (kernel_ready[space_i] == 1)
+              this->gather_sum_factorization(td, &space_data[space_i], space_i, in, np);
+            else
+            {
+              if (!basis_ready[space_i])
+              {
+                this->init_basis(td, &space_data[space_i], space_i, state_data->order, np);
+                basis_ready[space_i] = true;
+              }
+              this->gather(td, &space_data[space_i], space_i, in, np);
+            }
+            gathered_ready[space_i] = true;
+          }
+
+          if (!tra && kernel_ready[i] == 1 && this->apply_form_sum_factorization(td, form, state_data, u_ext))
+            continue;
+
+          for (unsigned char side = 0; side < (tra ? 2 : 1); side++)
+          {
+            unsigned int space_i = side ? j : i;
+            if (!basis_ready[space_i])
+            {
+              this->init_basis(td, &space_data[space_i], space_i, state_data->order, np);
+              basis_ready[space_i] = true;
+            }
+          }
+
+          this->apply_form(td, form, &space_data[i], td->basis + i * this->max_basis_size, td->gathered + 2 * j, false, np, wt, &td->geometry, u_ext, 1.);
+          if (tra)
+            this->apply_form(td, form, &space_data[j], td->basis + j * this->max_basis_size, td->gathered + 2 * i, true, np, wt, &td->geometry, u_ext, form->sym < 0 ? -1. : 1.);
+        }
+
+        // Surface forms - as DiscreteProblem, with the boundary assembly lists, and with the factor 0.5.
+        for (unsigned char edge_i = 0; edge_i < state_data->num_edges; edge_i++)
+        {
+          EdgeData* edge = &td->edges[state_data->first_edge + edge_i];
+          unsigned char np_surf = edge->np;
+          state->isurf = edge->isurf;
+          td->wf->set_active_edge_state(state->e, edge->isurf);
+
+          double* wt_surf = &td->reals[edge->geometry];
+          GeomSurf<double>& g = td->geometry_surf;
+          memcpy(g.x, wt_surf + np_surf, np_surf * sizeof(double));
+          memcpy(g.y, wt_surf + 2 * np_surf, np_surf * sizeof(double));
+          memcpy(g.nx, wt_surf + 3 * np_surf, np_surf * sizeof(double));
+          memcpy(g.ny, wt_surf + 4 * np_surf, np_surf * sizeof(double));
+          memcpy(g.tx, wt_surf + 5 * np_surf, np_surf * sizeof(double));
+          memcpy(g.ty, wt_surf + 6 * np_surf, np_surf * sizeof(double));
+          g.isurf = edge->isurf;
+          g.edge_marker = edge->edge_marker;
+          g.elem_marker = state_data->elem_marker;
+          g.orientation = edge->orientation;
+
+          SpaceData* edge_space_data = &td->space_data[edge->space_data];
+          for (unsigned short space_i = 0; space_i < this->spaces_size; space_i++)
+            basis_ready[space_i] = gathered_ready[space_i] = false;
+
+          for (unsigned short form_i = 0; form_i < td->wf->mfsurf.size(); form_i++)
+          {
+            MatrixFormSurf<Scalar>* form = td->wf->mfsurf[form_i];
+            if (!this->selectiveAssembler.form_to_be_assembled(form, state))
+              continue;
+
+            unsigned int i = form->i, j = form->j;
+            bool tra = (i != j) && (form->sym != 0);
+            if (diagonal && i != j)
+              continue;
+
+            for (unsigned char side = 0; side < 2; side++)
+            {
+              unsigned int space_i = side ? j : i;
+              if (!basis_ready[space_i])
+              {
+                this->init_basis(td, &edge_space_data[space_i], space_i, edge->order, np_surf);
+                basis_ready[space_i] = true;
+              }
+            }
+
+            if (diagonal)
+            {
+              this->add_diagonal(td, form, &edge_space_data[i], td->basis + i * this->max_basis_size, np_surf, wt_surf, &g, u_ext, 0.5);
+              continue;
+            }
+
+            for (unsigned char side = 0; side < (tra ? 2 : 1); side++)
+            {
+              unsigned int space_i = side ? i : j;
+              if (!gathered_ready[space_i])
+              {
+                this->gather(td, &edge_space_data[space_i], space_i, in, np_surf);
+                gathered_ready[space_i] = true;
+              }
+            }
+
+            this->apply_form(td, form, &edge_space_data[i], td->basis + i * this->max_basis_size, td->gathered + 2 * j, false, np_surf, wt_surf, &g, u_ext, 0.5);
+            if (tra)
+              this->apply_form(td, form, &edge_space_data[j], td->basis + j * this->max_basis_size, td->gathered + 2 * i, true, np_surf, wt_surf, &g, u_ext, form->sym < 0 ? -0.5 : 0.5);
+          }
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::run(const Scalar* in, Scalar* out)
+    {
+      if (!this->prepared || this->spaces_changed())
+        this->prepare();
+
+      this->exceptionMessageCaughtInParallelBlock.clear();
+#pragma omp parallel num_threads(this->num_threads_used)
+      {
+        int thread_number = omp_get_thread_num();
+        try
+        {
+          this->apply_states(thread_number, in);
+        }
+        catch (Hermes::Exceptions::Exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.info();
+        }
+        catch (std::exception& e)
+        {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+          this->exceptionMessageCaughtInParallelBlock = e.what();
+        }
+
+#pragma omp barrier
+
+        // Sum of the private vectors, the unknowns split among the threads.
+        int start = (this->size / this->num_threads_used) * thread_number;
+        int end = (this->size / this->num_threads_used) * (thread_number + 1);
+        if (thread_number == this->num_threads_used - 1)
+          end = this->size;
+        for (int k = start; k < end; k++)
+        {
+          Scalar sum = 0.;
+          for (int thread_i = 0; thread_i < this->num_threads_used; thread_i++)
+            sum += this->thread_data[thread_i]->out[k];
+          out[k] = sum;
+        }
+      }
+
+      if (!this->exceptionMessageCaughtInParallelBlock.empty())
+        throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::apply(const Scalar* in, Scalar* out)
+    {
+      if (!in)
+        throw Exceptions::NullException(1);
+      this->run(in, out);
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::get_diagonal(Scalar* diagonal)
+    {
+      this->run(nullptr, diagonal);
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized) const
+    {
+      MatrixFreeOperator<Scalar>* op = const_cast<MatrixFreeOperator<Scalar>*>(this);
+      if (!op->prepared || op->spaces_changed())
+        op->prepare();
+      if (!vector_out_initialized)
+        vector_out = malloc_with_check<Scalar>(this->size);
+      op->apply(vector_in, vector_out);
+    }
+
+    template<typename Scalar>
+    Scalar MatrixFreeOperator<Scalar>::get(unsigned int m, unsigned int n) const
+    {
+      throw Exceptions::MethodNotOverridenException("MatrixFreeOperator<Scalar>::get");
+      return 0.;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::zero()
+    {
+      throw Exceptions::MethodNotOverridenException("MatrixFreeOperator<Scalar>::zero");
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::add(unsigned int m, unsigned int n, Scalar v)
+    {
+      throw Exceptions::MethodNotOverridenException("MatrixFreeOperator<Scalar>::add");
+    }
+
+    template<typename Scalar>
+    void MatrixFreeOperator<Scalar>::export_to_file(const char *filename, const char *var_name, MatrixExportFormat fmt, char* number_format)
+    {
+      throw Exceptions::MethodNotOverridenException("MatrixFreeOperator<Scalar>::export_to_file");
+    }
+
+    template class HERMES_API MatrixFreeOperator < double > ;
+    template class HERMES_API MatrixFreeOperator < std::complex<double> > ;
+  }
+}
@@ -87,6 +87,24 @@ namespace Hermes
       return 1;
     }
 
+    template<typename Scalar>
+    void ExactSolutionScalar<Scalar>::exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const
+    {
+      if (dx)
+      {
+        for (int i = 0; i < n; i++)
+        {
+          dx[i] = dy[i] = 0.0;
+          v[i] = this->exact_function(x[i], y[i], dx[i], dy[i]);
+        }
+      }
+      else
+      {
+        for (int i = 0; i < n; i++)
+          v[i] = this->value(x[i], y[i]);
+      }
+    }
+
     template<typename Scalar, typename ValueType>
     ExactSolutionConstantArray<Scalar, ValueType>::ExactSolutionConstantArray(MeshSharedPtr mesh, ValueType* valueArray, bool deleteArray) : ExactSolutionScalar<Scalar>(mesh), valueArray(valueArray), deleteArray(deleteArray)
     {
@@ -128,6 +146,19 @@ namespace Hermes
       dy = 0;
     };
 
+    template<typename Scalar, typename ValueType>
+    void ExactSolutionConstantArray<Scalar, ValueType>::exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const
+    {
+      Scalar value = this->valueArray[this->element->id];
+      for (int i = 0; i < n; i++)
+        v[i] = value;
+      if (dx)
+      {
+        memset(dx, 0, n * sizeof(Scalar));
+        memset(dy, 0, n * sizeof(Scalar));
+      }
+    }
+
     template<typename Scalar>
     ExactSolutionVector<Scalar>::ExactSolutionVector(MeshSharedPtr mesh) : ExactSolution<Scalar>(mesh)
     {
@@ -305,6 +336,18 @@ namespace Hermes
       dy = 0;
     };
 
+    template<typename Scalar>
+    void ConstantSolution<Scalar>::exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const
+    {
+      for (int i = 0; i < n; i++)
+        v[i] = constant;
+      if (dx)
+      {
+        memset(dx, 0, n * sizeof(Scalar));
+        memset(dy, 0, n * sizeof(Scalar));
+      }
+    }
+
     template<typename Scalar>
     Ord ConstantSolution<Scalar>::ord(double x, double y) const {
       return Ord(0);
@@ -335,6 +378,17 @@ namespace Hermes
       dy = 0;
     };
 
+    template<typename Scalar>
+    void ZeroSolution<Scalar>::exact_values(int n, const double* x, const double* y, Scalar* v, Scalar* dx, Scalar* dy) const
+    {
+      memset(v, 0, n * sizeof(Scalar));
+      if (dx)
+      {
+        memset(dx, 0, n * sizeof(Scalar));
+        memset(dy, 0, n * sizeof(Scalar));
+      }
+    }
+
     template<typename Scalar>
     Ord ZeroSolution<Scalar>::ord(double x, double y) const {
       return Ord(0);
@@ -1025,6 +1025,506 @@ namespace Hermes
       }
     }
 
+    template<typename Scalar>
+    FilterExpression<Scalar>::FilterExpression(MeshFunctionSharedPtr<Scalar> function, int item) : node(new Node)
+    {
+      if (!function)
+        throw Hermes::Exceptions::Exception("nullptr function in FilterExpression.");
+      if (item <= 0 || (item & (item - 1)))
+        throw Hermes::Exceptions::Exception("FilterExpression: the item has to be a single item (H2D_FN_VAL_0, H2D_FN_DX_0, ...).");
+      this->node->operation = Function;
+      this->node->function = function;
+      this->node->item = item;
+      this->node->constant = 0.;
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar>::FilterExpression(Scalar constant) : node(new Node)
+    {
+      this->node->operation = Constant;
+      this->node->item = 0;
+      this->node->constant = constant;
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar>::FilterExpression(Operation operation, const FilterExpression* first, const FilterExpression* second) : node(new Node)
+    {
+      this->node->operation = operation;
+      this->node->item = 0;
+      this->node->constant = 0.;
+      this->node->first = first->node;
+      if (second)
+        this->node->second = second->node;
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::operator+(const FilterExpression& other) const
+    {
+      return FilterExpression(Sum, this, &other);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::operator-(const FilterExpression& other) const
+    {
+      return FilterExpression(Difference, this, &other);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::operator*(const FilterExpression& other) const
+    {
+      return FilterExpression(Product, this, &other);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::operator/(const FilterExpression& other) const
+    {
+      return FilterExpression(Quotient, this, &other);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::operator-() const
+    {
+      return FilterExpression(Negative, this, nullptr);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::square(const FilterExpression& expression)
+    {
+      return FilterExpression(Square, &expression, nullptr);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::sqrt(const FilterExpression& expression)
+    {
+      return FilterExpression(SquareRoot, &expression, nullptr);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::abs(const FilterExpression& expression)
+    {
+      return FilterExpression(AbsoluteValue, &expression, nullptr);
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> FilterExpression<Scalar>::magnitude(const FilterExpression& first, const FilterExpression& second)
+    {
+      return sqrt(square(first) + square(second));
+    }
+
+    template<typename Scalar>
+    std::vector<MeshFunctionSharedPtr<Scalar> > FilterExpression<Scalar>::get_functions() const
+    {
+      std::vector<MeshFunctionSharedPtr<Scalar> > functions;
+      this->get_functions(this->node.get(), functions);
+      if (functions.empty())
+        throw Hermes::Exceptions::Exception("FilterExpression without any function.");
+      return functions;
+    }
+
+    template<typename Scalar>
+    void FilterExpression<Scalar>::get_functions(Node* node, std::vector<MeshFunctionSharedPtr<Scalar> >& functions) const
+    {
+      if (node->operation == Function)
+      {
+        for (int i = 0; i < functions.size(); i++)
+        {
+          if (functions[i].get() == node->function.get())
+            return;
+        }
+        functions.push_back(node->function);
+      }
+      if (node->first)
+        get_functions(node->first.get(), functions);
+      if (node->second)
+        get_functions(node->second.get(), functions);
+    }
+
+    /// Number of points processed by one pass of the program of ExpressionFilter.
+    static const int expression_filter_batch_size = 32;
+
+    static double expression_filter_abs_derivative(double value, double derivative)
+    {
+      return value > 0. ? derivative : (value < 0. ? -derivative : 0.);
+    }
+
+    static std::complex<double> expression_filter_abs_derivative(std::complex<double> value, std::complex<double> derivative)
+    {
+      double abs_value = std::abs(value);
+      return abs_value > 0. ? std::real(std::conj(value) * derivative) / abs_value : 0.;
+    }
+
+    template<typename Scalar>
+    ExpressionFilter<Scalar>::ExpressionFilter(const FilterExpression<Scalar>& expression) : Filter<Scalar>(expression.get_functions()), expression(expression)
+    {
+      this->num_registers = 0;
+      this->derivative_leaves = false;
+      for (int i = 0; i < this->solutions.size(); i++)
+      {
+        this->function_masks.push_back(0);
+        this->function_masks_derivatives.push_back(0);
+      }
+
+      // Leaves first - the registers are numbered after them.
+      this->add_leaves(expression.node.get());
+
+      std::map<Node*, int> compiled_nodes;
+      std::map<std::pair<int, std::pair<int, int> >, int> compiled_operations;
+      this->result_slot = this->compile(expression.node.get(), compiled_nodes, compiled_operations);
+
+      this->init_registers();
+    }
+
+    template<typename Scalar>
+    ExpressionFilter<Scalar>::~ExpressionFilter()
+    {
+    }
+
+    template<typename Scalar>
+    int ExpressionFilter<Scalar>::find_leaf(Node* node) const
+    {
+      for (int i = 0; i < this->leaves.size(); i++)
+      {
+        if (this->solutions[this->leaves[i].function].get() == node->function.get() && this->leaves[i].item == node->item)
+          return i;
+      }
+      return -1;
+    }
+
+    template<typename Scalar>
+    void ExpressionFilter<Scalar>::add_leaves(Node* node)
+    {
+      if (node->operation == FilterExpression<Scalar>::Function && this->find_leaf(node) == -1)
+      {
+        Leaf leaf;
+        leaf.function = 0;
+        while (this->solutions[leaf.function].get() != node->function.get())
+          leaf.function++;
+        leaf.item = node->item;
+        leaf.component = 0;
+        leaf.value_index = 0;
+        int mask = node->item;
+        if (mask >= 0x40)
+        {
+          leaf.component = 1;
+          mask >>= 6;
+        }
+        while (!(mask & 1))
+        {
+          mask >>= 1;
+          leaf.value_index++;
+        }
+        if (leaf.component >= this->solutions[leaf.function]->get_num_components())
+          throw Hermes::Exceptions::Exception("ExpressionFilter: item of the second component of a scalar function.");
+
+        this->function_masks[leaf.function] |= node->item;
+        if (leaf.value_index == 0)
+          this->function_masks_derivatives[leaf.function] |= node->item | (node->item << 1) | (node->item << 2);
+        else
+        {
+          this->function_masks_derivatives[leaf.function] |= node->item;
+          this->derivative_leaves = true;
+        }
+
+        this->leaves.push_back(leaf);
+      }
+      if (node->first)
+        this->add_leaves(node->first.get());
+      if (node->second)
+        this->add_leaves(node->second.get());
+    }
+
+    template<typename Scalar>
+    int ExpressionFilter<Scalar>::compile(Node* node, std::map<Node*, int>& compiled_nodes, std::map<std::pair<int, std::pair<int, int> >, int>& compiled_operations)
+    {
+      // Shared subtree.
+      typename std::map<Node*, int>::iterator it = compiled_nodes.find(node);
+      if (it != compiled_nodes.end())
+        return it->second;
+
+      int slot;
+      if (node->operation == FilterExpression<Scalar>::Function)
+        slot = this->find_leaf(node);
+      else if (node->operation == FilterExpression<Scalar>::Constant)
+      {
+        slot = this->leaves.size() + this->num_registers++;
+        this->constants.push_back(std::pair<int, Scalar>(slot, node->constant));
+      }
+      else
+      {
+        int first = this->compile(node->first.get(), compiled_nodes, compiled_operations);
+        int second = node->second ? this->compile(node->second.get(), compiled_nodes, compiled_operations) : -1;
+        if ((node->operation == FilterExpression<Scalar>::Sum || node->operation == FilterExpression<Scalar>::Product) && second < first)
+          std::swap(first, second);
+
+        // Identical subexpression.
+        std::pair<int, std::pair<int, int> > key(node->operation, std::pair<int, int>(first, second));
+        typename std::map<std::pair<int, std::pair<int, int> >, int>::iterator it_operation = compiled_operations.find(key);
+        if (it_operation != compiled_operations.end())
+          slot = it_operation->second;
+        else
+        {
+          slot = this->leaves.size() + this->num_registers++;
+          Instruction instruction;
+          instruction.operation = node->operation;
+          instruction.result = slot;
+          instruction.first = first;
+          instruction.second = second;
+          this->program.push_back(instruction);
+          compiled_operations[key] = slot;
+        }
+      }
+
+      compiled_nodes[node] = slot;
+      return slot;
+    }
+
+    template<typename Scalar>
+    void ExpressionFilter<Scalar>::init_registers()
+    {
+      this->registers.assign(3 * std::max(this->num_registers, 1) * expression_filter_batch_size, Scalar(0.));
+      for (int i = 0; i < this->constants.size(); i++)
+      {
+        Scalar* constant_register = &this->registers[(this->constants[i].first - this->leaves.size()) * expression_filter_batch_size];
+        for (int j = 0; j < expression_filter_batch_size; j++)
+          constant_register[j] = this->constants[i].second;
+      }
+    }
+
+    template<typename Scalar>
+    int ExpressionFilter<Scalar>::get_num_operations() const
+    {
+      return this->program.size();
+    }
+
+    template<typename Scalar>
+    int ExpressionFilter<Scalar>::get_num_leaves() const
+    {
+      return this->leaves.size();
+    }
+
+    template<typename Scalar>
+    void ExpressionFilter<Scalar>::evaluate(int n, const Scalar* const* leaf_tables, bool derivatives, Scalar* result[3])
+    {
+      int num_leaves = this->leaves.size();
+      int num_planes = derivatives ? 3 : 1;
+      Scalar* registers = &this->registers[0];
+
+      for (int start = 0; start < n; start += expression_filter_batch_size)
+      {
+        int count = std::min(expression_filter_batch_size, n - start);
+
+        for (int instruction_i = 0; instruction_i < this->program.size(); instruction_i++)
+        {
+          const Instruction& instruction = this->program[instruction_i];
+          const Scalar* first[3] = { nullptr, nullptr, nullptr };
+          const Scalar* second[3] = { nullptr, nullptr, nullptr };
+          Scalar* r[3];
+          for (int plane = 0; plane < num_planes; plane++)
+          {
+            first[plane] = instruction.first < num_leaves ? leaf_tables[3 * instruction.first + plane] + start
+              : registers + (plane * this->num_registers + instruction.first - num_leaves) * expression_filter_batch_size;
+            if (instruction.second >= 0)
+              second[plane] = instruction.second < num_leaves ? leaf_tables[3 * instruction.second + plane] + start
+              : registers + (plane * this->num_registers + instruction.second - num_leaves) * expression_filter_batch_size;
+            r[plane] = registers + (plane * this->num_registers + instruction.result - num_leaves) * expression_filter_batch_size;
+          }
+
+          switch (instruction.operation)
+          {
+          case FilterExpression<Scalar>::Sum:
+            for (int plane = 0; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = first[plane][i] + second[plane][i];
+            break;
+          case FilterExpression<Scalar>::Difference:
+            for (int plane = 0; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = first[plane][i] - second[plane][i];
+            break;
+          case FilterExpression<Scalar>::Product:
+            for (int plane = 1; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = first[plane][i] * second[0][i] + first[0][i] * second[plane][i];
+            for (int i = 0; i < count; i++)
+              r[0][i] = first[0][i] * second[0][i];
+            break;
+          case FilterExpression<Scalar>::Quotient:
+            for (int i = 0; i < count; i++)
+              r[0][i] = first[0][i] / second[0][i];
+            for (int plane = 1; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = (first[plane][i] - r[0][i] * second[plane][i]) / second[0][i];
+            break;
+          case FilterExpression<Scalar>::Negative:
+            for (int plane = 0; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = -first[plane][i];
+            break;
+          case FilterExpression<Scalar>::Square:
+            for (int plane = 1; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = Scalar(2.) * first[0][i] * first[plane][i];
+            for (int i = 0; i < count; i++)
+              r[0][i] = first[0][i] * first[0][i];
+            break;
+          case FilterExpression<Scalar>::SquareRoot:
+            for (int i = 0; i < count; i++)
+              r[0][i] = std::sqrt(first[0][i]);
+            for (int plane = 1; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = first[plane][i] / (Scalar(2.) * r[0][i]);
+            break;
+          case FilterExpression<Scalar>::AbsoluteValue:
+            for (int plane = 1; plane < num_planes; plane++)
+              for (int i = 0; i < count; i++)
+                r[plane][i] = expression_filter_abs_derivative(first[0][i], first[plane][i]);
+            for (int i = 0; i < count; i++)
+              r[0][i] = std::abs(first[0][i]);
+            break;
+          default:
+            break;
+          }
+        }
+
+        for (int plane = 0; plane < num_planes; plane++)
+        {
+          const Scalar* result_values = this->result_slot < num_leaves ? leaf_tables[3 * this->result_slot + plane] + start
+            : registers + (plane * this->num_registers + this->result_slot - num_leaves) * expression_filter_batch_size;
+          memcpy(result[plane] + start, result_values, count * sizeof(Scalar));
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void ExpressionFilter<Scalar>::precalculate(unsigned short order, unsigned short mask)
+    {
+#ifdef H2D_USE_SECOND_DERIVATIVES
+      if (mask & (H2D_FN_DXX | H2D_FN_DYY | H2D_FN_DXY))
+        throw Hermes::Exceptions::Exception("ExpressionFilter not defined for second derivatives.");
+#endif
+
+      Quad2D* quad = this->quads[this->cur_quad];
+      unsigned char np = quad->get_num_points(order, this->element->get_mode());
+
+      // Derivatives of derivatives are not available - zero.
+      bool derivatives = (mask & (H2D_FN_DX | H2D_FN_DY)) && !this->derivative_leaves;
+
+      // precalculate all functions - once, with all the items needed
+      for (int i = 0; i < this->solutions.size(); i++)
+        this->solutions[i]->set_quad_order(order, derivatives ? this->function_masks_derivatives[i] : this->function_masks[i]);
+
+      std::vector<const Scalar*> leaf_tables(3 * this->leaves.size(), nullptr);
+      for (int i = 0; i < this->leaves.size(); i++)
+      {
+        const Leaf& leaf = this->leaves[i];
+        leaf_tables[3 * i] = this->solutions[leaf.function]->get_values(leaf.component, leaf.value_index);
+        if (derivatives)
+        {
+          leaf_tables[3 * i + 1] = this->solutions[leaf.function]->get_values(leaf.component, 1);
+          leaf_tables[3 * i + 2] = this->solutions[leaf.function]->get_values(leaf.component, 2);
+        }
+      }
+
+      Scalar* result[3] = { this->values[0][0], this->values[0][1], this->values[0][2] };
+      this->evaluate(np, &leaf_tables[0], derivatives, result);
+      if ((mask & (H2D_FN_DX | H2D_FN_DY)) && !derivatives)
+      {
+        memset(this->values[0][1], 0, np * sizeof(Scalar));
+        memset(this->values[0][2], 0, np * sizeof(Scalar));
+      }
+      this->values_valid = true;
+    }
+
+    template<typename Scalar>
+    Func<Scalar>* ExpressionFilter<Scalar>::get_pt_value(double x, double y, bool use_MeshHashGrid, Element* e)
+    {
+      std::vector<Scalar> leaf_values(3 * this->leaves.size(), Scalar(0.));
+      for (int i = 0; i < this->solutions.size(); i++)
+      {
+        Func<Scalar>* value = this->solutions[i]->get_pt_value(x, y, use_MeshHashGrid, e);
+        if (value == nullptr)
+          throw Hermes::Exceptions::Exception("ExpressionFilter: point value of a function not available.");
+        for (int j = 0; j < this->leaves.size(); j++)
+        {
+          const Leaf& leaf = this->leaves[j];
+          if (leaf.function != i)
+            continue;
+
+          // Vector-valued functions - values of both components only.
+          if (value->nc > 1)
+          {
+            if (leaf.value_index > 0)
+            {
+              delete value;
+              throw Hermes::Exceptions::Exception("ExpressionFilter: point values of derivatives of vector-valued functions not available.");
+            }
+            leaf_values[3 * j] = leaf.component == 0 ? value->val0[0] : value->val1[0];
+          }
+          else
+          {
+            leaf_values[3 * j] = leaf.value_index == 0 ? value->val[0] : (leaf.value_index == 1 ? value->dx[0] : value->dy[0]);
+            leaf_values[3 * j + 1] = value->dx[0];
+            leaf_values[3 * j + 2] = value->dy[0];
+          }
+        }
+        delete value;
+      }
+
+      std::vector<const Scalar*> leaf_tables(3 * this->leaves.size());
+      for (int i = 0; i < 3 * this->leaves.size(); i++)
+        leaf_tables[i] = &leaf_values[i];
+
+      bool derivatives = !this->derivative_leaves;
+      for (int i = 0; i < this->solutions.size(); i++)
+      {
+        if (this->solutions[i]->get_num_components() > 1)
+          derivatives = false;
+      }
+
+      Func<Scalar>* toReturn = new Func<Scalar>(1, 1);
+      toReturn->dx[0] = toReturn->dy[0] = 0.;
+      Scalar* result[3] = { toReturn->val, toReturn->dx, toReturn->dy };
+      this->evaluate(1, &leaf_tables[0], derivatives, result);
+      return toReturn;
+    }
+
+    template<typename Scalar>
+    FilterExpression<Scalar> ExpressionFilter<Scalar>::clone_expression(Node* node, const std::vector<MeshFunctionSharedPtr<Scalar> >& cloned_functions, std::map<Node*, FilterExpression<Scalar> >& cloned_nodes) const
+    {
+      typename std::map<Node*, FilterExpression<Scalar> >::iterator it = cloned_nodes.find(node);
+      if (it != cloned_nodes.end())
+        return it->second;
+
+      FilterExpression<Scalar> cloned(node->constant);
+      if (node->operation == FilterExpression<Scalar>::Function)
+        cloned = FilterExpression<Scalar>(cloned_functions[this->leaves[this->find_leaf(node)].function], node->item);
+      else if (node->operation != FilterExpression<Scalar>::Constant)
+      {
+        FilterExpression<Scalar> first = this->clone_expression(node->first.get(), cloned_functions, cloned_nodes);
+        if (node->second)
+        {
+          FilterExpression<Scalar> second = this->clone_expression(node->second.get(), cloned_functions, cloned_nodes);
+          cloned = FilterExpression<Scalar>(node->operation, &first, &second);
+        }
+        else
+          cloned = FilterExpression<Scalar>(node->operation, &first, nullptr);
+      }
+      cloned_nodes.insert(std::pair<Node*, FilterExpression<Scalar> >(node, cloned));
+      return cloned;
+    }
+
+    template<typename Scalar>
+    MeshFunction<Scalar>* ExpressionFilter<Scalar>::clone() const
+    {
+      // Rebuild the expression over the clones of the functions.
+      std::vector<MeshFunctionSharedPtr<Scalar> > cloned_functions;
+      for (int i = 0; i < this->solutions.size(); i++)
+        cloned_functions.push_back(this->solutions[i]->clone());
+
+      std::map<Node*, FilterExpression<Scalar> > cloned_nodes;
+      return new ExpressionFilter<Scalar>(this->clone_expression(this->expression.node.get(), cloned_functions, cloned_nodes));
+    }
+
     template class HERMES_API Filter < double > ;
     template class HERMES_API Filter < std::complex<double> > ;
     template class HERMES_API SimpleFilter < double > ;
@@ -1039,5 +1539,9 @@ namespace Hermes
     template class HERMES_API SumFilter < std::complex<double> > ;
     template class HERMES_API SquareFilter < double > ;
     template class HERMES_API SquareFilter < std::complex<double> > ;
+    template class HERMES_API FilterExpression < double > ;
+    template class HERMES_API FilterExpression < std::complex<double> > ;
+    template class HERMES_API ExpressionFilter < double > ;
+    template class HERMES_API ExpressionFilter < std::complex<double> > ;
   }
 }
\ No newline at end of file
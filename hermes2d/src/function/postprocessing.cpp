@@ -595,132 +595,194 @@ namespace Hermes
         return this->calculate(markers);
       }
 
-      template<>
-      void IntegralCalculator<double>::add_results(double* results_local, double* results)
+      /// Compensated (Neumaier) summation - sum + compensation is the accurate sum.
+      static void integral_add_compensated(double& sum, double& compensation, double value)
       {
-        for (int i = 0; i < this->number_of_integrals; i++)
-        {
-#pragma omp atomic
-          results[i] += results_local[i];
-        }
+        double new_sum = sum + value;
+        if (fabs(sum) >= fabs(value))
+          compensation += (sum - new_sum) + value;
+        else
+          compensation += (value - new_sum) + sum;
+        sum = new_sum;
       }
 
-      template<>
-      void IntegralCalculator<std::complex<double> >::add_results(std::complex<double> * results_local, std::complex<double> * results)
+      static void integral_add_compensated(std::complex<double>& sum, std::complex<double>& compensation, std::complex<double> value)
       {
-        for (int i = 0; i < this->number_of_integrals; i++)
-        {
-#pragma omp critical (integralAddition)
-          results[i] += results_local[i];
-        }
+        double sum_real = sum.real(), sum_imag = sum.imag(), compensation_real = compensation.real(), compensation_imag = compensation.imag();
+        integral_add_compensated(sum_real, compensation_real, value.real());
+        integral_add_compensated(sum_imag, compensation_imag, value.imag());
+        sum = std::complex<double>(sum_real, sum_imag);
+        compensation = std::complex<double>(compensation_real, compensation_imag);
       }
 
+      /// Deterministic reduction - the partial sums (and their compensations) of the threads are summed in the order of the threads.
+      /// \param[in] stride Distance of the sums of consecutive threads.
       template<typename Scalar>
-      VolumetricIntegralCalculator<Scalar>::VolumetricIntegralCalculator(MeshFunctionSharedPtr<Scalar> source_function, int number_of_integrals) : IntegralCalculator<Scalar>(source_function, number_of_integrals)
-      {
-      }
-
-      template<typename Scalar>
-      VolumetricIntegralCalculator<Scalar>::VolumetricIntegralCalculator(std::vector<MeshFunctionSharedPtr<Scalar> > source_functions, int number_of_integrals) : IntegralCalculator<Scalar>(source_functions, number_of_integrals)
+      static void integral_reduce(int num_threads, int number_of_integrals, int stride, const Scalar* thread_sums, const Scalar* thread_compensations, Scalar* results)
       {
+        for (int i = 0; i < number_of_integrals; i++)
+        {
+          Scalar sum = 0., compensation = 0.;
+          for (int thread_i = 0; thread_i < num_threads; thread_i++)
+          {
+            integral_add_compensated(sum, compensation, thread_sums[thread_i * stride + i]);
+            integral_add_compensated(sum, compensation, thread_compensations[thread_i * stride + i]);
+          }
+          results[i] = sum + compensation;
+        }
       }
 
       template<typename Scalar>
-      Scalar* VolumetricIntegralCalculator<Scalar>::calculate(std::vector<std::string> markers)
+      bool IntegralCalculator<Scalar>::get_internal_markers(std::vector<std::string> markers, bool boundary, std::vector<int>& internal_markers) const
       {
 #ifdef _DEBUG
         this->info("User markers");
         for (unsigned short i = 0; i < markers.size(); i++)
           this->info("\t%s", markers[i].c_str());
 #endif
-        // This serves for assembling over the whole domain in the case a passed marker is HERMES_ANY.
-        bool assemble_everywhere = false;
-
-        std::vector<int> internal_markers;
         for (unsigned short i = 0; i < markers.size(); i++)
         {
+          // This serves for assembling over the whole domain in the case a passed marker is HERMES_ANY.
           if (markers[i] == HERMES_ANY)
-          {
-            assemble_everywhere = true;
-            break;
-          }
+            return true;
           else
           {
-            Hermes::Hermes2D::Mesh::MarkersConversion::IntValid internalMarker = this->source_functions[0]->get_mesh()->get_element_markers_conversion().get_internal_marker(markers[i]);
+            MeshSharedPtr mesh = this->source_functions[0]->get_mesh();
+            Hermes::Hermes2D::Mesh::MarkersConversion::IntValid internalMarker = boundary ? mesh->get_boundary_markers_conversion().get_internal_marker(markers[i]) : mesh->get_element_markers_conversion().get_internal_marker(markers[i]);
             if (internalMarker.valid)
               internal_markers.push_back(internalMarker.marker);
           }
         }
 
-        Scalar* result = (Scalar*)calloc(this->number_of_integrals, sizeof(Scalar));
-
-        if (!assemble_everywhere && internal_markers.size() == 0)
-          return result;
-
 #ifdef _DEBUG
         this->info("Internal markers");
         for (unsigned short i = 0; i < internal_markers.size(); i++)
           this->info("\t%i", internal_markers[i]);
 #endif
+        return false;
+      }
 
-        int source_functions_size = this->source_functions.size();
+      template<typename Scalar>
+      VolumetricIntegralCalculator<Scalar>::VolumetricIntegralCalculator(MeshFunctionSharedPtr<Scalar> source_function, int number_of_integrals) : IntegralCalculator<Scalar>(source_function, number_of_integrals)
+      {
+      }
+
+      template<typename Scalar>
+      VolumetricIntegralCalculator<Scalar>::VolumetricIntegralCalculator(std::vector<MeshFunctionSharedPtr<Scalar> > source_functions, int number_of_integrals) : IntegralCalculator<Scalar>(source_functions, number_of_integrals)
+      {
+      }
+
+      template<typename Scalar>
+      Scalar* VolumetricIntegralCalculator<Scalar>::calculate(std::vector<std::string> markers)
+      {
+        std::vector<VolumetricIntegralCalculator<Scalar>*> calculators;
+        calculators.push_back(this);
+        return calculate_batch(calculators, markers)[0];
+      }
+
+      template<typename Scalar>
+      std::vector<Scalar*> VolumetricIntegralCalculator<Scalar>::calculate_batch(std::vector<VolumetricIntegralCalculator<Scalar>*> calculators, std::vector<std::string> markers)
+      {
+        int calculators_count = calculators.size();
+        std::vector<Scalar*> results;
+        if (calculators_count == 0)
+          return results;
+
+        // Markers, functions of all calculators (each distinct function once), positions of the results.
+        std::vector<bool> assemble_everywhere(calculators_count);
+        std::vector<std::vector<int> > internal_markers(calculators_count);
+        std::vector<MeshFunctionSharedPtr<Scalar> > source_functions;
+        std::vector<std::vector<int> > function_indices(calculators_count);
+        std::vector<int> result_offsets(calculators_count + 1, 0);
+        bool any_calculator = false;
+        for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
+        {
+          VolumetricIntegralCalculator<Scalar>* calculator = calculators[calculator_i];
+          results.push_back((Scalar*)calloc(calculator->number_of_integrals, sizeof(Scalar)));
+          result_offsets[calculator_i + 1] = result_offsets[calculator_i] + calculator->number_of_integrals;
+
+          assemble_everywhere[calculator_i] = calculator->get_internal_markers(markers, false, internal_markers[calculator_i]);
+          if (assemble_everywhere[calculator_i] || internal_markers[calculator_i].size() > 0)
+            any_calculator = true;
+
+          for (int i = 0; i < calculator->source_functions.size(); i++)
+          {
+            int function_i = 0;
+            while (function_i < source_functions.size() && source_functions[function_i].get() != calculator->source_functions[i].get())
+              function_i++;
+            if (function_i == source_functions.size())
+              source_functions.push_back(calculator->source_functions[i]);
+            function_indices[calculator_i].push_back(function_i);
+          }
+        }
+
+        if (!any_calculator)
+          return results;
+
+        int source_functions_size = source_functions.size();
+        int num_threads = calculators[0]->num_threads_used;
+        int results_size = result_offsets[calculators_count];
 
         Traverse trav(source_functions_size);
         unsigned int num_states;
-        Traverse::State** states = trav.get_states(this->source_functions, num_states);
+        Traverse::State** states = trav.get_states(source_functions, num_states);
 
         for (int i = 0; i < source_functions_size; i++)
-          this->source_functions[i]->set_quad_2d(&g_quad_2d_std);
+          source_functions[i]->set_quad_2d(&g_quad_2d_std);
+
+        // Partial sums of the threads, reduced in a fixed order afterwards - the results do not depend on the scheduling.
+        Scalar* thread_sums = calloc_with_check<Scalar>(num_threads * results_size);
+        Scalar* thread_compensations = calloc_with_check<Scalar>(num_threads * results_size);
 
-#pragma omp parallel num_threads(this->num_threads_used)
+#pragma omp parallel num_threads(num_threads)
         {
           RefMap* refmap = new RefMap;
           refmap->set_quad_2d(&g_quad_2d_std);
 
           int thread_number = omp_get_thread_num();
-          int start = (num_states / this->num_threads_used) * thread_number;
-          int end = (num_states / this->num_threads_used) * (thread_number + 1);
-          if (thread_number == this->num_threads_used - 1)
+          int start = (num_states / num_threads) * thread_number;
+          int end = (num_states / num_threads) * (thread_number + 1);
+          if (thread_number == num_threads - 1)
             end = num_states;
 
 #ifdef _DEBUG
-          this->info("Thread %i, states %i - %i", thread_number, start, end);
+          calculators[0]->info("Thread %i, states %i - %i", thread_number, start, end);
 #endif
-          Hermes::Ord* orders = malloc_with_check<Hermes::Ord>(this->number_of_integrals);
+          Hermes::Ord* orders = malloc_with_check<Hermes::Ord>(std::max(results_size, 1));
           Func<Hermes::Ord>** func_ord = malloc_with_check<Func<Hermes::Ord>*>(source_functions_size);
 
           MeshFunction<Scalar>** source_functions_cloned = malloc_with_check<MeshFunction<Scalar>*>(source_functions_size);
           for (int i = 0; i < source_functions_size; i++)
-            source_functions_cloned[i] = this->source_functions[i]->clone();
+            source_functions_cloned[i] = source_functions[i]->clone();
           Func<Scalar>** func = malloc_with_check<Func<Scalar>*>(source_functions_size);
 
-          Scalar* result_thread_local = calloc_with_check<Scalar>(this->number_of_integrals);
-          Scalar* result_local = malloc_with_check<Scalar>(this->number_of_integrals);
+          Scalar* sums = thread_sums + thread_number * results_size;
+          Scalar* compensations = thread_compensations + thread_number * results_size;
+          Scalar* result_local = malloc_with_check<Scalar>(std::max(results_size, 1));
           double jacobian_x_weights[H2D_MAX_INTEGRATION_POINTS_COUNT];
+          std::vector<bool> target_calculators(calculators_count);
 
           for (int state_i = start; state_i < end; state_i++)
           {
 #ifdef _DEBUG
-            this->info("Thread %i, state %i", thread_number, state_i);
+            calculators[0]->info("Thread %i, state %i", thread_number, state_i);
 #endif
 
             Traverse::State* current_state = states[state_i];
-            if (!assemble_everywhere)
+            bool any_target_calculator = false;
+            for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
             {
-              bool target_marker = false;
-              for (unsigned short i = 0; i < internal_markers.size(); i++)
+              target_calculators[calculator_i] = assemble_everywhere[calculator_i];
+              for (unsigned short i = 0; i < internal_markers[calculator_i].size() && !target_calculators[calculator_i]; i++)
               {
-                if (current_state->rep->marker == internal_markers[i])
-                {
-                  target_marker = true;
-                  break;
-                }
+                if (current_state->rep->marker == internal_markers[calculator_i][i])
+                  target_calculators[calculator_i] = true;
               }
-              if (!target_marker)
-                continue;
+              if (target_calculators[calculator_i])
+                any_target_calculator = true;
             }
-
-            memset(result_local, 0, sizeof(Scalar)* this->number_of_integrals);
+            if (!any_target_calculator)
+              continue;
 
             // Set active element.
             for (int i = 0; i < source_functions_size; i++)
@@ -735,63 +797,70 @@ namespace Hermes
 
             refmap->set_active_element(current_state->rep);
 
-            // Integration order.
-            Hermes::Ord order = Hermes::Ord(refmap->get_inv_ref_order());
-            for (int i = 0; i < this->number_of_integrals; i++)
-              orders[i] = Hermes::Ord(0);
+            // Geometry is shared by the calculators with the same integration order.
+            GeomVol<double> geometry;
+            int geometry_order = -1;
+            unsigned char n = 0;
 
-            for (int i = 0; i < source_functions_size; i++)
+            for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
             {
-              if (current_state->e[i])
+              if (!target_calculators[calculator_i])
+                continue;
+
+              VolumetricIntegralCalculator<Scalar>* calculator = calculators[calculator_i];
+              int calculator_functions_size = function_indices[calculator_i].size();
+              memset(result_local, 0, sizeof(Scalar)* calculator->number_of_integrals);
+
+              // Integration order.
+              Hermes::Ord order = Hermes::Ord(refmap->get_inv_ref_order());
+              for (int i = 0; i < calculator->number_of_integrals; i++)
+                orders[i] = Hermes::Ord(0);
+
+              for (int i = 0; i < calculator_functions_size; i++)
               {
-                if (current_state->e[i]->used)
-                  func_ord[i] = new Func<Ord>(source_functions_cloned[i]->get_fn_order());
+                int function_i = function_indices[calculator_i][i];
+                if (current_state->e[function_i] && current_state->e[function_i]->used)
+                  func_ord[i] = new Func<Ord>(source_functions_cloned[function_i]->get_fn_order());
                 else
                   func_ord[i] = new Func<Ord>(0);
               }
-              else
-                func_ord[i] = new Func<Ord>(0);
-            }
 
-            this->order(func_ord, orders);
+              calculator->order(func_ord, orders);
 
-            for (int i = 0; i < this->number_of_integrals; i++)
-              order += orders[i];
+              for (int i = 0; i < calculator->number_of_integrals; i++)
+                order += orders[i];
 
-            int order_int = order.get_order();
-            limit_order(order_int, refmap->get_active_element()->get_mode());
+              int order_int = order.get_order();
+              limit_order(order_int, refmap->get_active_element()->get_mode());
 
-            for (int i = 0; i < source_functions_size; i++)
-            {
-              if (current_state->e[i])
+              for (int i = 0; i < calculator_functions_size; i++)
               {
-                if (current_state->e[i]->used)
-                  func[i] = init_fn(source_functions_cloned[i], order_int);
+                int function_i = function_indices[calculator_i][i];
+                if (current_state->e[function_i] && current_state->e[function_i]->used)
+                  func[i] = init_fn(source_functions_cloned[function_i], order_int);
                 else
                   func[i] = init_zero_fn<Scalar>(current_state->rep->get_mode(), order_int);
               }
-              else
-                func[i] = init_zero_fn<Scalar>(current_state->rep->get_mode(), order_int);
-            }
 
-            GeomVol<double> geometry;
-            unsigned char n = init_geometry_points_allocated(refmap, order_int, geometry, jacobian_x_weights);
+              if (order_int != geometry_order)
+              {
+                n = init_geometry_points_allocated(refmap, order_int, geometry, jacobian_x_weights);
+                geometry_order = order_int;
+              }
 
-            this->integral(n, jacobian_x_weights, func, &geometry, result_local);
+              calculator->integral(n, jacobian_x_weights, func, &geometry, result_local);
 
-            for (unsigned short i = 0; i < source_functions_size; i++)
-            {
-              delete func_ord[i];
-              delete func[i];
-            }
+              for (unsigned short i = 0; i < calculator_functions_size; i++)
+              {
+                delete func_ord[i];
+                delete func[i];
+              }
 
-            for (unsigned short i = 0; i < this->number_of_integrals; i++)
-              result_thread_local[i] += result_local[i];
+              for (unsigned short i = 0; i < calculator->number_of_integrals; i++)
+                integral_add_compensated(sums[result_offsets[calculator_i] + i], compensations[result_offsets[calculator_i] + i], result_local[i]);
+            }
           }
 
-          this->add_results(result_thread_local, result);
-          free_with_check(result_thread_local);
-
           for (unsigned short i = 0; i < source_functions_size; i++)
             delete source_functions_cloned[i];
           free_with_check(source_functions_cloned);
@@ -802,11 +871,16 @@ namespace Hermes
           delete refmap;
         }
 
+        for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
+          integral_reduce(num_threads, calculators[calculator_i]->number_of_integrals, results_size, thread_sums + result_offsets[calculator_i], thread_compensations + result_offsets[calculator_i], results[calculator_i]);
+        free_with_check(thread_sums);
+        free_with_check(thread_compensations);
+
         for (int i = 0; i < num_states; i++)
           delete states[i];
         free_with_check(states);
 
-        return result;
+        return results;
       }
 
       template<typename Scalar>
@@ -822,86 +896,103 @@ namespace Hermes
       template<typename Scalar>
       Scalar* SurfaceIntegralCalculator<Scalar>::calculate(std::vector<std::string> markers)
       {
-#ifdef _DEBUG
-        this->info("User markers");
-        for (unsigned short i = 0; i < markers.size(); i++)
-          this->info("\t%s", markers[i].c_str());
-#endif
-        // This serves for assembling over the whole domain in the case a passed marker is HERMES_ANY.
-        bool assemble_everywhere = false;
+        std::vector<SurfaceIntegralCalculator<Scalar>*> calculators;
+        calculators.push_back(this);
+        return calculate_batch(calculators, markers)[0];
+      }
 
-        std::vector<int> internal_markers;
-        for (unsigned short i = 0; i < markers.size(); i++)
+      template<typename Scalar>
+      std::vector<Scalar*> SurfaceIntegralCalculator<Scalar>::calculate_batch(std::vector<SurfaceIntegralCalculator<Scalar>*> calculators, std::vector<std::string> markers)
+      {
+        int calculators_count = calculators.size();
+        std::vector<Scalar*> results;
+        if (calculators_count == 0)
+          return results;
+
+        // Markers, functions of all calculators (each distinct function once), positions of the results.
+        std::vector<bool> assemble_everywhere(calculators_count);
+        std::vector<std::vector<int> > internal_markers(calculators_count);
+        std::vector<MeshFunctionSharedPtr<Scalar> > source_functions;
+        std::vector<std::vector<int> > function_indices(calculators_count);
+        std::vector<int> result_offsets(calculators_count + 1, 0);
+        bool any_calculator = false;
+        for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
         {
-          if (markers[i] == HERMES_ANY)
-          {
-            assemble_everywhere = true;
-            break;
-          }
-          else
+          SurfaceIntegralCalculator<Scalar>* calculator = calculators[calculator_i];
+          results.push_back((Scalar*)calloc(calculator->number_of_integrals, sizeof(Scalar)));
+          result_offsets[calculator_i + 1] = result_offsets[calculator_i] + calculator->number_of_integrals;
+
+          assemble_everywhere[calculator_i] = calculator->get_internal_markers(markers, true, internal_markers[calculator_i]);
+          if (assemble_everywhere[calculator_i] || internal_markers[calculator_i].size() > 0)
+            any_calculator = true;
+
+          for (int i = 0; i < calculator->source_functions.size(); i++)
           {
-            Hermes::Hermes2D::Mesh::MarkersConversion::IntValid internalMarker = this->source_functions[0]->get_mesh()->get_boundary_markers_conversion().get_internal_marker(markers[i]);
-            if (internalMarker.valid)
-              internal_markers.push_back(internalMarker.marker);
+            int function_i = 0;
+            while (function_i < source_functions.size() && source_functions[function_i].get() != calculator->source_functions[i].get())
+              function_i++;
+            if (function_i == source_functions.size())
+              source_functions.push_back(calculator->source_functions[i]);
+            function_indices[calculator_i].push_back(function_i);
           }
         }
 
-        Scalar* result = (Scalar*)calloc(this->number_of_integrals, sizeof(Scalar));
+        if (!any_calculator)
+          return results;
 
-        if (!assemble_everywhere && internal_markers.size() == 0)
-          return result;
+        int source_functions_size = source_functions.size();
+        int num_threads = calculators[0]->num_threads_used;
+        int results_size = result_offsets[calculators_count];
 
-#ifdef _DEBUG
-        this->info("Internal markers");
-        for (unsigned short i = 0; i < internal_markers.size(); i++)
-          this->info("\t%i", internal_markers[i]);
-#endif
-
-        int source_functions_size = this->source_functions.size();
         Traverse trav(source_functions_size);
         unsigned int num_states;
-        Traverse::State** states = trav.get_states(this->source_functions, num_states);
+        Traverse::State** states = trav.get_states(source_functions, num_states);
 
         for (int i = 0; i < source_functions_size; i++)
-          this->source_functions[i]->set_quad_2d(&g_quad_2d_std);
+          source_functions[i]->set_quad_2d(&g_quad_2d_std);
 
-#pragma omp parallel num_threads(this->num_threads_used)
+        // Partial sums of the threads, reduced in a fixed order afterwards - the results do not depend on the scheduling.
+        Scalar* thread_sums = calloc_with_check<Scalar>(num_threads * results_size);
+        Scalar* thread_compensations = calloc_with_check<Scalar>(num_threads * results_size);
+
+#pragma omp parallel num_threads(num_threads)
         {
           RefMap* refmap = new RefMap;
           refmap->set_quad_2d(&g_quad_2d_std);
 
           int thread_number = omp_get_thread_num();
-          int start = (num_states / this->num_threads_used) * thread_number;
-          int end = (num_states / this->num_threads_used) * (thread_number + 1);
-          if (thread_number == this->num_threads_used - 1)
+          int start = (num_states / num_threads) * thread_number;
+          int end = (num_states / num_threads) * (thread_number + 1);
+          if (thread_number == num_threads - 1)
             end = num_states;
 
 #ifdef _DEBUG
-          this->info("Thread %i, states %i - %i", thread_number, start, end);
+          calculators[0]->info("Thread %i, states %i - %i", thread_number, start, end);
 #endif
-
-          Hermes::Ord* orders = malloc_with_check<Hermes::Ord>(this->number_of_integrals);
+          Hermes::Ord* orders = malloc_with_check<Hermes::Ord>(std::max(results_size, 1));
           Func<Hermes::Ord>** func_ord = malloc_with_check<Func<Hermes::Ord>*>(source_functions_size);
 
           MeshFunction<Scalar>** source_functions_cloned = malloc_with_check<MeshFunction<Scalar>*>(source_functions_size);
           for (int i = 0; i < source_functions_size; i++)
-            source_functions_cloned[i] = this->source_functions[i]->clone();
+            source_functions_cloned[i] = source_functions[i]->clone();
           Func<Scalar>** func = malloc_with_check<Func<Scalar>*>(source_functions_size);
 
-          Scalar* result_thread_local = calloc_with_check<Scalar>(this->number_of_integrals);
-          Scalar* result_local = malloc_with_check<Scalar>(this->number_of_integrals);
+          Scalar* sums = thread_sums + thread_number * results_size;
+          Scalar* compensations = thread_compensations + thread_number * results_size;
+          Scalar* result_local = malloc_with_check<Scalar>(std::max(results_size, 1));
           double jacobian_x_weights[H2D_MAX_INTEGRATION_POINTS_COUNT];
+          std::vector<bool> target_calculators(calculators_count);
 
           for (int state_i = start; state_i < end; state_i++)
           {
 #ifdef _DEBUG
-            this->info("Thread %i, state %i", thread_number, state_i);
+            calculators[0]->info("Thread %i, state %i", thread_number, state_i);
 #endif
 
             Traverse::State* current_state = states[state_i];
 
             // Set active element.
-            for (unsigned short i = 0; i < source_functions_size; i++)
+            for (int i = 0; i < source_functions_size; i++)
             {
               if (current_state->e[i])
                 if (current_state->e[i]->used)
@@ -913,77 +1004,93 @@ namespace Hermes
 
             refmap->set_active_element(current_state->rep);
 
-            Hermes::Ord order = Hermes::Ord(refmap->get_inv_ref_order());
-
             for (unsigned short edge = 0; edge < current_state->rep->nvert; edge++)
             {
 #ifdef _DEBUG
-              this->info("Thread %i, state %i, edge %i", thread_number, state_i, edge);
+              calculators[0]->info("Thread %i, state %i, edge %i", thread_number, state_i, edge);
 #endif
-              if (!assemble_everywhere)
+              int edge_marker = current_state->rep->en[edge]->marker;
+              bool any_target_calculator = false;
+              for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
               {
-                bool target_marker = false;
-                for (unsigned short i = 0; i < internal_markers.size(); i++)
+                target_calculators[calculator_i] = assemble_everywhere[calculator_i];
+                for (unsigned short i = 0; i < internal_markers[calculator_i].size() && !target_calculators[calculator_i]; i++)
                 {
-                  if (current_state->rep->en[edge]->marker == internal_markers[i])
-                  {
-                    target_marker = true;
-                    break;
-                  }
+                  if (edge_marker == internal_markers[calculator_i][i])
+                    target_calculators[calculator_i] = true;
                 }
-                if (!target_marker)
-                  continue;
+                if (target_calculators[calculator_i])
+                  any_target_calculator = true;
               }
+              if (!any_target_calculator)
+                continue;
 
-              memset(result_local, 0, sizeof(Scalar)* this->number_of_integrals);
+              // Geometry is shared by the calculators with the same integration order.
+              GeomSurf<double> geometry;
+              int geometry_order = -1;
+              int n = 0;
 
-              // Integration order.
-              for (int i = 0; i < this->number_of_integrals; i++)
-                orders[i] = Hermes::Ord(0);
-              for (int i = 0; i < source_functions_size; i++)
-                func_ord[i] = new Func<Ord>(source_functions_cloned[i]->get_fn_order());
+              for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
+              {
+                if (!target_calculators[calculator_i])
+                  continue;
 
-              this->order(func_ord, orders);
+                SurfaceIntegralCalculator<Scalar>* calculator = calculators[calculator_i];
+                int calculator_functions_size = function_indices[calculator_i].size();
+                memset(result_local, 0, sizeof(Scalar)* calculator->number_of_integrals);
 
-              for (int i = 0; i < this->number_of_integrals; i++)
-                order += orders[i];
+                // Integration order.
+                Hermes::Ord order = Hermes::Ord(refmap->get_inv_ref_order());
+                for (int i = 0; i < calculator->number_of_integrals; i++)
+                  orders[i] = Hermes::Ord(0);
 
-              int order_int = order.get_order();
-              limit_order(order_int, refmap->get_active_element()->get_mode());
+                for (int i = 0; i < calculator_functions_size; i++)
+                {
+                  int function_i = function_indices[calculator_i][i];
+                  if (current_state->e[function_i] && current_state->e[function_i]->used)
+                    func_ord[i] = new Func<Ord>(source_functions_cloned[function_i]->get_fn_order());
+                  else
+                    func_ord[i] = new Func<Ord>(0);
+                }
 
-              GeomSurf<double> geometry;
-              int n = init_surface_geometry_points_allocated(refmap, order_int, edge, current_state->rep->en[edge]->marker, geometry, jacobian_x_weights);
+                calculator->order(func_ord, orders);
 
-              for (int i = 0; i < source_functions_size; i++)
-              {
-                if (current_state->e[i])
+                for (int i = 0; i < calculator->number_of_integrals; i++)
+                  order += orders[i];
+
+                int order_int = order.get_order();
+                limit_order(order_int, refmap->get_active_element()->get_mode());
+
+                if (order_int != geometry_order)
                 {
-                  if (current_state->e[i]->used)
-                    func[i] = init_fn(source_functions_cloned[i], order_int);
+                  n = init_surface_geometry_points_allocated(refmap, order_int, edge, edge_marker, geometry, jacobian_x_weights);
+                  geometry_order = order_int;
+                }
+
+                for (int i = 0; i < calculator_functions_size; i++)
+                {
+                  int function_i = function_indices[calculator_i][i];
+                  if (current_state->e[function_i] && current_state->e[function_i]->used)
+                    func[i] = init_fn(source_functions_cloned[function_i], order_int);
                   else
                     func[i] = init_zero_fn<Scalar>(current_state->rep->get_mode(), order_int);
                 }
-                else
-                  func[i] = init_zero_fn<Scalar>(current_state->rep->get_mode(), order_int);
-              }
 
-              this->integral(n, jacobian_x_weights, func, &geometry, result_local);
+                calculator->integral(n, jacobian_x_weights, func, &geometry, result_local);
 
-              for (int i = 0; i < source_functions_size; i++)
-              {
-                delete func_ord[i];
-                delete func[i];
-              }
+                for (int i = 0; i < calculator_functions_size; i++)
+                {
+                  delete func_ord[i];
+                  delete func[i];
+                }
 
-              for (int i = 0; i < this->number_of_integrals; i++)
-                result_thread_local[i] += .5 * result_local[i];
+                for (int i = 0; i < calculator->number_of_integrals; i++)
+                  integral_add_compensated(sums[result_offsets[calculator_i] + i], compensations[result_offsets[calculator_i] + i], Scalar(.5) * result_local[i]);
+              }
             }
           }
 
-          this->add_results(result_thread_local, result);
-          free_with_check(result_thread_local);
-
-          for (int i = 0; i < source_functions_size; i++)
+          for (unsigned short i = 0; i < source_functions_size; i++)
             delete source_functions_cloned[i];
           free_with_check(source_functions_cloned);
           free_with_check(orders);
@@ -993,11 +1100,16 @@ namespace Hermes
           delete refmap;
         }
 
+        for (int calculator_i = 0; calculator_i < calculators_count; calculator_i++)
+          integral_reduce(num_threads, calculators[calculator_i]->number_of_integrals, results_size, thread_sums + result_offsets[calculator_i], thread_compensations + result_offsets[calculator_i], results[calculator_i]);
+        free_with_check(thread_sums);
+        free_with_check(thread_compensations);
+
         for (int i = 0; i < num_states; i++)
           delete states[i];
         free_with_check(states);
 
-        return result;
+        return results;
       }
 
       template class HERMES_API Limiter < double > ;
@@ -928,33 +928,39 @@ namespace Hermes
         // evaluate the exact solution
         if (this->num_components == 1)
         {
-          // untransform values
-          if (!transform)
-          {
-            double2x2 *mat, *m;
-            int mstep = 0;
-            mat = this->refmap.get_const_inv_ref_map();
-            if (!this->refmap.is_jacobian_const()) { mat = this->refmap.get_inv_ref_map(order); mstep = 1; }
+          // all points at once, the derivatives only if needed
+          bool derivatives = (mask & (H2D_FN_DX | H2D_FN_DY)) != 0;
+          (static_cast<ExactSolutionScalar<Scalar>*>(this))->exact_values(np, x, y, this->values[0][0], derivatives ? this->values[0][1] : nullptr, derivatives ? this->values[0][2] : nullptr);
+
+          Scalar exact_multiplicator = (static_cast<ExactSolutionScalar<Scalar>*>(this))->exact_multiplicator;
+          for (i = 0; i < np; i++)
+            this->values[0][0][i] *= exact_multiplicator;
 
-            for (i = 0, m = mat; i < np; i++, m += mstep)
+          if (derivatives)
+          {
+            // untransform values
+            if (!transform)
             {
-              double jac = (*m)[0][0] * (*m)[1][1] - (*m)[1][0] * (*m)[0][1];
-              Scalar val, dx = 0.0, dy = 0.0;
-              val = (static_cast<ExactSolutionScalar<Scalar>*>(this))->exact_function(x[i], y[i], dx, dy);
-              this->values[0][0][i] = val * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
-              this->values[0][1][i] = ((*m)[1][1] * dx - (*m)[0][1] * dy) / jac * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
-              this->values[0][2][i] = (-(*m)[1][0] * dx + (*m)[0][0] * dy) / jac * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
+              double2x2 *mat, *m;
+              int mstep = 0;
+              mat = this->refmap.get_const_inv_ref_map();
+              if (!this->refmap.is_jacobian_const()) { mat = this->refmap.get_inv_ref_map(order); mstep = 1; }
+
+              for (i = 0, m = mat; i < np; i++, m += mstep)
+              {
+                double jac = (*m)[0][0] * (*m)[1][1] - (*m)[1][0] * (*m)[0][1];
+                Scalar dx = this->values[0][1][i], dy = this->values[0][2][i];
+                this->values[0][1][i] = ((*m)[1][1] * dx - (*m)[0][1] * dy) / jac * exact_multiplicator;
+                this->values[0][2][i] = (-(*m)[1][0] * dx + (*m)[0][0] * dy) / jac * exact_multiplicator;
+              }
             }
-          }
-          else
-          {
-            for (i = 0; i < np; i++)
+            else
             {
-              Scalar val, dx = 0.0, dy = 0.0;
-              val = (static_cast<ExactSolutionScalar<Scalar>*>(this))->exact_function(x[i], y[i], dx, dy);
-              this->values[0][0][i] = val * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
-              this->values[0][1][i] = dx * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
-              this->values[0][2][i] = dy * (static_cast<ExactSolutionVector<Scalar>*>(this))->exact_multiplicator;
+              for (i = 0; i < np; i++)
+              {
+                this->values[0][1][i] *= exact_multiplicator;
+                this->values[0][2][i] *= exact_multiplicator;
+              }
             }
           }
         }
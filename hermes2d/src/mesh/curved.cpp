@@ -320,6 +320,7 @@ namespace Hermes
     CurvMap::CurvMap() : ref_map_pss(&ref_map_shapeset)
     {
       coeffs = nullptr;
+      poly_coeffs = nullptr;
       ctm = nullptr;
       memset(curves, 0, sizeof(Curve*)* H2D_MAX_NUMBER_EDGES);
       this->parent = nullptr;
@@ -334,6 +335,13 @@ namespace Hermes
       this->ctm = cm->ctm;
       this->coeffs = malloc_with_check<double2>(nc, true);
       memcpy(coeffs, cm->coeffs, sizeof(double2)* nc);
+      if (cm->poly_coeffs)
+      {
+        this->poly_coeffs = malloc_with_check<double2>((order + 1) * (order + 1), true);
+        memcpy(poly_coeffs, cm->poly_coeffs, sizeof(double2)* (order + 1) * (order + 1));
+      }
+      else
+        this->poly_coeffs = nullptr;
 
       this->toplevel = cm->toplevel;
       if (this->toplevel)
@@ -369,6 +377,7 @@ namespace Hermes
     void CurvMap::free()
     {
       free_with_check(this->coeffs, true);
+      free_with_check(this->poly_coeffs, true);
 
       if (toplevel)
       {
@@ -792,6 +801,7 @@ namespace Hermes
         coeffs[i][1] = e->vn[i]->y;
       }
 
+      Element* element = e;
       if (!e->cm->toplevel)
         e = e->cm->parent;
 
@@ -801,6 +811,168 @@ namespace Hermes
 
       //bubble part
       calc_bubble_projection(e, curves, order, coeffs);
+
+      // polynomial form (of the element's own mapping, i.e. not the parent)
+      calc_poly_coeffs(element);
+    }
+
+    void CurvMap::calc_poly_coeffs(Element* e)
+    {
+      free_with_check(this->poly_coeffs, true);
+      if (order > (e->is_quad() ? max_poly_order : max_poly_order_triangle))
+        return;
+
+      ElementMode2D mode = e->get_mode();
+      unsigned short n = order + 1;
+
+      // Shape functions of 'coeffs', in the same order as in RefMap::set_active_element().
+      unsigned short indices[(max_poly_order + 1) * (max_poly_order + 1)];
+      unsigned short k = 0;
+      for (unsigned char i = 0; i < e->get_nvert(); i++)
+        indices[k++] = ref_map_shapeset.get_vertex_index(i, mode);
+      for (unsigned char i = 0; i < e->get_nvert(); i++)
+        for (unsigned short j = 2; j <= order; j++)
+          indices[k++] = ref_map_shapeset.get_edge_index(i, 0, j, mode);
+      unsigned short qo = e->is_quad() ? H2D_MAKE_QUAD_ORDER(order, order) : order;
+      short* bubble_indices = ref_map_shapeset.get_bubble_indices(qo, mode);
+      for (unsigned short i = 0; i < ref_map_shapeset.get_num_bubbles(qo, mode); i++)
+        indices[k++] = bubble_indices[i];
+
+      // Legendre polynomials L_i(xi_1) * L_j(xi_2) (i + j <= order on triangles, i, j <= order on quads) and the points
+      // of the same (downward closed) pattern, the mapping is interpolated (exactly, it is a polynomial from this space).
+      // Quads use the Chebyshev-Gauss-Lobatto points, which keeps the interpolation well conditioned up to
+      // max_poly_order. Triangles use the equispaced lattice (the Legendre products are not orthogonal on the triangle,
+      // no point set helps much there), hence the lower max_poly_order_triangle.
+      unsigned short num_polynomials = 0;
+      unsigned short polynomials[(max_poly_order + 1) * (max_poly_order + 1)][2];
+      for (unsigned short i = 0; i < n; i++)
+        for (unsigned short j = 0; j < n; j++)
+          if (e->is_quad() || i + j <= order)
+          {
+            polynomials[num_polynomials][0] = i;
+            polynomials[num_polynomials++][1] = j;
+          }
+
+      double points[max_poly_order + 1];
+      for (unsigned short i = 0; i < n; i++)
+        points[i] = e->is_quad() ? -std::cos(M_PI * i / order) : -1. + 2. * i / order;
+      // Exactly symmetric.
+      for (unsigned short i = 0; i < n / 2; i++)
+        points[i] = -points[order - i];
+      if (n % 2)
+        points[order / 2] = 0.;
+
+      double** matrix = new_matrix<double>(num_polynomials, num_polynomials);
+      double* rhs_x = malloc_with_check<double>(num_polynomials);
+      double* rhs_y = malloc_with_check<double>(num_polynomials);
+      for (unsigned short point_i = 0; point_i < num_polynomials; point_i++)
+      {
+        double xi_1 = points[polynomials[point_i][0]];
+        double xi_2 = points[polynomials[point_i][1]];
+
+        double legendre_1[max_poly_order + 1], legendre_2[max_poly_order + 1];
+        calc_legendre(n, xi_1, legendre_1, nullptr);
+        calc_legendre(n, xi_2, legendre_2, nullptr);
+        for (unsigned short polynomial_i = 0; polynomial_i < num_polynomials; polynomial_i++)
+          matrix[point_i][polynomial_i] = legendre_1[polynomials[polynomial_i][0]] * legendre_2[polynomials[polynomial_i][1]];
+
+        rhs_x[point_i] = rhs_y[point_i] = 0.;
+        for (unsigned short i = 0; i < nc; i++)
+        {
+          double val = ref_map_shapeset.get_fn_value(indices[i], xi_1, xi_2, 0, mode);
+          rhs_x[point_i] += coeffs[i][0] * val;
+          rhs_y[point_i] += coeffs[i][1] * val;
+        }
+      }
+
+      double d;
+      int* perm = malloc_with_check<int>(num_polynomials);
+      ludcmp(matrix, (int)num_polynomials, perm, &d);
+      lubksb<double>(matrix, (int)num_polynomials, perm, rhs_x);
+      lubksb<double>(matrix, (int)num_polynomials, perm, rhs_y);
+
+      this->poly_coeffs = calloc_with_check<double2>(n * n, true);
+      for (unsigned short polynomial_i = 0; polynomial_i < num_polynomials; polynomial_i++)
+      {
+        poly_coeffs[polynomials[polynomial_i][0] * n + polynomials[polynomial_i][1]][0] = rhs_x[polynomial_i];
+        poly_coeffs[polynomials[polynomial_i][0] * n + polynomials[polynomial_i][1]][1] = rhs_y[polynomial_i];
+      }
+
+      free_with_check(perm);
+      free_with_check(rhs_x);
+      free_with_check(rhs_y);
+      free_with_check(matrix, true);
+    }
+
+    void CurvMap::calc_legendre(unsigned short n, double xi, double* values, double* derivatives)
+    {
+      values[0] = 1.;
+      if (n > 1)
+        values[1] = xi;
+      for (unsigned short k = 1; k + 1 < n; k++)
+        values[k + 1] = ((2 * k + 1) * xi * values[k] - k * values[k - 1]) / (k + 1);
+
+      if (derivatives)
+      {
+        derivatives[0] = 0.;
+        if (n > 1)
+          derivatives[1] = 1.;
+        for (unsigned short k = 1; k + 1 < n; k++)
+          derivatives[k + 1] = derivatives[k - 1] + (2 * k + 1) * values[k];
+      }
+    }
+
+    void CurvMap::calc_poly_ref_map(unsigned short np, const double* xi_1, const double* xi_2, double* x, double* y,
+      double* x_dxi_1, double* x_dxi_2, double* y_dxi_1, double* y_dxi_2) const
+    {
+      unsigned short n = order + 1;
+      bool derivatives = (x_dxi_1 != nullptr);
+
+      double legendre_1[max_poly_order + 1], legendre_2[max_poly_order + 1];
+      double legendre_1_d[max_poly_order + 1], legendre_2_d[max_poly_order + 1];
+      for (unsigned short k = 0; k < np; k++)
+      {
+        calc_legendre(n, xi_1[k], legendre_1, derivatives ? legendre_1_d : nullptr);
+        calc_legendre(n, xi_2[k], legendre_2, derivatives ? legendre_2_d : nullptr);
+
+        double val_x = 0., val_y = 0., dxi_1_x = 0., dxi_1_y = 0., dxi_2_x = 0., dxi_2_y = 0.;
+        for (unsigned short i = 0; i < n; i++)
+        {
+          // The row polynomial in xi_2 (and its derivative).
+          const double2* row = this->poly_coeffs + i * n;
+          double row_x = 0., row_y = 0., row_x_d = 0., row_y_d = 0.;
+          for (unsigned short j = 0; j < n; j++)
+          {
+            row_x += row[j][0] * legendre_2[j];
+            row_y += row[j][1] * legendre_2[j];
+            if (derivatives)
+            {
+              row_x_d += row[j][0] * legendre_2_d[j];
+              row_y_d += row[j][1] * legendre_2_d[j];
+            }
+          }
+
+          val_x += legendre_1[i] * row_x;
+          val_y += legendre_1[i] * row_y;
+          if (derivatives)
+          {
+            dxi_1_x += legendre_1_d[i] * row_x;
+            dxi_1_y += legendre_1_d[i] * row_y;
+            dxi_2_x += legendre_1[i] * row_x_d;
+            dxi_2_y += legendre_1[i] * row_y_d;
+          }
+        }
+
+        x[k] = val_x;
+        y[k] = val_y;
+        if (derivatives)
+        {
+          x_dxi_1[k] = dxi_1_x;
+          y_dxi_1[k] = dxi_1_y;
+          x_dxi_2[k] = dxi_2_x;
+          y_dxi_2[k] = dxi_2_y;
+        }
+      }
     }
 
     void CurvMap::get_mid_edge_points(Element* e, double2* pt, unsigned short n)
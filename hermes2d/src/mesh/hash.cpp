@@ -24,6 +24,8 @@ namespace Hermes
     HashTable::HashTable()
     {
       v_table = nullptr; e_table = nullptr;
+      v_mask = e_mask = 0;
+      v_count = e_count = 0;
     }
 
     HashTable::~HashTable()
@@ -31,30 +33,29 @@ namespace Hermes
       free();
     }
 
+    HashTable::HashEntry* HashTable::alloc_table(int size)
+    {
+      HashEntry* table = new HashEntry[size];
+      for (int i = 0; i < size; i++)
+        table[i].id = -1;
+      return table;
+    }
+
     void HashTable::init(int size)
     {
+      if (v_table != nullptr)
+        delete[] v_table;
+      if (e_table != nullptr)
+        delete[] e_table;
       v_table = e_table = nullptr;
 
-      mask = size - 1;
-      if (size & mask) throw Hermes::Exceptions::Exception("Parameter 'size' must be a power of two.");
+      if (size & (size - 1)) throw Hermes::Exceptions::Exception("Parameter 'size' must be a power of two.");
+      v_mask = e_mask = size - 1;
+      v_count = e_count = 0;
 
       // allocate and initialize the hash tables
-      v_table = new Node*[size];
-      e_table = new Node*[size];
-
-      memset(v_table, 0, size * sizeof(Node*));
-      memset(e_table, 0, size * sizeof(Node*));
-    }
-
-    void HashTable::copy_list(Node** ptr, Node* node)
-    {
-      while (node != nullptr)
-      {
-        *ptr = &nodes[node->id];
-        ptr = &((*ptr)->next_hash);
-        node = node->next_hash;
-      }
-      *ptr = nullptr;
+      v_table = alloc_table(size);
+      e_table = alloc_table(size);
     }
 
     Node* HashTable::get_node(int id) const
@@ -76,39 +77,55 @@ namespace Hermes
     {
       free();
       nodes.copy(ht->nodes);
-      mask = ht->mask;
 
-      v_table = new Node*[mask + 1];
-      e_table = new Node*[mask + 1];
-      for (int i = 0; i <= mask; i++)
-      {
-        copy_list(v_table + i, ht->v_table[i]);
-        copy_list(e_table + i, ht->e_table[i]);
-      }
+      // The tables only contain node ids, which are preserved by the copy.
+      v_mask = ht->v_mask;
+      e_mask = ht->e_mask;
+      v_count = ht->v_count;
+      e_count = ht->e_count;
+      v_table = new HashEntry[v_mask + 1];
+      e_table = new HashEntry[e_mask + 1];
+      memcpy(v_table, ht->v_table, (v_mask + 1) * sizeof(HashEntry));
+      memcpy(e_table, ht->e_table, (e_mask + 1) * sizeof(HashEntry));
     }
 
     void HashTable::rebuild()
     {
-      memset(v_table, 0, (mask + 1) * sizeof(Node*));
-      memset(e_table, 0, (mask + 1) * sizeof(Node*));
-
+      int num_vertex_nodes = 0, num_edge_nodes = 0;
       Node* node;
       for_all_nodes(node, this)
       {
+        if (node->type == HERMES_TYPE_VERTEX)
+          num_vertex_nodes++;
+        else
+          num_edge_nodes++;
+      }
+
+      // Size the tables at once, so that no growing takes place during the insertion.
+      int v_size = H2D_DEFAULT_HASH_SIZE, e_size = H2D_DEFAULT_HASH_SIZE;
+      while (v_size < 2 * num_vertex_nodes) v_size *= 2;
+      while (e_size < 2 * num_edge_nodes) e_size *= 2;
+      delete[] v_table;
+      delete[] e_table;
+      v_table = alloc_table(v_size);
+      e_table = alloc_table(e_size);
+      v_mask = v_size - 1;
+      e_mask = e_size - 1;
+      v_count = e_count = 0;
+
+      for_all_nodes(node, this)
+      {
+        // top-level vertex nodes have no parents and are never searched for
+        if (node->p1 < 0 || node->p2 < 0)
+          continue;
+
         int p1 = node->p1, p2 = node->p2;
         if (p1 > p2) std::swap(p1, p2);
-        int idx = hash(p1, p2);
 
         if (node->type == HERMES_TYPE_VERTEX)
-        {
-          node->next_hash = v_table[idx];
-          v_table[idx] = node;
-        }
+          insert_to_table(v_table, v_mask, v_count, p1, p2, node->id);
         else
-        {
-          node->next_hash = e_table[idx];
-          e_table[idx] = node;
-        }
+          insert_to_table(e_table, e_mask, e_count, p1, p2, node->id);
       }
     }
 
@@ -125,27 +142,152 @@ namespace Hermes
         delete[] e_table;
         e_table = nullptr;
       }
+      v_count = e_count = 0;
+    }
+
+    inline int HashTable::search_table(const HashEntry* table, int mask, int p1, int p2) const
+    {
+      int i = hash(p1, p2, mask);
+      while (table[i].id != -1)
+      {
+        if (table[i].p1 == p1 && table[i].p2 == p2)
+          return table[i].id;
+        i = (i + 1) & mask;
+      }
+      return -1;
+    }
+
+    void HashTable::insert_to_table(HashEntry*& table, int& mask, int& count, int p1, int p2, int id)
+    {
+      // keep the load factor at most 1/2
+      if (2 * (count + 1) > mask + 1)
+        resize_table(table, mask, 2 * (mask + 1));
+
+      int i = hash(p1, p2, mask);
+      while (table[i].id != -1)
+        i = (i + 1) & mask;
+      table[i].p1 = p1;
+      table[i].p2 = p2;
+      table[i].id = id;
+      count++;
+    }
+
+    void HashTable::insert_to_table(HashEntry*& table, int& mask, int& count, const std::vector<int>& node_ids, int type, int num_threads)
+    {
+      std::vector<int> ids;
+      for (unsigned int k = 0; k < node_ids.size(); k++)
+      if (nodes[node_ids[k]].type == type)
+        ids.push_back(node_ids[k]);
+      int num_ids = ids.size();
+      if (!num_ids)
+        return;
+
+      // keep the load factor at most 1/2
+      int size = mask + 1;
+      while (2 * (count + num_ids) > size)
+        size *= 2;
+      if (size > mask + 1)
+        resize_table(table, mask, size);
+
+      std::vector<int> home_slots(num_ids);
+#pragma omp parallel for num_threads(num_threads)
+      for (int k = 0; k < num_ids; k++)
+        home_slots[k] = hash(nodes[ids[k]].p1, nodes[ids[k]].p2, mask);
+
+      // Slots are only filled, so no search stops at an empty slot before the node.
+      std::vector<std::vector<int> > left_parts(num_threads);
+#pragma omp parallel for num_threads(num_threads)
+      for (int part = 0; part < num_threads; part++)
+      {
+        int part_begin = (int)(((long long)size * part) / num_threads), part_end = (int)(((long long)size * (part + 1)) / num_threads);
+        for (int k = 0; k < num_ids; k++)
+        {
+          int i = home_slots[k];
+          if (i < part_begin || i >= part_end)
+            continue;
+          while (i < part_end && table[i].id != -1)
+            i++;
+          if (i == part_end)
+          {
+            left_parts[part].push_back(k);
+            continue;
+          }
+          table[i].p1 = nodes[ids[k]].p1;
+          table[i].p2 = nodes[ids[k]].p2;
+          table[i].id = ids[k];
+        }
+      }
+
+      for (int part = 0; part < num_threads; part++)
+      {
+        for (unsigned int j = 0; j < left_parts[part].size(); j++)
+        {
+          int k = left_parts[part][j];
+          int i = home_slots[k];
+          while (table[i].id != -1)
+            i = (i + 1) & mask;
+          table[i].p1 = nodes[ids[k]].p1;
+          table[i].p2 = nodes[ids[k]].p2;
+          table[i].id = ids[k];
+        }
+      }
+      count += num_ids;
+    }
+
+    void HashTable::resize_table(HashEntry*& table, int& mask, int size)
+    {
+      int old_size = mask + 1;
+      HashEntry* old_table = table;
+      table = alloc_table(size);
+      mask = size - 1;
+      for (int j = 0; j < old_size; j++)
+      {
+        if (old_table[j].id == -1)
+          continue;
+        int i = hash(old_table[j].p1, old_table[j].p2, mask);
+        while (table[i].id != -1)
+          i = (i + 1) & mask;
+        table[i] = old_table[j];
+      }
+      delete[] old_table;
     }
 
-    inline Node* HashTable::search_list(Node* node, int p1, int p2) const
+    void HashTable::remove_from_table(HashEntry* table, int mask, int& count, int p1, int p2, int id)
     {
-      while (node != nullptr)
+      int i = hash(p1, p2, mask);
+      while (table[i].id != id)
       {
-        if (node->p1 == p1 && node->p2 == p2)
-          return node;
-        node = node->next_hash;
+        if (table[i].id == -1)
+          return;
+        i = (i + 1) & mask;
+      }
+      table[i].id = -1;
+      count--;
+
+      // Shift back the following entries of the cluster, so that no search stops at the emptied slot.
+      int j = i;
+      while (true)
+      {
+        j = (j + 1) & mask;
+        if (table[j].id == -1)
+          break;
+        int k = hash(table[j].p1, table[j].p2, mask);
+        // The entry stays, if its home slot k lies cyclically in (i, j].
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+          continue;
+        table[i] = table[j];
+        table[j].id = -1;
+        i = j;
       }
-      return nullptr;
     }
 
     Node* HashTable::get_vertex_node(int p1, int p2)
     {
       // search for the node in the vertex hashtable
       if (p1 > p2) std::swap(p1, p2);
-      int i = hash(p1, p2);
-      Node* node = search_list(v_table[i], p1, p2);
-      if (node != nullptr)
-        return node;
+      int id = search_table(v_table, v_mask, p1, p2);
+      if (id != -1)
+        return &nodes[id];
 
       // not found - create a new_ one
       Node* newnode = nodes.add();
@@ -161,8 +303,7 @@ namespace Hermes
       newnode->y = (nodes[p1].y + nodes[p2].y) * 0.5;
 
       // insert into hashtable
-      newnode->next_hash = v_table[i];
-      v_table[i] = newnode;
+      insert_to_table(v_table, v_mask, v_count, p1, p2, newnode->id);
 
       return newnode;
     }
@@ -171,9 +312,9 @@ namespace Hermes
     {
       // search for the node in the edge hashtable
       if (p1 > p2) std::swap(p1, p2);
-      int i = hash(p1, p2);
-      Node* node = search_list(e_table[i], p1, p2);
-      if (node != nullptr) return node;
+      int id = search_table(e_table, e_mask, p1, p2);
+      if (id != -1)
+        return &nodes[id];
 
       // not found - create a new_ one
       Node* newnode = nodes.add();
@@ -188,8 +329,7 @@ namespace Hermes
       newnode->elem[0] = newnode->elem[1] = nullptr;
 
       // insert into hashtable
-      newnode->next_hash = e_table[i];
-      e_table[i] = newnode;
+      insert_to_table(e_table, e_mask, e_count, p1, p2, newnode->id);
 
       return newnode;
     }
@@ -197,31 +337,27 @@ namespace Hermes
     Node* HashTable::peek_vertex_node(int p1, int p2) const
     {
       if (p1 > p2) std::swap(p1, p2);
-      return search_list(v_table[hash(p1, p2)], p1, p2);
+      int id = search_table(v_table, v_mask, p1, p2);
+      return id == -1 ? nullptr : &nodes[id];
     }
 
     Node* HashTable::peek_edge_node(int p1, int p2) const
     {
       if (p1 > p2) std::swap(p1, p2);
-      return search_list(e_table[hash(p1, p2)], p1, p2);
+      int id = search_table(e_table, e_mask, p1, p2);
+      return id == -1 ? nullptr : &nodes[id];
+    }
+
+    void HashTable::insert_nodes(const std::vector<int>& node_ids, int num_threads)
+    {
+      insert_to_table(v_table, v_mask, v_count, node_ids, HERMES_TYPE_VERTEX, num_threads);
+      insert_to_table(e_table, e_mask, e_count, node_ids, HERMES_TYPE_EDGE, num_threads);
     }
 
     void HashTable::remove_vertex_node(int id)
     {
       // remove the node from the hash table
-      int i = hash(nodes[id].p1, nodes[id].p2);
-      Node** ptr = v_table + i;
-      Node* node = *ptr;
-      while (node != nullptr)
-      {
-        if (node->id == id)
-        {
-          *ptr = node->next_hash;
-          break;
-        }
-        ptr = &node->next_hash;
-        node = *ptr;
-      }
+      remove_from_table(v_table, v_mask, v_count, nodes[id].p1, nodes[id].p2, id);
 
       // remove node from the array
       nodes.remove(id);
@@ -230,19 +366,7 @@ namespace Hermes
     void HashTable::remove_edge_node(int id)
     {
       // remove the node from the hash table
-      int i = hash(nodes[id].p1, nodes[id].p2);
-      Node** ptr = e_table + i;
-      Node* node = *ptr;
-      while (node != nullptr)
-      {
-        if (node->id == id)
-        {
-          *ptr = node->next_hash;
-          break;
-        }
-        ptr = &node->next_hash;
-        node = *ptr;
-      }
+      remove_from_table(e_table, e_mask, e_count, nodes[id].p1, nodes[id].p2, id);
 
       // remove node from the array
       nodes.remove(id);
@@ -30,8 +30,8 @@ namespace Hermes
     static const int H2D_DG_INNER_EDGE_INT = -54125631;
     static const std::string H2D_DG_INNER_EDGE = "-54125631";
 
-    Mesh::Mesh() : HashTable(), meshHashGrid(nullptr), nbase(0), nactive(0), ntopvert(0), ninitial(0), seq(g_mesh_seq++),
-      bounding_box_calculated(0)
+    Mesh::Mesh() : HashTable(), meshHashGrid(nullptr), meshFaceTable(nullptr), nbase(0), nactive(0), ntopvert(0), ninitial(0), seq(g_mesh_seq++),
+      bounding_box_calculated(0), deferred_curved_sons(nullptr)
     {
     }
 
@@ -120,7 +120,6 @@ namespace Hermes
         node->type = HERMES_TYPE_VERTEX;
         node->bnd = 0;
         node->p1 = node->p2 = -1;
-        node->next_hash = nullptr;
         node->x = verts[i][0];
         node->y = verts[i][1];
       }
@@ -437,7 +436,7 @@ namespace Hermes
       // update coefficients of curved reference mapping
       for (int i = 0; i < 4; i++)
         if (sons[i]->is_curved())
-          sons[i]->cm->update_refmap_coeffs(sons[i]);
+          this->update_curved_son(sons[i]);
 
       // deactivate this element and unregister from its nodes
       e->active = 0;
@@ -644,7 +643,7 @@ namespace Hermes
         if (sons[i])
         {
         if (sons[i]->cm)
-          sons[i]->cm->update_refmap_coeffs(sons[i]);
+          this->update_curved_son(sons[i]);
         }
 
       // set pointers to parent element for sons
@@ -734,6 +733,78 @@ namespace Hermes
         if (e->sons[i])
           e->sons[i]->iro_cache = e->iro_cache;
 
+      // Distinct meshes may be refined in parallel (Adapt::refine_meshes).
+#pragma omp critical (g_mesh_seq)
+      this->seq = g_mesh_seq++;
+    }
+
+    void Mesh::update_curved_son(Element* son)
+    {
+      if (this->deferred_curved_sons)
+        this->deferred_curved_sons->push_back(son);
+      else
+        son->cm->update_refmap_coeffs(son);
+    }
+
+    void Mesh::reorder_base_elements(std::vector<int>& new_ids)
+    {
+      int n = this->nbase;
+      new_ids.resize(n);
+      for (int i = 0; i < n; i++)
+        new_ids[i] = i;
+
+      if (this->nactive != n || this->elements.get_num_items() != n)
+        throw Hermes::Exceptions::Exception("Only base elements of a mesh without refinements can be reordered.");
+
+      double* x = malloc_with_check<double>(n);
+      double* y = malloc_with_check<double>(n);
+      for (int i = 0; i < n; i++)
+      {
+        Element* e = this->get_element_fast(i);
+        if (!e->used)
+        {
+          // Unused slots would be moved, the numbering of the mesh file is kept instead.
+          free_with_check(x);
+          free_with_check(y);
+          return;
+        }
+        e->get_center(x[i], y[i]);
+      }
+
+      // order[i] = the original id of the element which gets the id i.
+      int* order = malloc_with_check<int>(n);
+      MeshUtil::space_filling_curve_order(x, y, n, order);
+      for (int i = 0; i < n; i++)
+        new_ids[order[i]] = i;
+      free_with_check(x);
+      free_with_check(y);
+
+      // Elements sharing edge nodes by their original ids.
+      int* edge_elems = malloc_with_check<int>(2 * this->get_max_node_id());
+      Node* node;
+      for_all_edge_nodes(node, this)
+      for (int j = 0; j < 2; j++)
+        edge_elems[2 * node->id + j] = node->elem[j] ? node->elem[j]->id : -1;
+
+      Element* original_elements = new Element[n];
+      for (int i = 0; i < n; i++)
+        original_elements[i] = this->elements[i];
+      for (int i = 0; i < n; i++)
+      {
+        this->elements[i] = original_elements[order[i]];
+        this->elements[i].id = i;
+      }
+      delete[] original_elements;
+      free_with_check(order);
+
+      for_all_edge_nodes(node, this)
+      for (int j = 0; j < 2; j++)
+      {
+        if (edge_elems[2 * node->id + j] != -1)
+          node->elem[j] = this->get_element_fast(new_ids[edge_elems[2 * node->id + j]]);
+      }
+      free_with_check(edge_elems);
+
       this->seq = g_mesh_seq++;
     }
 
@@ -749,6 +820,687 @@ namespace Hermes
       this->refine_element(e, refinement);
     }
 
+    // Kinds of nodes touched by refine_elements_id().
+    enum ParallelRefinementKeyKind
+    {
+      // A vertex / edge node existing before the refinements, a = its id.
+      PR_VERTEX,
+      PR_EDGE,
+      // A vertex node whose parent vertex nodes existed before the refinements, a < b their ids.
+      PR_NEW_VERTEX,
+      // An edge node between two vertex nodes of the kinds PR_VERTEX - (id, -1) - or PR_NEW_VERTEX - (p1, p2),
+      // (a, b) <= (c, d) these pairs.
+      PR_NEW_EDGE,
+      // A node only one refinement can touch (it has a parent vertex node created by the refinement),
+      // a = the refinement, vertex: b = a counter, edge: c < d the handles of the vertex nodes.
+      PR_PRIVATE_VERTEX,
+      PR_PRIVATE_EDGE
+    };
+
+    // Operations of a refinement on the nodes, in the order of the serial refinement.
+    enum ParallelRefinementEventType
+    {
+      PR_GET_VERTEX,
+      PR_GET_EDGE,
+      PR_UNREF_EDGE
+    };
+
+    // What happens to the node array in an event.
+    enum ParallelRefinementAction
+    {
+      PR_NONE,
+      PR_CREATE,
+      PR_REMOVE
+    };
+
+    /// Identification of a node touched by refine_elements_id(), the same for all refinements touching the node.
+    struct Mesh::ParallelRefinementKey
+    {
+      /// ParallelRefinementKeyKind.
+      int kind;
+      int a, b, c, d;
+
+      bool operator==(const ParallelRefinementKey& other) const
+      {
+        return kind == other.kind && a == other.a && b == other.b && c == other.c && d == other.d;
+      }
+
+      bool is_edge() const
+      {
+        return kind == PR_EDGE || kind == PR_NEW_EDGE || kind == PR_PRIVATE_EDGE;
+      }
+
+      /// Decides which thread merges the events of the node (and the slot in its table).
+      unsigned int hash() const
+      {
+        unsigned int h = (unsigned int)kind;
+        h = (h ^ (unsigned int)a) * 0x9E3779B1u;
+        h = (h ^ (unsigned int)b) * 0x85EBCA6Bu;
+        h = (h ^ (unsigned int)c) * 0xC2B2AE35u;
+        h = (h ^ (unsigned int)d) * 0x9E3779B1u;
+        return h ^ (h >> 16);
+      }
+    };
+
+    /// One operation of a refinement on a node.
+    /// Nodes are referred to by handles: >= 0 a node existing before the refinements (its id),
+    /// < 0 the node got in the event -(handle + 1).
+    struct Mesh::ParallelRefinementEvent
+    {
+      ParallelRefinementKey key;
+      /// ParallelRefinementEventType.
+      int type;
+      /// PR_GET_VERTEX: references added by the sons, PR_GET_EDGE: the son (its index in the batch),
+      /// PR_UNREF_EDGE: the id of the refined element.
+      int value;
+      /// PR_GET_*: the boundary flag and marker set by the refinement (bnd == -1: not set),
+      /// PR_UNREF_EDGE: the ones the refinement read.
+      int bnd, marker;
+      /// PR_GET_*: handles of the parent vertex nodes.
+      int p1, p2;
+      /// Set by the merge: ParallelRefinementAction, and the node (existing id, or the handle of the creating event).
+      int action;
+      int instance;
+    };
+
+    /// One refinement of refine_elements_id().
+    struct Mesh::ParallelRefinementPlan
+    {
+      int element_id;
+      int refinement;
+      /// The first event / son of the refinement in the batch.
+      int event_begin;
+      int son_begin;
+      /// The sons in the order of creation: their slots in Element::sons, the handles of their vertex nodes,
+      /// the events getting their edge nodes.
+      int num_sons;
+      int son_slots[H2D_MAX_ELEMENT_SONS];
+      int son_vertices[H2D_MAX_ELEMENT_SONS][H2D_MAX_NUMBER_VERTICES];
+      int son_edges[H2D_MAX_ELEMENT_SONS][H2D_MAX_NUMBER_EDGES];
+    };
+
+    /// The state of a node during / after the refinements of refine_elements_id().
+    struct Mesh::ParallelRefinementNode
+    {
+      ParallelRefinementKey key;
+      /// The node exists (it is not removed, or it is already created).
+      bool alive;
+      /// Existing node id, or the handle of the creating event.
+      int instance;
+      int ref, bnd, marker;
+      /// Elements of an edge node: -1 none, >= 0 an existing element id, < -1 the son -(elem + 2) of the batch.
+      int elem[2];
+    };
+
+    /// The phases of refine_elements_id() working on the events.
+    class Mesh::ParallelRefinement
+    {
+    public:
+      /// \param[in] bucket_events The events of the planned partition will be added to these lists
+      /// (one per bucket = merging thread), in the serial order.
+      ParallelRefinement(const Mesh* mesh, ParallelRefinementEvent* events, int num_buckets, std::vector<int>* bucket_events) :
+        mesh(mesh), events(events), num_buckets(num_buckets), bucket_events(bucket_events)
+      {
+      }
+
+      static int get_num_events(const Element* e, int refinement)
+      {
+        if (e->is_triangle())
+          return 18;
+        return refinement == 0 ? 25 : 14;
+      }
+
+      static int get_num_sons(const Element* e, int refinement)
+      {
+        return (e->is_quad() && refinement != 0) ? 2 : H2D_MAX_ELEMENT_SONS;
+      }
+
+      /// Fills in the plan and its events, as refine_quad() / refine_triangle_to_triangles() would perform them.
+      /// Only reads the mesh.
+      void plan(ParallelRefinementPlan& plan, int refinement_index)
+      {
+        this->current_plan = &plan;
+        this->next_event = plan.event_begin;
+        this->refinement_index = refinement_index;
+        this->num_private_keys = 0;
+        plan.num_sons = 0;
+
+        Element* e = mesh->get_element_fast(plan.element_id);
+        int bnd[H2D_MAX_NUMBER_EDGES], mrk[H2D_MAX_NUMBER_EDGES];
+        Vertex v[H2D_MAX_NUMBER_VERTICES];
+        for (int i = 0; i < e->nvert; i++)
+        {
+          bnd[i] = e->en[i]->bnd;
+          mrk[i] = e->en[i]->marker;
+          v[i] = get_vertex(e->vn[i]);
+        }
+
+        if (e->is_triangle())
+        {
+          Vertex x0 = get_mid_vertex(v[0], v[1], 3, bnd[0]);
+          Vertex x1 = get_mid_vertex(v[1], v[2], 3, bnd[1]);
+          Vertex x2 = get_mid_vertex(v[2], v[0], 3, bnd[2]);
+
+          Vertex sons[4][3] = { { v[0], x0, x2 }, { x0, v[1], x1 }, { x2, x1, v[2] }, { x1, x2, x0 } };
+          create_son(0, 3, sons[0], (1 << 0) | (1 << 2), bnd, mrk);
+          create_son(1, 3, sons[1], (1 << 0) | (1 << 1), bnd, mrk);
+          create_son(2, 3, sons[2], (1 << 1) | (1 << 2), bnd, mrk);
+          create_son(3, 3, sons[3], 0, bnd, mrk);
+
+          for (int i = 0; i < 3; i++)
+            unref_edge(e->en[i], e->id, bnd[i], mrk[i]);
+          return;
+        }
+
+        for (int i = 0; i < 4; i++)
+          unref_edge(e->en[i], e->id, bnd[i], mrk[i]);
+
+        if (plan.refinement == 0)
+        {
+          Vertex x0 = get_mid_vertex(v[0], v[1], 2, bnd[0]);
+          Vertex x1 = get_mid_vertex(v[1], v[2], 2, bnd[1]);
+          Vertex x2 = get_mid_vertex(v[2], v[3], 2, bnd[2]);
+          Vertex x3 = get_mid_vertex(v[3], v[0], 2, bnd[3]);
+          Vertex mid = get_mid_vertex(x0, x2, 4, -1);
+
+          Vertex sons[4][4] = { { v[0], x0, mid, x3 }, { x0, v[1], x1, mid }, { mid, x1, v[2], x2 }, { x3, mid, x2, v[3] } };
+          for (int i = 0; i < 4; i++)
+            create_son(i, 4, sons[i], (1 << i) | (1 << ((i > 0) ? i - 1 : 3)), bnd, mrk);
+        }
+        else if (plan.refinement == 1)
+        {
+          Vertex x1 = get_mid_vertex(v[1], v[2], 2, bnd[1]);
+          Vertex x3 = get_mid_vertex(v[3], v[0], 2, bnd[3]);
+
+          Vertex sons[2][4] = { { v[0], v[1], x1, x3 }, { x3, x1, v[2], v[3] } };
+          create_son(0, 4, sons[0], (1 << 0) | (1 << 1) | (1 << 3), bnd, mrk);
+          create_son(1, 4, sons[1], (1 << 1) | (1 << 2) | (1 << 3), bnd, mrk);
+        }
+        else
+        {
+          Vertex x0 = get_mid_vertex(v[0], v[1], 2, bnd[0]);
+          Vertex x2 = get_mid_vertex(v[2], v[3], 2, bnd[2]);
+
+          Vertex sons[2][4] = { { v[0], x0, x2, v[3] }, { x0, v[1], v[2], x2 } };
+          create_son(2, 4, sons[0], (1 << 0) | (1 << 2) | (1 << 3), bnd, mrk);
+          create_son(3, 4, sons[1], (1 << 0) | (1 << 1) | (1 << 2), bnd, mrk);
+        }
+      }
+
+      /// Replays the events of one bucket node by node, in the serial order, finds out which of them create
+      /// and remove nodes, and the final states of the nodes (the nodes are found by an open addressing table
+      /// as in HashTable).
+      /// Returns false if the parallel refinement can not reproduce the serial one (the mesh has to be refined serially).
+      static bool merge_bucket(const Mesh* mesh, ParallelRefinementEvent* events, int num_buckets, const std::vector<int>& bucket_events,
+        std::vector<ParallelRefinementNode>& nodes)
+      {
+        int table_size = 16;
+        while (table_size < 2 * (int)bucket_events.size())
+          table_size *= 2;
+        std::vector<int> table(table_size, -1);
+
+        for (unsigned int i = 0; i < bucket_events.size(); i++)
+        {
+          int event_i = bucket_events[i];
+          ParallelRefinementEvent& ev = events[event_i];
+
+          int slot = (ev.key.hash() / num_buckets) & (table_size - 1);
+          while (table[slot] != -1 && !(nodes[table[slot]].key == ev.key))
+            slot = (slot + 1) & (table_size - 1);
+          if (table[slot] == -1)
+          {
+            table[slot] = nodes.size();
+            ParallelRefinementNode node;
+            node.key = ev.key;
+            node.alive = (ev.key.kind == PR_VERTEX || ev.key.kind == PR_EDGE);
+            if (node.alive)
+            {
+              Node* existing_node = mesh->get_node(ev.key.a);
+              node.instance = ev.key.a;
+              node.ref = existing_node->ref;
+              node.bnd = existing_node->bnd;
+              node.marker = ev.key.is_edge() ? existing_node->marker : 0;
+              for (int j = 0; j < 2; j++)
+                node.elem[j] = (ev.key.is_edge() && existing_node->elem[j]) ? existing_node->elem[j]->id : -1;
+            }
+            nodes.push_back(node);
+          }
+          ParallelRefinementNode& node = nodes[table[slot]];
+
+          ev.action = PR_NONE;
+          if (ev.type == PR_UNREF_EDGE)
+          {
+            // The boundary flag / marker read by the refinement was changed by a previous one.
+            if (!node.alive || node.bnd != ev.bnd || node.marker != ev.marker)
+              return false;
+            ev.instance = node.instance;
+            if (node.elem[0] == ev.value)
+              node.elem[0] = -1;
+            else if (node.elem[1] == ev.value)
+              node.elem[1] = -1;
+            if (!--node.ref)
+            {
+              ev.action = PR_REMOVE;
+              node.alive = false;
+            }
+            continue;
+          }
+
+          if (!node.alive)
+          {
+            ev.action = PR_CREATE;
+            node.instance = -(event_i + 1);
+            node.ref = node.bnd = node.marker = 0;
+            node.elem[0] = node.elem[1] = -1;
+            node.alive = true;
+          }
+          ev.instance = node.instance;
+
+          if (ev.type == PR_GET_VERTEX)
+            node.ref += ev.value;
+          else
+          {
+            // "No free slot 'elem'", let the serial refinement throw.
+            if (node.elem[0] != -1 && node.elem[1] != -1)
+              return false;
+            node.elem[node.elem[0] == -1 ? 0 : 1] = -(ev.value + 2);
+            node.ref++;
+          }
+
+          if (ev.bnd != -1)
+          {
+            node.bnd = ev.bnd;
+            if (ev.key.is_edge())
+              node.marker = ev.marker;
+          }
+        }
+        return true;
+      }
+
+      /// The id of the node of a handle, the nodes created by the events before have to have their ids in event_node_ids.
+      static int get_node_id(const ParallelRefinementEvent* events, const std::vector<int>& event_node_ids, int handle)
+      {
+        if (handle >= 0)
+          return handle;
+        int instance = events[-handle - 1].instance;
+        return instance >= 0 ? instance : event_node_ids[-instance - 1];
+      }
+
+      /// Coordinates of a vertex node, calculated as in HashTable::get_vertex_node().
+      static void get_coordinates(const Mesh* mesh, const ParallelRefinementEvent* events, int handle, double& x, double& y)
+      {
+        if (handle < 0 && events[-handle - 1].key.kind == PR_VERTEX)
+          handle = events[-handle - 1].key.a;
+        if (handle >= 0)
+        {
+          x = mesh->get_node(handle)->x;
+          y = mesh->get_node(handle)->y;
+          return;
+        }
+
+        double x1, y1, x2, y2;
+        get_coordinates(mesh, events, events[-handle - 1].p1, x1, y1);
+        get_coordinates(mesh, events, events[-handle - 1].p2, x2, y2);
+        x = (x1 + x2) * 0.5;
+        y = (y1 + y2) * 0.5;
+      }
+
+    private:
+      /// A vertex node of the planned refinement.
+      struct Vertex
+      {
+        ParallelRefinementKey key;
+        int handle;
+      };
+
+      Vertex get_vertex(Node* node)
+      {
+        Vertex vertex = { { PR_VERTEX, node->id, 0, 0, 0 }, node->id };
+        return vertex;
+      }
+
+      /// HashTable::get_vertex_node() and 'refs' references of the sons.
+      Vertex get_mid_vertex(const Vertex& v1, const Vertex& v2, int refs, int bnd)
+      {
+        ParallelRefinementKey key = { PR_PRIVATE_VERTEX, this->refinement_index, this->num_private_keys, 0, 0 };
+        if (v1.key.kind == PR_VERTEX && v2.key.kind == PR_VERTEX)
+        {
+          Node* node = mesh->peek_vertex_node(v1.key.a, v2.key.a);
+          key.kind = node ? PR_VERTEX : PR_NEW_VERTEX;
+          key.a = node ? node->id : std::min(v1.key.a, v2.key.a);
+          key.b = node ? 0 : std::max(v1.key.a, v2.key.a);
+        }
+        else
+          this->num_private_keys++;
+
+        Vertex vertex = { key, -(add_event(key, PR_GET_VERTEX, refs, bnd, 0, v1.handle, v2.handle) + 1) };
+        return vertex;
+      }
+
+      /// HashTable::get_edge_node() and the reference of the son, returns the event.
+      int get_edge(const Vertex& v1, const Vertex& v2, int son, int bnd, int marker)
+      {
+        ParallelRefinementKey key = { PR_PRIVATE_EDGE, this->refinement_index, 0, std::min(v1.handle, v2.handle), std::max(v1.handle, v2.handle) };
+        Node* node = nullptr;
+        if (v1.key.kind == PR_VERTEX && v2.key.kind == PR_VERTEX)
+          node = mesh->peek_edge_node(v1.key.a, v2.key.a);
+
+        if (node)
+        {
+          key.kind = PR_EDGE;
+          key.a = node->id;
+          key.b = key.c = key.d = 0;
+        }
+        else if ((v1.key.kind == PR_VERTEX || v1.key.kind == PR_NEW_VERTEX) && (v2.key.kind == PR_VERTEX || v2.key.kind == PR_NEW_VERTEX))
+        {
+          int a = v1.key.a, b = (v1.key.kind == PR_VERTEX) ? -1 : v1.key.b;
+          int c = v2.key.a, d = (v2.key.kind == PR_VERTEX) ? -1 : v2.key.b;
+          if (a > c || (a == c && b > d))
+          {
+            std::swap(a, c);
+            std::swap(b, d);
+          }
+          key.kind = PR_NEW_EDGE;
+          key.a = a;
+          key.b = b;
+          key.c = c;
+          key.d = d;
+        }
+
+        return add_event(key, PR_GET_EDGE, son, bnd, marker, v1.handle, v2.handle);
+      }
+
+      /// Node::unref_element() of an edge node of the refined element.
+      void unref_edge(Node* edge_node, int element_id, int bnd, int marker)
+      {
+        ParallelRefinementKey key = { PR_EDGE, edge_node->id, 0, 0, 0 };
+        add_event(key, PR_UNREF_EDGE, element_id, bnd, marker, 0, 0);
+      }
+
+      /// Mesh::create_quad() / create_triangle(), the bits of 'edges_set' are the son's edges lying on the edge
+      /// of the refined element with the same index (their boundary flags and markers are set from it).
+      void create_son(int slot, int nvert, const Vertex* vertices, int edges_set, const int* bnd, const int* mrk)
+      {
+        ParallelRefinementPlan& plan = *this->current_plan;
+        int son_i = plan.num_sons++;
+        plan.son_slots[son_i] = slot;
+        for (int i = 0; i < nvert; i++)
+        {
+          plan.son_vertices[son_i][i] = vertices[i].handle;
+          bool set = (edges_set >> i) & 1;
+          plan.son_edges[son_i][i] = get_edge(vertices[i], vertices[(i + 1) % nvert], plan.son_begin + son_i, set ? bnd[i] : -1, set ? mrk[i] : 0);
+        }
+      }
+
+      int add_event(const ParallelRefinementKey& key, int type, int value, int bnd, int marker, int p1, int p2)
+      {
+        ParallelRefinementEvent& ev = this->events[this->next_event];
+        ev.key = key;
+        ev.type = type;
+        ev.value = value;
+        ev.bnd = bnd;
+        ev.marker = marker;
+        ev.p1 = p1;
+        ev.p2 = p2;
+        ev.action = PR_NONE;
+        ev.instance = 0;
+        this->bucket_events[key.hash() % this->num_buckets].push_back(this->next_event);
+        return this->next_event++;
+      }
+
+      const Mesh* mesh;
+      ParallelRefinementEvent* events;
+      int num_buckets;
+      std::vector<int>* bucket_events;
+
+      ParallelRefinementPlan* current_plan;
+      int next_event;
+      int refinement_index;
+      int num_private_keys;
+    };
+
+    void Mesh::refine_elements_id(const std::vector<int>& elem_ids, const std::vector<int>& refinements, int num_threads)
+    {
+      if (elem_ids.size() != refinements.size())
+        throw Hermes::Exceptions::LengthException(1, 2, elem_ids.size(), refinements.size());
+
+      // The refinements done in parallel: elements active before, each refined once, straight, to four / two quads
+      // or to four triangles. Anything else is left to refine_element_id() including its errors.
+      bool parallel = (num_threads > 1);
+      std::vector<int> ids, refs;
+      std::vector<bool> refined(parallel ? this->elements.get_size() : 0, false);
+      for (unsigned int i = 0; i < elem_ids.size() && parallel; i++)
+      {
+        if (refinements[i] == -1)
+          continue;
+        int id = elem_ids[i];
+        if (id < 0 || id >= (int)this->elements.get_size() || refinements[i] < 0 || refinements[i] > 2)
+        {
+          parallel = false;
+          break;
+        }
+        Element* e = this->get_element_fast(id);
+        if (!e->used || !e->active || e->cm || refined[id])
+          parallel = false;
+        refined[id] = true;
+        ids.push_back(id);
+        refs.push_back(refinements[i]);
+      }
+
+      int num_refinements = ids.size();
+      if (!parallel || num_refinements < num_threads)
+      {
+        for (unsigned int i = 0; i < elem_ids.size(); i++)
+          this->refine_element_id(elem_ids[i], refinements[i]);
+        return;
+      }
+
+      // Partitions of the refinements (one per thread), and the buckets of nodes (one per thread) the events are merged in.
+      int num_partitions = num_threads, num_buckets = num_threads;
+      std::vector<int> partition_begin(num_partitions + 1);
+      for (int p = 0; p <= num_partitions; p++)
+        partition_begin[p] = (int)(((long long)num_refinements * p) / num_partitions);
+
+      // Count: the events and sons of each partition, the prefix sums give their ranges in the batch.
+      std::vector<int> partition_events(num_partitions + 1, 0), partition_sons(num_partitions + 1, 0);
+#pragma omp parallel for num_threads(num_threads)
+      for (int p = 0; p < num_partitions; p++)
+      {
+        for (int k = partition_begin[p]; k < partition_begin[p + 1]; k++)
+        {
+          Element* e = this->get_element_fast(ids[k]);
+          partition_events[p + 1] += ParallelRefinement::get_num_events(e, refs[k]);
+          partition_sons[p + 1] += ParallelRefinement::get_num_sons(e, refs[k]);
+        }
+      }
+      for (int p = 0; p < num_partitions; p++)
+      {
+        partition_events[p + 1] += partition_events[p];
+        partition_sons[p + 1] += partition_sons[p];
+      }
+      int num_events = partition_events[num_partitions], num_sons = partition_sons[num_partitions];
+
+      // Plan: the events of all refinements (reading the mesh only).
+      std::vector<ParallelRefinementEvent> events(num_events);
+      std::vector<ParallelRefinementPlan> plans(num_refinements);
+      std::vector<std::vector<std::vector<int> > > partition_bucket_events(num_partitions, std::vector<std::vector<int> >(num_buckets));
+#pragma omp parallel for num_threads(num_threads)
+      for (int p = 0; p < num_partitions; p++)
+      {
+        ParallelRefinement planner(this, &events[0], num_buckets, &partition_bucket_events[p][0]);
+        int event_begin = partition_events[p], son_begin = partition_sons[p];
+        for (int k = partition_begin[p]; k < partition_begin[p + 1]; k++)
+        {
+          ParallelRefinementPlan& plan = plans[k];
+          plan.element_id = ids[k];
+          plan.refinement = refs[k];
+          plan.event_begin = event_begin;
+          plan.son_begin = son_begin;
+          planner.plan(plan, k);
+          event_begin += ParallelRefinement::get_num_events(this->get_element_fast(ids[k]), refs[k]);
+          son_begin += plan.num_sons;
+        }
+      }
+
+      // Merge: the events of every node in the serial order, in buckets by the nodes.
+      std::vector<std::vector<ParallelRefinementNode> > final_nodes(num_buckets);
+      std::vector<char> bucket_merged(num_buckets);
+#pragma omp parallel for num_threads(num_threads)
+      for (int b = 0; b < num_buckets; b++)
+      {
+        std::vector<int> bucket_events;
+        for (int p = 0; p < num_partitions; p++)
+          bucket_events.insert(bucket_events.end(), partition_bucket_events[p][b].begin(), partition_bucket_events[p][b].end());
+        bucket_merged[b] = ParallelRefinement::merge_bucket(this, &events[0], num_buckets, bucket_events, final_nodes[b]);
+      }
+      for (int b = 0; b < num_buckets; b++)
+      {
+        if (!bucket_merged[b])
+        {
+          for (unsigned int i = 0; i < elem_ids.size(); i++)
+            this->refine_element_id(elem_ids[i], refinements[i]);
+          return;
+        }
+      }
+
+      // Count the node creations / removals of each partition, the prefix sums give their ranges in the batch.
+      std::vector<int> partition_actions(num_partitions + 1, 0);
+#pragma omp parallel for num_threads(num_threads)
+      for (int p = 0; p < num_partitions; p++)
+      for (int i = partition_events[p]; i < partition_events[p + 1]; i++)
+      {
+        if (events[i].action != PR_NONE)
+          partition_actions[p + 1]++;
+      }
+      for (int p = 0; p < num_partitions; p++)
+        partition_actions[p + 1] += partition_actions[p];
+      std::vector<int> actions(partition_actions[num_partitions]);
+#pragma omp parallel for num_threads(num_threads)
+      for (int p = 0; p < num_partitions; p++)
+      {
+        int action_i = partition_actions[p];
+        for (int i = partition_events[p]; i < partition_events[p + 1]; i++)
+        {
+          if (events[i].action != PR_NONE)
+            actions[action_i++] = i;
+        }
+      }
+
+      // Assign the ids: the arrays (and their lists of unused items) change in the serial order.
+      std::vector<int> event_node_ids(num_events, -1), created_events;
+      for (unsigned int action_i = 0; action_i < actions.size(); action_i++)
+      {
+        int event_i = actions[action_i];
+        ParallelRefinementEvent& ev = events[event_i];
+        if (ev.action == PR_CREATE)
+        {
+          event_node_ids[event_i] = this->nodes.add()->id;
+          created_events.push_back(event_i);
+          continue;
+        }
+
+        int id = ParallelRefinement::get_node_id(&events[0], event_node_ids, -(event_i + 1));
+        if (ev.instance < 0)
+        {
+          // Created and removed by the refinements, never gets into the hash table.
+          this->nodes.remove(id);
+          events[-ev.instance - 1].action = PR_NONE;
+        }
+        else if (ev.key.is_edge())
+          this->remove_edge_node(id);
+        else
+          this->remove_vertex_node(id);
+      }
+      std::vector<int> son_ids(num_sons);
+      for (int son_i = 0; son_i < num_sons; son_i++)
+        son_ids[son_i] = this->elements.add()->id;
+
+      // Fill in the nodes.
+#pragma omp parallel for num_threads(num_threads)
+      for (int b = 0; b < num_buckets; b++)
+      {
+        for (unsigned int i = 0; i < final_nodes[b].size(); i++)
+        {
+          const ParallelRefinementNode& final_node = final_nodes[b][i];
+          if (!final_node.alive)
+            continue;
+          Node* node = this->get_node(ParallelRefinement::get_node_id(&events[0], event_node_ids, final_node.instance));
+          if (final_node.instance < 0)
+          {
+            const ParallelRefinementEvent& creating_event = events[-final_node.instance - 1];
+            node->type = final_node.key.is_edge() ? HERMES_TYPE_EDGE : HERMES_TYPE_VERTEX;
+            node->p1 = ParallelRefinement::get_node_id(&events[0], event_node_ids, creating_event.p1);
+            node->p2 = ParallelRefinement::get_node_id(&events[0], event_node_ids, creating_event.p2);
+            if (node->p1 > node->p2)
+              std::swap(node->p1, node->p2);
+          }
+          node->ref = final_node.ref;
+          node->bnd = final_node.bnd;
+          if (final_node.key.is_edge())
+          {
+            node->marker = final_node.marker;
+            for (int j = 0; j < 2; j++)
+            {
+              int elem = final_node.elem[j];
+              node->elem[j] = (elem == -1) ? nullptr : this->get_element_fast(elem >= 0 ? elem : son_ids[-elem - 2]);
+            }
+          }
+          else if (final_node.instance < 0)
+            ParallelRefinement::get_coordinates(this, &events[0], final_node.instance, node->x, node->y);
+        }
+      }
+
+      std::vector<int> created_node_ids;
+      for (unsigned int i = 0; i < created_events.size(); i++)
+      {
+        if (events[created_events[i]].action == PR_CREATE)
+          created_node_ids.push_back(event_node_ids[created_events[i]]);
+      }
+      this->insert_nodes(created_node_ids, num_threads);
+
+      // Fill in the sons and deactivate the refined elements.
+#pragma omp parallel for num_threads(num_threads)
+      for (int k = 0; k < num_refinements; k++)
+      {
+        const ParallelRefinementPlan& plan = plans[k];
+        Element* e = this->get_element_fast(plan.element_id);
+        Element* sons[H2D_MAX_ELEMENT_SONS] = { nullptr, nullptr, nullptr, nullptr };
+        for (int son_i = 0; son_i < plan.num_sons; son_i++)
+        {
+          Element* son = this->get_element_fast(son_ids[plan.son_begin + son_i]);
+          son->active = 1;
+          son->marker = e->marker;
+          son->nvert = e->nvert;
+          son->iro_cache = e->iro_cache;
+          son->cm = nullptr;
+          son->parent = e;
+          son->visited = false;
+          for (int i = 0; i < e->nvert; i++)
+          {
+            son->vn[i] = this->get_node(ParallelRefinement::get_node_id(&events[0], event_node_ids, plan.son_vertices[son_i][i]));
+            son->en[i] = this->get_node(ParallelRefinement::get_node_id(&events[0], event_node_ids, -(plan.son_edges[son_i][i] + 1)));
+          }
+          son->calc_area();
+          son->calc_diameter();
+          sons[plan.son_slots[son_i]] = son;
+        }
+
+        e->active = 0;
+        e->calc_area();
+        e->calc_diameter();
+        memcpy(e->sons, sons, sizeof(sons));
+      }
+
+      for (int k = 0; k < num_refinements; k++)
+      {
+        this->nactive += plans[k].num_sons - 1;
+        this->refinements.push_back(std::pair<unsigned int, int>(plans[k].element_id, plans[k].refinement));
+      }
+
+#pragma omp critical (g_mesh_seq)
+      this->seq = g_mesh_seq++;
+    }
+
     void Mesh::refine_all_elements(int refinement, bool mark_as_initial)
     {
       ninitial = this->get_max_element_id();
@@ -1264,6 +2016,12 @@ namespace Hermes
       if (this->meshHashGrid)
         delete this->meshHashGrid;
 
+      if (this->meshFaceTable)
+      {
+        delete this->meshFaceTable;
+        this->meshFaceTable = nullptr;
+      }
+
       this->boundary_markers_conversion.conversion_table.clear();
       this->boundary_markers_conversion.conversion_table_inverse.clear();
       this->element_markers_conversion.conversion_table.clear();
@@ -1652,7 +2410,7 @@ namespace Hermes
       // update coefficients of curved reference mapping
       for (int i = 0; i < 3; i++)
         if (sons[i]->is_curved())
-          sons[i]->cm->update_refmap_coeffs(sons[i]);
+          this->update_curved_son(sons[i]);
 
       // deactivate this element and unregister from its nodes
       e->active = 0;
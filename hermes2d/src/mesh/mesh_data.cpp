@@ -149,7 +149,273 @@ namespace Hermes
       return temp;
     }
 
+    void MeshData::clear()
+    {
+      vars_.clear();
+      x_vertex.clear(); y_vertex.clear();
+      en1.clear(); en2.clear(); en3.clear(); en4.clear();
+      e_mtl.clear();
+      bdy_first.clear(); bdy_second.clear();
+      bdy_type.clear();
+      curv_first.clear(); curv_second.clear();
+      curv_third.clear();
+      curv_inner_pts.clear();
+      curv_knots.clear();
+      curv_nurbs.clear();
+      ref_elt.clear();
+      ref_type.clear();
+    }
+
+    /// Characters ending a token in parse_mesh_fast().
+    static inline bool is_mesh_delimiter(char c)
+    {
+      return c == '\0' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ';' || c == '[' || c == ']' || c == '{' || c == '}' || c == '#' || c == '=';
+    }
+
+    static inline bool read_mesh_int(const char*& p, int& value)
+    {
+      char* end;
+      long v = strtol(p, &end, 10);
+      if (end == p || !is_mesh_delimiter(*end))
+        return false;
+      value = (int)v;
+      p = end;
+      return true;
+    }
+
+    static inline bool read_mesh_double(const char*& p, double& value)
+    {
+      char* end;
+      double v = strtod(p, &end);
+      if (end == p || !is_mesh_delimiter(*end))
+        return false;
+      value = v;
+      p = end;
+      return true;
+    }
+
+    static inline bool read_mesh_word(const char*& p, std::string& word)
+    {
+      if (*p == '"')
+      {
+        const char* end = strchr(p + 1, '"');
+        if (!end)
+          return false;
+        word.assign(p + 1, end);
+        p = end + 1;
+        return true;
+      }
+
+      const char* end = p;
+      while (!is_mesh_delimiter(*end))
+        end++;
+      // Unquoted words separated by single blank spaces form one marker in the generic parser.
+      if (*end == ' ' && !is_mesh_delimiter(*(end + 1)))
+        return false;
+      word.assign(p, end);
+      p = end;
+      return true;
+    }
+
+    bool MeshData::parse_mesh_fast()
+    {
+      FILE* f = fopen(mesh_file_.c_str(), "rb");
+      if (!f)
+        return false;
+      fseek(f, 0, SEEK_END);
+      long size = ftell(f);
+      fseek(f, 0, SEEK_SET);
+      if (size < 0)
+      {
+        fclose(f);
+        return false;
+      }
+      std::vector<char> buffer(size + 1);
+      size_t read_size = fread(&buffer[0], 1, size, f);
+      fclose(f);
+      buffer[read_size] = '\0';
+
+      enum Section { NoSection, Vertices, Elements, Boundaries, Curves, Refinements } section = NoSection;
+      // Position in the current section, as in parse_mesh_generic().
+      int counter = 0;
+      int int_value;
+      double double_value;
+      std::string word;
+
+      const char* p = &buffer[0];
+      while (true)
+      {
+        // Skip separators and comments.
+        while (*p)
+        {
+          if (*p == '#')
+          {
+            while (*p && *p != '\n')
+              p++;
+          }
+          else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == ',' || *p == ';' || *p == '[' || *p == ']' || *p == '{' || *p == '}')
+            p++;
+          else
+            break;
+        }
+        if (!*p)
+          break;
+
+        // Section header.
+        if (isalpha(*p) || *p == '_')
+        {
+          const char* end = p;
+          while (!is_mesh_delimiter(*end))
+            end++;
+          const char* next = end;
+          while (*next == ' ' || *next == '\t' || *next == '\r' || *next == '\n')
+            next++;
+          if (*next == '=')
+          {
+            std::string name(p, end);
+            if (name == "vertices")
+              section = Vertices;
+            else if (name == "elements")
+              section = Elements;
+            else if (name == "boundaries")
+              section = Boundaries;
+            else if (name == "curves")
+              section = Curves;
+            else if (name == "refinements")
+              section = Refinements;
+            else
+              // Variables.
+              return false;
+            counter = 0;
+            p = next + 1;
+            continue;
+          }
+        }
+        if (*p == '=' || section == NoSection)
+          return false;
+
+        switch (section)
+        {
+        case Vertices:
+          if (!read_mesh_double(p, double_value))
+            return false;
+          (counter % 2 == 0 ? x_vertex : y_vertex).push_back(double_value);
+          counter++;
+          break;
+        case Elements:
+          switch (counter % 5)
+          {
+          case 0:
+          case 1:
+          case 2:
+            if (!read_mesh_int(p, int_value))
+              return false;
+            (counter % 5 == 0 ? en1 : (counter % 5 == 1 ? en2 : en3)).push_back(int_value);
+            counter++;
+            break;
+          case 3:
+            // Either the fourth vertex of a quad, or the marker of a triangle.
+            if (read_mesh_int(p, int_value))
+            {
+              en4.push_back(int_value);
+              counter++;
+            }
+            else
+            {
+              if (!read_mesh_word(p, word))
+                return false;
+              en4.push_back(-1);
+              e_mtl.push_back(word);
+              counter += 2;
+            }
+            break;
+          default:
+            if (!read_mesh_word(p, word))
+              return false;
+            e_mtl.push_back(word);
+            counter++;
+          }
+          break;
+        case Boundaries:
+          if (counter % 3 < 2)
+          {
+            if (!read_mesh_int(p, int_value))
+              return false;
+            (counter % 3 == 0 ? bdy_first : bdy_second).push_back(int_value);
+          }
+          else
+          {
+            if (!read_mesh_word(p, word))
+              return false;
+            bdy_type.push_back(word);
+          }
+          counter++;
+          break;
+        case Curves:
+          // Only circular arcs, NURBS curves refer to variables.
+          if (counter % 3 < 2)
+          {
+            if (!read_mesh_int(p, int_value))
+              return false;
+            (counter % 3 == 0 ? curv_first : curv_second).push_back(int_value);
+          }
+          else
+          {
+            if (!read_mesh_double(p, double_value))
+              return false;
+            curv_third.push_back(double_value);
+            curv_nurbs.push_back(false);
+            curv_inner_pts.push_back("none");
+            curv_knots.push_back("none");
+          }
+          counter++;
+          break;
+        case Refinements:
+          if (!read_mesh_int(p, int_value))
+            return false;
+          (counter % 2 == 0 ? ref_elt : ref_type).push_back(int_value);
+          counter++;
+          break;
+        default:
+          return false;
+        }
+      }
+
+      return x_vertex.size() == y_vertex.size() && en1.size() == en4.size() && en4.size() == e_mtl.size()
+        && bdy_first.size() == bdy_type.size() && curv_first.size() == curv_third.size() && ref_elt.size() == ref_type.size();
+    }
+
     void MeshData::parse_mesh(void)
+    {
+      // Files without variables are parsed in one pass, the generic parser is only used otherwise.
+      if (!parse_mesh_fast())
+      {
+        clear();
+        parse_mesh_generic();
+      }
+
+      assert(x_vertex.size() == y_vertex.size());
+      n_vert = x_vertex.size();
+
+      assert(en1.size() == en2.size());
+      assert(en2.size() == en3.size());
+      assert(en3.size() == en4.size());
+      assert(en4.size() == e_mtl.size());
+      n_el = en1.size();
+
+      assert(bdy_first.size() == bdy_second.size());
+      assert(bdy_first.size() == bdy_type.size());
+      n_bdy = bdy_first.size();
+
+      assert(curv_first.size() == curv_second.size());
+
+      n_curv = curv_first.size();
+
+      assert(ref_elt.size() == ref_type.size());
+      n_ref = ref_elt.size();
+    }
+
+    void MeshData::parse_mesh_generic()
     {
       int dummy_int;
       double dummy_dbl;
@@ -466,26 +732,6 @@ namespace Hermes
           }
         }
       }
-
-      assert(x_vertex.size() == y_vertex.size());
-      n_vert = x_vertex.size();
-
-      assert(en1.size() == en2.size());
-      assert(en2.size() == en3.size());
-      assert(en3.size() == en4.size());
-      assert(en4.size() == e_mtl.size());
-      n_el = en1.size();
-
-      assert(bdy_first.size() == bdy_second.size());
-      assert(bdy_first.size() == bdy_type.size());
-      n_bdy = bdy_first.size();
-
-      assert(curv_first.size() == curv_second.size());
-
-      n_curv = curv_first.size();
-
-      assert(ref_elt.size() == ref_type.size());
-      n_ref = ref_elt.size();
     }
   }
 }
\ No newline at end of file
@@ -199,7 +199,6 @@ namespace Hermes
         node->type = HERMES_TYPE_VERTEX;
         node->bnd = 0;
         node->p1 = node->p2 = -1;
-        node->next_hash = nullptr;
         node->x = m.x_vertex[i];
         node->y = m.y_vertex[i];
       }
@@ -220,7 +219,7 @@ namespace Hermes
         if (m.en4[i] == -1)  nv = 4;
         else nv = 5;
 
-        int* idx = new int[nv - 1];
+        int idx[4];
         std::string el_marker;
         if (!nv) {
           mesh->elements.skip_slot()->cm = nullptr;
@@ -229,7 +228,6 @@ namespace Hermes
 
         if (nv < 4 || nv > 5)
         {
-          delete[] idx;
           throw Hermes::Exceptions::MeshLoadFailureException("File %s: element #%d: wrong number of vertex indices.", filename, i);
         }
 
@@ -251,7 +249,6 @@ namespace Hermes
         for (j = 0; j < nv - 1; j++)
           if (idx[j] < 0 || idx[j] >= mesh->ntopvert)
           {
-          delete[] idx;
           throw Hermes::Exceptions::MeshLoadFailureException("File %s: error creating element #%d: vertex #%d does not exist.", filename, i, idx[j]);
           }
 
@@ -275,8 +272,6 @@ namespace Hermes
         }
 
         mesh->nactive++;
-
-        delete[] idx;
       }
       mesh->nbase = n;
 
@@ -348,6 +343,11 @@ namespace Hermes
         this->ref_map.set_element_iro_cache(e);
       }
 
+      // space-filling curve ordering of base elements
+      std::vector<int> new_ids;
+      if (HermesCommonApi.get_integral_param_value(spaceFillingCurveOrdering))
+        mesh->reorder_base_elements(new_ids);
+
       //// refinements /////////////////////////////////////////////////////////////
       if (m.n_ref > 0)
       {
@@ -360,6 +360,9 @@ namespace Hermes
           int id, ref;
           id = m.ref_elt[i];
           ref = m.ref_type[i];
+          // base element ids in the file refer to the original numbering, ids of sons are unchanged
+          if (id >= 0 && id < (int)new_ids.size())
+            id = new_ids[id];
           mesh->refine_element_id(id, ref);
         }
       }
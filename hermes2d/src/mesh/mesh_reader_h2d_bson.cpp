@@ -101,7 +101,6 @@ namespace Hermes
         node->type = HERMES_TYPE_VERTEX;
         node->bnd = 0;
         node->p1 = node->p2 = -1;
-        node->next_hash = nullptr;
         node->x = vertex_xes[vertex_i];
         node->y = vertex_yes[vertex_i];
       }
@@ -865,7 +864,6 @@ namespace Hermes
             node->type = HERMES_TYPE_VERTEX;
             node->bnd = 0;
             node->p1 = node->p2 = -1;
-            node->next_hash = nullptr;
 
             // assignment.
             node->x = vertices[vertex_number].x;
@@ -1137,7 +1135,6 @@ namespace Hermes
         node->type = HERMES_TYPE_VERTEX;
         node->bnd = 0;
         node->p1 = node->p2 = -1;
-        node->next_hash = nullptr;
 
         if (vertices[vertex_i].i > H2D_MAX_NODE_ID - 1)
           throw Exceptions::MeshLoadFailureException("The index 'i' of vertex in the mesh file must be lower than %i.", H2D_MAX_NODE_ID);
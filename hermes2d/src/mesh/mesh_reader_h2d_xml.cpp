@@ -66,6 +66,11 @@ namespace Hermes
         // load
         load(parsed_xml_mesh, mesh, vertex_is);
 
+        // space-filling curve ordering of base elements
+        std::vector<int> new_ids;
+        if (HermesCommonApi.get_integral_param_value(spaceFillingCurveOrdering))
+          mesh->reorder_base_elements(new_ids);
+
         // refinements.
         if (parsed_xml_mesh->refinements().present() && parsed_xml_mesh->refinements()->ref().size() > 0)
         {
@@ -73,6 +78,9 @@ namespace Hermes
           for (unsigned int i = 0; i < parsed_xml_mesh->refinements()->ref().size(); i++)
           {
             int element_id = parsed_xml_mesh->refinements()->ref().at(i).element_id();
+            // base element ids in the file refer to the original numbering, ids of sons are unchanged
+            if (element_id >= 0 && element_id < (int)new_ids.size())
+              element_id = new_ids[element_id];
             int refinement_type = parsed_xml_mesh->refinements()->ref().at(i).refinement_type();
             if (refinement_type == -1)
               mesh->unrefine_element_id(element_id);
@@ -303,7 +311,6 @@ namespace Hermes
               node->type = HERMES_TYPE_VERTEX;
               node->bnd = 0;
               node->p1 = node->p2 = -1;
-              node->next_hash = nullptr;
 
               // variables matching.
               std::string x = parsed_xml_domain->vertices().v().at(vertex_number).x();
@@ -774,7 +781,6 @@ namespace Hermes
           node->type = HERMES_TYPE_VERTEX;
           node->bnd = 0;
           node->p1 = node->p2 = -1;
-          node->next_hash = nullptr;
 
           // variables matching.
           std::string x = parsed_xml_mesh->vertices().v().at(vertex_i).x();
@@ -1001,7 +1007,6 @@ namespace Hermes
           node->type = HERMES_TYPE_VERTEX;
           node->bnd = 0;
           node->p1 = node->p2 = -1;
-          node->next_hash = nullptr;
 
           // variables matching.
           std::string x = parsed_xml_domain->vertices().v().at(vertex_i).x();
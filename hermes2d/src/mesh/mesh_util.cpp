@@ -92,6 +92,57 @@ namespace Hermes
       }
     }
 
+    void MeshUtil::space_filling_curve_order(const double* x, const double* y, int count, int* order)
+    {
+      if (count == 0)
+        return;
+
+      double x_min = x[0], x_max = x[0], y_min = y[0], y_max = y[0];
+      for (int i = 1; i < count; i++)
+      {
+        x_min = std::min(x_min, x[i]);
+        x_max = std::max(x_max, x[i]);
+        y_min = std::min(y_min, y[i]);
+        y_max = std::max(y_max, y[i]);
+      }
+
+      // Points are mapped onto a grid of 2^16 x 2^16 cells of the (square) bounding box.
+      const unsigned int grid_size = 1 << 16;
+      double box_size = std::max(x_max - x_min, y_max - y_min);
+      double scale = box_size > 0. ? (grid_size - 1) / box_size : 0.;
+
+      std::vector<std::pair<uint64_t, int> > keys(count);
+      for (int i = 0; i < count; i++)
+      {
+        unsigned int ix = (unsigned int)((x[i] - x_min) * scale);
+        unsigned int iy = (unsigned int)((y[i] - y_min) * scale);
+
+        // Distance along the Hilbert curve.
+        uint64_t d = 0;
+        for (unsigned int s = grid_size / 2; s > 0; s /= 2)
+        {
+          unsigned int rx = (ix & s) > 0;
+          unsigned int ry = (iy & s) > 0;
+          d += (uint64_t)s * s * ((3 * rx) ^ ry);
+          if (ry == 0)
+          {
+            if (rx == 1)
+            {
+              ix = grid_size - 1 - ix;
+              iy = grid_size - 1 - iy;
+            }
+            std::swap(ix, iy);
+          }
+        }
+        keys[i] = std::pair<uint64_t, int>(d, i);
+      }
+
+      // Ties are broken by the original index, so that the order is deterministic.
+      std::sort(keys.begin(), keys.end());
+      for (int i = 0; i < count; i++)
+        order[i] = keys[i].second;
+    }
+
     Node* MeshUtil::get_base_edge_node(Element* base, int edge)
     {
       while (!base->active) // we need to go down to an active element
@@ -165,18 +165,25 @@ namespace Hermes
     {
       int i, j, np = quad_2d->get_num_points(order, element->get_mode());
 
-      // construct jacobi matrices of the direct reference map for all integration points
-      ref_map_pss.force_transform(sub_idx, ctm);
-
       double* m_00 = this->direct_ref_map[0][0];
       double* m_01 = this->direct_ref_map[0][1];
       double* m_10 = this->direct_ref_map[1][0];
       double* m_11 = this->direct_ref_map[1][1];
 
-      for (j = 0; j < np; j++)
-        m_00[j] = m_01[j] = m_10[j] = m_11[j] = 0.;
+      // construct jacobi matrices of the direct reference map for all integration points
+      // curvilinear elements: the polynomial form gives the physical coordinates too
+      bool poly_calculated = calc_poly_ref_map(order, this->phys_x, this->phys_y, m_00, m_01, m_10, m_11);
+      if (poly_calculated)
+        this->phys_x_calculated = this->phys_y_calculated = order;
+      else
+      {
+        ref_map_pss.force_transform(sub_idx, ctm);
 
-      for (i = 0; i < nc; i++)
+        for (j = 0; j < np; j++)
+          m_00[j] = m_01[j] = m_10[j] = m_11[j] = 0.;
+      }
+
+      for (i = 0; i < nc && !poly_calculated; i++)
       {
         double coeff_0 = coeffs[i][0];
         double coeff_1 = coeffs[i][1];
@@ -224,6 +231,26 @@ namespace Hermes
       this->jacobian_calculated = order;
     }
 
+    bool RefMap::calc_poly_ref_map(int order, double* x, double* y, double* x_dxi_1, double* x_dxi_2, double* y_dxi_1, double* y_dxi_2)
+    {
+      if (!element->cm || !element->cm->poly_coeffs)
+        return false;
+
+      unsigned short np = quad_2d->get_num_points(order, element->get_mode());
+      double3* pt = quad_2d->get_points(order, element->get_mode());
+
+      // points of the sub-element in the reference domain of the element
+      double xi_1[H2D_MAX_INTEGRATION_POINTS_COUNT], xi_2[H2D_MAX_INTEGRATION_POINTS_COUNT];
+      for (unsigned short k = 0; k < np; k++)
+      {
+        xi_1[k] = ctm->m[0] * pt[k][0] + ctm->t[0];
+        xi_2[k] = ctm->m[1] * pt[k][1] + ctm->t[1];
+      }
+
+      element->cm->calc_poly_ref_map(np, xi_1, xi_2, x, y, x_dxi_1, x_dxi_2, y_dxi_1, y_dxi_2);
+      return true;
+    }
+
     void RefMap::calc_const_inv_ref_map()
     {
       int k = element->is_triangle() ? 2 : 3;
@@ -246,6 +273,12 @@ namespace Hermes
     {
       // transform all x coordinates of the integration points
       int i, j, np = quad_2d->get_num_points(order, element->get_mode());
+      if (calc_poly_ref_map(order, this->phys_x, this->phys_y, nullptr, nullptr, nullptr, nullptr))
+      {
+        this->phys_x_calculated = this->phys_y_calculated = order;
+        return;
+      }
+
       double* x = this->phys_x;
       memset(x, 0, np * sizeof(double));
       ref_map_pss.force_transform(sub_idx, ctm);
@@ -264,6 +297,12 @@ namespace Hermes
     {
       // transform all y coordinates of the integration points
       int i, j, np = quad_2d->get_num_points(order, element->get_mode());
+      if (calc_poly_ref_map(order, this->phys_x, this->phys_y, nullptr, nullptr, nullptr, nullptr))
+      {
+        this->phys_x_calculated = this->phys_y_calculated = order;
+        return;
+      }
+
       double* y = this->phys_y;
       memset(y, 0, np * sizeof(double));
       ref_map_pss.force_transform(sub_idx, ctm);
@@ -304,9 +343,24 @@ namespace Hermes
         // construct jacobi matrices of the direct reference map at integration points along the edge
         double2x2 m[15];
         assert(np <= 15);
-        memset(m, 0, np*sizeof(double2x2));
-        ref_map_pss.force_transform(sub_idx, ctm);
-        for (i = 0; i < nc; i++)
+        double x[15], y[15], m_00[15], m_01[15], m_10[15], m_11[15];
+        bool poly_calculated = calc_poly_ref_map(eo, x, y, m_00, m_01, m_10, m_11);
+        if (poly_calculated)
+        {
+          for (j = 0; j < np; j++)
+          {
+            m[j][0][0] = m_00[j];
+            m[j][0][1] = m_01[j];
+            m[j][1][0] = m_10[j];
+            m[j][1][1] = m_11[j];
+          }
+        }
+        else
+        {
+          memset(m, 0, np*sizeof(double2x2));
+          ref_map_pss.force_transform(sub_idx, ctm);
+        }
+        for (i = 0; i < nc && !poly_calculated; i++)
         {
           ref_map_pss.set_active_shape(indices[i]);
           ref_map_pss.set_quad_order(eo);
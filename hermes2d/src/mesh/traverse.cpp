@@ -289,6 +289,26 @@ namespace Hermes
       return this->get_states(meshes, states_count);
     }
 
+    void Traverse::reorder_states(State** states, int count)
+    {
+      double* x = malloc_with_check<double>(count);
+      double* y = malloc_with_check<double>(count);
+      for (int i = 0; i < count; i++)
+        states[i]->rep->get_center(x[i], y[i]);
+
+      int* order = malloc_with_check<int>(count);
+      MeshUtil::space_filling_curve_order(x, y, count, order);
+      free_with_check(x);
+      free_with_check(y);
+
+      State** original_states = malloc_with_check<State*>(count);
+      memcpy(original_states, states, count * sizeof(State*));
+      for (int i = 0; i < count; i++)
+        states[i] = original_states[order[i]];
+      free_with_check(original_states);
+      free_with_check(order);
+    }
+
     Traverse::State** Traverse::get_states(std::vector<MeshSharedPtr> meshes, unsigned int& states_count)
     {
       return Traverse::get_states(&meshes[0], meshes.size(), states_count);
@@ -335,6 +355,8 @@ namespace Hermes
             {
               this->finish();
               states_count = count;
+              if (HermesCommonApi.get_integral_param_value(spaceFillingCurveOrdering))
+                this->reorder_states(states, count);
               return states;
             }
 
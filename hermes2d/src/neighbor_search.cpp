@@ -179,6 +179,10 @@ namespace Hermes
       reset_neighb_info();
       active_edge = edge;
 
+      // Precomputed neighborhood.
+      if (this->set_active_edge_from_face_table())
+        return;
+
       if (!this->ignore_errors && central_el->en[active_edge]->bnd == 1)
         throw Hermes::Exceptions::Exception("The given edge isn't inner");
       else
@@ -263,6 +267,57 @@ namespace Hermes
       }
     }
 
+    template<typename Scalar>
+    bool NeighborSearch<Scalar>::set_active_edge_from_face_table()
+    {
+      const MeshFaceTable* face_table = this->mesh->meshFaceTable;
+      if (!face_table || face_table->get_mesh_seq() != this->mesh->get_seq())
+        return false;
+
+      int num_faces, type;
+      const MeshFaceTable::Face* faces = face_table->get_faces(central_el->id, active_edge, num_faces, type);
+      if (!faces)
+        return false;
+
+      // The same state as the search leaves, see find_act_elem_up(), find_act_elem_down().
+      for (int neighbor_i = 0; neighbor_i < num_faces; neighbor_i++)
+      {
+        const MeshFaceTable::Face& face = faces[neighbor_i];
+        neighb_el = face.neighbor;
+        neighbor_edge.local_num_of_edge = face.neighbor_edge;
+
+        NeighborEdgeInfo local_edge_info;
+        local_edge_info.local_num_of_edge = face.neighbor_edge;
+        local_edge_info.orientation = face.orientation;
+        neighbor_edges.push_back(local_edge_info);
+        neighbors.push_back(face.neighbor);
+
+        Transformations* transformations = nullptr;
+        if (type == H2D_DG_GO_DOWN)
+        {
+          if ((neighbor_i >= this->central_transformations_alloc_size) || !central_transformations[neighbor_i])
+            this->add_central_transformations(new Transformations, neighbor_i);
+          transformations = central_transformations[neighbor_i];
+        }
+        else if (type == H2D_DG_GO_UP)
+        {
+          if ((neighbor_i >= this->neighbor_transformations_alloc_size) || !neighbor_transformations[neighbor_i])
+            this->add_neighbor_transformations(new Transformations, neighbor_i);
+          transformations = neighbor_transformations[neighbor_i];
+        }
+        if (transformations)
+        {
+          for (unsigned char level = 0; level < face.num_levels; level++)
+            transformations->transf[level] = face.transf[level];
+          transformations->num_levels = face.num_levels;
+        }
+      }
+
+      n_neighbors = num_faces;
+      neighborhood_type = (NeighborhoodType)type;
+      return true;
+    }
+
     template<typename Scalar>
     bool NeighborSearch<Scalar>::set_active_edge_multimesh(const int& edge)
     {
@@ -1157,6 +1212,134 @@ namespace Hermes
           (*it)->push_transform(transf[i]);
     }
 
+    MeshFaceTable::MeshFaceTable(MeshSharedPtr mesh) : mesh_seq(mesh->get_seq()), faces(nullptr)
+    {
+      this->num_element_ids = mesh->get_max_element_id();
+      int num_edges = this->num_element_ids * H2D_MAX_NUMBER_EDGES;
+      this->edge_faces_ptr = malloc_with_check<int>(num_edges + 1);
+      this->edge_neighborhood_type = malloc_with_check<signed char>(num_edges);
+      memset(this->edge_neighborhood_type, -1, num_edges * sizeof(signed char));
+      int* edge_num_faces = calloc_with_check<int>(num_edges);
+
+      // Active elements, in the order of ids.
+      std::vector<Element*> active_elements;
+      Element* e;
+      for_all_active_elements(e, mesh)
+        active_elements.push_back(e);
+
+      // Each thread searches a contiguous block of elements into its own buffer, the buffers joined in the thread
+      // order then follow the order of the ids.
+      int num_threads = std::max(1, std::min(HermesCommonApi.get_integral_param_value(numThreads), (int)active_elements.size()));
+      std::vector<std::vector<Face> > thread_faces(num_threads);
+
+#pragma omp parallel num_threads(num_threads)
+      {
+        int thread_number = omp_get_thread_num();
+        int start = (active_elements.size() / num_threads) * thread_number;
+        int end = (active_elements.size() / num_threads) * (thread_number + 1);
+        if (thread_number == num_threads - 1)
+          end = active_elements.size();
+
+        for (int element_i = start; element_i < end; element_i++)
+        {
+          Element* central_el = active_elements[element_i];
+          NeighborSearch<double> ns(central_el, mesh);
+          for (int edge = 0; edge < central_el->get_nvert(); edge++)
+          {
+            if (central_el->en[edge]->bnd)
+              continue;
+
+            // Edges where the search fails are left to NeighborSearch (to report the error in its context).
+            try
+            {
+              ns.set_active_edge(edge);
+            }
+            catch (std::exception&)
+            {
+              continue;
+            }
+
+            int edge_index = central_el->id * H2D_MAX_NUMBER_EDGES + edge;
+            edge_num_faces[edge_index] = ns.n_neighbors;
+            this->edge_neighborhood_type[edge_index] = ns.neighborhood_type;
+            for (unsigned int neighbor_i = 0; neighbor_i < ns.n_neighbors; neighbor_i++)
+            {
+              Face face;
+              face.neighbor = ns.neighbors[neighbor_i];
+              face.neighbor_edge = ns.neighbor_edges[neighbor_i].local_num_of_edge;
+              face.orientation = ns.neighbor_edges[neighbor_i].orientation;
+
+              NeighborSearch<double>::Transformations* transformations = nullptr;
+              if (ns.neighborhood_type == NeighborSearch<double>::H2D_DG_GO_DOWN && neighbor_i < ns.central_transformations_alloc_size)
+                transformations = ns.central_transformations[neighbor_i];
+              if (ns.neighborhood_type == NeighborSearch<double>::H2D_DG_GO_UP && neighbor_i < ns.neighbor_transformations_alloc_size)
+                transformations = ns.neighbor_transformations[neighbor_i];
+              face.num_levels = transformations ? transformations->num_levels : 0;
+              for (unsigned char level = 0; level < face.num_levels; level++)
+                face.transf[level] = transformations->transf[level];
+
+              thread_faces[thread_number].push_back(face);
+            }
+          }
+        }
+      }
+
+      this->edge_faces_ptr[0] = 0;
+      for (int edge_index = 0; edge_index < num_edges; edge_index++)
+        this->edge_faces_ptr[edge_index + 1] = this->edge_faces_ptr[edge_index] + edge_num_faces[edge_index];
+      free_with_check(edge_num_faces);
+
+      this->faces = malloc_with_check<Face>(this->edge_faces_ptr[num_edges]);
+      Face* faces_end = this->faces;
+      for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        faces_end = std::copy(thread_faces[thread_i].begin(), thread_faces[thread_i].end(), faces_end);
+    }
+
+    MeshFaceTable::~MeshFaceTable()
+    {
+      free_with_check(this->edge_faces_ptr);
+      free_with_check(this->edge_neighborhood_type);
+      free_with_check(this->faces);
+    }
+
+    MeshFaceTable* MeshFaceTable::get(MeshSharedPtr mesh)
+    {
+      // If no table exists, or the mesh has been refined afterwards, (re-)create.
+      if (mesh->meshFaceTable && mesh->meshFaceTable->get_mesh_seq() != mesh->get_seq())
+      {
+        delete mesh->meshFaceTable;
+        mesh->meshFaceTable = nullptr;
+      }
+      if (!mesh->meshFaceTable)
+        mesh->meshFaceTable = new MeshFaceTable(mesh);
+
+      return mesh->meshFaceTable;
+    }
+
+    const MeshFaceTable::Face* MeshFaceTable::get_faces(int element_id, int edge, int& num_faces, int& neighborhood_type) const
+    {
+      if (element_id < 0 || element_id >= this->num_element_ids || edge < 0 || edge >= H2D_MAX_NUMBER_EDGES)
+        return nullptr;
+
+      int edge_index = element_id * H2D_MAX_NUMBER_EDGES + edge;
+      neighborhood_type = this->edge_neighborhood_type[edge_index];
+      if (neighborhood_type == -1)
+        return nullptr;
+
+      num_faces = this->edge_faces_ptr[edge_index + 1] - this->edge_faces_ptr[edge_index];
+      return this->faces + this->edge_faces_ptr[edge_index];
+    }
+
+    int MeshFaceTable::get_mesh_seq() const
+    {
+      return this->mesh_seq;
+    }
+
+    int MeshFaceTable::get_num_faces() const
+    {
+      return this->edge_faces_ptr[this->num_element_ids * H2D_MAX_NUMBER_EDGES];
+    }
+
     template class HERMES_API NeighborSearch < double > ;
     template class HERMES_API NeighborSearch < std::complex<double> > ;
   }
@@ -282,35 +282,29 @@ namespace Hermes
       template<typename Scalar>
       double H1ProjBasedSelector<Scalar>::evaluate_error_squared_subdomain(Element* sub_elem, const typename ProjBasedSelector<Scalar>::ElemGIP& sub_gip, int son, const typename ProjBasedSelector<Scalar>::ElemSubTrf& sub_trf, const typename ProjBasedSelector<Scalar>::ElemProj& elem_proj, Scalar* rval[H2D_MAX_ELEMENT_SONS][MAX_NUMBER_FUNCTION_VALUES_FOR_SELECTORS])
       {
+        //calculate values of projected solution
+        const int num_gip = sub_gip.num_gip_points;
+        Scalar* proj_value[H2D_H1FE_NUM] = { elem_proj.proj_values, elem_proj.proj_values + num_gip, elem_proj.proj_values + 2 * num_gip };
+        for (int i = 0; i < H2D_H1FE_NUM; i++)
+          ProjBasedSelector<Scalar>::evaluate_projection_expansion(elem_proj, i, num_gip, proj_value[i]);
+
         double total_error_squared = 0;
-        for (int gip_inx = 0; gip_inx < sub_gip.num_gip_points; gip_inx++)
+        for (int gip_inx = 0; gip_inx < num_gip; gip_inx++)
         {
           double3 &gip_pt = sub_gip.gip_points[gip_inx];
 
-          //calculate value of projected solution
-          Scalar proj_value[H2D_H1FE_NUM] = { 0, 0, 0 };
-          for (int i = 0; i < elem_proj.num_shapes; i++)
-          {
-            int shape_inx = elem_proj.shape_inxs[i];
-            proj_value[H2D_H1FE_VALUE] += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_H1FE_VALUE][gip_inx];
-            proj_value[H2D_H1FE_DX] += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_H1FE_DX][gip_inx];
-            proj_value[H2D_H1FE_DY] += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_H1FE_DY][gip_inx];
-          }
+          //get value of ref. solution
+          Scalar ref_value[3];
+          ref_value[H2D_H1FE_VALUE] = rval[son][H2D_H1FE_VALUE][gip_inx];
+          ref_value[H2D_H1FE_DX] = sub_trf.coef_mx * rval[son][H2D_H1FE_DX][gip_inx];
+          ref_value[H2D_H1FE_DY] = sub_trf.coef_my * rval[son][H2D_H1FE_DY][gip_inx];
 
-          {
-            //get value of ref. solution
-            Scalar ref_value[3];
-            ref_value[H2D_H1FE_VALUE] = rval[son][H2D_H1FE_VALUE][gip_inx];
-            ref_value[H2D_H1FE_DX] = sub_trf.coef_mx * rval[son][H2D_H1FE_DX][gip_inx];
-            ref_value[H2D_H1FE_DY] = sub_trf.coef_my * rval[son][H2D_H1FE_DY][gip_inx];
-
-            //evaluate error
-            double error_squared = sqr(proj_value[H2D_H1FE_VALUE] - ref_value[H2D_H1FE_VALUE])
-              + sqr(proj_value[H2D_H1FE_DX] - ref_value[H2D_H1FE_DX])
-              + sqr(proj_value[H2D_H1FE_DY] - ref_value[H2D_H1FE_DY]);
-
-            total_error_squared += gip_pt[H2D_GIP2D_W] * error_squared;
-          }
+          //evaluate error
+          double error_squared = sqr(proj_value[H2D_H1FE_VALUE][gip_inx] - ref_value[H2D_H1FE_VALUE])
+            + sqr(proj_value[H2D_H1FE_DX][gip_inx] - ref_value[H2D_H1FE_DX])
+            + sqr(proj_value[H2D_H1FE_DY][gip_inx] - ref_value[H2D_H1FE_DY]);
+
+          total_error_squared += gip_pt[H2D_GIP2D_W] * error_squared;
         }
 
         return total_error_squared;
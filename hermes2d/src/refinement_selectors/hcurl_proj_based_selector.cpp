@@ -292,37 +292,31 @@ namespace Hermes
       template<typename Scalar>
       double HcurlProjBasedSelector<Scalar>::evaluate_error_squared_subdomain(Element* sub_elem, const typename ProjBasedSelector<Scalar>::ElemGIP& sub_gip, int son, const typename ProjBasedSelector<Scalar>::ElemSubTrf& sub_trf, const typename ProjBasedSelector<Scalar>::ElemProj& elem_proj, Scalar* rval[H2D_MAX_ELEMENT_SONS][MAX_NUMBER_FUNCTION_VALUES_FOR_SELECTORS])
       {
+        //calculate values of projected solution
+        const int num_gip = sub_gip.num_gip_points;
+        Scalar* proj_value[H2D_HCFE_NUM] = { elem_proj.proj_values, elem_proj.proj_values + num_gip, elem_proj.proj_values + 2 * num_gip };
+        for (int i = 0; i < H2D_HCFE_NUM; i++)
+          ProjBasedSelector<Scalar>::evaluate_projection_expansion(elem_proj, i, num_gip, proj_value[i]);
+
         double total_error_squared = 0;
         double coef_curl = std::abs(sub_trf.coef_mx * sub_trf.coef_my);
-        for (int gip_inx = 0; gip_inx < sub_gip.num_gip_points; gip_inx++)
+        for (int gip_inx = 0; gip_inx < num_gip; gip_inx++)
         {
           //get location and transform it
           double3 &gip_pt = sub_gip.gip_points[gip_inx];
 
-          //calculate value of projected solution
-          Scalar proj_value0 = 0, proj_value1 = 0, proj_curl = 0;
-          for (int i = 0; i < elem_proj.num_shapes; i++)
-          {
-            int shape_inx = elem_proj.shape_inxs[i];
-            proj_value0 += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_HCFE_VALUE0][gip_inx];
-            proj_value1 += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_HCFE_VALUE1][gip_inx];
-            proj_curl += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_HCFE_CURL][gip_inx];
-          }
+          //get value of ref. solution
+          Scalar ref_value0 = sub_trf.coef_mx * rval[son][H2D_HCFE_VALUE0][gip_inx];
+          Scalar ref_value1 = sub_trf.coef_my * rval[son][H2D_HCFE_VALUE1][gip_inx];
+          //coef_curl * curl
+          Scalar ref_curl = coef_curl * rval[son][H2D_HCFE_CURL][gip_inx];
 
-          {
-            //get value of ref. solution
-            Scalar ref_value0 = sub_trf.coef_mx * rval[son][H2D_HCFE_VALUE0][gip_inx];
-            Scalar ref_value1 = sub_trf.coef_my * rval[son][H2D_HCFE_VALUE1][gip_inx];
-            //coef_curl * curl
-            Scalar ref_curl = coef_curl * rval[son][H2D_HCFE_CURL][gip_inx];
-
-            //evaluate error
-            double error_squared = sqr(proj_value0 - ref_value0)
-              + sqr(proj_value1 - ref_value1)
-              + sqr(proj_curl - ref_curl);
-
-            total_error_squared += gip_pt[H2D_GIP2D_W] * error_squared;
-          }
+          //evaluate error
+          double error_squared = sqr(proj_value[H2D_HCFE_VALUE0][gip_inx] - ref_value0)
+            + sqr(proj_value[H2D_HCFE_VALUE1][gip_inx] - ref_value1)
+            + sqr(proj_value[H2D_HCFE_CURL][gip_inx] - ref_curl);
+
+          total_error_squared += gip_pt[H2D_GIP2D_W] * error_squared;
         }
         return total_error_squared;
       }
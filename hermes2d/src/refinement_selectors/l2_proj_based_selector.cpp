@@ -254,25 +254,22 @@ namespace Hermes
       template<typename Scalar>
       double L2ProjBasedSelector<Scalar>::evaluate_error_squared_subdomain(Element* sub_elem, const typename ProjBasedSelector<Scalar>::ElemGIP& sub_gip, int son, const typename ProjBasedSelector<Scalar>::ElemSubTrf& sub_trf, const typename ProjBasedSelector<Scalar>::ElemProj& elem_proj, Scalar* rval[H2D_MAX_ELEMENT_SONS][MAX_NUMBER_FUNCTION_VALUES_FOR_SELECTORS])
       {
+        //calculate values of projected solution
+        const int num_gip = sub_gip.num_gip_points;
+        Scalar* proj_value = elem_proj.proj_values;
+        ProjBasedSelector<Scalar>::evaluate_projection_expansion(elem_proj, H2D_L2FE_VALUE, num_gip, proj_value);
+
         double total_error_squared = 0;
-        for (int gip_inx = 0; gip_inx < sub_gip.num_gip_points; gip_inx++)
+        for (int gip_inx = 0; gip_inx < num_gip; gip_inx++)
         {
           //get location and transform it
           double3 &gip_pt = sub_gip.gip_points[gip_inx];
 
-          //calculate value of projected solution
-          Scalar proj_value = 0;
-          for (int i = 0; i < elem_proj.num_shapes; i++)
-          {
-            int shape_inx = elem_proj.shape_inxs[i];
-            proj_value += elem_proj.shape_coeffs[i] * elem_proj.svals[shape_inx][H2D_L2FE_VALUE][gip_inx];
-          }
-
           //get value of ref. solution
           Scalar ref_value = rval[son][H2D_L2FE_VALUE][gip_inx];
 
           //evaluate error
-          double error_squared = sqr(proj_value - ref_value);
+          double error_squared = sqr(proj_value[gip_inx] - ref_value);
 
           total_error_squared += gip_pt[H2D_GIP2D_W] * error_squared;
         }
@@ -40,6 +40,8 @@ namespace Hermes
         //build shape indices
         build_shape_indices(HERMES_MODE_TRIANGLE, vertex_order, edge_bubble_order);
         build_shape_indices(HERMES_MODE_QUAD, vertex_order, edge_bubble_order);
+
+        reset_selection_statistics();
       }
 
       template<typename Scalar>
@@ -570,6 +572,28 @@ namespace Hermes
         this->dof_score_exponent = exponent;
       }
 
+      template<typename Scalar>
+      double OptimumSelector<Scalar>::get_selection_time(ElementMode2D mode) const
+      {
+        return this->selection_time[mode];
+      }
+
+      template<typename Scalar>
+      int OptimumSelector<Scalar>::get_selection_count(ElementMode2D mode) const
+      {
+        return this->selection_count[mode];
+      }
+
+      template<typename Scalar>
+      void OptimumSelector<Scalar>::reset_selection_statistics()
+      {
+        for (int i = 0; i < H2D_NUM_MODES; i++)
+        {
+          this->selection_time[i] = 0.;
+          this->selection_count[i] = 0;
+        }
+      }
+
       template<typename Scalar>
       void OptimumSelector<Scalar>::evaluate_cands_score(std::vector<Cand>& candidates, Element* e)
       {
@@ -653,6 +677,10 @@ namespace Hermes
       template<typename Scalar>
       bool OptimumSelector<Scalar>::select_refinement(Element* element, int quad_order, MeshFunction<Scalar>* rsln, ElementToRefine& refinement)
       {
+        // Selection time per element type, this runs in parallel, so the object's own timer can not be used.
+        Hermes::Mixins::TimeMeasurable selection_timer;
+        ElementMode2D mode = element->get_mode();
+
         //make an uniform order in a case of a triangle
         int order_h = H2D_GET_H_ORDER(quad_order), order_v = H2D_GET_V_ORDER(quad_order);
         if (element->is_triangle())
@@ -684,6 +712,12 @@ namespace Hermes
           best_candidate = &candidates[0];
         }
 
+        selection_timer.tick();
+#pragma omp atomic
+        this->selection_time[mode] += selection_timer.last();
+#pragma omp atomic
+        this->selection_count[mode]++;
+
         if (best_candidate == &candidates[0])
           return false;
 
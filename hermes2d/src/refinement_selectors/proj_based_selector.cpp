@@ -46,9 +46,19 @@ namespace Hermes
 
         //clear matrix cache
         for (int m = 0; m < H2D_NUM_MODES; m++)
+        {
           for (int i = 0; i < H2DRS_MAX_ORDER + 2; i++)
+          {
             for (int k = 0; k < H2DRS_MAX_ORDER + 2; k++)
+            {
               proj_matrix_cache[m][i][k] = nullptr;
+              proj_matrix_diag_cache[m][i][k] = nullptr;
+            }
+            prefix_factor_cache[m][i] = nullptr;
+            prefix_factor_diag_cache[m][i] = nullptr;
+          }
+          prefix_factor_order[m] = -1;
+        }
       }
 
       template<typename Scalar>
@@ -62,7 +72,14 @@ namespace Hermes
             {
             if (proj_matrix_cache[m][i][k] != nullptr)
               free_with_check<double*>(proj_matrix_cache[m][i][k], true);
+            free_with_check(proj_matrix_diag_cache[m][i][k]);
             }
+          for (int i = 0; i < H2DRS_MAX_ORDER + 2; i++)
+          {
+            if (prefix_factor_cache[m][i] != nullptr)
+              free_with_check<double*>(prefix_factor_cache[m][i], true);
+            free_with_check(prefix_factor_diag_cache[m][i]);
+          }
         }
 
         delete[] cached_shape_vals_valid;
@@ -440,14 +457,13 @@ namespace Hermes
         int max_num_shapes = this->next_order_shape[mode][this->max_order == H2DRS_DEFAULT_ORDER ? H2DRS_MAX_ORDER : this->max_order];
         Scalar* right_side = new Scalar[max_num_shapes];
         int* shape_inxs = new int[max_num_shapes];
-        //solver data
-        int* indx = new int[max_num_shapes];
-        //solver data
-        double* d = new double[max_num_shapes];
-        double** proj_matrix = new_matrix<double>(max_num_shapes, max_num_shapes);
-        ProjMatrixCache& proj_matrices = proj_matrix_cache[mode];
+        //values of a projection at integration points, see ElemProj::proj_values
+        Scalar* proj_values = new Scalar[MAX_NUMBER_FUNCTION_VALUES_FOR_SELECTORS * num_gip_points];
         std::vector<typename OptimumSelector<Scalar>::ShapeInx>& full_shape_indices = this->shape_indices[mode];
 
+        //the highest uniform order the candidates of this element can ask for
+        int max_prefix_order = std::max(H2D_GET_H_ORDER(info.max_quad_order), H2D_GET_V_ORDER(info.max_quad_order));
+
         //check whether ortho-svals are available
         bool ortho_svals_available = true;
         for (int i = 0; i < num_sub && ortho_svals_available; i++)
@@ -473,6 +489,8 @@ namespace Hermes
           //build a list of shape indices from the full list
           int num_shapes = 0;
           unsigned int inx_shape = 0;
+          //true if the list is a prefix of the full list, i.e. no shape was skipped before the last used one
+          bool is_prefix = true;
           while (inx_shape < full_shape_indices.size())
           {
             typename OptimumSelector<Scalar>::ShapeInx& shape = full_shape_indices[inx_shape];
@@ -480,6 +498,8 @@ namespace Hermes
             {
               if (num_shapes >= max_num_shapes)
                 throw Exceptions::Exception("more shapes than predicted, possible incosistency");
+              if (num_shapes != (int)inx_shape)
+                is_prefix = false;
               shape_inxs[num_shapes] = shape.inx;
               num_shapes++;
             }
@@ -496,23 +516,11 @@ namespace Hermes
           std::vector< ValueCacheItem<Scalar> >& rhs_cache = use_ortho ? ortho_rhs_cache : nonortho_rhs_cache;
           std::vector<TrfShapeExp>** sub_svals = use_ortho ? sub_ortho_svals : sub_nonortho_svals;
 
-          //calculate projection matrix iff no ortho is used
+          //obtain a factorized projection matrix iff no ortho is used
+          double** proj_matrix_factor = nullptr;
+          double* proj_matrix_diag = nullptr;
           if (!use_ortho)
-          {
-            if (!proj_matrices[order_h][order_v])
-            {
-#pragma omp critical
-              {
-                if (!proj_matrices[order_h][order_v])
-                {
-                  proj_matrices[order_h][order_v] = build_projection_matrix(gip_points, num_gip_points, shape_inxs, num_shapes, mode);
-                }
-              }
-            }
-
-            //copy projection matrix because original matrix will be modified
-            copy_matrix(proj_matrix, proj_matrices[order_h][order_v], num_shapes, num_shapes);
-          }
+            proj_matrix_factor = get_factorized_projection_matrix(mode, gip_points, num_gip_points, order_h, order_v, shape_inxs, num_shapes, is_prefix, max_prefix_order, proj_matrix_diag);
 
           //build right side (fill cache values that are missing)
           for (int inx_sub = 0; inx_sub < num_sub; inx_sub++)
@@ -545,10 +553,7 @@ namespace Hermes
 
           //solve iff no ortho is used
           if (!use_ortho)
-          {
-            ludcmp(proj_matrix, num_shapes, indx, d);
-            lubksb<double, Scalar>(proj_matrix, num_shapes, indx, right_side);
-          }
+            cholsl<Scalar, int>(proj_matrix_factor, num_shapes, proj_matrix_diag, right_side, right_side);
 
           //calculate error
           double error_squared = 0;
@@ -557,7 +562,7 @@ namespace Hermes
             Element* this_sub_domain = sub_domains[inx_sub];
             ElemSubTrf this_sub_trf = { sub_trfs[inx_sub], 1 / sub_trfs[inx_sub]->m[0], 1 / sub_trfs[inx_sub]->m[1] };
             ElemGIP this_sub_gip = { gip_points, num_gip_points };
-            ElemProj elem_proj = { shape_inxs, num_shapes, *(sub_svals[inx_sub]), right_side, quad_order };
+            ElemProj elem_proj = { shape_inxs, num_shapes, *(sub_svals[inx_sub]), right_side, quad_order, proj_values };
 
             error_squared += evaluate_error_squared_subdomain(this_sub_domain, this_sub_gip, sons[inx_sub], this_sub_trf, elem_proj, rval);
           }
@@ -565,11 +570,93 @@ namespace Hermes
           errors_squared[order_h][order_v] = error_squared * sub_area_corr_coef;
         } while (order_perm.next());
 
-        free_with_check(proj_matrix, true);
         delete[] right_side;
         delete[] shape_inxs;
-        delete[] indx;
-        delete[] d;
+        delete[] proj_values;
+      }
+
+      template<typename Scalar>
+      double** ProjBasedSelector<Scalar>::get_factorized_projection_matrix(const ElementMode2D mode, double3* gip_points, int num_gip_points, int order_h, int order_v, const int* shape_inxs, int num_shapes, bool is_prefix, int max_prefix_order, double*& diag)
+      {
+        std::vector<typename OptimumSelector<Scalar>::ShapeInx>& full_shape_indices = this->shape_indices[mode];
+
+        if (is_prefix)
+        {
+          int prefix_order = prefix_factor_order[mode];
+          if (prefix_order < 0 || this->next_order_shape[mode][prefix_order] < num_shapes)
+          {
+#pragma omp critical (prefix_factor_cache)
+            {
+              prefix_order = prefix_factor_order[mode];
+              if (prefix_order < 0 || this->next_order_shape[mode][prefix_order] < num_shapes)
+              {
+                // Extend to the highest order this element may need so that the remaining candidates reuse the factor.
+                int new_prefix_order = std::max(max_prefix_order, std::max(order_h, order_v));
+                int prefix_num_shapes = this->next_order_shape[mode][new_prefix_order];
+                if (prefix_num_shapes >= num_shapes)
+                {
+                  int* prefix_shape_inxs = new int[prefix_num_shapes];
+                  for (int i = 0; i < prefix_num_shapes; i++)
+                    prefix_shape_inxs[i] = full_shape_indices[i].inx;
+
+                  double** factor = build_projection_matrix(gip_points, num_gip_points, prefix_shape_inxs, prefix_num_shapes, mode);
+                  double* factor_diag = malloc_with_check<double>(prefix_num_shapes);
+                  choldc(factor, prefix_num_shapes, factor_diag);
+                  delete[] prefix_shape_inxs;
+
+                  prefix_factor_cache[mode][new_prefix_order] = factor;
+                  prefix_factor_diag_cache[mode][new_prefix_order] = factor_diag;
+#pragma omp flush
+                  prefix_factor_order[mode] = new_prefix_order;
+                  prefix_order = new_prefix_order;
+                }
+              }
+            }
+          }
+
+          // The leading block of the prefix factor is the factor of the requested matrix.
+          if (prefix_order >= 0 && this->next_order_shape[mode][prefix_order] >= num_shapes)
+          {
+            diag = prefix_factor_diag_cache[mode][prefix_order];
+            return prefix_factor_cache[mode][prefix_order];
+          }
+        }
+
+        ProjMatrixCache& proj_matrices = proj_matrix_cache[mode];
+        ProjMatrixDiagCache& proj_matrices_diag = proj_matrix_diag_cache[mode];
+        if (!proj_matrices_diag[order_h][order_v])
+        {
+#pragma omp critical
+          {
+            if (!proj_matrices_diag[order_h][order_v])
+            {
+              if (!proj_matrices[order_h][order_v])
+                proj_matrices[order_h][order_v] = build_projection_matrix(gip_points, num_gip_points, shape_inxs, num_shapes, mode);
+
+              // Factorize in place, the upper triangle keeps the matrix.
+              double* factor_diag = malloc_with_check<double>(num_shapes);
+              choldc(proj_matrices[order_h][order_v], num_shapes, factor_diag);
+#pragma omp flush
+              proj_matrices_diag[order_h][order_v] = factor_diag;
+            }
+          }
+        }
+
+        diag = proj_matrices_diag[order_h][order_v];
+        return proj_matrices[order_h][order_v];
+      }
+
+      template<typename Scalar>
+      void ProjBasedSelector<Scalar>::evaluate_projection_expansion(const ElemProj& elem_proj, int inx_expansion, int num_gip_points, Scalar* proj_values)
+      {
+        memset(proj_values, 0, num_gip_points * sizeof(Scalar));
+        for (int i = 0; i < elem_proj.num_shapes; i++)
+        {
+          const Scalar coeff = elem_proj.shape_coeffs[i];
+          const double* shape_values = elem_proj.svals[elem_proj.shape_inxs[i]][inx_expansion];
+          for (int k = 0; k < num_gip_points; k++)
+            proj_values[k] += coeff * shape_values[k];
+        }
       }
 
       template class HERMES_API ProjBasedSelector < double > ;
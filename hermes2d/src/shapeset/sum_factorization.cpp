@@ -0,0 +1,360 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sum_factorization.h"
+#include "quad_all.h"
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    /// Relative tolerance of the factorization (and of the comparison of the factors).
+    static const double factorization_tolerance = 1e-10;
+
+    template<typename Scalar>
+    SumFactorizationKernel<Scalar>::SumFactorizationKernel(Shapeset* shapeset) : shapeset(shapeset), rule(nullptr), num_fns(0), num_groups(0)
+    {
+      if (shapeset->get_num_components() != 1)
+        throw Hermes::Exceptions::Exception("SumFactorizationKernel works with scalar shapesets only.");
+
+      this->max_index = shapeset->get_max_index(HERMES_MODE_QUAD);
+      memset(this->rules, 0, sizeof(this->rules));
+    }
+
+    template<typename Scalar>
+    SumFactorizationKernel<Scalar>::~SumFactorizationKernel()
+    {
+      for (unsigned short order = 0; order <= g_max_quad; order++)
+      {
+        if (this->rules[order])
+        {
+          free_with_check(this->rules[order]->fns);
+          delete this->rules[order];
+        }
+      }
+    }
+
+    template<typename Scalar>
+    unsigned char SumFactorizationKernel<Scalar>::get_num_points_1d() const
+    {
+      return this->rule->np;
+    }
+
+    template<typename Scalar>
+    unsigned short SumFactorizationKernel<Scalar>::find_factor(Rule* rule, const double* values, const double* derivatives)
+    {
+      unsigned char np = rule->np;
+
+      double max_derivative = 0.;
+      for (unsigned char i = 0; i < np; i++)
+        max_derivative = std::max(max_derivative, std::abs(derivatives[i]));
+
+      for (unsigned short factor_i = 0; factor_i < rule->num_factors; factor_i++)
+      {
+        const double* factor_values = &rule->factor_values[factor_i * np];
+        const double* factor_derivatives = &rule->factor_derivatives[factor_i * np];
+
+        bool same = true;
+        for (unsigned char i = 0; i < np && same; i++)
+        {
+          if (std::abs(factor_values[i] - values[i]) > factorization_tolerance
+            || std::abs(factor_derivatives[i] - derivatives[i]) > factorization_tolerance * (1. + max_derivative))
+            same = false;
+        }
+        if (same)
+          return factor_i;
+      }
+
+      rule->factor_values.insert(rule->factor_values.end(), values, values + np);
+      rule->factor_derivatives.insert(rule->factor_derivatives.end(), derivatives, derivatives + np);
+      return rule->num_factors++;
+    }
+
+    template<typename Scalar>
+    void SumFactorizationKernel<Scalar>::factorize(Rule* rule, int index)
+    {
+      Factorization& fn = rule->fns[index];
+      fn.state = -1;
+
+      unsigned char np = rule->np;
+      double values[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D][H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+      double dx[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D][H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+      double dy[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D][H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+
+      // Values at the points of the rule, pivot = the largest value.
+      unsigned char pivot_i = 0, pivot_j = 0;
+      double max_value = 0., max_dx = 0., max_dy = 0.;
+      for (unsigned char i = 0; i < np; i++)
+      {
+        for (unsigned char j = 0; j < np; j++)
+        {
+          double x = rule->points[2 * i], y = rule->points[2 * j];
+          values[i][j] = shapeset->get_fn_value(index, x, y, 0, HERMES_MODE_QUAD);
+          dx[i][j] = shapeset->get_dx_value(index, x, y, 0, HERMES_MODE_QUAD);
+          dy[i][j] = shapeset->get_dy_value(index, x, y, 0, HERMES_MODE_QUAD);
+          if (std::abs(values[i][j]) > max_value)
+          {
+            max_value = std::abs(values[i][j]);
+            pivot_i = i;
+            pivot_j = j;
+          }
+          max_dx = std::max(max_dx, std::abs(dx[i][j]));
+          max_dy = std::max(max_dy, std::abs(dy[i][j]));
+        }
+      }
+
+      if (max_value < factorization_tolerance)
+        return;
+
+      // phi(x_i, y_j) = X_i * Y_j with Y(y_pivot_j) = 1.
+      double X[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D], X_d[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+      double Y[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D], Y_d[H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D];
+      double pivot = values[pivot_i][pivot_j];
+      for (unsigned char i = 0; i < np; i++)
+      {
+        X[i] = values[i][pivot_j];
+        X_d[i] = dx[i][pivot_j];
+        Y[i] = values[pivot_i][i] / pivot;
+        Y_d[i] = dy[pivot_i][i] / pivot;
+      }
+
+      // Check the product form of the values and both derivatives.
+      double tolerance = factorization_tolerance * (max_value + max_dx + max_dy);
+      for (unsigned char i = 0; i < np; i++)
+      {
+        for (unsigned char j = 0; j < np; j++)
+        {
+          if (std::abs(values[i][j] - X[i] * Y[j]) > tolerance || std::abs(dx[i][j] - X_d[i] * Y[j]) > tolerance
+            || std::abs(dy[i][j] - X[i] * Y_d[j]) > tolerance)
+            return;
+        }
+      }
+
+      // Normalization - unit norm, first significant value positive.
+      double c = 1.;
+      double* factors[2][2] = { { X, X_d }, { Y, Y_d } };
+      for (unsigned char factor_i = 0; factor_i < 2; factor_i++)
+      {
+        double* factor_values = factors[factor_i][0];
+        double* factor_derivatives = factors[factor_i][1];
+        double norm = 0., max_factor_value = 0.;
+        for (unsigned char i = 0; i < np; i++)
+        {
+          norm += factor_values[i] * factor_values[i];
+          max_factor_value = std::max(max_factor_value, std::abs(factor_values[i]));
+        }
+        norm = std::sqrt(norm);
+        for (unsigned char i = 0; i < np; i++)
+        {
+          if (std::abs(factor_values[i]) > 1e-3 * max_factor_value)
+          {
+            if (factor_values[i] < 0.)
+              norm = -norm;
+            break;
+          }
+        }
+        for (unsigned char i = 0; i < np; i++)
+        {
+          factor_values[i] /= norm;
+          factor_derivatives[i] /= norm;
+        }
+        c *= norm;
+      }
+
+      fn.x = find_factor(rule, X, X_d);
+      fn.y = find_factor(rule, Y, Y_d);
+      fn.c = c;
+      fn.state = 1;
+    }
+
+    template<typename Scalar>
+    bool SumFactorizationKernel<Scalar>::set_basis(unsigned short num_fns, const int* indices, unsigned short order)
+    {
+      if (order > g_max_quad || g_quad_1d_std.get_num_points(order) > H2D_MAX_INTEGRATION_POINTS_COUNT_QUAD_1D)
+        return false;
+
+      if (!this->rules[order])
+      {
+        Rule* new_rule = new Rule;
+        new_rule->np = g_quad_1d_std.get_num_points(order);
+        new_rule->points = (double*)g_quad_1d_std.get_points(order);
+        new_rule->num_factors = 0;
+        new_rule->fns = calloc_with_check<Factorization>(this->max_index + 1);
+        this->rules[order] = new_rule;
+      }
+      this->rule = this->rules[order];
+      this->num_fns = num_fns;
+      this->num_groups = 0;
+
+      for (unsigned short k = 0; k < num_fns; k++)
+      {
+        int index = indices[k];
+        // Constrained functions are not factorized.
+        if (index < 0 || index > this->max_index)
+          return false;
+
+        if (rule->fns[index].state == 0)
+          this->factorize(rule, index);
+        if (rule->fns[index].state < 0)
+          return false;
+
+        // Group of the X factor (there are only a few of them).
+        unsigned short group_i = 0;
+        while (group_i < this->num_groups && this->group_factor[group_i] != rule->fns[index].x)
+          group_i++;
+        if (group_i == this->num_groups)
+          this->group_factor[this->num_groups++] = rule->fns[index].x;
+
+        this->fn_group[k] = group_i;
+        this->fn_y[k] = rule->fns[index].y;
+        this->fn_c[k] = rule->fns[index].c;
+      }
+
+      return true;
+    }
+
+    template<typename Scalar>
+    void SumFactorizationKernel<Scalar>::evaluate(const Scalar* coeffs, Scalar* values, Scalar* dx, Scalar* dy)
+    {
+      unsigned char np = rule->np;
+      bool derivatives = (dx != nullptr || dy != nullptr);
+
+      // Contraction in y: partial[g][j] = sum_{k in g} coeffs_k * c_k * Y_k(y_j).
+      for (unsigned short group_i = 0; group_i < this->num_groups; group_i++)
+      {
+        for (unsigned char j = 0; j < np; j++)
+          partial[group_i][j] = partial_d[group_i][j] = 0.;
+      }
+      for (unsigned short k = 0; k < this->num_fns; k++)
+      {
+        Scalar coeff = coeffs[k] * fn_c[k];
+        if (coeff == 0.)
+          continue;
+        const double* Y = &rule->factor_values[fn_y[k] * np];
+        const double* Y_d = &rule->factor_derivatives[fn_y[k] * np];
+        Scalar* partial_k = partial[fn_group[k]];
+        Scalar* partial_d_k = partial_d[fn_group[k]];
+        for (unsigned char j = 0; j < np; j++)
+          partial_k[j] += coeff * Y[j];
+        if (derivatives)
+        {
+          for (unsigned char j = 0; j < np; j++)
+            partial_d_k[j] += coeff * Y_d[j];
+        }
+      }
+
+      // Contraction in x.
+      unsigned short n = np * np;
+      for (unsigned short q = 0; q < n; q++)
+        values[q] = 0.;
+      if (dx)
+      {
+        for (unsigned short q = 0; q < n; q++)
+          dx[q] = 0.;
+      }
+      if (dy)
+      {
+        for (unsigned short q = 0; q < n; q++)
+          dy[q] = 0.;
+      }
+
+      for (unsigned short group_i = 0; group_i < this->num_groups; group_i++)
+      {
+        const double* X = &rule->factor_values[group_factor[group_i] * np];
+        const double* X_d = &rule->factor_derivatives[group_factor[group_i] * np];
+        const Scalar* partial_g = partial[group_i];
+        const Scalar* partial_d_g = partial_d[group_i];
+        for (unsigned char i = 0; i < np; i++)
+        {
+          Scalar* values_i = values + i * np;
+          for (unsigned char j = 0; j < np; j++)
+            values_i[j] += X[i] * partial_g[j];
+          if (dx)
+          {
+            Scalar* dx_i = dx + i * np;
+            for (unsigned char j = 0; j < np; j++)
+              dx_i[j] += X_d[i] * partial_g[j];
+          }
+          if (dy)
+          {
+            Scalar* dy_i = dy + i * np;
+            for (unsigned char j = 0; j < np; j++)
+              dy_i[j] += X[i] * partial_d_g[j];
+          }
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void SumFactorizationKernel<Scalar>::integrate(const Scalar* f, const Scalar* f_x, const Scalar* f_y, Scalar* result)
+    {
+      unsigned char np = rule->np;
+
+      // Contraction in x: partial[g][j] = sum_i f(x_i, y_j) * X_g(x_i) + f_x(x_i, y_j) * X_g'(x_i), partial_d[g][j] = sum_i f_y(x_i, y_j) * X_g(x_i).
+      for (unsigned short group_i = 0; group_i < this->num_groups; group_i++)
+      {
+        const double* X = &rule->factor_values[group_factor[group_i] * np];
+        const double* X_d = &rule->factor_derivatives[group_factor[group_i] * np];
+        Scalar* partial_g = partial[group_i];
+        Scalar* partial_d_g = partial_d[group_i];
+        for (unsigned char j = 0; j < np; j++)
+          partial_g[j] = partial_d_g[j] = 0.;
+
+        for (unsigned char i = 0; i < np; i++)
+        {
+          if (f)
+          {
+            const Scalar* f_i = f + i * np;
+            for (unsigned char j = 0; j < np; j++)
+              partial_g[j] += X[i] * f_i[j];
+          }
+          if (f_x)
+          {
+            const Scalar* f_x_i = f_x + i * np;
+            for (unsigned char j = 0; j < np; j++)
+              partial_g[j] += X_d[i] * f_x_i[j];
+          }
+          if (f_y)
+          {
+            const Scalar* f_y_i = f_y + i * np;
+            for (unsigned char j = 0; j < np; j++)
+              partial_d_g[j] += X[i] * f_y_i[j];
+          }
+        }
+      }
+
+      // Contraction in y.
+      for (unsigned short k = 0; k < this->num_fns; k++)
+      {
+        const double* Y = &rule->factor_values[fn_y[k] * np];
+        const double* Y_d = &rule->factor_derivatives[fn_y[k] * np];
+        const Scalar* partial_k = partial[fn_group[k]];
+        const Scalar* partial_d_k = partial_d[fn_group[k]];
+        Scalar value = 0.;
+        for (unsigned char j = 0; j < np; j++)
+          value += Y[j] * partial_k[j];
+        if (f_y)
+        {
+          for (unsigned char j = 0; j < np; j++)
+            value += Y_d[j] * partial_d_k[j];
+        }
+        result[k] = fn_c[k] * value;
+      }
+    }
+
+    template class HERMES_API SumFactorizationKernel < double > ;
+    template class HERMES_API SumFactorizationKernel < std::complex<double> > ;
+  }
+}
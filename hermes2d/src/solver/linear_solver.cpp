@@ -103,6 +103,8 @@ namespace Hermes
 
       // Extremely important.
       Space<Scalar>::assign_dofs(this->dp->get_spaces());
+      if (this->static_condensation_used)
+        this->set_condensable_dofs(Space<Scalar>::get_bubble_dofs(this->dp->get_spaces()));
 
       // Assemble the residual always and the Matrix when necessary (nonconstant jacobian, not reusable, ...).
       if (this->jacobian_reusable && this->constant_jacobian)
@@ -129,9 +131,7 @@ namespace Hermes
       this->tick();
 
       // Solve, if the solver is iterative, give him the initial guess.
-      this->linear_matrix_solver->solve(coeff_vec);
-
-      this->sln_vector = this->linear_matrix_solver->get_sln_vector();
+      this->sln_vector = this->solve_linear_matrix_system(coeff_vec);
 
       this->on_finish();
 
@@ -0,0 +1,193 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file matrix_free_solver.cpp
+\brief Linear solver without an assembled matrix.
+*/
+#include "solver/matrix_free_solver.h"
+#include "discrete_problem/discrete_problem.h"
+
+using namespace Hermes::Algebra;
+
+namespace Hermes
+{
+  namespace Hermes2D
+  {
+    template<typename Scalar>
+    MatrixFreeSolver<Scalar>::JacobiPreconditioner::JacobiPreconditioner() : inverse_diagonal(nullptr), size(0)
+    {
+    }
+
+    template<typename Scalar>
+    MatrixFreeSolver<Scalar>::JacobiPreconditioner::~JacobiPreconditioner()
+    {
+      free_with_check(this->inverse_diagonal, true);
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::JacobiPreconditioner::init(MatrixFreeOperator<Scalar>* op, int size)
+    {
+      this->size = size;
+      this->inverse_diagonal = realloc_with_check<Scalar>(this->inverse_diagonal, size);
+      op->get_diagonal(this->inverse_diagonal);
+      for (int i = 0; i < size; i++)
+        this->inverse_diagonal[i] = (this->inverse_diagonal[i] == Scalar(0.)) ? Scalar(1.) : Scalar(1.) / this->inverse_diagonal[i];
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::JacobiPreconditioner::apply(const Scalar* in, Scalar* out)
+    {
+      for (int i = 0; i < this->size; i++)
+        out[i] = this->inverse_diagonal[i] * in[i];
+    }
+
+    template<typename Scalar>
+    MatrixFreeSolver<Scalar>::MatrixFreeSolver(WeakFormSharedPtr<Scalar> wf, SpaceSharedPtr<Scalar> space) : Hermes::Mixins::Loggable(false),
+      spaces(std::vector<SpaceSharedPtr<Scalar> >(1, space)), wf(wf), op(wf, space), method(MatrixFreeCG), relative_tolerance(1e-8),
+      max_iterations(1000), gmres_restart(30), jacobi(true), num_iters(0), relative_residual(0.), sln_vector(nullptr)
+    {
+    }
+
+    template<typename Scalar>
+    MatrixFreeSolver<Scalar>::MatrixFreeSolver(WeakFormSharedPtr<Scalar> wf, std::vector<SpaceSharedPtr<Scalar> > spaces) : Hermes::Mixins::Loggable(false),
+      spaces(spaces), wf(wf), op(wf, spaces), method(MatrixFreeCG), relative_tolerance(1e-8),
+      max_iterations(1000), gmres_restart(30), jacobi(true), num_iters(0), relative_residual(0.), sln_vector(nullptr)
+    {
+    }
+
+    template<typename Scalar>
+    MatrixFreeSolver<Scalar>::~MatrixFreeSolver()
+    {
+      free_with_check(this->sln_vector, true);
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::solve(Scalar* coeff_vec)
+    {
+      this->tick();
+
+      // Extremely important.
+      int ndof = Space<Scalar>::assign_dofs(this->spaces);
+
+      // Right-hand side including the Dirichlet lift, the matrix is not assembled.
+      this->info("\tMatrixFreeSolver: assembling the rhs.");
+      SimpleVector<Scalar> rhs(ndof);
+      DiscreteProblem<Scalar> dp(this->wf, this->spaces, true);
+      dp.set_verbose_output(false);
+      dp.assemble(&rhs);
+
+      this->op.prepare();
+      if (this->jacobi)
+        this->preconditioner.init(&this->op, ndof);
+
+      this->tick();
+      this->info("\tMatrixFreeSolver: assembling and preparing done in %s. Solving...", this->last_str().c_str());
+      this->tick();
+
+      this->sln_vector = realloc_with_check<Scalar>(this->sln_vector, ndof);
+      if (coeff_vec)
+        memcpy(this->sln_vector, coeff_vec, ndof * sizeof(Scalar));
+      else
+        memset(this->sln_vector, 0, ndof * sizeof(Scalar));
+
+      bool converged;
+      Hermes::Solvers::KrylovOperator<Scalar>* preconditioner = this->jacobi ? &this->preconditioner : nullptr;
+      if (this->method == MatrixFreeCG)
+      {
+        Hermes::Solvers::CGSolver<Scalar> solver;
+        solver.set_max_iterations(this->max_iterations);
+        converged = solver.solve(&this->op, preconditioner, rhs.v, this->sln_vector, ndof, this->relative_tolerance);
+        this->num_iters = solver.get_num_iters();
+        this->relative_residual = solver.get_relative_residual();
+      }
+      else
+      {
+        Hermes::Solvers::GMRESSolver<Scalar> solver;
+        solver.set_max_iterations(this->max_iterations);
+        solver.set_restart(this->gmres_restart);
+        converged = solver.solve(&this->op, preconditioner, rhs.v, this->sln_vector, ndof, this->relative_tolerance);
+        this->num_iters = solver.get_num_iters();
+        this->relative_residual = solver.get_relative_residual();
+      }
+
+      this->tick();
+      this->warn_if(!converged, "\tMatrixFreeSolver: not converged in %i iterations, relative residual %g.", this->num_iters, this->relative_residual);
+      this->info("\tMatrixFreeSolver: solving done in %s, %i iterations.", this->last_str().c_str(), this->num_iters);
+    }
+
+    template<typename Scalar>
+    Scalar* MatrixFreeSolver<Scalar>::get_sln_vector()
+    {
+      return this->sln_vector;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::set_krylov_method(MatrixFreeKrylovMethod method)
+    {
+      this->method = method;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::set_tolerance(double relative_tolerance)
+    {
+      if (relative_tolerance <= 0.)
+        throw Exceptions::ValueException("relative_tolerance", relative_tolerance, 0.);
+      this->relative_tolerance = relative_tolerance;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::set_max_iterations(int max_iterations)
+    {
+      if (max_iterations < 1)
+        throw Exceptions::ValueException("max_iterations", max_iterations, 1);
+      this->max_iterations = max_iterations;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::set_gmres_restart(int restart)
+    {
+      if (restart < 1)
+        throw Exceptions::ValueException("restart", restart, 1);
+      this->gmres_restart = restart;
+    }
+
+    template<typename Scalar>
+    void MatrixFreeSolver<Scalar>::use_jacobi_preconditioner(bool to_set)
+    {
+      this->jacobi = to_set;
+    }
+
+    template<typename Scalar>
+    int MatrixFreeSolver<Scalar>::get_num_iters() const
+    {
+      return this->num_iters;
+    }
+
+    template<typename Scalar>
+    double MatrixFreeSolver<Scalar>::get_relative_residual() const
+    {
+      return this->relative_residual;
+    }
+
+    template<typename Scalar>
+    MatrixFreeOperator<Scalar>* MatrixFreeSolver<Scalar>::get_operator()
+    {
+      return &this->op;
+    }
+
+    template class HERMES_API MatrixFreeSolver < double > ;
+    template class HERMES_API MatrixFreeSolver < std::complex<double> > ;
+  }
+}
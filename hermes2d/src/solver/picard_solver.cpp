@@ -137,6 +137,8 @@ namespace Hermes
     void PicardSolver<Scalar>::init_solving(Scalar* coeff_vec)
     {
       this->problem_size = Space<Scalar>::assign_dofs(this->get_spaces());
+      if (this->static_condensation_used)
+        this->set_condensable_dofs(Space<Scalar>::get_bubble_dofs(this->get_spaces()));
       PicardMatrixSolver<Scalar>::init_solving(coeff_vec);
     }
 
@@ -58,6 +58,18 @@ namespace Hermes
 
       this->stage_dp_left = nullptr;
       this->stage_dp_right = nullptr;
+
+      this->mass_inversion = HERMES_RK_MASS_FULL;
+      this->explicit_dp = nullptr;
+      this->explicit_projection_dp = nullptr;
+      this->explicit_mass_size = 0;
+      this->mass_diagonal_inverse = nullptr;
+      this->num_mass_blocks = 0;
+      this->mass_block_ptr = nullptr;
+      this->mass_block_dofs = nullptr;
+      this->mass_factor_ptr = nullptr;
+      this->mass_factors = nullptr;
+      this->mass_pivots = nullptr;
     }
 
     template<typename Scalar>
@@ -89,6 +101,18 @@ namespace Hermes
 
       this->stage_dp_left = nullptr;
       this->stage_dp_right = nullptr;
+
+      this->mass_inversion = HERMES_RK_MASS_FULL;
+      this->explicit_dp = nullptr;
+      this->explicit_projection_dp = nullptr;
+      this->explicit_mass_size = 0;
+      this->mass_diagonal_inverse = nullptr;
+      this->num_mass_blocks = 0;
+      this->mass_block_ptr = nullptr;
+      this->mass_block_dofs = nullptr;
+      this->mass_factor_ptr = nullptr;
+      this->mass_factors = nullptr;
+      this->mass_pivots = nullptr;
     }
 
     template<typename Scalar>
@@ -120,6 +144,10 @@ namespace Hermes
 
       if (this->stage_dp_left != nullptr)
         this->stage_dp_left->set_spaces(this->spaces);
+      if (this->explicit_dp != nullptr)
+        this->explicit_dp->set_spaces(this->spaces);
+      if (this->explicit_projection_dp != nullptr)
+        this->explicit_projection_dp->set_spaces(this->spaces);
     }
 
     template<typename Scalar>
@@ -148,6 +176,10 @@ namespace Hermes
 
       if (this->stage_dp_left != nullptr)
         this->stage_dp_left->set_space(space);
+      if (this->explicit_dp != nullptr)
+        this->explicit_dp->set_space(space);
+      if (this->explicit_projection_dp != nullptr)
+        this->explicit_projection_dp->set_space(space);
     }
 
     template<typename Scalar>
@@ -179,6 +211,9 @@ namespace Hermes
       // matrix and residula vector coming from the function f(...). Of course the RK equation is assumed
       // in a form suitable for the Newton's method: k_i - f(...) = 0. At the end, matrix_left and vector_left
       // are added to matrix_right and vector_right, respectively.
+      // (The mass matrix part may already exist from the explicit path, see prepare_explicit_mass().)
+      if (this->stage_dp_left != nullptr)
+        delete this->stage_dp_left;
       this->stage_dp_left = new DiscreteProblem<Scalar>(stage_wf_left, spaces);
 
       // All Spaces of the problem.
@@ -217,6 +252,16 @@ namespace Hermes
       this->block_diagonal_jacobian = true;
     }
 
+    template<typename Scalar>
+    void RungeKutta<Scalar>::set_explicit_mass_inversion(RungeKuttaMassInversion mass_inversion)
+    {
+      if (mass_inversion != HERMES_RK_MASS_FULL && !this->bt->is_explicit())
+        throw Hermes::Exceptions::Exception("RungeKutta::set_explicit_mass_inversion(): the Butcher's table is not explicit.");
+      if (mass_inversion != this->mass_inversion)
+        this->free_explicit_mass();
+      this->mass_inversion = mass_inversion;
+    }
+
     template<typename Scalar>
     void RungeKutta<Scalar>::set_freeze_jacobian()
     {
@@ -257,6 +302,11 @@ namespace Hermes
       delete[] K_vector;
       delete[] u_ext_vec;
       delete[] vector_left;
+      if (explicit_dp != nullptr)
+        delete explicit_dp;
+      if (explicit_projection_dp != nullptr)
+        delete explicit_projection_dp;
+      this->free_explicit_mass();
     }
 
     template<typename Scalar>
@@ -295,18 +345,28 @@ namespace Hermes
 
       int ndof = Space<Scalar>::get_num_dofs(spaces);
 
-      if (this->stage_dp_left == nullptr)
-        this->init();
-
-      // Creates the stage weak formulation.
-      update_stage_wf(slns_time_prev);
-
       // Check whether the user provided a nonzero B2-row if he wants temporal error estimation.
       if (error_fns != std::vector<MeshFunctionSharedPtr<Scalar> >() && bt->is_embedded() == false)
         throw Hermes::Exceptions::Exception("rk_time_step_newton(): R-K method must be embedded if temporal error estimate is requested.");
 
       info("\tRunge-Kutta: time step, time: %f, time step: %f", this->time, this->time_step);
 
+      // Explicit Butcher's table with the inverted mass matrix: neither the stage weak formulation, nor the stage system,
+      // nor the Newton's method.
+      if (this->mass_inversion != HERMES_RK_MASS_FULL)
+      {
+        Scalar* coeff_vec = new Scalar[ndof];
+        this->rk_explicit_stages(slns_time_prev, slns_time_new, coeff_vec);
+        this->rk_finish_time_step(coeff_vec, slns_time_new, error_fns);
+        return;
+      }
+
+      if (this->stage_dp_right == nullptr)
+        this->init();
+
+      // Creates the stage weak formulation.
+      update_stage_wf(slns_time_prev);
+
       // Set the correct time to the essential boundary conditions.
       for (unsigned int stage_i = 0; stage_i < num_stages; stage_i++)
         Space<Scalar>::update_essential_bc_values(spaces, this->time + bt->get_C(stage_i)*this->time_step);
@@ -466,6 +526,15 @@ namespace Hermes
       Scalar* coeff_vec = new Scalar[ndof];
       OGProjection<Scalar>::project_global(spaces, slns_time_prev, coeff_vec);
 
+      this->rk_finish_time_step(coeff_vec, slns_time_new, error_fns);
+    }
+
+    template<typename Scalar>
+    void RungeKutta<Scalar>::rk_finish_time_step(Scalar* coeff_vec, std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_new,
+      std::vector<MeshFunctionSharedPtr<Scalar> > error_fns)
+    {
+      int ndof = Space<Scalar>::get_num_dofs(spaces);
+
       // Calculate new_ time level solution in the stage space (u_{n + 1} = u_n + h \sum_{j = 1}^s b_j k_j).
       for (int i = 0; i < ndof; i++)
         for (unsigned int j = 0; j < num_stages; j++)
@@ -525,33 +594,12 @@ namespace Hermes
     void RungeKutta<Scalar>::create_stage_wf(unsigned int size, bool block_diagonal_jacobian)
     {
       // Clear the WeakForms.
-      stage_wf_left->delete_all();
       stage_wf_right->delete_all();
 
       int spaces_size = stage_wf_right->original_neq = spaces.size();
 
       // First let's do the mass matrix (only one block ndof times ndof).
-      for (unsigned int component_i = 0; component_i < size; component_i++)
-      {
-        if (spaces[component_i]->get_type() == HERMES_H1_SPACE
-          || spaces[component_i]->get_type() == HERMES_L2_SPACE)
-        {
-          MatrixDefaultNormFormVol<Scalar>* proj_form = new MatrixDefaultNormFormVol<Scalar>(component_i, component_i, HERMES_L2_NORM);
-          proj_form->areas.push_back(HERMES_ANY);
-          proj_form->scaling_factor = 1.0;
-          proj_form->u_ext_offset = 0;
-          stage_wf_left->add_matrix_form(proj_form);
-        }
-        if (spaces[component_i]->get_type() == HERMES_HDIV_SPACE
-          || spaces[component_i]->get_type() == HERMES_HCURL_SPACE)
-        {
-          MatrixDefaultNormFormVol<Scalar>* proj_form = new MatrixDefaultNormFormVol<Scalar>(component_i, component_i, HERMES_HCURL_NORM);
-          proj_form->areas.push_back(HERMES_ANY);
-          proj_form->scaling_factor = 1.0;
-          proj_form->u_ext_offset = 0;
-          stage_wf_left->add_matrix_form(proj_form);
-        }
-      }
+      this->create_mass_wf(size);
 
       // In the rest we will take the stationary jacobian and residual forms
       // (right-hand side) and use them to create a block Jacobian matrix of
@@ -658,6 +706,34 @@ namespace Hermes
       }
     }
 
+    template<typename Scalar>
+    void RungeKutta<Scalar>::create_mass_wf(unsigned int size)
+    {
+      stage_wf_left->delete_all();
+
+      for (unsigned int component_i = 0; component_i < size; component_i++)
+      {
+        if (spaces[component_i]->get_type() == HERMES_H1_SPACE
+          || spaces[component_i]->get_type() == HERMES_L2_SPACE)
+        {
+          MatrixDefaultNormFormVol<Scalar>* proj_form = new MatrixDefaultNormFormVol<Scalar>(component_i, component_i, HERMES_L2_NORM);
+          proj_form->areas.push_back(HERMES_ANY);
+          proj_form->scaling_factor = 1.0;
+          proj_form->u_ext_offset = 0;
+          stage_wf_left->add_matrix_form(proj_form);
+        }
+        if (spaces[component_i]->get_type() == HERMES_HDIV_SPACE
+          || spaces[component_i]->get_type() == HERMES_HCURL_SPACE)
+        {
+          MatrixDefaultNormFormVol<Scalar>* proj_form = new MatrixDefaultNormFormVol<Scalar>(component_i, component_i, HERMES_HCURL_NORM);
+          proj_form->areas.push_back(HERMES_ANY);
+          proj_form->scaling_factor = 1.0;
+          proj_form->u_ext_offset = 0;
+          stage_wf_left->add_matrix_form(proj_form);
+        }
+      }
+    }
+
     template<typename Scalar>
     void RungeKutta<Scalar>::update_stage_wf(std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_prev)
     {
@@ -740,6 +816,309 @@ namespace Hermes
         }
       }
     }
+    template<typename Scalar>
+    void RungeKutta<Scalar>::rk_explicit_stages(std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_prev,
+      std::vector<MeshFunctionSharedPtr<Scalar> > slns_time_new, Scalar* coeff_vec)
+    {
+      int ndof = Space<Scalar>::get_num_dofs(spaces);
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+
+      Space<Scalar>::assign_dofs(spaces);
+      Space<Scalar>::update_essential_bc_values(spaces, this->time);
+
+      // The mass matrix is only assembled when the spaces change.
+      this->prepare_explicit_mass();
+
+      // Previous time level solution. With L2 spaces, the projection is M^{-1} (u_n, v) - just one more local solve.
+      bool all_L2 = true;
+      for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
+        if (spaces[space_i]->get_type() != HERMES_L2_SPACE)
+          all_L2 = false;
+      if (this->mass_inversion == HERMES_RK_MASS_BLOCK_DIAGONAL && all_L2)
+      {
+        if (this->explicit_projection_dp == nullptr)
+        {
+          this->explicit_projection_wf = WeakFormSharedPtr<Scalar>(new WeakForm<Scalar>(spaces.size()));
+          this->explicit_projection_wf->set_verbose_output(false);
+          for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
+            this->explicit_projection_wf->add_vector_form(new VectorDefaultNormFormVol<Scalar>(space_i, HERMES_L2_NORM));
+          this->explicit_projection_dp = new DiscreteProblem<Scalar>(this->explicit_projection_wf, spaces);
+          this->explicit_projection_dp->set_verbose_output(false);
+        }
+        for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
+          this->explicit_projection_wf->vfvol[space_i]->set_ext(slns_time_prev[space_i]);
+
+        this->explicit_projection_dp->assemble(&this->explicit_residual);
+        this->explicit_residual.extract(coeff_vec);
+        this->apply_explicit_mass_inverse(coeff_vec);
+      }
+      else
+        OGProjection<Scalar>::project_global(spaces, slns_time_prev, coeff_vec);
+
+      // The residual of the original weak formulation (incl. DG forms), F(t, Y) = M dY/dt.
+      if (this->explicit_dp == nullptr)
+      {
+        this->explicit_dp = new DiscreteProblem<Scalar>(this->wf, spaces);
+        this->explicit_dp->set_verbose_output(this->get_verbose_output());
+      }
+
+      // The stage solution Y_i (the first ndof entries of u_ext_vec are used).
+      Scalar* stage_coeff_vec = this->u_ext_vec;
+      for (unsigned int stage_i = 0; stage_i < num_stages; stage_i++)
+      {
+        // Y_i = u_n + h \sum_{j < i} a_{ij} K_j.
+        double* stage_weights = new double[stage_i + 1];
+        for (unsigned int stage_j = 0; stage_j < stage_i; stage_j++)
+          stage_weights[stage_j] = this->time_step * bt->get_A(stage_i, stage_j);
+
+#pragma omp parallel num_threads(num_threads_used)
+        {
+#pragma omp for schedule(static)
+          for (int i = 0; i < ndof; i++)
+          {
+            Scalar value = coeff_vec[i];
+            for (unsigned int stage_j = 0; stage_j < stage_i; stage_j++)
+              value += stage_weights[stage_j] * K_vector[stage_j * ndof + i];
+            stage_coeff_vec[i] = value;
+          }
+        }
+        delete[] stage_weights;
+
+        // Stage time.
+        double stage_time = this->time + bt->get_C(stage_i) * this->time_step;
+        Space<Scalar>::update_essential_bc_values(spaces, stage_time);
+        for (unsigned int i = 0; i < wf->vfvol.size(); i++)
+          wf->vfvol[i]->set_current_stage_time(stage_time);
+        for (unsigned int i = 0; i < wf->vfsurf.size(); i++)
+          wf->vfsurf[i]->set_current_stage_time(stage_time);
+        for (unsigned int i = 0; i < wf->vfDG.size(); i++)
+          wf->vfDG[i]->set_current_stage_time(stage_time);
+        // The cached solution-independent forms may depend on the stage time.
+        this->explicit_dp->invalidate_solution_independent_forms();
+
+        // Reinitialize filters.
+        if (this->filters_to_reinit.size() > 0)
+        {
+          Solution<Scalar>::vector_to_solutions(stage_coeff_vec, spaces, slns_time_new);
+
+          for (unsigned int filters_i = 0; filters_i < this->filters_to_reinit.size(); filters_i++)
+            filters_to_reinit.at(filters_i)->reinit();
+        }
+
+        // K_i = M^{-1} F(t_i, Y_i).
+        this->explicit_dp->assemble(stage_coeff_vec, &this->explicit_residual);
+        Scalar* K_i = this->K_vector + stage_i * ndof;
+        this->explicit_residual.extract(K_i);
+        this->apply_explicit_mass_inverse(K_i);
+      }
+
+      // The new time level solution.
+      Space<Scalar>::update_essential_bc_values(spaces, this->time + this->time_step);
+    }
+
+    /// Root of the set containing i (union-find with path halving).
+    static int mass_block_root(int* parent, int i)
+    {
+      while (parent[i] != i)
+      {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+
+    template<typename Scalar>
+    void RungeKutta<Scalar>::prepare_explicit_mass()
+    {
+      int ndof = Space<Scalar>::get_num_dofs(spaces);
+
+      bool prepared = (this->explicit_mass_size == ndof && this->explicit_mass_spaces_seqs.size() == spaces.size());
+      for (unsigned int space_i = 0; prepared && space_i < spaces.size(); space_i++)
+        if (this->explicit_mass_spaces_seqs[space_i] != spaces[space_i]->get_seq())
+          prepared = false;
+      if (prepared)
+        return;
+
+      this->free_explicit_mass();
+
+      // Only the mass matrix forms (the stage weak formulation is not needed here).
+      if (this->stage_dp_left == nullptr)
+      {
+        this->create_mass_wf(spaces.size());
+        this->stage_dp_left = new DiscreteProblem<Scalar>(stage_wf_left, spaces);
+        this->stage_dp_left->set_verbose_output(false);
+      }
+      if (this->wf->global_integration_order_set)
+        this->stage_wf_left->set_global_integration_order(this->wf->global_integration_order);
+
+      CSCMatrix<Scalar> mass_matrix;
+      stage_dp_left->assemble(&mass_matrix);
+      int* Ap = mass_matrix.get_Ap();
+      int* Ai = mass_matrix.get_Ai();
+      Scalar* Ax = mass_matrix.get_Ax();
+
+      if (this->mass_inversion == HERMES_RK_MASS_LUMPED)
+      {
+        this->mass_diagonal_inverse = calloc_with_check<Scalar>(ndof);
+        for (int col = 0; col < ndof; col++)
+          for (int k = Ap[col]; k < Ap[col + 1]; k++)
+            this->mass_diagonal_inverse[Ai[k]] += Ax[k];
+
+        for (int i = 0; i < ndof; i++)
+        {
+          if (std::abs(this->mass_diagonal_inverse[i]) < Hermes::HermesEpsilon)
+          {
+            this->free_explicit_mass();
+            throw Hermes::Exceptions::Exception("RungeKutta: the lumped mass matrix is singular (DOF %i), use HERMES_RK_MASS_BLOCK_DIAGONAL or HERMES_RK_MASS_FULL.", i);
+          }
+          this->mass_diagonal_inverse[i] = 1.0 / this->mass_diagonal_inverse[i];
+        }
+      }
+      else
+      {
+        // Blocks = connected components of the matrix graph, each one is represented by its smallest DOF.
+        int* parent = malloc_with_check<int>(ndof);
+        for (int i = 0; i < ndof; i++)
+          parent[i] = i;
+        for (int col = 0; col < ndof; col++)
+        {
+          for (int k = Ap[col]; k < Ap[col + 1]; k++)
+          {
+            int root_col = mass_block_root(parent, col), root_row = mass_block_root(parent, Ai[k]);
+            if (root_col < root_row)
+              parent[root_row] = root_col;
+            else
+              parent[root_col] = root_row;
+          }
+        }
+
+        // Numbering of the blocks, DOFs in each block (ascending).
+        int* dof_block = malloc_with_check<int>(ndof);
+        this->num_mass_blocks = 0;
+        for (int i = 0; i < ndof; i++)
+        {
+          int root = mass_block_root(parent, i);
+          dof_block[i] = (root == i) ? this->num_mass_blocks++ : dof_block[root];
+        }
+        free_with_check(parent);
+
+        this->mass_block_ptr = calloc_with_check<int>(this->num_mass_blocks + 1);
+        for (int i = 0; i < ndof; i++)
+          this->mass_block_ptr[dof_block[i] + 1]++;
+        for (int block = 0; block < this->num_mass_blocks; block++)
+        {
+          int block_size = this->mass_block_ptr[block + 1];
+          if (block_size > H2D_MAX_LOCAL_BASIS_SIZE)
+          {
+            free_with_check(dof_block);
+            this->free_explicit_mass();
+            throw Hermes::Exceptions::Exception("RungeKutta: the mass matrix is not block-diagonal (a block of %i DOFs), use HERMES_RK_MASS_LUMPED or HERMES_RK_MASS_FULL.", block_size);
+          }
+          this->mass_block_ptr[block + 1] += this->mass_block_ptr[block];
+        }
+
+        int* local_index = malloc_with_check<int>(ndof);
+        int* block_fill = malloc_with_check<int>(this->num_mass_blocks);
+        memcpy(block_fill, this->mass_block_ptr, this->num_mass_blocks * sizeof(int));
+        this->mass_block_dofs = malloc_with_check<int>(ndof);
+        for (int i = 0; i < ndof; i++)
+        {
+          local_index[i] = block_fill[dof_block[i]] - this->mass_block_ptr[dof_block[i]];
+          this->mass_block_dofs[block_fill[dof_block[i]]++] = i;
+        }
+        free_with_check(block_fill);
+
+        // Dense blocks (row-wise).
+        this->mass_factor_ptr = malloc_with_check<long long>(this->num_mass_blocks + 1);
+        this->mass_factor_ptr[0] = 0;
+        for (int block = 0; block < this->num_mass_blocks; block++)
+        {
+          long long block_size = this->mass_block_ptr[block + 1] - this->mass_block_ptr[block];
+          this->mass_factor_ptr[block + 1] = this->mass_factor_ptr[block] + block_size * block_size;
+        }
+        this->mass_factors = calloc_with_check<Scalar>(this->mass_factor_ptr[this->num_mass_blocks]);
+        for (int col = 0; col < ndof; col++)
+        {
+          int block = dof_block[col];
+          int block_size = this->mass_block_ptr[block + 1] - this->mass_block_ptr[block];
+          for (int k = Ap[col]; k < Ap[col + 1]; k++)
+            this->mass_factors[this->mass_factor_ptr[block] + local_index[Ai[k]] * block_size + local_index[col]] += Ax[k];
+        }
+        free_with_check(local_index);
+        free_with_check(dof_block);
+
+        // LU factorization of the blocks.
+        this->mass_pivots = malloc_with_check<int>(ndof);
+        Scalar* rows[H2D_MAX_LOCAL_BASIS_SIZE];
+        for (int block = 0; block < this->num_mass_blocks; block++)
+        {
+          int block_size = this->mass_block_ptr[block + 1] - this->mass_block_ptr[block];
+          for (int i = 0; i < block_size; i++)
+            rows[i] = this->mass_factors + this->mass_factor_ptr[block] + i * block_size;
+          double d;
+          Hermes::Algebra::DenseMatrixOperations::ludcmp(rows, block_size, this->mass_pivots + this->mass_block_ptr[block], &d);
+        }
+
+        this->info("\tRunge-Kutta: block-diagonal mass matrix, %i blocks.", this->num_mass_blocks);
+      }
+
+      this->explicit_mass_size = ndof;
+      this->explicit_mass_spaces_seqs.clear();
+      for (unsigned int space_i = 0; space_i < spaces.size(); space_i++)
+        this->explicit_mass_spaces_seqs.push_back(spaces[space_i]->get_seq());
+    }
+
+    template<typename Scalar>
+    void RungeKutta<Scalar>::apply_explicit_mass_inverse(Scalar* vec) const
+    {
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+
+      if (this->mass_diagonal_inverse)
+      {
+#pragma omp parallel num_threads(num_threads_used)
+        {
+#pragma omp for schedule(static)
+          for (int i = 0; i < this->explicit_mass_size; i++)
+            vec[i] *= this->mass_diagonal_inverse[i];
+        }
+        return;
+      }
+
+#pragma omp parallel num_threads(num_threads_used)
+      {
+        Scalar* rows[H2D_MAX_LOCAL_BASIS_SIZE];
+        Scalar rhs[H2D_MAX_LOCAL_BASIS_SIZE];
+#pragma omp for schedule(dynamic, 256)
+        for (int block = 0; block < this->num_mass_blocks; block++)
+        {
+          int* block_dofs = this->mass_block_dofs + this->mass_block_ptr[block];
+          int block_size = this->mass_block_ptr[block + 1] - this->mass_block_ptr[block];
+          for (int i = 0; i < block_size; i++)
+          {
+            rows[i] = this->mass_factors + this->mass_factor_ptr[block] + i * block_size;
+            rhs[i] = vec[block_dofs[i]];
+          }
+          Hermes::Algebra::DenseMatrixOperations::lubksb(rows, block_size, this->mass_pivots + this->mass_block_ptr[block], rhs);
+          for (int i = 0; i < block_size; i++)
+            vec[block_dofs[i]] = rhs[i];
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void RungeKutta<Scalar>::free_explicit_mass()
+    {
+      free_with_check(this->mass_diagonal_inverse);
+      free_with_check(this->mass_block_ptr);
+      free_with_check(this->mass_block_dofs);
+      free_with_check(this->mass_factor_ptr);
+      free_with_check(this->mass_factors);
+      free_with_check(this->mass_pivots);
+      this->num_mass_blocks = 0;
+      this->explicit_mass_size = 0;
+      this->explicit_mass_spaces_seqs.clear();
+    }
+
     template class HERMES_API RungeKutta < double > ;
     template class HERMES_API RungeKutta < std::complex<double> > ;
   }
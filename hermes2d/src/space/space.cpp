@@ -388,6 +388,26 @@ namespace Hermes
       return ndof;
     }
 
+    template<typename Scalar>
+    bool* Space<Scalar>::get_bubble_dofs(std::vector<SpaceSharedPtr<Scalar> > spaces)
+    {
+      bool* bubble_dofs = calloc_with_check<bool>(get_num_dofs(spaces));
+
+      for (unsigned char i = 0; i < spaces.size(); i++)
+      {
+        Space<Scalar>* space = spaces[i].get();
+        Element* e;
+        for_all_active_elements(e, space->mesh)
+        {
+          ElementData* ed = &space->edata[e->id];
+          for (int j = 0; j < ed->n; j++)
+            bubble_dofs[ed->bdof + j] = true;
+        }
+      }
+
+      return bubble_dofs;
+    }
+
     template<typename Scalar>
     void Space<Scalar>::set_uniform_order(int order, std::string marker)
     {
@@ -25,7 +25,7 @@ namespace Hermes
     CubicSpline::CubicSpline(std::vector<double> points, std::vector<double> values,
       double bc_left, double bc_right,
       bool first_der_left, bool first_der_right,
-      bool extrapolate_der_left, bool extrapolate_der_right) : Hermes::Hermes1DFunction<double>(), points(points), values(values),
+      bool extrapolate_der_left, bool extrapolate_der_right) : Hermes::Hermes1DFunction<double>(), points(points), point_values(values),
       bc_left(bc_left), bc_right(bc_right), first_der_left(first_der_left),
       first_der_right(first_der_right), extrapolate_der_left(extrapolate_der_left),
       extrapolate_der_right(extrapolate_der_right)
@@ -49,7 +49,8 @@ namespace Hermes
     {
       coeffs.clear();
       points.clear();
-      values.clear();
+      point_values.clear();
+      interval_table.clear();
     }
 
     double CubicSpline::value(double x) const
@@ -123,6 +124,108 @@ namespace Hermes
       return get_derivative_from_interval(x, m);
     };
 
+    void CubicSpline::values(int n, const double* x, double* out, double* dout) const
+    {
+      // For simple constant case.
+      if (this->is_const)
+      {
+        for (int i = 0; i < n; i++)
+          out[i] = const_value;
+        if (dout)
+          memset(dout, 0, n * sizeof(double));
+        return;
+      }
+
+      // Coefficients not calculated.
+      if (this->interval_table.empty())
+      {
+        Hermes::Hermes1DFunction<double>::values(n, x, out, dout);
+        return;
+      }
+
+      // Chunks, so that the interval indices fit on the stack.
+      const int chunk_size = 128;
+      int m[chunk_size];
+      for (int chunk_start = 0; chunk_start < n; chunk_start += chunk_size)
+      {
+        int chunk_end = std::min(n, chunk_start + chunk_size);
+
+        // Locate the intervals, -1 (left) and -2 (right) for the points outside.
+        for (int i = chunk_start; i < chunk_end; i++)
+        {
+          if (x[i] < point_left)
+            m[i - chunk_start] = -1;
+          else if (x[i] > point_right)
+            m[i - chunk_start] = -2;
+          else
+            m[i - chunk_start] = this->find_interval_in_table(x[i]);
+        }
+
+        // Horner scheme.
+        for (int i = chunk_start; i < chunk_end; i++)
+        {
+          const SplineCoeff& coeff = this->coeffs[std::max(m[i - chunk_start], 0)];
+          out[i] = coeff.a + x[i] * (coeff.b + x[i] * (coeff.c + x[i] * coeff.d));
+        }
+        if (dout)
+        {
+          for (int i = chunk_start; i < chunk_end; i++)
+          {
+            const SplineCoeff& coeff = this->coeffs[std::max(m[i - chunk_start], 0)];
+            dout[i] = coeff.b + x[i] * (2. * coeff.c + 3. * coeff.d * x[i]);
+          }
+        }
+
+        // Extrapolation, as in value() and derivative().
+        for (int i = chunk_start; i < chunk_end; i++)
+        {
+          if (m[i - chunk_start] == -1)
+          {
+            out[i] = extrapolate_der_left ? extrapolate_value(point_left, value_left, derivative_left, x[i]) : value_left;
+            if (dout)
+              dout[i] = extrapolate_der_left ? derivative_left : 0.;
+          }
+          else if (m[i - chunk_start] == -2)
+          {
+            out[i] = extrapolate_der_right ? extrapolate_value(point_right, value_right, derivative_right, x[i]) : value_right;
+            if (dout)
+              dout[i] = extrapolate_der_right ? derivative_right : 0.;
+          }
+        }
+      }
+    }
+
+    void CubicSpline::build_interval_table()
+    {
+      int nelem = points.size() - 1;
+      // Twice as many cells as intervals - the walk in find_interval_in_table() is short even for moderately graded points.
+      int num_cells = 2 * nelem;
+      this->interval_table_inv_width = num_cells / (point_right - point_left);
+      this->interval_table.resize(num_cells);
+      int m = 0;
+      for (int cell = 0; cell < num_cells; cell++)
+      {
+        double cell_left = point_left + cell / this->interval_table_inv_width;
+        while (m + 1 < nelem && points[m + 1] <= cell_left)
+          m++;
+        this->interval_table[cell] = m;
+      }
+    }
+
+    int CubicSpline::find_interval_in_table(double x_in) const
+    {
+      int nelem = points.size() - 1;
+      int cell = (int)((x_in - point_left) * this->interval_table_inv_width);
+      if (cell >= (int)this->interval_table.size())
+        cell = this->interval_table.size() - 1;
+      else if (cell < 0)
+        cell = 0;
+      int m = this->interval_table[cell];
+      while (m + 1 < nelem && points[m + 1] < x_in)
+        m++;
+      return m;
+    }
+
     double CubicSpline::extrapolate_value(double point_end, double value_end,
       double derivative_end, double x_in) const
     {
@@ -238,17 +341,17 @@ namespace Hermes
       int nelem = points.size() - 1;
 
       // Basic sanity checks.
-      if (points.empty() || values.empty())
+      if (points.empty() || point_values.empty())
       {
         this->warn("Empty points or values vector in CubicSpline, cancelling coefficients calculation.");
         return;
       }
-      if (points.size() < 2 || values.size() < 2)
+      if (points.size() < 2 || point_values.size() < 2)
       {
         this->warn("At least two points and values required in CubicSpline, cancelling coefficients calculation.");
         return;
       }
-      if (points.size() != values.size())
+      if (points.size() != point_values.size())
       {
         this->warn("Mismatched number of points and values in CubicSpline, cancelling coefficients calculation.");
         return;
@@ -286,8 +389,8 @@ namespace Hermes
       // Fill the rhs vector.
       for (int i = 0; i < nelem; i++)
       {
-        rhs[2 * i] = values[i];
-        rhs[2 * i + 1] = values[i + 1];
+        rhs[2 * i] = point_values[i];
+        rhs[2 * i + 1] = point_values[i + 1];
       }
 
       // Fill the matrix. Step 1 - match values at interval endpoints.
@@ -398,15 +501,17 @@ namespace Hermes
       }
 
       // Define end point values and derivatives so that
-      // the points[] and values[] arrays are no longer
+      // the points[] and point_values[] arrays are no longer
       // needed.
       point_left = points[0];
-      value_left = values[0];
+      value_left = point_values[0];
       derivative_left = get_derivative_from_interval(point_left, 0);
       point_right = points[points.size() - 1];
-      value_right = values[values.size() - 1];
+      value_right = point_values[point_values.size() - 1];
       derivative_right = get_derivative_from_interval(point_right, points.size() - 2);
 
+      this->build_interval_table();
+
       // Free the matrix and rhs vector.
       free_with_check(matrix);
       free_with_check(rhs);
@@ -25,6 +25,85 @@ namespace Hermes
   {
     namespace Views
     {
+      /// Merging of the vertices of all threads - positions on a mesh edge are multiples of 1 / merge_edge_positions.
+      static const int merge_edge_positions = 1 << 20;
+      /// Merging of the vertices of all threads - the same tolerance of values as when looking for a vertex in one thread.
+      static const double merge_relative_tolerance = 0.01;
+
+      /// Merge key of the midpoint of the vertices with the keys key1, key2.
+      /// A key is (a, a, 0) for the mesh vertex a, (a, b, t) for the point t / merge_edge_positions on the mesh edge (a, b), a < b,
+      /// (-1, -1, 0) for a vertex inside of a mesh element (never shared with other elements).
+      static void merge_midpoint_key(const int3& key1, const int3& key2, int3& key)
+      {
+        key[0] = key[1] = -1;
+        key[2] = 0;
+        if (key1[0] < 0 || key2[0] < 0)
+          return;
+
+        bool mesh_vertex1 = (key1[0] == key1[1]), mesh_vertex2 = (key2[0] == key2[1]);
+        int position;
+        if (mesh_vertex1 && mesh_vertex2)
+        {
+          if (key1[0] == key2[0])
+            return;
+          key[0] = std::min(key1[0], key2[0]);
+          key[1] = std::max(key1[0], key2[0]);
+          key[2] = merge_edge_positions / 2;
+          return;
+        }
+        else if (mesh_vertex1 || mesh_vertex2)
+        {
+          const int3& mesh_vertex = mesh_vertex1 ? key1 : key2;
+          const int3& edge_point = mesh_vertex1 ? key2 : key1;
+          if (mesh_vertex[0] == edge_point[0])
+            position = edge_point[2];
+          else if (mesh_vertex[0] == edge_point[1])
+            position = edge_point[2] + merge_edge_positions;
+          else
+            return;
+          key[0] = edge_point[0];
+          key[1] = edge_point[1];
+        }
+        else
+        {
+          if (key1[0] != key2[0] || key1[1] != key2[1])
+            return;
+          position = key1[2] + key2[2];
+          key[0] = key1[0];
+          key[1] = key1[1];
+        }
+
+        // Too deep refinement - treated as an inner vertex.
+        if (position % 2)
+        {
+          key[0] = key[1] = -1;
+          return;
+        }
+        key[2] = position / 2;
+      }
+
+      static unsigned int merge_key_hash(const int3& key)
+      {
+        return ((unsigned int)key[0] * 73856093u) ^ ((unsigned int)key[1] * 19349663u) ^ ((unsigned int)key[2] * 83492791u);
+      }
+
+      template<typename vertex_t, int dimension>
+      static bool merge_same_vertex(const vertex_t& vertex1, const vertex_t& vertex2)
+      {
+        for (int k = 0; k < 2; k++)
+        {
+          if (fabs(vertex1[k] - vertex2[k]) > Hermes::HermesSqrtEpsilon * (1. + fabs(vertex1[k])))
+            return false;
+        }
+        // note that vertices with different values are not merged - discontinuities in the solution.
+        for (int k = 0; k < dimension; k++)
+        {
+          if (fabs(vertex1[2 + k] - vertex2[2 + k]) > merge_relative_tolerance * std::max(fabs(vertex1[2 + k]), fabs(vertex2[2 + k])))
+            return false;
+        }
+        return true;
+      }
+
       LinearizerCriterion::LinearizerCriterion(bool adaptive) : adaptive(adaptive)
       {
       }
@@ -163,6 +242,8 @@ namespace Hermes
         // lock data.
         lock_data();
 
+        this->tick();
+
         // Initialization of 'global' stuff.
         this->init(sln, item_);
 
@@ -213,6 +294,9 @@ namespace Hermes
           }
         }
 
+        this->tick();
+        this->info("\tLinearizer: states processing: %s.", this->last_str().c_str());
+
         // Free states.
         if (this->states)
         {
@@ -269,32 +353,202 @@ namespace Hermes
         // regularize the linear mesh
         if (this->exceptionMessageCaughtInParallelBlock.empty())
         {
-          find_min_max();
-          // Polish triangle vertex indices for FileExport case.
+          // Merge the vertices of the threads and make the triangle vertex indices global for FileExport case.
           if (this->linearizerOutputType == FileExport)
           {
-            int running_count = 0;
-            for (int i = 0; i < this->num_threads_used; i++)
+            this->merge_vertices();
+            this->tick();
+            this->info("\tLinearizer: vertex merge: %s.", this->last_str().c_str());
+          }
+          find_min_max();
+        }
+        else if (this->linearizerOutputType == FileExport)
+        {
+          for (int i = 0; i < this->num_threads_used; i++)
+            free_with_check(this->threadLinearizerMultidimensional[i]->info, true);
+        }
+
+        // select old quadratrues
+        for (int k = 0; k < LinearizerDataDimensions::dimension; k++)
+          sln[k]->set_quad_2d(old_quad[k]);
+
+        // Unlock data.
+        this->unlock_data();
+      }
+
+      template<typename LinearizerDataDimensions>
+      void LinearizerMultidimensional<LinearizerDataDimensions>::merge_vertices()
+      {
+        typedef typename LinearizerDataDimensions::vertex_t vertex_t;
+        ThreadLinearizerMultidimensional<LinearizerDataDimensions>** thread_linearizers = this->threadLinearizerMultidimensional;
+        int num_threads = this->num_threads_used;
+        int num_buckets = num_threads;
+
+        // Vertices of all threads one after another (raw indices).
+        int* raw_offsets = malloc_with_check<int>(num_threads + 1);
+        raw_offsets[0] = 0;
+        for (int i = 0; i < num_threads; i++)
+          raw_offsets[i + 1] = raw_offsets[i] + thread_linearizers[i]->vertex_count;
+        int raw_count = raw_offsets[num_threads];
+
+        int3* keys = malloc_with_check<int3>(std::max(raw_count, 1));
+        int* representatives = malloc_with_check<int>(std::max(raw_count, 1));
+        int* new_indices = malloc_with_check<int>(std::max(raw_count, 1));
+        // Number of the shared vertex candidates of each thread in each bucket, positions in bucket_entries.
+        int* bucket_counts = calloc_with_check<int>(num_threads * num_buckets);
+        int* bucket_starts = malloc_with_check<int>(num_buckets + 1);
+        int* kept_offsets = malloc_with_check<int>(num_threads + 1);
+
+        // Keys (in the order of creation, parents always come first), bucket counts.
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        {
+          ThreadLinearizerMultidimensional<LinearizerDataDimensions>* thread_linearizer = thread_linearizers[thread_i];
+          int3* thread_keys = keys + raw_offsets[thread_i];
+          for (int i = 0; i < thread_linearizer->vertex_count; i++)
+          {
+            int p1 = thread_linearizer->info[i][0], p2 = thread_linearizer->info[i][1];
+            if (p1 == p2)
+            {
+              thread_keys[i][0] = thread_keys[i][1] = -p1;
+              thread_keys[i][2] = 0;
+            }
+            else
+              merge_midpoint_key(thread_keys[p1], thread_keys[p2], thread_keys[i]);
+
+            representatives[raw_offsets[thread_i] + i] = raw_offsets[thread_i] + i;
+            if (thread_keys[i][0] >= 0)
+              bucket_counts[thread_i * num_buckets + merge_key_hash(thread_keys[i]) % num_buckets]++;
+          }
+          free_with_check(thread_linearizer->info, true);
+        }
+
+        // Bucket entries ordered by thread (and by index within the thread) - the first occurrence is the representative.
+        int max_bucket_size = 0;
+        bucket_starts[0] = 0;
+        for (int bucket_i = 0; bucket_i < num_buckets; bucket_i++)
+        {
+          int position = bucket_starts[bucket_i];
+          for (int thread_i = 0; thread_i < num_threads; thread_i++)
+          {
+            int count = bucket_counts[thread_i * num_buckets + bucket_i];
+            bucket_counts[thread_i * num_buckets + bucket_i] = position;
+            position += count;
+          }
+          bucket_starts[bucket_i + 1] = position;
+          max_bucket_size = std::max(max_bucket_size, position - bucket_starts[bucket_i]);
+        }
+        int* bucket_entries = malloc_with_check<int>(std::max(bucket_starts[num_buckets], 1));
+
+        int table_size = 1;
+        while (table_size < 2 * max_bucket_size)
+          table_size *= 2;
+        int* tables = malloc_with_check<int>(table_size * num_buckets);
+
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        {
+          int* positions = bucket_counts + thread_i * num_buckets;
+          for (int i = raw_offsets[thread_i]; i < raw_offsets[thread_i + 1]; i++)
+          {
+            if (keys[i][0] >= 0)
+              bucket_entries[positions[merge_key_hash(keys[i]) % num_buckets]++] = i;
+          }
+        }
+
+        // Representatives - open addressing in each bucket.
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (int bucket_i = 0; bucket_i < num_buckets; bucket_i++)
+        {
+          int* table = tables + bucket_i * table_size;
+          memset(table, 0xff, sizeof(int) * table_size);
+          for (int entry_i = bucket_starts[bucket_i]; entry_i < bucket_starts[bucket_i + 1]; entry_i++)
+          {
+            int raw_i = bucket_entries[entry_i];
+            int thread_i = std::upper_bound(raw_offsets, raw_offsets + num_threads + 1, raw_i) - raw_offsets - 1;
+            vertex_t& vertex = thread_linearizers[thread_i]->vertices[raw_i - raw_offsets[thread_i]];
+
+            int slot = (merge_key_hash(keys[raw_i]) / num_buckets) & (table_size - 1);
+            while (table[slot] >= 0)
             {
-              if (i > 0)
+              int raw_j = table[slot];
+              if (keys[raw_j][0] == keys[raw_i][0] && keys[raw_j][1] == keys[raw_i][1] && keys[raw_j][2] == keys[raw_i][2])
               {
-                for (int j = 0; j < this->threadLinearizerMultidimensional[i]->triangle_count; j++)
+                int thread_j = std::upper_bound(raw_offsets, raw_offsets + num_threads + 1, raw_j) - raw_offsets - 1;
+                if (merge_same_vertex<vertex_t, LinearizerDataDimensions::dimension>(thread_linearizers[thread_j]->vertices[raw_j - raw_offsets[thread_j]], vertex))
                 {
-                  for (int k = 0; k < 3; k++)
-                    this->threadLinearizerMultidimensional[i]->triangle_indices[j][k] += running_count;
+                  representatives[raw_i] = raw_j;
+                  break;
                 }
               }
-              running_count += this->threadLinearizerMultidimensional[i]->vertex_count;
+              slot = (slot + 1) & (table_size - 1);
             }
+            if (table[slot] < 0)
+              table[slot] = raw_i;
           }
         }
 
-        // select old quadratrues
-        for (int k = 0; k < LinearizerDataDimensions::dimension; k++)
-          sln[k]->set_quad_2d(old_quad[k]);
+        // Global indices of the kept vertices, compaction of the vertex arrays.
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        {
+          int kept = 0;
+          for (int i = raw_offsets[thread_i]; i < raw_offsets[thread_i + 1]; i++)
+          {
+            if (representatives[i] == i)
+              kept++;
+          }
+          kept_offsets[thread_i + 1] = kept;
+        }
+        kept_offsets[0] = 0;
+        for (int i = 0; i < num_threads; i++)
+          kept_offsets[i + 1] += kept_offsets[i];
 
-        // Unlock data.
-        this->unlock_data();
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        {
+          ThreadLinearizerMultidimensional<LinearizerDataDimensions>* thread_linearizer = thread_linearizers[thread_i];
+          int kept = 0;
+          for (int i = 0; i < thread_linearizer->vertex_count; i++)
+          {
+            int raw_i = raw_offsets[thread_i] + i;
+            if (representatives[raw_i] == raw_i)
+            {
+              new_indices[raw_i] = kept_offsets[thread_i] + kept;
+              if (kept < i)
+                memcpy(thread_linearizer->vertices[kept], thread_linearizer->vertices[i], sizeof(vertex_t));
+              kept++;
+            }
+          }
+        }
+
+        // Remapping of the triangles.
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int thread_i = 0; thread_i < num_threads; thread_i++)
+        {
+          ThreadLinearizerMultidimensional<LinearizerDataDimensions>* thread_linearizer = thread_linearizers[thread_i];
+          for (int i = raw_offsets[thread_i]; i < raw_offsets[thread_i + 1]; i++)
+          {
+            if (representatives[i] != i)
+              new_indices[i] = new_indices[representatives[i]];
+          }
+          for (int j = 0; j < thread_linearizer->triangle_count; j++)
+          {
+            for (int k = 0; k < 3; k++)
+              thread_linearizer->triangle_indices[j][k] = new_indices[raw_offsets[thread_i] + thread_linearizer->triangle_indices[j][k]];
+          }
+          thread_linearizer->vertex_count = kept_offsets[thread_i + 1] - kept_offsets[thread_i];
+        }
+
+        free_with_check(raw_offsets);
+        free_with_check(keys);
+        free_with_check(representatives);
+        free_with_check(new_indices);
+        free_with_check(bucket_counts);
+        free_with_check(bucket_starts);
+        free_with_check(kept_offsets);
+        free_with_check(bucket_entries);
+        free_with_check(tables);
       }
 
       template<typename LinearizerDataDimensions>
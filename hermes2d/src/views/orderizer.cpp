@@ -136,29 +136,6 @@ namespace Hermes
 #endif
       }
 
-      int Orderizer::add_vertex()
-      {
-        if (this->vertex_count >= this->vertex_size)
-        {
-          this->vertex_size *= 2;
-          this->verts = (double3*)realloc(verts, sizeof(double3)* vertex_size);
-          if ((!this->verts))
-          {
-            free();
-            throw Exceptions::Exception("Orderizer out of memory!");
-          }
-        }
-        return this->vertex_count++;
-      }
-
-      void Orderizer::make_vert(int & index, double x, double y, double val)
-      {
-        index = add_vertex();
-        verts[index][0] = x;
-        verts[index][1] = y;
-        verts[index][2] = val;
-      }
-
       static const int default_allocation_multiplier_vertices = 10;
       static const int default_allocation_multiplier_triangles = 15;
       static const int default_allocation_multiplier_edges = 10;
@@ -167,32 +144,95 @@ namespace Hermes
       static const int default_allocation_minsize_triangles = 15000;
       static const int default_allocation_minsize_edges = 10000;
 
-      void Orderizer::reallocate(MeshSharedPtr mesh)
+      OrderizerThreadData::OrderizerThreadData() : verts(nullptr), tris(nullptr), tri_markers(nullptr), edges(nullptr), edge_markers(nullptr),
+        vertex_count(0), triangle_count(0), edges_count(0), vertex_size(0), triangle_size(0), edges_size(0)
       {
-        int number_of_elements = mesh->get_num_elements();
+      }
 
+      OrderizerThreadData::~OrderizerThreadData()
+      {
+        free();
+      }
+
+      void OrderizerThreadData::reallocate(int number_of_elements)
+      {
         this->vertex_size = std::max(default_allocation_multiplier_vertices * number_of_elements, std::max(this->vertex_size, default_allocation_minsize_vertices));
         this->triangle_size = std::max(default_allocation_multiplier_triangles * number_of_elements, std::max(this->triangle_size, default_allocation_minsize_triangles));
         this->edges_size = std::max(default_allocation_multiplier_edges * number_of_elements, std::max(this->edges_size, default_allocation_minsize_edges));
 
-        // Set count.
         this->vertex_count = 0;
         this->triangle_count = 0;
         this->edges_count = 0;
 
-        this->tris = (int3*)realloc(this->tris, sizeof(int3)* this->triangle_size);
-        this->tri_markers = (int*)realloc(this->tri_markers, sizeof(int)* this->triangle_size);
-        this->edges = (int2*)realloc(this->edges, sizeof(int2)* this->edges_size);
-        this->edge_markers = (int*)realloc(this->edge_markers, sizeof(int)* this->edges_size);
+        this->verts = realloc_with_check<OrderizerThreadData, double3>(this->verts, this->vertex_size, this);
+        this->tris = realloc_with_check<OrderizerThreadData, int3>(this->tris, this->triangle_size, this);
+        this->tri_markers = realloc_with_check<OrderizerThreadData, int>(this->tri_markers, this->triangle_size, this);
+        this->edges = realloc_with_check<OrderizerThreadData, int2>(this->edges, this->edges_size, this);
+        this->edge_markers = realloc_with_check<OrderizerThreadData, int>(this->edge_markers, this->edges_size, this);
+      }
+
+      void OrderizerThreadData::free()
+      {
+        free_with_check(verts, true);
+        free_with_check(tris, true);
+        free_with_check(tri_markers, true);
+        free_with_check(edges, true);
+        free_with_check(edge_markers, true);
+        vertex_count = triangle_count = edges_count = vertex_size = triangle_size = edges_size = 0;
+      }
+
+      int OrderizerThreadData::add_vertex(double x, double y, double val)
+      {
+        if (this->vertex_count >= this->vertex_size)
+        {
+          this->vertex_size = std::ceil(this->vertex_size * 1.5);
+          this->verts = realloc_with_check<OrderizerThreadData, double3>(this->verts, this->vertex_size, this);
+        }
+        this->verts[vertex_count][0] = x;
+        this->verts[vertex_count][1] = y;
+        this->verts[vertex_count][2] = val;
+        return this->vertex_count++;
+      }
+
+      void OrderizerThreadData::add_triangle(int iv0, int iv1, int iv2, int marker)
+      {
+        if (this->triangle_count >= this->triangle_size)
+        {
+          this->triangle_size = std::ceil(this->triangle_size * 1.5);
+          this->tris = realloc_with_check<OrderizerThreadData, int3>(this->tris, this->triangle_size, this);
+          this->tri_markers = realloc_with_check<OrderizerThreadData, int>(this->tri_markers, this->triangle_size, this);
+        }
+        this->tris[triangle_count][0] = iv0;
+        this->tris[triangle_count][1] = iv1;
+        this->tris[triangle_count][2] = iv2;
+        this->tri_markers[triangle_count++] = marker;
+      }
+
+      void OrderizerThreadData::add_edge(int iv1, int iv2, int marker)
+      {
+        if (this->edges_count >= this->edges_size)
+        {
+          this->edges_size = std::ceil(this->edges_size * 1.5);
+          this->edges = realloc_with_check<OrderizerThreadData, int2>(this->edges, this->edges_size, this);
+          this->edge_markers = realloc_with_check<OrderizerThreadData, int>(this->edge_markers, this->edges_size, this);
+        }
+        this->edges[edges_count][0] = iv1;
+        this->edges[edges_count][1] = iv2;
+        this->edge_markers[edges_count++] = marker;
+      }
 
-        if (!this->tris || !this->tri_markers || !this->edges || !this->edge_markers)
-          throw Exceptions::Exception("Orderizer out of memory!");
+      void Orderizer::reallocate(MeshSharedPtr mesh)
+      {
+        int number_of_elements = mesh->get_num_elements();
+
+        // Set count.
+        this->vertex_count = 0;
+        this->triangle_count = 0;
+        this->edges_count = 0;
 
         this->label_size = std::max(this->label_size, number_of_elements + 10);
         this->label_count = 0;
 
-        this->verts = realloc_with_check<Orderizer, double3>(this->verts, this->vertex_size, this);
-
         this->lvert = realloc_with_check<Orderizer, int>(this->lvert, label_size, this);
 
         ltext = realloc_with_check<Orderizer, char *>(this->ltext, label_size, this);
@@ -200,6 +240,73 @@ namespace Hermes
         lbox = realloc_with_check<Orderizer, double2>(this->lbox, label_size, this);
       }
 
+      void Orderizer::merge(OrderizerThreadData* thread_data, int* element_starts)
+      {
+        // Prefix sums.
+        int* vertex_offsets = malloc_with_check<int>(this->num_threads_used + 1);
+        int* triangle_offsets = malloc_with_check<int>(this->num_threads_used + 1);
+        int* edge_offsets = malloc_with_check<int>(this->num_threads_used + 1);
+        vertex_offsets[0] = triangle_offsets[0] = edge_offsets[0] = 0;
+        for (int i = 0; i < this->num_threads_used; i++)
+        {
+          vertex_offsets[i + 1] = vertex_offsets[i] + thread_data[i].vertex_count;
+          triangle_offsets[i + 1] = triangle_offsets[i] + thread_data[i].triangle_count;
+          edge_offsets[i + 1] = edge_offsets[i] + thread_data[i].edges_count;
+        }
+        this->vertex_count = vertex_offsets[this->num_threads_used];
+        this->triangle_count = triangle_offsets[this->num_threads_used];
+        this->edges_count = edge_offsets[this->num_threads_used];
+
+        if (this->vertex_count > this->vertex_size)
+          this->verts = realloc_with_check<Orderizer, double3>(this->verts, this->vertex_size = this->vertex_count, this);
+        if (this->triangle_count > this->triangle_size)
+        {
+          this->tris = realloc_with_check<Orderizer, int3>(this->tris, this->triangle_count, this);
+          this->tri_markers = realloc_with_check<Orderizer, int>(this->tri_markers, this->triangle_size = this->triangle_count, this);
+        }
+        if (this->edges_count > this->edges_size)
+        {
+          this->edges = realloc_with_check<Orderizer, int2>(this->edges, this->edges_count, this);
+          this->edge_markers = realloc_with_check<Orderizer, int>(this->edge_markers, this->edges_size = this->edges_count, this);
+        }
+
+        // Each thread copies its own part.
+#pragma omp parallel num_threads(this->num_threads_used)
+        {
+          int thread_number = omp_get_thread_num();
+          OrderizerThreadData& data = thread_data[thread_number];
+          int vertex_offset = vertex_offsets[thread_number];
+
+          if (data.vertex_count > 0)
+            memcpy(this->verts + vertex_offset, data.verts, data.vertex_count * sizeof(double3));
+
+          int3* tris_target = this->tris + triangle_offsets[thread_number];
+          int* tri_markers_target = this->tri_markers + triangle_offsets[thread_number];
+          for (int i = 0; i < data.triangle_count; i++)
+          {
+            for (int k = 0; k < 3; k++)
+              tris_target[i][k] = data.tris[i][k] + vertex_offset;
+            tri_markers_target[i] = data.tri_markers[i];
+          }
+
+          int2* edges_target = this->edges + edge_offsets[thread_number];
+          int* edge_markers_target = this->edge_markers + edge_offsets[thread_number];
+          for (int i = 0; i < data.edges_count; i++)
+          {
+            edges_target[i][0] = data.edges[i][0] + vertex_offset;
+            edges_target[i][1] = data.edges[i][1] + vertex_offset;
+            edge_markers_target[i] = data.edge_markers[i];
+          }
+
+          for (int i = element_starts[thread_number]; i < element_starts[thread_number + 1]; i++)
+            this->lvert[i] += vertex_offset;
+        }
+
+        free_with_check(vertex_offsets);
+        free_with_check(triangle_offsets);
+        free_with_check(edge_offsets);
+      }
+
       Orderizer::~Orderizer()
       {
         free();
@@ -233,152 +340,164 @@ namespace Hermes
 
         MeshSharedPtr mesh = space->get_mesh();
 
+        // Init the caught parallel exception message.
+        this->exceptionMessageCaughtInParallelBlock.clear();
+
         // Reallocate.
         this->reallocate(mesh);
 
-        RefMap refmap;
-
-        int oo, o[6];
-
-        // make a mesh illustrating the distribution of polynomial orders over the space
+        // The elements are split among the threads, the label of an element is at its position in this list.
+        std::vector<Element*> elements;
         Element* e;
         for_all_active_elements(e, mesh)
+          elements.push_back(e);
+        int num_elements = elements.size();
+
+        OrderizerThreadData* thread_data = new OrderizerThreadData[this->num_threads_used];
+        int* element_starts = malloc_with_check<int>(this->num_threads_used + 1);
+        for (int i = 0; i < this->num_threads_used; i++)
+          element_starts[i] = (num_elements / this->num_threads_used) * i;
+        element_starts[this->num_threads_used] = num_elements;
+
+#pragma omp parallel num_threads(this->num_threads_used)
         {
-          oo = o[4] = o[5] = space->get_element_order(e->id);
-          if (show_edge_orders)
-            for (unsigned int k = 0; k < e->get_nvert(); k++)
-              o[k] = space->get_edge_order(e, k);
-          else if (e->is_curved())
-          {
-            if (e->is_triangle())
-              for (unsigned int k = 0; k < e->get_nvert(); k++)
-                o[k] = oo;
-            else
-              for (unsigned int k = 0; k < e->get_nvert(); k++)
-                o[k] = H2D_GET_H_ORDER(oo);
-          }
+          int thread_number = omp_get_thread_num();
+          int start = element_starts[thread_number];
+          int end = element_starts[thread_number + 1];
 
-          double3* pt;
-          int np;
-          double* x;
-          double* y;
-          if (show_edge_orders || e->is_curved())
+          try
           {
-            refmap.set_quad_2d(&quad_ord);
-            refmap.set_active_element(e);
-            x = refmap.get_phys_x(1);
-            y = refmap.get_phys_y(1);
+            OrderizerThreadData& data = thread_data[thread_number];
+            data.reallocate(end - start);
 
-            pt = quad_ord.get_points(1, e->get_mode());
-            np = quad_ord.get_num_points(1, e->get_mode());
-          }
-          else
-          {
-            refmap.set_quad_2d(&quad_ord_simple);
-            refmap.set_active_element(e);
-            x = refmap.get_phys_x(1);
-            y = refmap.get_phys_y(1);
+            RefMap refmap;
 
-            pt = quad_ord_simple.get_points(1, e->get_mode());
-            np = quad_ord_simple.get_num_points(1, e->get_mode());
-          }
+            int oo, o[6];
 
-          int id[80];
-          assert(np <= 80);
+            // make a mesh illustrating the distribution of polynomial orders over the space
+            for (int element_i = start; element_i < end; element_i++)
+            {
+              // Exception already thrown -> exit the loop.
+              if (!this->exceptionMessageCaughtInParallelBlock.empty())
+                break;
 
-          int mode = e->get_mode();
-          if (e->is_quad())
-          {
-            o[4] = H2D_GET_H_ORDER(oo);
-            o[5] = H2D_GET_V_ORDER(oo);
-          }
-          if (show_edge_orders || e->is_curved())
-          {
-            make_vert(lvert[label_count], x[0], y[0], o[4]);
+              Element* e = elements[element_i];
 
-            for (int i = 1; i < np; i++)
-              make_vert(id[i - 1], x[i], y[i], o[(int)pt[i][2]]);
+              oo = o[4] = o[5] = space->get_element_order(e->id);
+              if (show_edge_orders)
+                for (unsigned int k = 0; k < e->get_nvert(); k++)
+                  o[k] = space->get_edge_order(e, k);
+              else if (e->is_curved())
+              {
+                if (e->is_triangle())
+                  for (unsigned int k = 0; k < e->get_nvert(); k++)
+                    o[k] = oo;
+                else
+                  for (unsigned int k = 0; k < e->get_nvert(); k++)
+                    o[k] = H2D_GET_H_ORDER(oo);
+              }
 
-            for (int i = 0; i < num_elem[mode][1]; i++)
-              this->add_triangle(id[ord_elem[mode][1][i][0]], id[ord_elem[mode][1][i][1]], id[ord_elem[mode][1][i][2]], e->marker);
+              double3* pt;
+              int np;
+              double* x;
+              double* y;
+              if (show_edge_orders || e->is_curved())
+              {
+                refmap.set_quad_2d(&quad_ord);
+                refmap.set_active_element(e);
+                x = refmap.get_phys_x(1);
+                y = refmap.get_phys_y(1);
 
-            for (int i = 0; i < num_edge[mode][1]; i++)
-            {
-              if (e->en[ord_edge[mode][1][i][2]]->bnd || (y[ord_edge[mode][1][i][0] + 1] < y[ord_edge[mode][1][i][1] + 1]) ||
-                ((y[ord_edge[mode][1][i][0] + 1] == y[ord_edge[mode][1][i][1] + 1]) &&
-                (x[ord_edge[mode][1][i][0] + 1] < x[ord_edge[mode][1][i][1] + 1])))
+                pt = quad_ord.get_points(1, e->get_mode());
+                np = quad_ord.get_num_points(1, e->get_mode());
+              }
+              else
               {
-                add_edge(id[ord_edge[mode][1][i][0]], id[ord_edge[mode][1][i][1]], e->en[ord_edge[mode][1][i][2]]->marker);
+                refmap.set_quad_2d(&quad_ord_simple);
+                refmap.set_active_element(e);
+                x = refmap.get_phys_x(1);
+                y = refmap.get_phys_y(1);
+
+                pt = quad_ord_simple.get_points(1, e->get_mode());
+                np = quad_ord_simple.get_num_points(1, e->get_mode());
               }
-            }
-          }
-          else
-          {
-            make_vert(lvert[label_count], x[0], y[0], o[4]);
 
-            for (int i = 1; i < np; i++)
-              make_vert(id[i - 1], x[i], y[i], o[(int)pt[i][2]]);
+              int id[80];
+              assert(np <= 80);
 
-            for (int i = 0; i < num_elem_simple[mode][1]; i++)
-              this->add_triangle(id[ord_elem_simple[mode][1][i][0]], id[ord_elem_simple[mode][1][i][1]], id[ord_elem_simple[mode][1][i][2]], e->marker);
+              int mode = e->get_mode();
+              if (e->is_quad())
+              {
+                o[4] = H2D_GET_H_ORDER(oo);
+                o[5] = H2D_GET_V_ORDER(oo);
+              }
 
-            for (int i = 0; i < num_edge_simple[mode][1]; i++)
-              add_edge(id[ord_edge_simple[mode][1][i][0]], id[ord_edge_simple[mode][1][i][1]], e->en[ord_edge_simple[mode][1][i][2]]->marker);
-          }
+              // The label vertex (thread-local index for now, shifted in merge()).
+              lvert[element_i] = data.add_vertex(x[0], y[0], o[4]);
 
-          double xmin = 1e100, ymin = 1e100, xmax = -1e100, ymax = -1e100;
-          for (unsigned int k = 0; k < e->get_nvert(); k++)
-          {
-            if (e->vn[k]->x < xmin) xmin = e->vn[k]->x;
-            if (e->vn[k]->x > xmax) xmax = e->vn[k]->x;
-            if (e->vn[k]->y < ymin) ymin = e->vn[k]->y;
-            if (e->vn[k]->y > ymax) ymax = e->vn[k]->y;
-          }
-          lbox[label_count][0] = xmax - xmin;
-          lbox[label_count][1] = ymax - ymin;
-          ltext[label_count++] = labels[o[4]][o[5]];
-        }
+              for (int i = 1; i < np; i++)
+                id[i - 1] = data.add_vertex(x[i], y[i], o[(int)pt[i][2]]);
 
-        refmap.set_quad_2d(&g_quad_2d_std);
-      }
+              if (show_edge_orders || e->is_curved())
+              {
+                for (int i = 0; i < num_elem[mode][1]; i++)
+                  data.add_triangle(id[ord_elem[mode][1][i][0]], id[ord_elem[mode][1][i][1]], id[ord_elem[mode][1][i][2]], e->marker);
+
+                for (int i = 0; i < num_edge[mode][1]; i++)
+                {
+                  if (e->en[ord_edge[mode][1][i][2]]->bnd || (y[ord_edge[mode][1][i][0] + 1] < y[ord_edge[mode][1][i][1] + 1]) ||
+                    ((y[ord_edge[mode][1][i][0] + 1] == y[ord_edge[mode][1][i][1] + 1]) &&
+                    (x[ord_edge[mode][1][i][0] + 1] < x[ord_edge[mode][1][i][1] + 1])))
+                  {
+                    data.add_edge(id[ord_edge[mode][1][i][0]], id[ord_edge[mode][1][i][1]], e->en[ord_edge[mode][1][i][2]]->marker);
+                  }
+                }
+              }
+              else
+              {
+                for (int i = 0; i < num_elem_simple[mode][1]; i++)
+                  data.add_triangle(id[ord_elem_simple[mode][1][i][0]], id[ord_elem_simple[mode][1][i][1]], id[ord_elem_simple[mode][1][i][2]], e->marker);
 
-      void Orderizer::add_edge(int iv1, int iv2, int marker)
-      {
-#pragma omp critical(realloc_edges)
-        {
-          if (edges_count >= edges_size)
+                for (int i = 0; i < num_edge_simple[mode][1]; i++)
+                  data.add_edge(id[ord_edge_simple[mode][1][i][0]], id[ord_edge_simple[mode][1][i][1]], e->en[ord_edge_simple[mode][1][i][2]]->marker);
+              }
+
+              double xmin = 1e100, ymin = 1e100, xmax = -1e100, ymax = -1e100;
+              for (unsigned int k = 0; k < e->get_nvert(); k++)
+              {
+                if (e->vn[k]->x < xmin) xmin = e->vn[k]->x;
+                if (e->vn[k]->x > xmax) xmax = e->vn[k]->x;
+                if (e->vn[k]->y < ymin) ymin = e->vn[k]->y;
+                if (e->vn[k]->y > ymax) ymax = e->vn[k]->y;
+              }
+              lbox[element_i][0] = xmax - xmin;
+              lbox[element_i][1] = ymax - ymin;
+              ltext[element_i] = labels[o[4]][o[5]];
+            }
+          }
+          catch (Hermes::Exceptions::Exception& e)
+          {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+            this->exceptionMessageCaughtInParallelBlock = e.info();
+          }
+          catch (std::exception& e)
           {
-            edges = (int2*)realloc(edges, sizeof(int2)* (edges_size * 1.5));
-            edge_markers = (int*)realloc(edge_markers, sizeof(int)* (edges_size = edges_size * 1.5));
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+            this->exceptionMessageCaughtInParallelBlock = e.what();
           }
-          edges[edges_count][0] = iv1;
-          edges[edges_count][1] = iv2;
-          edge_markers[edges_count++] = marker;
         }
-      }
 
-      void Orderizer::add_triangle(int iv0, int iv1, int iv2, int marker)
-      {
-        int index;
-#pragma omp critical(realloc_triangles)
+        if (this->exceptionMessageCaughtInParallelBlock.empty())
         {
-          if (triangle_count >= triangle_size)
-          {
-            this->triangle_size *= 2;
-            tri_markers = (int*)realloc(tri_markers, sizeof(int)* triangle_size);
-            tris = (int3*)realloc(tris, sizeof(int3)* triangle_size);
-            if ((!tri_markers) || (!this->tris))
-            {
-              free();
-              throw Exceptions::Exception("Orderizer out of memory!");
-            }
-          }
-          index = triangle_count++;
+          this->merge(thread_data, element_starts);
+          this->label_count = num_elements;
         }
-        tris[index][0] = iv0;
-        tris[index][1] = iv1;
-        tris[index][2] = iv2;
-        tri_markers[index] = marker;
+
+        delete[] thread_data;
+        free_with_check(element_starts);
+
+        if (!this->exceptionMessageCaughtInParallelBlock.empty())
+          throw Hermes::Exceptions::Exception(this->exceptionMessageCaughtInParallelBlock.c_str());
       }
 
       void Orderizer::free()
@@ -391,6 +510,8 @@ namespace Hermes
         free_with_check(tri_markers, true);
         free_with_check(edges, true);
         free_with_check(edge_markers, true);
+        this->vertex_size = this->triangle_size = this->edges_size = this->label_size = 0;
+        this->vertex_count = this->triangle_count = this->edges_count = this->label_count = 0;
       }
 
       template<typename Scalar>
@@ -533,6 +654,145 @@ namespace Hermes
         fclose(f);
       }
 
+      template<typename Scalar>
+      void Orderizer::save_orders_vtu(SpaceSharedPtr<Scalar> space, const char* file_name)
+      {
+        process_space(space);
+        this->write_vtu(file_name, false, true);
+      }
+
+      template<typename Scalar>
+      void Orderizer::save_markers_vtu(SpaceSharedPtr<Scalar> space, const char* file_name)
+      {
+        process_space(space);
+        this->write_vtu(file_name, false, false);
+      }
+
+      template<typename Scalar>
+      void Orderizer::save_mesh_vtu(SpaceSharedPtr<Scalar> space, const char* file_name)
+      {
+        process_space(space);
+        this->write_vtu(file_name, true, false);
+      }
+
+      /// One block of the raw appended data - the byte count (UInt64) followed by the data.
+      static void write_vtu_block(FILE* f, const void* data, uint64_t size)
+      {
+        fwrite(&size, sizeof(uint64_t), 1, f);
+        if (size > 0)
+          fwrite(data, 1, size, f);
+      }
+
+      void Orderizer::write_vtu(const char* file_name, bool edges_as_cells, bool point_data) const
+      {
+        int num_cells = edges_as_cells ? this->edges_count : this->triangle_count;
+        int cell_size = edges_as_cells ? 2 : 3;
+        // The "3" means line, the "5" triangle in VTK.
+        uint8_t cell_type = edges_as_cells ? 3 : 5;
+
+        // Sizes of the appended blocks - data, points, connectivity, offsets, types.
+        uint64_t data_bytes = point_data ? (uint64_t)this->vertex_count * sizeof(float) : (uint64_t)num_cells * sizeof(int32_t);
+        uint64_t points_bytes = (uint64_t)this->vertex_count * 3 * sizeof(float);
+        uint64_t connectivity_bytes = (uint64_t)num_cells * cell_size * sizeof(int32_t);
+        uint64_t offsets_bytes = (uint64_t)num_cells * sizeof(int32_t);
+        uint64_t types_bytes = (uint64_t)num_cells * sizeof(uint8_t);
+
+        uint64_t offset_data = 0;
+        uint64_t offset_points = offset_data + sizeof(uint64_t) + data_bytes;
+        uint64_t offset_connectivity = offset_points + sizeof(uint64_t) + points_bytes;
+        uint64_t offset_offsets = offset_connectivity + sizeof(uint64_t) + connectivity_bytes;
+        uint64_t offset_types = offset_offsets + sizeof(uint64_t) + offsets_bytes;
+
+        FILE* f = fopen(file_name, "wb");
+        if (f == nullptr) throw Hermes::Exceptions::Exception("Could not open %s for writing.", file_name);
+
+        // The data are written in the native byte order.
+        uint16_t endianness_test = 1;
+        const char* byte_order = (*(uint8_t*)&endianness_test == 1) ? "LittleEndian" : "BigEndian";
+
+        fprintf(f, "<?xml version=\"1.0\"?>\n");
+        fprintf(f, "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"%s\" header_type=\"UInt64\">\n", byte_order);
+        fprintf(f, "  <UnstructuredGrid>\n");
+        fprintf(f, "    <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n", this->vertex_count, num_cells);
+        if (point_data)
+        {
+          fprintf(f, "      <PointData Scalars=\"Mesh\">\n");
+          fprintf(f, "        <DataArray type=\"Float32\" Name=\"Mesh\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_data);
+          fprintf(f, "      </PointData>\n");
+        }
+        else
+        {
+          fprintf(f, "      <CellData Scalars=\"Mesh\">\n");
+          fprintf(f, "        <DataArray type=\"Int32\" Name=\"Mesh\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_data);
+          fprintf(f, "      </CellData>\n");
+        }
+        fprintf(f, "      <Points>\n");
+        fprintf(f, "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_points);
+        fprintf(f, "      </Points>\n");
+        fprintf(f, "      <Cells>\n");
+        fprintf(f, "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_connectivity);
+        fprintf(f, "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_offsets);
+        fprintf(f, "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"%llu\"/>\n", (unsigned long long)offset_types);
+        fprintf(f, "      </Cells>\n");
+        fprintf(f, "    </Piece>\n");
+        fprintf(f, "  </UnstructuredGrid>\n");
+        fprintf(f, "  <AppendedData encoding=\"raw\">\n");
+        fprintf(f, "_");
+
+        // Data - orders or markers.
+        if (point_data)
+        {
+          float* values = malloc_with_check<float>(this->vertex_count);
+          for (int i = 0; i < this->vertex_count; i++)
+            values[i] = (float)this->verts[i][2];
+          write_vtu_block(f, values, data_bytes);
+          free_with_check(values);
+        }
+        else
+        {
+          int32_t* markers = malloc_with_check<int32_t>(num_cells);
+          for (int i = 0; i < num_cells; i++)
+            markers[i] = edges_as_cells ? this->edge_markers[i] : this->tri_markers[i];
+          write_vtu_block(f, markers, data_bytes);
+          free_with_check(markers);
+        }
+
+        // Points.
+        float* points = malloc_with_check<float>(3 * this->vertex_count);
+        for (int i = 0; i < this->vertex_count; i++)
+        {
+          points[3 * i] = (float)this->verts[i][0];
+          points[3 * i + 1] = (float)this->verts[i][1];
+          points[3 * i + 2] = 0.f;
+        }
+        write_vtu_block(f, points, points_bytes);
+        free_with_check(points);
+
+        // Cells.
+        int32_t* connectivity = malloc_with_check<int32_t>(cell_size * num_cells);
+        for (int i = 0; i < num_cells; i++)
+          for (int k = 0; k < cell_size; k++)
+            connectivity[cell_size * i + k] = edges_as_cells ? this->edges[i][k] : this->tris[i][k];
+        write_vtu_block(f, connectivity, connectivity_bytes);
+        free_with_check(connectivity);
+
+        int32_t* offsets = malloc_with_check<int32_t>(num_cells);
+        for (int i = 0; i < num_cells; i++)
+          offsets[i] = cell_size * (i + 1);
+        write_vtu_block(f, offsets, offsets_bytes);
+        free_with_check(offsets);
+
+        uint8_t* types = malloc_with_check<uint8_t>(num_cells);
+        for (int i = 0; i < num_cells; i++)
+          types[i] = cell_type;
+        write_vtu_block(f, types, types_bytes);
+        free_with_check(types);
+
+        fprintf(f, "\n  </AppendedData>\n");
+        fprintf(f, "</VTKFile>\n");
+        fclose(f);
+      }
+
       int Orderizer::get_labels(int*& lvert, char**& ltext, double2*& lbox) const
       {
         lvert = this->lvert;
@@ -610,6 +870,12 @@ namespace Hermes
       template HERMES_API void Orderizer::save_markers_vtk<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, const char* file_name);
       template HERMES_API void Orderizer::save_mesh_vtk<double>(const SpaceSharedPtr<double> space, const char* file_name);
       template HERMES_API void Orderizer::save_mesh_vtk<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, const char* file_name);
+      template HERMES_API void Orderizer::save_orders_vtu<double>(const SpaceSharedPtr<double> space, const char* file_name);
+      template HERMES_API void Orderizer::save_orders_vtu<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, const char* file_name);
+      template HERMES_API void Orderizer::save_markers_vtu<double>(const SpaceSharedPtr<double> space, const char* file_name);
+      template HERMES_API void Orderizer::save_markers_vtu<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, const char* file_name);
+      template HERMES_API void Orderizer::save_mesh_vtu<double>(const SpaceSharedPtr<double> space, const char* file_name);
+      template HERMES_API void Orderizer::save_mesh_vtu<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, const char* file_name);
       template HERMES_API void Orderizer::process_space<double>(const SpaceSharedPtr<double> space, bool);
       template HERMES_API void Orderizer::process_space<std::complex<double> >(const SpaceSharedPtr<std::complex<double> > space, bool);
     }
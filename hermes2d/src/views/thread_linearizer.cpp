@@ -177,7 +177,7 @@ namespace Hermes
         this->hash_table = malloc_with_check<ThreadLinearizerMultidimensional<LinearizerDataDimensions>, int>(this->vertex_size, this, true);
         memset(this->hash_table, 0xff, sizeof(int)* this->vertex_size);
 
-        this->info = malloc_with_check<ThreadLinearizerMultidimensional<LinearizerDataDimensions>, internal_vertex_info_t>(this->vertex_size, this, true);
+        this->info = realloc_with_check<ThreadLinearizerMultidimensional, internal_vertex_info_t>(this->info, this->vertex_size, this);
       }
 
       template<typename LinearizerDataDimensions>
@@ -187,7 +187,9 @@ namespace Hermes
           delete fns[j];
 
         free_with_check(this->hash_table, true);
-        free_with_check(this->info, true);
+        // FileExport - info is needed for merging the vertices of all threads, freed there.
+        if (this->linearizerOutputType == OpenGL)
+          free_with_check(this->info, true);
       }
 
       template<typename LinearizerDataDimensions>
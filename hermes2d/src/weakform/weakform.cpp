@@ -292,6 +292,15 @@ namespace Hermes
       return true;
     }
 
+    template<typename Scalar>
+    bool WeakForm<Scalar>::has_solution_independent_forms() const
+    {
+      for (unsigned int i = 0; i < this->forms.size(); i++)
+        if (this->forms[i]->is_solution_independent())
+          return true;
+      return false;
+    }
+
     template<typename Scalar>
     std::vector<MeshFunctionSharedPtr<Scalar> > WeakForm<Scalar>::get_ext() const
     {
@@ -299,7 +308,7 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    Form<Scalar>::Form(int i) : scaling_factor(1.0), wf(nullptr), assembleEverywhere(false), i(i)
+    Form<Scalar>::Form(int i) : scaling_factor(1.0), solution_independent(false), wf(nullptr), assembleEverywhere(false), i(i)
     {
       areas.push_back(HERMES_ANY);
       stage_time = 0.0;
@@ -346,6 +355,18 @@ namespace Hermes
       this->scaling_factor = scalingFactor;
     }
 
+    template<typename Scalar>
+    void Form<Scalar>::set_solution_independent(bool to_set)
+    {
+      this->solution_independent = to_set;
+    }
+
+    template<typename Scalar>
+    bool Form<Scalar>::is_solution_independent() const
+    {
+      return this->solution_independent;
+    }
+
     template<typename Scalar>
     void Form<Scalar>::set_ext(MeshFunctionSharedPtr<Scalar> ext)
     {
@@ -383,6 +404,7 @@ namespace Hermes
     {
       this->stage_time = other_form->stage_time;
       this->scaling_factor = other_form->scaling_factor;
+      this->solution_independent = other_form->solution_independent;
       this->u_ext_offset = other_form->u_ext_offset;
       this->previous_iteration_space_index = other_form->previous_iteration_space_index;
     }
@@ -438,6 +460,12 @@ namespace Hermes
       return Hermes::Ord();
     }
 
+    template<typename Scalar>
+    bool MatrixFormVol<Scalar>::integrand(int n, Func<Scalar> **u_ext, Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+    {
+      return false;
+    }
+
     template<typename Scalar>
     MatrixFormVol<Scalar>* MatrixFormVol<Scalar>::clone() const
     {
@@ -554,6 +582,12 @@ namespace Hermes
       return Hermes::Ord();
     }
 
+    template<typename Scalar>
+    bool VectorFormVol<Scalar>::integrand(int n, Func<Scalar> **u_ext, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+    {
+      return false;
+    }
+
     template<typename Scalar>
     VectorFormVol<Scalar>* VectorFormVol<Scalar>::clone() const
     {
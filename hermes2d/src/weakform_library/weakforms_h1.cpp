@@ -15,6 +15,7 @@
 
 #include "weakform_library/weakforms_h1.h"
 #include "weakform_library/integrals_h1.h"
+#include <typeinfo>
 
 namespace Hermes
 {
@@ -99,6 +100,10 @@ namespace Hermes
         GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        // The planar constant case below does not need them.
+        if (gt != HERMES_PLANAR || !coeff->is_constant())
+          coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR)
         {
           if (coeff->is_constant())
@@ -110,18 +115,18 @@ namespace Hermes
           else
           {
             for (int i = 0; i < n; i++)
-              result += wt[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+              result += wt[i] * coeff_values[i] * u->val[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * u->val[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * u->val[i] * v->val[i];
             }
           }
         }
@@ -155,6 +160,29 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultMatrixFormVol<Scalar>::integrand(int n, Func<Scalar> *u_ext[], Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultMatrixFormVol<Scalar>))
+          return false;
+
+        coeff->values(n, e->x, e->y, f, nullptr, nullptr);
+        if (gt == HERMES_PLANAR) {
+          for (int i = 0; i < n; i++)
+            f[i] *= u->val[i];
+        }
+        else if (gt == HERMES_AXISYM_X) {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->y[i] * u->val[i];
+        }
+        else {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->x[i] * u->val[i];
+        }
+        return true;
+      }
+
       template<typename Scalar>
       MatrixFormVol<Scalar>* DefaultMatrixFormVol<Scalar>::clone() const
       {
@@ -206,6 +234,10 @@ namespace Hermes
         Func<double> *v, GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT], coeff_derivatives[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        // The planar constant case below does not need them.
+        if (gt != HERMES_PLANAR || !coeff->is_constant())
+          coeff->values(n, u_ext[this->previous_iteration_space_index]->val, coeff_values, coeff_derivatives);
         if (gt == HERMES_PLANAR)
         {
           if (coeff->is_constant())
@@ -224,9 +256,9 @@ namespace Hermes
           {
             for (int i = 0; i < n; i++)
             {
-              result += wt[i] * (coeff->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u->val[i] *
+              result += wt[i] * (coeff_derivatives[i] * u->val[i] *
                 (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i])
-                + coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+                + coeff_values[i]
                 * (u->dx[i] * v->dx[i] + u->dy[i] * v->dy[i]));
             }
           }
@@ -234,17 +266,17 @@ namespace Hermes
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * (coeff->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u->val[i] *
+              result += wt[i] * e->y[i] * (coeff_derivatives[i] * u->val[i] *
                 (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i])
-                + coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+                + coeff_values[i]
                 * (u->dx[i] * v->dx[i] + u->dy[i] * v->dy[i]));
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * (coeff->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u->val[i] *
+              result += wt[i] * e->x[i] * (coeff_derivatives[i] * u->val[i] *
                 (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i])
-                + coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+                + coeff_values[i]
                 * (u->dx[i] * v->dx[i] + u->dy[i] * v->dy[i]));
             }
           }
@@ -386,6 +418,30 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultMatrixFormDiffusion<Scalar>::integrand(int n, Func<Scalar> *u_ext[], Func<double> *u, GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultMatrixFormDiffusion<Scalar>))
+          return false;
+
+        Scalar coeff_value = this->coeff->value(0.);
+        if (gt == HERMES_PLANAR) {
+          for (int i = 0; i < n; i++) {
+            f_x[i] = coeff_value * u->dx[i];
+            f_y[i] = coeff_value * u->dy[i];
+          }
+        }
+        else {
+          double* r = (gt == HERMES_AXISYM_X) ? e->y : e->x;
+          for (int i = 0; i < n; i++) {
+            f_x[i] = coeff_value * r[i] * u->dx[i];
+            f_y[i] = coeff_value * r[i] * u->dy[i];
+          }
+        }
+        return true;
+      }
+
       template<typename Scalar>
       MatrixFormVol<Scalar>* DefaultMatrixFormDiffusion<Scalar>::clone() const
       {
@@ -462,11 +518,15 @@ namespace Hermes
         Func<double> *v, GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff1_values[H2D_MAX_INTEGRATION_POINTS_COUNT], coeff1_derivatives[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff1->values(n, u_ext[this->previous_iteration_space_index]->val, coeff1_values, coeff1_derivatives);
+        Scalar coeff2_values[H2D_MAX_INTEGRATION_POINTS_COUNT], coeff2_derivatives[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff2->values(n, u_ext[this->previous_iteration_space_index]->val, coeff2_values, coeff2_derivatives);
         for (int i = 0; i < n; i++) {
-          result += wt[i] * (coeff1->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u->val[i] * u_ext[this->previous_iteration_space_index]->dx[i] * v->val[i]
-            + coeff1->value(u_ext[this->previous_iteration_space_index]->val[i]) * u->dx[i] * v->val[i]
-            + coeff2->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u->val[i] * u_ext[this->previous_iteration_space_index]->dy[i] * v->val[i]
-            + coeff2->value(u_ext[this->previous_iteration_space_index]->val[i]) * u->dy[i] * v->val[i]);
+          result += wt[i] * (coeff1_derivatives[i] * u->val[i] * u_ext[this->previous_iteration_space_index]->dx[i] * v->val[i]
+            + coeff1_values[i] * u->dx[i] * v->val[i]
+            + coeff2_derivatives[i] * u->val[i] * u_ext[this->previous_iteration_space_index]->dy[i] * v->val[i]
+            + coeff2_values[i] * u->dy[i] * v->val[i]);
         }
         return result;
       }
@@ -536,20 +596,22 @@ namespace Hermes
         GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+            result += wt[i] * coeff_values[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * v->val[i];
             }
           }
         }
@@ -582,6 +644,25 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultVectorFormVol<Scalar>::integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultVectorFormVol<Scalar>))
+          return false;
+
+        coeff->values(n, e->x, e->y, f, nullptr, nullptr);
+        if (gt == HERMES_AXISYM_X) {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->y[i];
+        }
+        else if (gt == HERMES_AXISYM_Y) {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->x[i];
+        }
+        return true;
+      }
+
       template<typename Scalar>
       VectorFormVol<Scalar>* DefaultVectorFormVol<Scalar>::clone() const
       {
@@ -632,20 +713,22 @@ namespace Hermes
         GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+            result += wt[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
             }
           }
         }
@@ -678,6 +761,28 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultResidualVol<Scalar>::integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultResidualVol<Scalar>))
+          return false;
+
+        coeff->values(n, e->x, e->y, f, nullptr, nullptr);
+        Func<Scalar>* u_prev = u_ext[this->previous_iteration_space_index];
+        for (int i = 0; i < n; i++)
+          f[i] *= u_prev->val[i];
+        if (gt == HERMES_AXISYM_X) {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->y[i];
+        }
+        else if (gt == HERMES_AXISYM_Y) {
+          for (int i = 0; i < n; i++)
+            f[i] *= e->x[i];
+        }
+        return true;
+      }
+
       template<typename Scalar>
       VectorFormVol<Scalar>* DefaultResidualVol<Scalar>::clone() const
       {
@@ -726,22 +831,24 @@ namespace Hermes
         GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, u_ext[this->previous_iteration_space_index]->val, coeff_values, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+            result += wt[i] * coeff_values[i]
               * (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i]);
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+              result += wt[i] * e->y[i] * coeff_values[i]
                 * (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i]);
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(u_ext[this->previous_iteration_space_index]->val[i])
+              result += wt[i] * e->x[i] * coeff_values[i]
                 * (u_ext[this->previous_iteration_space_index]->dx[i] * v->dx[i] + u_ext[this->previous_iteration_space_index]->dy[i] * v->dy[i]);
             }
           }
@@ -764,6 +871,31 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultResidualDiffusion<Scalar>::integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultResidualDiffusion<Scalar>))
+          return false;
+
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        Func<Scalar>* u_prev = u_ext[this->previous_iteration_space_index];
+        coeff->values(n, u_prev->val, coeff_values, nullptr);
+        if (gt == HERMES_AXISYM_X) {
+          for (int i = 0; i < n; i++)
+            coeff_values[i] *= e->y[i];
+        }
+        else if (gt == HERMES_AXISYM_Y) {
+          for (int i = 0; i < n; i++)
+            coeff_values[i] *= e->x[i];
+        }
+        for (int i = 0; i < n; i++) {
+          f_x[i] = coeff_values[i] * u_prev->dx[i];
+          f_y[i] = coeff_values[i] * u_prev->dy[i];
+        }
+        return true;
+      }
+
       template<typename Scalar>
       VectorFormVol<Scalar>* DefaultResidualDiffusion<Scalar>::clone() const
       {
@@ -840,10 +972,14 @@ namespace Hermes
         GeomVol<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff1_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff1->values(n, u_ext[this->previous_iteration_space_index]->val, coeff1_values, nullptr);
+        Scalar coeff2_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff2->values(n, u_ext[this->previous_iteration_space_index]->val, coeff2_values, nullptr);
         Func<Scalar>* u_prev = u_ext[this->previous_iteration_space_index];
         for (int i = 0; i < n; i++) {
-          result += wt[i] * (coeff1->value(u_prev->val[i]) * (u_prev->dx[i] * v->val[i])
-            + coeff2->value(u_prev->val[i]) * (u_prev->dy[i] * v->val[i]));
+          result += wt[i] * (coeff1_values[i] * (u_prev->dx[i] * v->val[i])
+            + coeff2_values[i] * (u_prev->dy[i] * v->val[i]));
         }
         return result;
       }
@@ -861,6 +997,23 @@ namespace Hermes
         return result;
       }
 
+      template<typename Scalar>
+      bool DefaultResidualAdvection<Scalar>::integrand(int n, Func<Scalar> *u_ext[], GeomVol<double> *e, Func<Scalar> **ext, Scalar* f, Scalar* f_x, Scalar* f_y) const
+      {
+        // A subclass overriding only value() has to be integrated by its value().
+        if (typeid(*this) != typeid(DefaultResidualAdvection<Scalar>))
+          return false;
+
+        Scalar coeff1_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        Scalar coeff2_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        Func<Scalar>* u_prev = u_ext[this->previous_iteration_space_index];
+        coeff1->values(n, u_prev->val, coeff1_values, nullptr);
+        coeff2->values(n, u_prev->val, coeff2_values, nullptr);
+        for (int i = 0; i < n; i++)
+          f[i] = coeff1_values[i] * u_prev->dx[i] + coeff2_values[i] * u_prev->dy[i];
+        return true;
+      }
+
       template<typename Scalar>
       VectorFormVol<Scalar>* DefaultResidualAdvection<Scalar>::clone() const
       {
@@ -911,20 +1064,22 @@ namespace Hermes
         GeomSurf<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+            result += wt[i] * coeff_values[i] * u->val[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * u->val[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * u->val[i] * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * u->val[i] * v->val[i];
             }
           }
         }
@@ -1008,9 +1163,11 @@ namespace Hermes
         GeomSurf<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT], coeff_derivatives[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, u_ext[this->previous_iteration_space_index]->val, coeff_values, coeff_derivatives);
         for (int i = 0; i < n; i++) {
-          result += wt[i] * (coeff->derivative(u_ext[this->previous_iteration_space_index]->val[i]) * u_ext[this->previous_iteration_space_index]->val[i]
-            + coeff->value(u_ext[this->previous_iteration_space_index]->val[i]))
+          result += wt[i] * (coeff_derivatives[i] * u_ext[this->previous_iteration_space_index]->val[i]
+            + coeff_values[i])
             * u->val[i] * v->val[i];
         }
         return result;
@@ -1080,20 +1237,22 @@ namespace Hermes
         GeomSurf<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+            result += wt[i] * coeff_values[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * v->val[i];
             }
           }
         }
@@ -1177,20 +1336,22 @@ namespace Hermes
         GeomSurf<double> *e, Func<Scalar> **ext) const
       {
         Scalar result = 0;
+        Scalar coeff_values[H2D_MAX_INTEGRATION_POINTS_COUNT];
+        coeff->values(n, e->x, e->y, coeff_values, nullptr, nullptr);
         if (gt == HERMES_PLANAR) {
           for (int i = 0; i < n; i++) {
-            result += wt[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+            result += wt[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
           }
         }
         else {
           if (gt == HERMES_AXISYM_X) {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->y[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+              result += wt[i] * e->y[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
             }
           }
           else {
             for (int i = 0; i < n; i++) {
-              result += wt[i] * e->x[i] * coeff->value(e->x[i], e->y[i]) * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
+              result += wt[i] * e->x[i] * coeff_values[i] * u_ext[this->previous_iteration_space_index]->val[i] * v->val[i];
             }
           }
         }
@@ -0,0 +1,155 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example compares the matrix-free operator (MatrixFreeOperator) with the
+// assembled matrix for increasing polynomial degrees. For each degree it
+//
+//   - assembles the matrix (CSC) and checks that both give the same product,
+//   - measures the time of one product (SpMV vs. matrix-free application),
+//   - solves the problem by the matrix-free CG (MatrixFreeSolver) and checks
+//     the residual with the assembled matrix.
+//
+// The assembled product costs O(p^4) per element (the number of nonzeros), the
+// matrix-free one O(p^3) on affine quads (sum factorization), so the latter
+// wins for high degrees, besides not storing the matrix at all.
+//
+// PDE: Poisson equation -div(LAMBDA grad u) + C u = VOLUME_HEAT_SRC.
+//
+// Boundary conditions: Dirichlet u(x, y) = FIXED_BDY_TEMP on the boundary.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 4;
+// Polynomial degrees.
+const int P_MIN = 2;
+const int P_MAX = 10;
+// Number of products measured.
+const int NUM_PRODUCTS = 20;
+// Tolerance of the matrix-free CG.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+const double LAMBDA = 2.0;
+const double C = 1.0;
+const double VOLUME_HEAT_SRC = 5.0;
+const double FIXED_BDY_TEMP = 20.0;
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times.
+  for (unsigned int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+
+  // Initialize essential boundary conditions.
+  DefaultEssentialBCConst<double> bc_essential("Bdy", FIXED_BDY_TEMP);
+  EssentialBCs<double> bcs(&bc_essential);
+
+  // Initialize the weak formulation (linear forms only).
+  WeakFormSharedPtr<double> wf(new WeakForm<double>(1));
+  wf->add_matrix_form(new DefaultMatrixFormDiffusion<double>(0, 0, HERMES_ANY, new Hermes1DFunction<double>(LAMBDA), HERMES_SYM));
+  wf->add_matrix_form(new DefaultMatrixFormVol<double>(0, 0, HERMES_ANY, new Hermes2DFunction<double>(C), HERMES_SYM));
+  wf->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(VOLUME_HEAT_SRC)));
+
+  Hermes::Mixins::TimeMeasurable timer;
+  printf("   p    ndofs       nnz   SpMV [ms]    MF [ms]   CG iters   CG [s]\n");
+
+  try
+  {
+    for (int p = P_MIN; p <= P_MAX; p++)
+    {
+      SpaceSharedPtr<double> space(new H1Space<double>(mesh, &bcs, p));
+      int ndof = space->get_num_dofs();
+
+      // The assembled matrix.
+      CSCMatrix<double> matrix;
+      SimpleVector<double> rhs;
+      DiscreteProblem<double> dp(wf, space, true);
+      dp.assemble(&matrix, &rhs);
+
+      // The matrix-free operator.
+      MatrixFreeOperator<double> op(wf, space);
+      op.prepare();
+
+      double* x = new double[ndof];
+      double* y_assembled = new double[ndof];
+      double* y_matrix_free = new double[ndof];
+      for (int i = 0; i < ndof; i++)
+        x[i] = std::sin(0.1 * i);
+
+      timer.tick_reset();
+      for (int i = 0; i < NUM_PRODUCTS; i++)
+        matrix.multiply_with_vector(x, y_assembled, true);
+      timer.tick();
+      double time_assembled = timer.last() / NUM_PRODUCTS;
+
+      timer.tick_reset();
+      for (int i = 0; i < NUM_PRODUCTS; i++)
+        op.apply(x, y_matrix_free);
+      timer.tick();
+      double time_matrix_free = timer.last() / NUM_PRODUCTS;
+
+      double difference = 0., norm = 0.;
+      for (int i = 0; i < ndof; i++)
+      {
+        difference = std::max(difference, std::abs(y_assembled[i] - y_matrix_free[i]));
+        norm = std::max(norm, std::abs(y_assembled[i]));
+      }
+      if (difference > 1e-10 * norm)
+      {
+        printf("Products differ for p = %i: %g.\n", p, difference);
+        return -1;
+      }
+
+      // Matrix-free CG.
+      MatrixFreeSolver<double> solver(wf, space);
+      solver.set_tolerance(TOLERANCE);
+      timer.tick_reset();
+      solver.solve();
+      timer.tick();
+
+      // Residual with the assembled matrix.
+      matrix.multiply_with_vector(solver.get_sln_vector(), y_assembled, true);
+      double residual = 0., rhs_norm = 0.;
+      for (int i = 0; i < ndof; i++)
+      {
+        residual += (y_assembled[i] - rhs.get(i)) * (y_assembled[i] - rhs.get(i));
+        rhs_norm += rhs.get(i) * rhs.get(i);
+      }
+      if (std::sqrt(residual) > 1e3 * TOLERANCE * std::sqrt(rhs_norm))
+      {
+        printf("CG did not converge for p = %i: %g.\n", p, std::sqrt(residual / rhs_norm));
+        return -1;
+      }
+
+      printf("%4i %8i %9i %11.3f %10.3f %10i %8.3f\n", p, ndof, matrix.get_nnz(), 1e3 * time_assembled, 1e3 * time_matrix_free,
+        solver.get_num_iters(), timer.last());
+
+      delete[] x;
+      delete[] y_assembled;
+      delete[] y_matrix_free;
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Hermes2D;
+
+// This example measures the mesh operations which are dominated by the node
+// hash tables (HashTable) on a mesh with millions of nodes:
+//
+//   - uniform refinements (node creation),
+//   - searching the edge nodes of all active elements by their parents
+//     (peek_edge_node(), the search used by the mesh functions),
+//   - copying the mesh,
+//   - unrefinements (node removal).
+//
+// The found edge nodes are checked against the ones stored in the elements.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of uniform mesh refinements (4^REF_NUM elements).
+const int REF_NUM = 10;
+// Number of rounds of searching all edge nodes.
+const int NUM_SEARCH_ROUNDS = 5;
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  Hermes::Mixins::TimeMeasurable timer;
+
+  // Refinements.
+  timer.tick_reset();
+  for (int i = 0; i < REF_NUM; i++)
+    mesh->refine_all_elements(0, false);
+  timer.tick();
+  printf("Refinements:   %8.3f s (%i elements, %i vertex nodes, %i edge nodes)\n", timer.last(), mesh->get_num_active_elements(),
+    mesh->get_num_vertex_nodes(), mesh->get_num_edge_nodes());
+
+  // Searching the edge nodes.
+  long long searches = 0;
+  timer.tick_reset();
+  for (int round = 0; round < NUM_SEARCH_ROUNDS; round++)
+  {
+    Element* e;
+    for_all_active_elements(e, mesh)
+    {
+      for (unsigned char i = 0; i < e->get_nvert(); i++)
+      {
+        Node* en = mesh->peek_edge_node(e->vn[i]->id, e->vn[e->next_vert(i)]->id);
+        if (en != e->en[i])
+        {
+          printf("Wrong edge node of element %i.\n", e->id);
+          return -1;
+        }
+        searches++;
+      }
+    }
+  }
+  timer.tick();
+  printf("Searches:      %8.3f s (%lld searches)\n", timer.last(), searches);
+
+  // Copying.
+  MeshSharedPtr mesh_copy(new Mesh);
+  timer.tick_reset();
+  mesh_copy->copy(mesh);
+  timer.tick();
+  printf("Copy:          %8.3f s\n", timer.last());
+  if (mesh_copy->get_num_vertex_nodes() != mesh->get_num_vertex_nodes() || mesh_copy->get_num_edge_nodes() != mesh->get_num_edge_nodes())
+  {
+    printf("Wrong number of nodes of the copy.\n");
+    return -1;
+  }
+
+  // Unrefinements.
+  timer.tick_reset();
+  for (int i = 0; i < REF_NUM; i++)
+    mesh->unrefine_all_elements(false);
+  timer.tick();
+  printf("Unrefinements: %8.3f s (%i elements)\n", timer.last(), mesh->get_num_active_elements());
+
+  return 0;
+}
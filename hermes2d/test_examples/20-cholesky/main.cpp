@@ -0,0 +1,166 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Solvers;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example checks the built-in Cholesky solver (SOLVER_CHOLESKY) against UMFPACK
+// on the Poisson equation, both for real and complex (complex symmetric) coefficients.
+// The same CholeskySolver instance goes through all the MatrixStructureReuseScheme paths:
+//
+//   - HERMES_CREATE_STRUCTURE_FROM_SCRATCH (symbolic and numeric factorization),
+//   - HERMES_REUSE_MATRIX_REORDERING and HERMES_REUSE_MATRIX_REORDERING_AND_SCALING
+//     with changed matrix values (numeric factorization only),
+//   - HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY with a changed right-hand side (substitution only),
+//   - the automatic reuse of an unchanged structure, and a changed structure (higher degree).
+//
+// PDE: Poisson equation -div(LAMBDA grad u) + C u = VOLUME_HEAT_SRC.
+//
+// Boundary conditions: Dirichlet u(x, y) = FIXED_BDY_TEMP on the boundary.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 4;
+// Polynomial degree (the last step uses P_INIT + 1).
+const int P_INIT = 3;
+// Relative tolerance of the comparison with UMFPACK.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+const double VOLUME_HEAT_SRC = 5.0;
+const double FIXED_BDY_TEMP = 20.0;
+
+template<typename Scalar>
+WeakFormSharedPtr<Scalar> create_weak_form(Scalar lambda, Scalar c)
+{
+  WeakFormSharedPtr<Scalar> wf(new WeakForm<Scalar>(1));
+  wf->add_matrix_form(new DefaultMatrixFormDiffusion<Scalar>(0, 0, HERMES_ANY, new Hermes1DFunction<Scalar>(lambda), HERMES_SYM));
+  wf->add_matrix_form(new DefaultMatrixFormVol<Scalar>(0, 0, HERMES_ANY, new Hermes2DFunction<Scalar>(c), HERMES_SYM));
+  wf->add_vector_form(new DefaultVectorFormVol<Scalar>(0, HERMES_ANY, new Hermes2DFunction<Scalar>(Scalar(VOLUME_HEAT_SRC))));
+  return wf;
+}
+
+// Solves the system by the Cholesky solver with the given scheme, and compares the solution with UMFPACK.
+template<typename Scalar>
+bool check(const char* step, CholeskySolver<Scalar>& cholesky, MatrixStructureReuseScheme reuse_scheme, CSCMatrix<Scalar>* matrix, SimpleVector<Scalar>* rhs)
+{
+  cholesky.set_reuse_scheme(reuse_scheme);
+  cholesky.solve();
+
+  HermesCommonApi.set_integral_param_value(matrixSolverType, SOLVER_UMFPACK);
+  LinearMatrixSolver<Scalar>* umfpack = create_linear_solver<Scalar>(matrix, rhs);
+  umfpack->solve();
+
+  double difference = 0., norm = 0.;
+  for (unsigned int i = 0; i < matrix->get_size(); i++)
+  {
+    difference = std::max(difference, std::abs(cholesky.get_sln_vector()[i] - umfpack->get_sln_vector()[i]));
+    norm = std::max(norm, std::abs(umfpack->get_sln_vector()[i]));
+  }
+  delete umfpack;
+
+  printf("  %-45s %12.3e\n", step, difference / norm);
+  return difference <= TOLERANCE * norm;
+}
+
+template<typename Scalar>
+bool test(MeshSharedPtr mesh, Scalar lambda[3], Scalar c[3])
+{
+  DefaultEssentialBCConst<Scalar> bc_essential("Bdy", Scalar(FIXED_BDY_TEMP));
+  EssentialBCs<Scalar> bcs(&bc_essential);
+  SpaceSharedPtr<Scalar> space(new H1Space<Scalar>(mesh, &bcs, P_INIT));
+
+  CSCMatrix<Scalar> matrix;
+  SimpleVector<Scalar> rhs;
+  CholeskySolver<Scalar> cholesky(&matrix, &rhs);
+  bool success = true;
+
+  DiscreteProblem<Scalar> dp(create_weak_form(lambda[0], c[0]), space);
+  dp.assemble(&matrix, &rhs);
+  success = check("structure from scratch", cholesky, HERMES_CREATE_STRUCTURE_FROM_SCRATCH, &matrix, &rhs) && success;
+
+  // Changed values, the same structure.
+  dp.set_weak_formulation(create_weak_form(lambda[1], c[1]));
+  dp.assemble(&matrix, &rhs);
+  success = check("reuse reordering", cholesky, HERMES_REUSE_MATRIX_REORDERING, &matrix, &rhs) && success;
+
+  dp.set_weak_formulation(create_weak_form(lambda[2], c[2]));
+  dp.assemble(&matrix, &rhs);
+  success = check("reuse reordering and scaling", cholesky, HERMES_REUSE_MATRIX_REORDERING_AND_SCALING, &matrix, &rhs) && success;
+
+  // Changed right-hand side only.
+  for (unsigned int i = 0; i < rhs.get_size(); i++)
+    rhs.set(i, rhs.get(i) * Scalar(std::sin(0.1 * i)));
+  success = check("reuse structure completely (new rhs)", cholesky, HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY, &matrix, &rhs) && success;
+
+  // Structure from scratch requested, but unchanged - reused automatically.
+  dp.set_weak_formulation(create_weak_form(lambda[0], c[0]));
+  dp.assemble(&matrix, &rhs);
+  success = check("automatic reuse (unchanged structure)", cholesky, HERMES_CREATE_STRUCTURE_FROM_SCRATCH, &matrix, &rhs) && success;
+
+  // Changed structure.
+  space->set_uniform_order(P_INIT + 1);
+  space->assign_dofs();
+  dp.set_space(space);
+  dp.assemble(&matrix, &rhs);
+  success = check("changed structure", cholesky, HERMES_CREATE_STRUCTURE_FROM_SCRATCH, &matrix, &rhs) && success;
+
+  // The symbolic factorization done only for the first and the last step.
+  if (cholesky.get_structure_reuse_misses() != 2 || cholesky.get_structure_reuse_hits() != 4)
+  {
+    printf("  Unexpected structure reuse: %u hits, %u misses.\n", cholesky.get_structure_reuse_hits(), cholesky.get_structure_reuse_misses());
+    success = false;
+  }
+
+  return success;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times.
+  for (unsigned int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+
+  bool success = true;
+  try
+  {
+    printf("Real problem, relative difference to UMFPACK:\n");
+    double lambda[3] = { 1.0, 2.5, 0.5 };
+    double c[3] = { 0.0, 1.0, 3.0 };
+    success = test<double>(mesh, lambda, c) && success;
+
+    // Complex symmetric (not Hermitian) matrices.
+    printf("Complex problem, relative difference to UMFPACK:\n");
+    std::complex<double> lambda_complex[3] = { std::complex<double>(1.0, 0.5), std::complex<double>(2.0, -0.3), std::complex<double>(0.7, 0.1) };
+    std::complex<double> c_complex[3] = { std::complex<double>(1.0, 2.0), std::complex<double>(0.0, -1.0), std::complex<double>(3.0, 0.5) };
+    success = test<std::complex<double> >(mesh, lambda_complex, c_complex) && success;
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example checks the static condensation (MatrixSolver::use_static_condensation()) of the
+// element-interior (bubble) unknowns with both the full and the symmetric (lower triangle only,
+// symmetricMatrixStorage) matrix storage. All four combinations have to give the same solution.
+//
+// PDE: Poisson equation -div(LAMBDA grad u) + C u = VOLUME_HEAT_SRC.
+//
+// Boundary conditions: Dirichlet u(x, y) = FIXED_BDY_TEMP on the boundary.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 3;
+// Polynomial degree (high enough to have bubble functions).
+const int P_INIT = 5;
+// Relative tolerance of the comparison.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+const double LAMBDA = 2.0;
+const double C = 1.0;
+const double VOLUME_HEAT_SRC = 5.0;
+const double FIXED_BDY_TEMP = 20.0;
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times.
+  for (unsigned int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+
+  // Initialize essential boundary conditions.
+  DefaultEssentialBCConst<double> bc_essential("Bdy", FIXED_BDY_TEMP);
+  EssentialBCs<double> bcs(&bc_essential);
+  SpaceSharedPtr<double> space(new H1Space<double>(mesh, &bcs, P_INIT));
+  int ndof = space->get_num_dofs();
+
+  // Initialize the weak formulation (symmetric).
+  WeakFormSharedPtr<double> wf(new WeakForm<double>(1));
+  wf->add_matrix_form(new DefaultMatrixFormDiffusion<double>(0, 0, HERMES_ANY, new Hermes1DFunction<double>(LAMBDA), HERMES_SYM));
+  wf->add_matrix_form(new DefaultMatrixFormVol<double>(0, 0, HERMES_ANY, new Hermes2DFunction<double>(C), HERMES_SYM));
+  wf->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(VOLUME_HEAT_SRC)));
+
+  // The built-in Cholesky solver supports both storages.
+  HermesCommonApi.set_integral_param_value(matrixSolverType, SOLVER_CHOLESKY);
+
+  double* reference = nullptr;
+  bool success = true;
+  try
+  {
+    for (int symmetric_storage = 0; symmetric_storage < 2; symmetric_storage++)
+    {
+      HermesCommonApi.set_integral_param_value(symmetricMatrixStorage, symmetric_storage);
+      for (int condensation = 0; condensation < 2; condensation++)
+      {
+        LinearSolver<double> linear_solver(wf, space);
+        linear_solver.set_verbose_output(false);
+        linear_solver.use_static_condensation(condensation == 1);
+        linear_solver.solve();
+
+        // The first combination (full storage, no condensation) is the reference.
+        if (!reference)
+        {
+          reference = new double[ndof];
+          memcpy(reference, linear_solver.get_sln_vector(), ndof * sizeof(double));
+          continue;
+        }
+
+        double difference = 0., norm = 0.;
+        for (int i = 0; i < ndof; i++)
+        {
+          difference = std::max(difference, std::abs(linear_solver.get_sln_vector()[i] - reference[i]));
+          norm = std::max(norm, std::abs(reference[i]));
+        }
+        printf("%s storage, %s condensation: relative difference %g.\n", symmetric_storage ? "Symmetric" : "Full",
+          condensation ? "with" : "without", difference / norm);
+        if (difference > TOLERANCE * norm)
+          success = false;
+      }
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+  delete[] reference;
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
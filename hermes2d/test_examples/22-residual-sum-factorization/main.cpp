@@ -0,0 +1,159 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example measures the assembly of the residual vector with the sum-factorized
+// kernel (SumFactorizationKernel, used on affine quads for forms providing VectorFormVol::integrand())
+// against the per-test-function evaluation of the same forms, for increasing polynomial degrees.
+//
+// The default forms provide the integrand only for their exact type, so trivial subclasses of them
+// (overriding clone() only) are integrated by value() - those serve as the reference here.
+// Both residuals have to be the same.
+//
+// PDE: Poisson equation -div(LAMBDA grad u) + C u - VOLUME_HEAT_SRC = 0.
+//
+// Boundary conditions: Dirichlet u(x, y) = FIXED_BDY_TEMP on the boundary.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 4;
+// Polynomial degrees.
+const int P_MIN = 4;
+const int P_MAX = 10;
+// Number of assemblies measured.
+const int NUM_ASSEMBLIES = 5;
+// Relative tolerance of the comparison.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+const double LAMBDA = 2.0;
+const double C = 1.0;
+const double VOLUME_HEAT_SRC = 5.0;
+const double FIXED_BDY_TEMP = 20.0;
+
+// The same forms, but not of the exact default types, i.e. without the sum-factorized kernel.
+class ResidualDiffusionWithoutKernel : public DefaultResidualDiffusion<double>
+{
+public:
+  ResidualDiffusionWithoutKernel(Hermes1DFunction<double>* coeff) : DefaultResidualDiffusion<double>(0, HERMES_ANY, coeff), coeff(coeff) {};
+  VectorFormVol<double>* clone() const { return new ResidualDiffusionWithoutKernel(coeff); }
+private:
+  Hermes1DFunction<double>* coeff;
+};
+
+class ResidualVolWithoutKernel : public DefaultResidualVol<double>
+{
+public:
+  ResidualVolWithoutKernel(Hermes2DFunction<double>* coeff) : DefaultResidualVol<double>(0, HERMES_ANY, coeff), coeff(coeff) {};
+  VectorFormVol<double>* clone() const { return new ResidualVolWithoutKernel(coeff); }
+private:
+  Hermes2DFunction<double>* coeff;
+};
+
+class VectorFormVolWithoutKernel : public DefaultVectorFormVol<double>
+{
+public:
+  VectorFormVolWithoutKernel(Hermes2DFunction<double>* coeff) : DefaultVectorFormVol<double>(0, HERMES_ANY, coeff), coeff(coeff) {};
+  VectorFormVol<double>* clone() const { return new VectorFormVolWithoutKernel(coeff); }
+private:
+  Hermes2DFunction<double>* coeff;
+};
+
+// Assembles the residual NUM_ASSEMBLIES-times, returns the time of one assembly.
+double assemble(WeakFormSharedPtr<double> wf, SpaceSharedPtr<double> space, double* coeff_vec, SimpleVector<double>* residual)
+{
+  Hermes::Mixins::TimeMeasurable timer;
+  DiscreteProblem<double> dp(wf, space);
+  dp.set_verbose_output(false);
+  timer.tick_reset();
+  for (int i = 0; i < NUM_ASSEMBLIES; i++)
+    dp.assemble(coeff_vec, residual);
+  timer.tick();
+  return timer.last() / NUM_ASSEMBLIES;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times.
+  for (unsigned int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+
+  // Initialize essential boundary conditions.
+  DefaultEssentialBCConst<double> bc_essential("Bdy", FIXED_BDY_TEMP);
+  EssentialBCs<double> bcs(&bc_essential);
+
+  // The residual with the sum-factorized kernel.
+  WeakFormSharedPtr<double> wf_kernel(new WeakForm<double>(1));
+  wf_kernel->add_vector_form(new DefaultResidualDiffusion<double>(0, HERMES_ANY, new Hermes1DFunction<double>(LAMBDA)));
+  wf_kernel->add_vector_form(new DefaultResidualVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(C)));
+  wf_kernel->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(-VOLUME_HEAT_SRC)));
+
+  // The same residual without it.
+  WeakFormSharedPtr<double> wf_reference(new WeakForm<double>(1));
+  wf_reference->add_vector_form(new ResidualDiffusionWithoutKernel(new Hermes1DFunction<double>(LAMBDA)));
+  wf_reference->add_vector_form(new ResidualVolWithoutKernel(new Hermes2DFunction<double>(C)));
+  wf_reference->add_vector_form(new VectorFormVolWithoutKernel(new Hermes2DFunction<double>(-VOLUME_HEAT_SRC)));
+
+  printf("   p    ndofs   kernel [ms]   value() [ms]   speedup   rel. difference\n");
+
+  bool success = true;
+  try
+  {
+    for (int p = P_MIN; p <= P_MAX; p++)
+    {
+      SpaceSharedPtr<double> space(new H1Space<double>(mesh, &bcs, p));
+      int ndof = space->get_num_dofs();
+
+      double* coeff_vec = new double[ndof];
+      for (int i = 0; i < ndof; i++)
+        coeff_vec[i] = std::sin(0.1 * i);
+
+      SimpleVector<double> residual_kernel, residual_reference;
+      double time_kernel = assemble(wf_kernel, space, coeff_vec, &residual_kernel);
+      double time_reference = assemble(wf_reference, space, coeff_vec, &residual_reference);
+
+      double difference = 0., norm = 0.;
+      for (int i = 0; i < ndof; i++)
+      {
+        difference = std::max(difference, std::abs(residual_kernel.get(i) - residual_reference.get(i)));
+        norm = std::max(norm, std::abs(residual_reference.get(i)));
+      }
+
+      printf("%4i %8i %13.3f %14.3f %9.2f %17.3e\n", p, ndof, 1e3 * time_kernel, 1e3 * time_reference,
+        time_reference / time_kernel, difference / norm);
+      if (difference > TOLERANCE * norm)
+        success = false;
+
+      delete[] coeff_vec;
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
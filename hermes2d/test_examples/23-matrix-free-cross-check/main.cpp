@@ -0,0 +1,211 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example cross-checks the matrix-free operator (MatrixFreeOperator) against the assembled matrix:
+// the product with a random vector and the diagonal (get_diagonal()) have to be the same as those of
+// the CSC matrix DiscreteProblem assembles. It covers
+//
+//   - quads and triangles, including curved elements (see file domain.mesh),
+//   - hanging nodes (constrained functions) after an irregular refinement,
+//   - volumetric forms applied by sum factorization (default forms on affine quads) and through value()
+//     (a custom advection form, a subclass of a default form overriding value(), curved elements, triangles),
+//   - surface forms, on a straight and on a curved boundary,
+//   - a coupled H1 + L2 system with a symmetric (HERMES_SYM) off-diagonal form,
+//   - real and complex problems, one and several threads.
+//
+// The following parameters can be changed:
+
+// Polynomial degrees of the H1 space (the L2 space uses one less).
+const int P_DEGREES[] = { 1, 2, 4, 7 };
+// Numbers of threads.
+const int THREAD_COUNTS[] = { 1, 3 };
+// Relative tolerance of the comparison.
+const double TOLERANCE = 1e-10;
+
+// Nonsymmetric advection form, integrated through value() only.
+template<typename Scalar>
+class CustomAdvection : public MatrixFormVol<Scalar>
+{
+public:
+  CustomAdvection(int i, int j) : MatrixFormVol<Scalar>(i, j) {};
+
+  Scalar value(int n, double *wt, Func<Scalar> *u_ext[], Func<double> *u, Func<double> *v, GeomVol<double> *e, Func<Scalar> **ext) const
+  {
+    Scalar result = Scalar(0);
+    for (int i = 0; i < n; i++)
+      result += wt[i] * (2. * u->dx[i] + (1. + e->x[i]) * u->dy[i]) * v->val[i];
+    return result;
+  }
+
+  Ord ord(int n, double *wt, Func<Ord> *u_ext[], Func<Ord> *u, Func<Ord> *v, GeomVol<Ord> *e, Func<Ord> **ext) const
+  {
+    Ord result = Ord(0);
+    for (int i = 0; i < n; i++)
+      result += wt[i] * (u->dx[i] + e->x[i] * u->dy[i]) * v->val[i];
+    return result;
+  }
+
+  MatrixFormVol<Scalar>* clone() const { return new CustomAdvection<Scalar>(*this); }
+};
+
+// A default form with its value() overridden - the operator must not use the inherited integrand().
+template<typename Scalar>
+class ScaledDiffusion : public DefaultMatrixFormDiffusion<Scalar>
+{
+public:
+  ScaledDiffusion(int i, int j, Hermes1DFunction<Scalar>* coeff) : DefaultMatrixFormDiffusion<Scalar>(i, j, HERMES_ANY, coeff), coeff(coeff) {};
+
+  Scalar value(int n, double *wt, Func<Scalar> *u_ext[], Func<double> *u, Func<double> *v, GeomVol<double> *e, Func<Scalar> **ext) const
+  {
+    return Scalar(0.5) * DefaultMatrixFormDiffusion<Scalar>::value(n, wt, u_ext, u, v, e, ext);
+  }
+
+  MatrixFormVol<Scalar>* clone() const { return new ScaledDiffusion<Scalar>(this->i, this->j, this->coeff); }
+
+private:
+  Hermes1DFunction<Scalar>* coeff;
+};
+
+template<typename Scalar>
+WeakFormSharedPtr<Scalar> create_weak_form()
+{
+  WeakFormSharedPtr<Scalar> wf(new WeakForm<Scalar>(2));
+  wf->add_matrix_form(new DefaultMatrixFormDiffusion<Scalar>(0, 0, HERMES_ANY, new Hermes1DFunction<Scalar>(Scalar(2.0))));
+  wf->add_matrix_form(new ScaledDiffusion<Scalar>(0, 0, new Hermes1DFunction<Scalar>(Scalar(1.0))));
+  wf->add_matrix_form(new DefaultMatrixFormVol<Scalar>(0, 0, "Copper", new Hermes2DFunction<Scalar>(Scalar(3.0))));
+  wf->add_matrix_form(new CustomAdvection<Scalar>(0, 0));
+  wf->add_matrix_form(new DefaultMatrixFormVol<Scalar>(1, 1, HERMES_ANY, new Hermes2DFunction<Scalar>(Scalar(1.5))));
+  wf->add_matrix_form(new DefaultMatrixFormVol<Scalar>(0, 1, HERMES_ANY, new Hermes2DFunction<Scalar>(Scalar(0.5)), HERMES_SYM));
+  wf->add_matrix_form(new CustomAdvection<Scalar>(1, 0));
+  wf->add_matrix_form_surf(new DefaultMatrixFormSurf<Scalar>(0, 0, "Bottom", new Hermes2DFunction<Scalar>(Scalar(4.0))));
+  wf->add_matrix_form_surf(new DefaultMatrixFormSurf<Scalar>(0, 0, "Outer", new Hermes2DFunction<Scalar>(Scalar(2.5))));
+  wf->add_vector_form(new DefaultVectorFormVol<Scalar>(0, HERMES_ANY, new Hermes2DFunction<Scalar>(Scalar(1.0))));
+  return wf;
+}
+
+template<typename Scalar> Scalar random_value(int i);
+template<> double random_value<double>(int i) { return std::sin(0.7 * i + 0.3); }
+template<> std::complex<double> random_value<std::complex<double> >(int i) { return std::complex<double>(std::sin(0.7 * i + 0.3), std::cos(1.3 * i)); }
+
+// Compares the product and the diagonal with the assembled matrix.
+template<typename Scalar>
+bool check(WeakFormSharedPtr<Scalar> wf, std::vector<SpaceSharedPtr<Scalar> > spaces, int num_threads)
+{
+  HermesCommonApi.set_integral_param_value(numThreads, num_threads);
+
+  CSCMatrix<Scalar> matrix;
+  SimpleVector<Scalar> rhs;
+  DiscreteProblem<Scalar> dp(wf, spaces, true);
+  dp.set_verbose_output(false);
+  dp.assemble(&matrix, &rhs);
+  int ndof = matrix.get_size();
+
+  MatrixFreeOperator<Scalar> op(wf, spaces);
+
+  Scalar* x = new Scalar[ndof];
+  Scalar* y_assembled = new Scalar[ndof];
+  Scalar* y_matrix_free = new Scalar[ndof];
+  for (int i = 0; i < ndof; i++)
+    x[i] = random_value<Scalar>(i);
+
+  matrix.multiply_with_vector(x, y_assembled, true);
+  op.apply(x, y_matrix_free);
+  double difference = 0., norm = 0.;
+  for (int i = 0; i < ndof; i++)
+  {
+    difference = std::max(difference, std::abs(y_assembled[i] - y_matrix_free[i]));
+    norm = std::max(norm, std::abs(y_assembled[i]));
+  }
+
+  op.get_diagonal(y_matrix_free);
+  double diagonal_difference = 0., diagonal_norm = 0.;
+  for (int i = 0; i < ndof; i++)
+  {
+    diagonal_difference = std::max(diagonal_difference, std::abs(matrix.get(i, i) - y_matrix_free[i]));
+    diagonal_norm = std::max(diagonal_norm, std::abs(matrix.get(i, i)));
+  }
+
+  delete[] x;
+  delete[] y_assembled;
+  delete[] y_matrix_free;
+
+  printf(" %8i %8i %16.3e %16.3e\n", ndof, num_threads, difference / norm, diagonal_difference / diagonal_norm);
+  return difference <= TOLERANCE * norm && diagonal_difference <= TOLERANCE * diagonal_norm;
+}
+
+template<typename Scalar>
+bool test(const char* name)
+{
+  printf("%s problem:\n", name);
+  printf("   mesh         p    ndofs  threads   product (rel.)  diagonal (rel.)\n");
+
+  WeakFormSharedPtr<Scalar> wf = create_weak_form<Scalar>();
+  DefaultEssentialBCConst<Scalar> bc_essential(std::vector<std::string>({ "Inner", "Left" }), Scalar(1.0));
+  EssentialBCs<Scalar> bcs(&bc_essential);
+
+  bool success = true;
+  for (int hanging_nodes = 0; hanging_nodes < 2; hanging_nodes++)
+  {
+    // Load the mesh.
+    MeshSharedPtr mesh(new Mesh);
+    MeshReaderH2D mloader;
+    mloader.load("domain.mesh", mesh);
+    mesh->refine_all_elements();
+
+    // Irregular refinements: a quad next to a triangle (twice), and a curved triangle.
+    if (hanging_nodes)
+    {
+      mesh->refine_element_id(7);
+      mesh->refine_element_id(mesh->get_max_element_id() - 1);
+      mesh->refine_element_id(13);
+    }
+
+    for (unsigned int p_i = 0; p_i < sizeof(P_DEGREES) / sizeof(int); p_i++)
+    {
+      int p = P_DEGREES[p_i];
+      SpaceSharedPtr<Scalar> space_h1(new H1Space<Scalar>(mesh, &bcs, p));
+      SpaceSharedPtr<Scalar> space_l2(new L2Space<Scalar>(mesh, p - 1));
+      std::vector<SpaceSharedPtr<Scalar> > spaces({ space_h1, space_l2 });
+      Space<Scalar>::assign_dofs(spaces);
+
+      for (unsigned int threads_i = 0; threads_i < sizeof(THREAD_COUNTS) / sizeof(int); threads_i++)
+      {
+        printf("   %-10s %3i", hanging_nodes ? "irregular" : "regular", p);
+        success = check<Scalar>(wf, spaces, THREAD_COUNTS[threads_i]) && success;
+      }
+    }
+  }
+  return success;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+  try
+  {
+    success = test<double>("Real") && success;
+    success = test<std::complex<double> >("Complex") && success;
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example compares the two ways the sparse structure of a CS matrix is built
+// (DiscreteProblemSelectiveAssembler::use_assembly_list_pattern()):
+//
+//   - the page lists of SparseMatrix::pre_add_ij(), sorted in CSMatrix::alloc(),
+//   - directly from the element assembly lists (two-pass count-then-fill, in parallel).
+//
+// The structures are built for reference spaces (Space::ReferenceSpaceCreator) of an irregularly
+// refined mesh (hanging nodes) for increasing polynomial degrees. For each degree it checks that
+// both give the same Ap / Ai arrays, and prints the times.
+//
+// PDE: Poisson equation -div(LAMBDA grad u) + C u = VOLUME_HEAT_SRC.
+//
+// Boundary conditions: Dirichlet u(x, y) = FIXED_BDY_TEMP on the boundary.
+//
+// Geometry: Unit square (see file square.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 3;
+// Polynomial degrees of the coarse space (the reference space has one more).
+const int P_MIN = 1;
+const int P_MAX = 8;
+// Number of builds measured.
+const int NUM_BUILDS = 3;
+
+// Problem parameters.
+const double LAMBDA = 2.0;
+const double C = 1.0;
+const double VOLUME_HEAT_SRC = 5.0;
+const double FIXED_BDY_TEMP = 20.0;
+
+// Builds the structure of matrix NUM_BUILDS-times, returns the time of one build.
+double build(WeakFormSharedPtr<double> wf, SpaceSharedPtr<double> space, bool assembly_list_pattern, CSCMatrix<double>& matrix)
+{
+  std::vector<SpaceSharedPtr<double> > spaces(1, space);
+  std::vector<MeshSharedPtr> meshes(1, space->get_mesh());
+  Hermes::Mixins::TimeMeasurable timer;
+  double time = 0.;
+  for (int i = 0; i < NUM_BUILDS; i++)
+  {
+    Traverse trav(1);
+    unsigned int num_states;
+    Traverse::State** states = trav.get_states(meshes, num_states);
+
+    // A new instance every time, so that the structure is not reused.
+    DiscreteProblemSelectiveAssembler<double> selective_assembler;
+    selective_assembler.set_verbose_output(false);
+    selective_assembler.set_spaces(spaces);
+    selective_assembler.set_weak_formulation(wf);
+    selective_assembler.use_assembly_list_pattern(assembly_list_pattern);
+
+    matrix.free();
+    timer.tick_reset();
+    selective_assembler.prepare_sparse_structure(&matrix, nullptr, spaces, states, num_states);
+    timer.tick();
+    time += timer.last();
+
+    for (unsigned int state_i = 0; state_i < num_states; state_i++)
+      delete states[state_i];
+    free_with_check(states);
+  }
+  return time / NUM_BUILDS;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("square.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times, then refine a corner more (hanging nodes).
+  for (unsigned int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+  mesh->refine_towards_vertex(0, 3);
+
+  // Initialize essential boundary conditions.
+  DefaultEssentialBCConst<double> bc_essential("Bdy", FIXED_BDY_TEMP);
+  EssentialBCs<double> bcs(&bc_essential);
+
+  // Initialize the weak formulation.
+  WeakFormSharedPtr<double> wf(new WeakForm<double>(1));
+  wf->add_matrix_form(new DefaultMatrixFormDiffusion<double>(0, 0, HERMES_ANY, new Hermes1DFunction<double>(LAMBDA), HERMES_SYM));
+  wf->add_matrix_form(new DefaultMatrixFormVol<double>(0, 0, HERMES_ANY, new Hermes2DFunction<double>(C), HERMES_SYM));
+  wf->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(VOLUME_HEAT_SRC)));
+
+  printf("   p    ndofs        nnz   pages [ms]   assembly lists [ms]   speedup\n");
+
+  bool success = true;
+  try
+  {
+    for (int p = P_MIN; p <= P_MAX; p++)
+    {
+      SpaceSharedPtr<double> space(new H1Space<double>(mesh, &bcs, p));
+
+      // The reference space.
+      Mesh::ReferenceMeshCreator ref_mesh_creator(mesh);
+      MeshSharedPtr ref_mesh = ref_mesh_creator.create_ref_mesh();
+      Space<double>::ReferenceSpaceCreator ref_space_creator(space, ref_mesh);
+      SpaceSharedPtr<double> ref_space = ref_space_creator.create_ref_space();
+
+      CSCMatrix<double> matrix_pages, matrix_assembly_lists;
+      double time_pages = build(wf, ref_space, false, matrix_pages);
+      double time_assembly_lists = build(wf, ref_space, true, matrix_assembly_lists);
+
+      // The same structures.
+      unsigned int size = matrix_pages.get_size();
+      bool same = (size == matrix_assembly_lists.get_size()) && (matrix_pages.get_nnz() == matrix_assembly_lists.get_nnz());
+      if (same)
+        same = !memcmp(matrix_pages.get_Ap(), matrix_assembly_lists.get_Ap(), (size + 1) * sizeof(int))
+        && !memcmp(matrix_pages.get_Ai(), matrix_assembly_lists.get_Ai(), matrix_pages.get_nnz() * sizeof(int));
+
+      printf("%4i %8i %10i %12.3f %21.3f %9.2f%s\n", p + 1, size, matrix_pages.get_nnz(), 1e3 * time_pages, 1e3 * time_assembly_lists,
+        time_pages / time_assembly_lists, same ? "" : "   structures differ!");
+      if (!same)
+        success = false;
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
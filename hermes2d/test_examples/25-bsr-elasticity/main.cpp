@@ -0,0 +1,179 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Solvers;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+using namespace Hermes::Hermes2D::WeakFormsElasticity;
+
+// This example checks the block compressed sparse row matrix (BSRMatrix) on linear elasticity:
+// the system is assembled both into a BSRMatrix (2 x 2 blocks, one per node / edge / bubble function)
+// and into a CSCMatrix, and
+//
+//   - the products with a random vector (multiply_with_vector()) are compared,
+//   - the matrix converted by BSRMatrix::to_csc() is compared entry by entry with the assembled one,
+//   - the system is solved through the converted matrix by the direct solver and compared with the solution
+//     of the assembled one.
+//
+// PDE: Lame equations of linear elasticity, a beam fixed on the left and loaded by gravity and
+// a traction on the right end.
+//
+// Boundary conditions: u_1 = u_2 = 0 on "Left", zero traction on "Bottom" and "Top",
+// traction (0, TRACTION) on "Right".
+//
+// Geometry: Rectangle (0, 3) x (0, 1), quads and triangles, refined towards a corner (hanging nodes),
+// see file beam.mesh.
+//
+// The following parameters can be changed:
+
+// Polynomial degrees.
+const int P_DEGREES[] = { 1, 2, 4, 6 };
+// Relative tolerance of the comparison.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+// Young modulus for steel: 200 GPa.
+const double E = 200e9;
+// Poisson ratio.
+const double NU = 0.3;
+// Density.
+const double RHO = 8000.0;
+// Gravitational acceleration.
+const double GRAV = 9.81;
+// Traction on the right end.
+const double TRACTION = -1e6;
+// First Lame constant.
+const double LAMBDA = (E * NU) / ((1 + NU) * (1 - 2 * NU));
+// Second Lame constant.
+const double MU = E / (2 * (1 + NU));
+
+// Maximum of |a - b| relative to the maximum of |b|.
+double relative_difference(const double* a, const double* b, int size)
+{
+  double difference = 0., norm = 0.;
+  for (int i = 0; i < size; i++)
+  {
+    difference = std::max(difference, std::abs(a[i] - b[i]));
+    norm = std::max(norm, std::abs(b[i]));
+  }
+  return difference / norm;
+}
+
+// Largest difference of the entries of the two CSC matrices relative to the largest entry.
+// Both structures are traversed, an entry missing in one of them has to be zero in the other.
+double relative_difference(CSCMatrix<double>& a, CSCMatrix<double>& b)
+{
+  double difference = 0., norm = 0.;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    CSCMatrix<double>& traversed = pass ? b : a;
+    CSCMatrix<double>& other = pass ? a : b;
+    for (unsigned int col = 0; col < traversed.get_size(); col++)
+      for (int entry = traversed.get_Ap()[col]; entry < traversed.get_Ap()[col + 1]; entry++)
+      {
+        int row = traversed.get_Ai()[entry];
+        difference = std::max(difference, std::abs(traversed.get_Ax()[entry] - other.get(row, col)));
+        norm = std::max(norm, std::abs(traversed.get_Ax()[entry]));
+      }
+  }
+  return difference / norm;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("beam.mesh", mesh);
+
+  // Refine all elements, then the bottom right corner more (hanging nodes).
+  mesh->refine_all_elements();
+  mesh->refine_towards_vertex(3, 2);
+
+  // Initialize essential boundary conditions.
+  DefaultEssentialBCConst<double> bc_essential("Left", 0.0);
+  EssentialBCs<double> bcs(&bc_essential);
+
+  // Initialize the weak formulation.
+  WeakFormSharedPtr<double> wf(new WeakForm<double>(2));
+  wf->add_matrix_form(new DefaultJacobianElasticity_0_0<double>(0, 0, LAMBDA, MU));
+  wf->add_matrix_form(new DefaultJacobianElasticity_0_1<double>(0, 1, LAMBDA, MU));
+  wf->add_matrix_form(new DefaultJacobianElasticity_1_1<double>(1, 1, LAMBDA, MU));
+  wf->add_vector_form(new DefaultVectorFormVol<double>(1, HERMES_ANY, new Hermes2DFunction<double>(-RHO * GRAV)));
+  wf->add_vector_form_surf(new DefaultVectorFormSurf<double>(1, "Right", new Hermes2DFunction<double>(TRACTION)));
+
+  printf("   p    ndofs    blocks   product (rel.)   to_csc (rel.)   solution (rel.)\n");
+
+  bool success = true;
+  try
+  {
+    for (unsigned int p_i = 0; p_i < sizeof(P_DEGREES) / sizeof(int); p_i++)
+    {
+      int p = P_DEGREES[p_i];
+      SpaceSharedPtr<double> u1_space(new H1Space<double>(mesh, &bcs, p));
+      SpaceSharedPtr<double> u2_space(new H1Space<double>(mesh, &bcs, p));
+      std::vector<SpaceSharedPtr<double> > spaces({ u1_space, u2_space });
+      int ndof = Space<double>::assign_dofs(spaces);
+
+      // Assemble the block and the scalar matrix.
+      BSRMatrix<double> matrix_bsr(spaces.size());
+      CSCMatrix<double> matrix_csc;
+      SimpleVector<double> rhs_bsr, rhs_csc;
+      DiscreteProblem<double> dp(wf, spaces);
+      dp.set_verbose_output(false);
+      dp.assemble(&matrix_bsr, &rhs_bsr);
+      dp.assemble(&matrix_csc, &rhs_csc);
+
+      // The products.
+      double* x = new double[ndof];
+      double* y_bsr = new double[ndof];
+      double* y_csc = new double[ndof];
+      for (int i = 0; i < ndof; i++)
+        x[i] = std::sin(0.7 * i + 0.3);
+      matrix_bsr.multiply_with_vector(x, y_bsr, true);
+      matrix_csc.multiply_with_vector(x, y_csc, true);
+      double product_difference = relative_difference(y_bsr, y_csc, ndof);
+
+      // The conversion.
+      CSCMatrix<double> matrix_converted;
+      matrix_bsr.to_csc(&matrix_converted);
+      double matrix_difference = relative_difference(matrix_converted, matrix_csc);
+
+      // Solve both systems.
+      LinearMatrixSolver<double>* solver_converted = create_linear_solver<double>(&matrix_converted, &rhs_bsr);
+      solver_converted->solve();
+      LinearMatrixSolver<double>* solver_csc = create_linear_solver<double>(&matrix_csc, &rhs_csc);
+      solver_csc->solve();
+      double solution_difference = relative_difference(solver_converted->get_sln_vector(), solver_csc->get_sln_vector(), ndof);
+
+      printf("%4i %8i %9i %16.3e %15.3e %17.3e\n", p, ndof, matrix_bsr.get_num_blocks(), product_difference, matrix_difference, solution_difference);
+      if (product_difference > TOLERANCE || matrix_difference > TOLERANCE || solution_difference > TOLERANCE)
+        success = false;
+
+      delete solver_converted;
+      delete solver_csc;
+      delete[] x;
+      delete[] y_bsr;
+      delete[] y_csc;
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Algebra;
+using namespace Hermes::Hermes2D;
+using namespace Hermes::Hermes2D::WeakFormsH1;
+
+// This example checks the treatment of the mass matrix with explicit Butcher's tables
+// (RungeKutta::set_explicit_mass_inversion()):
+//
+//   - L2 space (block-diagonal mass matrix, one block per element): the time stepping with the factorized
+//     blocks (HERMES_RK_MASS_BLOCK_DIAGONAL) has to give the same solution as the whole stage system
+//     passed to the matrix solver (HERMES_RK_MASS_FULL), up to round-off,
+//   - H1 space of degree 1 (no essential boundary conditions, the basis is a partition of unity):
+//     the lumped mass matrix (HERMES_RK_MASS_LUMPED) changes the solution, but it keeps the same integral
+//     of the solution as HERMES_RK_MASS_FULL, up to round-off (the column sums of the lumped and
+//     of the consistent mass matrix are the same).
+//
+// PDE: du/dt = div(DIFFUSIVITY grad u) - REACTION u + S(x, y), S(x, y) = 1 + SOURCE_GRADIENT x y,
+// (without the diffusion for the L2 space).
+//
+// Boundary conditions: zero flux.
+//
+// IC: u = 0.
+//
+// Geometry: Rectangle (0, 2) x (0, 1), a quad and two triangles (see file domain.mesh).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 2;
+// Polynomial degrees of the L2 space.
+const int P_DEGREES_L2[] = { 0, 1, 2, 3 };
+// Explicit Butcher's table.
+const ButcherTableType BUTCHER_TABLE_TYPE = Explicit_RK_4;
+// Time step, number of time steps.
+const double TIME_STEP = 0.02;
+const int NUM_TIME_STEPS = 10;
+// Relative tolerance of the comparison.
+const double TOLERANCE = 1e-10;
+
+// Problem parameters.
+const double DIFFUSIVITY = 1e-2;
+const double REACTION = 2.0;
+const double SOURCE_GRADIENT = 4.0;
+
+// Source S(x, y) = 1 + SOURCE_GRADIENT x y.
+class CustomSource : public Hermes2DFunction<double>
+{
+public:
+  CustomSource() : Hermes2DFunction<double>() {}
+
+  virtual double value(double x, double y) const
+  {
+    return 1.0 + SOURCE_GRADIENT * x * y;
+  }
+
+  virtual Ord value(Ord x, Ord y) const
+  {
+    return x * y;
+  }
+};
+
+// The right-hand side of du/dt = f(u), Jacobian and residual.
+WeakFormSharedPtr<double> create_weak_form(bool diffusion)
+{
+  WeakFormSharedPtr<double> wf(new WeakForm<double>(1));
+  if (diffusion)
+  {
+    wf->add_matrix_form(new DefaultJacobianDiffusion<double>(0, 0, HERMES_ANY, new Hermes1DFunction<double>(-DIFFUSIVITY)));
+    wf->add_vector_form(new DefaultResidualDiffusion<double>(0, HERMES_ANY, new Hermes1DFunction<double>(-DIFFUSIVITY)));
+  }
+  wf->add_matrix_form(new DefaultMatrixFormVol<double>(0, 0, HERMES_ANY, new Hermes2DFunction<double>(-REACTION)));
+  wf->add_vector_form(new DefaultResidualVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(-REACTION)));
+  wf->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new CustomSource));
+  return wf;
+}
+
+// Performs NUM_TIME_STEPS steps from the zero initial condition, returns the coefficient vector of the solution.
+double* time_stepping(WeakFormSharedPtr<double> wf, SpaceSharedPtr<double> space, RungeKuttaMassInversion mass_inversion)
+{
+  ButcherTable bt(BUTCHER_TABLE_TYPE);
+  MeshFunctionSharedPtr<double> sln_time_prev(new ZeroSolution<double>(space->get_mesh()));
+  MeshFunctionSharedPtr<double> sln_time_new(new Solution<double>);
+
+  RungeKutta<double> runge_kutta(wf, space, &bt);
+  runge_kutta.set_verbose_output(false);
+  runge_kutta.set_explicit_mass_inversion(mass_inversion);
+  runge_kutta.set_time_step(TIME_STEP);
+
+  double current_time = 0.;
+  for (int ts = 0; ts < NUM_TIME_STEPS; ts++)
+  {
+    runge_kutta.set_time(current_time);
+    runge_kutta.rk_time_step_newton(sln_time_prev, sln_time_new);
+    sln_time_prev->copy(sln_time_new);
+    current_time += TIME_STEP;
+  }
+
+  double* coeff_vec = new double[space->get_num_dofs()];
+  OGProjection<double>::project_global(space, sln_time_new, coeff_vec);
+  return coeff_vec;
+}
+
+// Maximum of |a - b| relative to the maximum of |b|.
+double relative_difference(const double* a, const double* b, int size)
+{
+  double difference = 0., norm = 0.;
+  for (int i = 0; i < size; i++)
+  {
+    difference = std::max(difference, std::abs(a[i] - b[i]));
+    norm = std::max(norm, std::abs(b[i]));
+  }
+  return difference / norm;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("domain.mesh", mesh);
+
+  // Perform initial mesh refinements.
+  for (int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+
+  bool success = true;
+  try
+  {
+    // L2: block-diagonal vs. full mass matrix.
+    printf("L2:   p    ndofs   solution (rel.)\n");
+    WeakFormSharedPtr<double> wf_l2 = create_weak_form(false);
+    for (unsigned int p_i = 0; p_i < sizeof(P_DEGREES_L2) / sizeof(int); p_i++)
+    {
+      SpaceSharedPtr<double> space(new L2Space<double>(mesh, P_DEGREES_L2[p_i]));
+      int ndof = space->get_num_dofs();
+
+      double* coeff_vec_full = time_stepping(wf_l2, space, HERMES_RK_MASS_FULL);
+      double* coeff_vec_blocks = time_stepping(wf_l2, space, HERMES_RK_MASS_BLOCK_DIAGONAL);
+      double solution_difference = relative_difference(coeff_vec_blocks, coeff_vec_full, ndof);
+
+      printf("%8i %8i %17.3e\n", P_DEGREES_L2[p_i], ndof, solution_difference);
+      if (solution_difference > TOLERANCE)
+        success = false;
+
+      delete[] coeff_vec_full;
+      delete[] coeff_vec_blocks;
+    }
+
+    // H1: lumped vs. full mass matrix, the integrals of the solutions.
+    printf("H1:   p    ndofs   solution (rel.)   integral (rel.)\n");
+    WeakFormSharedPtr<double> wf_h1 = create_weak_form(true);
+    SpaceSharedPtr<double> space(new H1Space<double>(mesh, 1));
+    int ndof = space->get_num_dofs();
+
+    double* coeff_vec_full = time_stepping(wf_h1, space, HERMES_RK_MASS_FULL);
+    double* coeff_vec_lumped = time_stepping(wf_h1, space, HERMES_RK_MASS_LUMPED);
+    double solution_difference = relative_difference(coeff_vec_lumped, coeff_vec_full, ndof);
+
+    // Integrals of the basis functions.
+    WeakFormSharedPtr<double> wf_integral(new WeakForm<double>(1));
+    wf_integral->add_vector_form(new DefaultVectorFormVol<double>(0, HERMES_ANY, new Hermes2DFunction<double>(1.0)));
+    DiscreteProblem<double> dp_integral(wf_integral, space);
+    dp_integral.set_verbose_output(false);
+    SimpleVector<double> basis_integrals;
+    dp_integral.assemble(&basis_integrals);
+
+    double integral_full = 0., integral_lumped = 0.;
+    for (int i = 0; i < ndof; i++)
+    {
+      integral_full += basis_integrals.get(i) * coeff_vec_full[i];
+      integral_lumped += basis_integrals.get(i) * coeff_vec_lumped[i];
+    }
+    double integral_difference = std::abs(integral_lumped - integral_full) / std::abs(integral_full);
+
+    printf("%8i %8i %17.3e %17.3e\n", 1, ndof, solution_difference, integral_difference);
+    if (integral_difference > TOLERANCE)
+      success = false;
+
+    delete[] coeff_vec_full;
+    delete[] coeff_vec_lumped;
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
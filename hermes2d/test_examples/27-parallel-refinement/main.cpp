@@ -0,0 +1,217 @@
+#include "hermes2d.h"
+
+using namespace Hermes;
+using namespace Hermes::Hermes2D;
+
+// This example checks that the parallel refinement of one mesh (Mesh::refine_elements_id()) gives
+// exactly the same mesh as the serial one (Mesh::refine_element_id() for the elements in the same order):
+// the same element and node ids, the same element hierarchy, node pointers, boundary flags, markers,
+// reference counts, coordinates and hash table lookups.
+//
+// In every round, a pseudo-random part of the active elements is refined (quads to four quads or
+// anisotropically to two, triangles to four triangles) in a pseudo-random order, so that neighbouring
+// refinements fall into different partitions. Before that, some elements refined in the previous round
+// are unrefined again, so that the ids of the removed elements and nodes are reused.
+//
+// Geometry: Rectangle (0, 3) x (0, 1), two quads and two triangles (see file domain.mesh), refined
+// towards a corner (hanging nodes).
+//
+// The following parameters can be changed:
+
+// Number of initial uniform mesh refinements.
+const int INIT_REF_NUM = 3;
+// Number of rounds of refinements.
+const int NUM_ROUNDS = 6;
+// Numbers of threads of the parallel refinement.
+const int THREAD_COUNTS[] = { 2, 3, 4, 8 };
+// Percentage of the active elements refined / of the elements with active sons unrefined in a round.
+const unsigned int REFINED_PERCENTAGE = 60;
+const unsigned int UNREFINED_PERCENTAGE = 20;
+
+// Pseudo-random number of an element in a round.
+unsigned int element_hash(int id, int round, int salt)
+{
+  unsigned int h = (unsigned int)id * 2654435761u + (unsigned int)round * 40503u + (unsigned int)salt * 97u;
+  h ^= h >> 15;
+  h *= 2246822519u;
+  h ^= h >> 13;
+  return h;
+}
+
+// The ids of the elements and nodes (-1 for nullptr).
+int element_id(Element* e)
+{
+  return e ? e->id : -1;
+}
+
+int node_id(Node* node)
+{
+  return node ? node->id : -1;
+}
+
+// Compares the meshes element by element and node by node.
+bool same_meshes(MeshSharedPtr a, MeshSharedPtr b)
+{
+  if (a->get_max_element_id() != b->get_max_element_id() || a->get_num_active_elements() != b->get_num_active_elements()
+    || a->get_max_node_id() != b->get_max_node_id()
+    || a->refinements != b->refinements)
+    return false;
+
+  for (int id = 0; id < a->get_max_element_id(); id++)
+  {
+    Element* e_a = a->get_element_fast(id), *e_b = b->get_element_fast(id);
+    if (e_a->used != e_b->used)
+      return false;
+    if (!e_a->used)
+      continue;
+    if (e_a->active != e_b->active || e_a->marker != e_b->marker || e_a->nvert != e_b->nvert || e_a->iro_cache != e_b->iro_cache
+      || element_id(e_a->parent) != element_id(e_b->parent) || e_a->area != e_b->area || e_a->diameter != e_b->diameter)
+      return false;
+    for (int i = 0; i < e_a->nvert; i++)
+    {
+      if (node_id(e_a->vn[i]) != node_id(e_b->vn[i]))
+        return false;
+      if (e_a->active && node_id(e_a->en[i]) != node_id(e_b->en[i]))
+        return false;
+    }
+    for (int i = 0; i < H2D_MAX_ELEMENT_SONS && !e_a->active; i++)
+    if (element_id(e_a->sons[i]) != element_id(e_b->sons[i]))
+      return false;
+  }
+
+  for (int id = 0; id < a->get_max_node_id(); id++)
+  {
+    Node* n_a = a->get_node(id), *n_b = b->get_node(id);
+    if (n_a->used != n_b->used)
+      return false;
+    if (!n_a->used)
+      continue;
+    if (n_a->type != n_b->type || n_a->ref != n_b->ref || n_a->bnd != n_b->bnd || n_a->p1 != n_b->p1 || n_a->p2 != n_b->p2)
+      return false;
+    if (n_a->type == HERMES_TYPE_VERTEX)
+    {
+      if (n_a->x != n_b->x || n_a->y != n_b->y)
+        return false;
+      // Top-level vertex nodes are not in the hash table.
+      if (n_a->p1 >= 0 && (node_id(a->peek_vertex_node(n_a->p1, n_a->p2)) != id || node_id(b->peek_vertex_node(n_a->p1, n_a->p2)) != id))
+        return false;
+    }
+    else
+    {
+      if (n_a->marker != n_b->marker || element_id(n_a->elem[0]) != element_id(n_b->elem[0]) || element_id(n_a->elem[1]) != element_id(n_b->elem[1]))
+        return false;
+      if (node_id(a->peek_edge_node(n_a->p1, n_a->p2)) != id || node_id(b->peek_edge_node(n_a->p1, n_a->p2)) != id)
+        return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  MeshSharedPtr mesh(new Mesh);
+  MeshReaderH2D mloader;
+  mloader.load("domain.mesh", mesh);
+
+  // Refine all elements, do it INIT_REF_NUM-times, then the bottom right corner more (hanging nodes).
+  for (int i = 0; i < INIT_REF_NUM; i++)
+    mesh->refine_all_elements();
+  mesh->refine_towards_vertex(3, 3);
+
+  // The serially refined mesh and the meshes refined in parallel.
+  const int num_thread_counts = sizeof(THREAD_COUNTS) / sizeof(int);
+  std::vector<MeshSharedPtr> meshes_parallel;
+  for (int t = 0; t < num_thread_counts; t++)
+  {
+    meshes_parallel.push_back(MeshSharedPtr(new Mesh));
+    meshes_parallel[t]->copy(mesh);
+  }
+
+  printf("round   refined   elements      nodes   serial [ms]");
+  for (int t = 0; t < num_thread_counts; t++)
+    printf("   %i threads [ms]", THREAD_COUNTS[t]);
+  printf("\n");
+
+  bool success = true;
+  try
+  {
+    Hermes::Mixins::TimeMeasurable timer;
+    for (int round = 0; round < NUM_ROUNDS; round++)
+    {
+      // Unrefine some of the elements with active sons.
+      std::vector<int> unrefined_ids;
+      for (int id = 0; id < mesh->get_max_element_id(); id++)
+      {
+        Element* e = mesh->get_element_fast(id);
+        if (!e->used || e->active || element_hash(id, round, 1) % 100 >= UNREFINED_PERCENTAGE)
+          continue;
+        bool active_sons = true;
+        for (int i = 0; i < H2D_MAX_ELEMENT_SONS; i++)
+        if (e->sons[i] && !e->sons[i]->active)
+          active_sons = false;
+        if (active_sons)
+          unrefined_ids.push_back(id);
+      }
+      for (unsigned int i = 0; i < unrefined_ids.size(); i++)
+      {
+        mesh->unrefine_element_id(unrefined_ids[i]);
+        for (int t = 0; t < num_thread_counts; t++)
+          meshes_parallel[t]->unrefine_element_id(unrefined_ids[i]);
+      }
+
+      // The refinements, in the order of their pseudo-random numbers.
+      std::vector<std::pair<unsigned int, int> > order;
+      Element* e;
+      for_all_active_elements(e, mesh)
+      if (element_hash(e->id, round, 2) % 100 < REFINED_PERCENTAGE)
+        order.push_back(std::pair<unsigned int, int>(element_hash(e->id, round, 3), e->id));
+      std::sort(order.begin(), order.end());
+      std::vector<int> ids, refinements;
+      for (unsigned int i = 0; i < order.size(); i++)
+      {
+        ids.push_back(order[i].second);
+        refinements.push_back(mesh->get_element(order[i].second)->is_triangle() ? 0 : (int)(element_hash(order[i].second, round, 4) % 3));
+      }
+
+      // Serial refinement.
+      timer.tick_reset();
+      for (unsigned int i = 0; i < ids.size(); i++)
+        mesh->refine_element_id(ids[i], refinements[i]);
+      timer.tick();
+      double time_serial = timer.last();
+      printf("%5i %9i %10i %10i %13.3f", round, (int)ids.size(), mesh->get_num_active_elements(), mesh->get_max_node_id(), 1e3 * time_serial);
+
+      // Parallel refinements.
+      for (int t = 0; t < num_thread_counts; t++)
+      {
+        timer.tick_reset();
+        meshes_parallel[t]->refine_elements_id(ids, refinements, THREAD_COUNTS[t]);
+        timer.tick();
+        bool same = same_meshes(meshes_parallel[t], mesh);
+        printf(" %17.3f%s", 1e3 * timer.last(), same ? "" : " (differs!)");
+        if (!same)
+          success = false;
+      }
+      printf("\n");
+    }
+  }
+  catch (Exceptions::Exception& e)
+  {
+    std::cout << e.info();
+    return -1;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << e.what();
+    return -1;
+  }
+
+  if (!success)
+  {
+    printf("Failure!\n");
+    return -1;
+  }
+  printf("Success!\n");
+  return 0;
+}
@@ -37,6 +37,7 @@ namespace Hermes
     SOLVER_AMESOS = 6,
     SOLVER_AZTECOO = 7,
     SOLVER_EXTERNAL = 8,
+    SOLVER_CHOLESKY = 9,
     SOLVER_EMPTY = 100
   };
 
@@ -47,7 +48,9 @@ namespace Hermes
     DIRECT_SOLVER_SUPERLU = 5,
     DIRECT_SOLVER_AMESOS = 6,
     // Solver external is here, because direct solvers are used in projections.
-    DIRECT_SOLVER_EXTERNAL = 8
+    DIRECT_SOLVER_EXTERNAL = 8,
+    // Built-in, for symmetric (complex symmetric) positive definite matrices only.
+    DIRECT_SOLVER_CHOLESKY = 9
   };
 
   enum IterativeMatrixSolverType
@@ -0,0 +1,151 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file bsr_matrix.h
+\brief Block compressed sparse row (BSR) matrix for systems of equations.
+*/
+#ifndef __HERMES_COMMON_BSR_MATRIX_H
+#define __HERMES_COMMON_BSR_MATRIX_H
+
+#include "algebra/cs_matrix.h"
+
+namespace Hermes
+{
+  namespace Algebra
+  {
+    /// \brief Block compressed sparse row matrix.
+    /// Meant for systems of k equations whose unknowns come in groups of k (the components of one node), such as
+    /// elasticity or multigroup problems with all the spaces on the same mesh and with the same orders.
+    /// The nonzero structure is stored per blocks (k x k dense blocks, row-wise inside the block), which cuts the index
+    /// storage by k^2, and the matrix-vector product works with whole blocks.
+    ///
+    /// The interface works with the ordinary (scalar) indices, the block layout maps each of them to a block row / column
+    /// and a component in it:
+    /// - by default the equation-wise layout is used (i = component * (size / k) + block, the numbering of k spaces
+    ///   with identical DOF numbering),
+    /// - any other layout can be set by set_block_layout(), the components without a scalar unknown
+    ///   (e.g. a Dirichlet DOF in only one of the spaces) are kept in the blocks but never used.
+    /// The existing (CSC) solvers are served through to_csc().
+    ///
+    /// The matrix is standalone: create_matrix() never returns it (the matrix type there is given by the solver type),
+    /// and no linear solver takes it directly. It is created by the user, assembled by DiscreteProblem (which sets the block
+    /// layout from the assembly lists, block size = number of spaces), and then either used as an operator
+    /// (multiply_with_vector()), or converted for a solver.<br>
+    /// Typical usage:<br>
+    /// Hermes::Algebra::BSRMatrix<double> matrix(spaces.size());<br>
+    /// Hermes::Algebra::SimpleVector<double> rhs;<br>
+    /// Hermes::Hermes2D::DiscreteProblem<double> dp(wf, spaces);<br>
+    /// dp.assemble(&matrix, &rhs);<br>
+    /// Hermes::Algebra::CSCMatrix<double> csc;<br>
+    /// matrix.to_csc(&csc);<br>
+    /// Hermes::Solvers::LinearMatrixSolver<double>* solver = Hermes::Solvers::create_linear_solver<double>(&csc, &rhs);<br>
+    template <typename Scalar>
+    class HERMES_API BSRMatrix : public SparseMatrix < Scalar >
+    {
+    public:
+      /// \param[in] block_size The block size (number of equations) k.
+      BSRMatrix(unsigned int block_size = 1);
+      virtual ~BSRMatrix();
+
+      /// Set the block layout of the scalar unknowns.
+      /// \param[in] size Number of scalar unknowns (the matrix size).
+      /// \param[in] num_blocks Number of block rows (columns).
+      /// \param[in] dof_block Block of every scalar unknown.
+      /// \param[in] dof_component Component (0 .. k - 1) of every scalar unknown, at most one unknown per (block, component).
+      void set_block_layout(unsigned int size, unsigned int num_blocks, const int* dof_block, const int* dof_component);
+
+      /// Use the default (equation-wise) layout again.
+      void reset_block_layout();
+
+      virtual void prealloc(unsigned int n);
+      virtual void pre_add_ij(unsigned int row, unsigned int col);
+      virtual void alloc();
+      virtual void alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows);
+      /// Releases the structure and the values, the block layout is kept.
+      virtual void free();
+      virtual void zero();
+
+      virtual Scalar get(unsigned int m, unsigned int n) const;
+      virtual void add(unsigned int m, unsigned int n, Scalar v);
+      /// Local (element) matrix - the block positions are looked up once per pair of unknowns.
+      virtual void add(unsigned int m, unsigned int n, Scalar *mat, int *rows, int *cols, const int size);
+      virtual void set_row_zero(unsigned int n);
+
+      /// Block matrix-vector product.
+      virtual void multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized = false) const;
+      virtual void multiply_with_Scalar(Scalar value);
+
+      /// Matrices with the same structure and layout are added as vectors.
+      using SparseMatrix<Scalar>::add_as_block;
+      virtual void add_as_block(unsigned int i, unsigned int j, SparseMatrix<Scalar>* mat);
+
+      /// Exports the matrix converted to CSC (see to_csc()).
+      virtual void export_to_file(const char *filename, const char *var_name, MatrixExportFormat fmt, char* number_format = "%lf");
+
+      /// Fill the (scalar) CSC matrix with the contents, its previous contents are discarded.
+      /// All the entries of the used components of the blocks are kept (including the zero ones), so that the structure
+      /// does not depend on the values. A target with symmetric storage only gets the lower triangle.
+      void to_csc(CSCMatrix<Scalar>* target) const;
+
+      /// Duplicates a matrix (including allocation).
+      virtual SparseMatrix<Scalar>* duplicate() const;
+
+      /// Number of stored scalar entries (whole blocks).
+      virtual unsigned int get_nnz() const;
+      virtual double get_fill_in() const;
+
+      unsigned int get_block_size() const;
+      unsigned int get_num_blocks() const;
+      /// Number of nonzero blocks.
+      unsigned int get_num_nonzero_blocks() const;
+      /// Index to col_idx, where each block row starts (num_blocks + 1).
+      int* get_row_ptr() const;
+      /// Block column of each nonzero block.
+      int* get_col_idx() const;
+      /// Values, block by block, each block row-wise.
+      Scalar* get_values() const;
+      /// Scalar unknown of each (block, component) (num_blocks * k), -1 if unused.
+      int* get_block_dofs() const;
+
+    protected:
+      /// Create the default layout for the size, unless a layout is set.
+      void ensure_block_layout(unsigned int size);
+      /// Position of the block (block_row, block_col) in col_idx, -1 if not present.
+      int find_block(int block_row, int block_col) const;
+      /// Whether the other matrix has the same layout and block structure.
+      bool has_same_structure(const BSRMatrix<Scalar>* other) const;
+      void free_layout();
+
+      unsigned int block_size;
+      unsigned int num_blocks;
+      /// Layout.
+      int* dof_block;
+      int* dof_component;
+      int* block_dofs;
+      /// Set by set_block_layout() (otherwise the default one is created).
+      bool layout_set;
+
+      /// Structure.
+      int* row_ptr;
+      int* col_idx;
+      unsigned int nnz_blocks;
+      Scalar* values;
+    };
+  }
+}
+#endif
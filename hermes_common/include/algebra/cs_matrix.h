@@ -29,6 +29,40 @@ namespace Hermes
   /// \brief Namespace containing classes for vector / matrix operations.
   namespace Algebra
   {
+    /// \brief Immutable sparsity pattern (the Ap, Ai arrays) of a CS matrix.
+    /// Matrices with the same structure (a Jacobian and its copy, matrices assembled on the same spaces) can share
+    /// one instance through SparsityPatternSharedPtr - the arrays are released with the last reference.
+    /// See CSMatrix::get_sparsity_pattern(), CSMatrix::share_sparsity_pattern().
+    class HERMES_API SparsityPattern
+    {
+    public:
+      /// Takes over the arrays (allocated by malloc_with_check).
+      /// @param[in] row_wise Ap indexed by rows (CSR), otherwise by columns (CSC).
+      /// @param[in] symmetric_storage Only the lower (CSC) triangle is stored.
+      SparsityPattern(unsigned int size, int* Ap, int* Ai, bool row_wise, bool symmetric_storage);
+      ~SparsityPattern();
+
+      unsigned int get_size() const;
+      unsigned int get_nnz() const;
+      const int* get_Ap() const;
+      const int* get_Ai() const;
+      bool is_row_wise() const;
+      bool has_symmetric_storage() const;
+
+    private:
+      /// Not copyable.
+      SparsityPattern(const SparsityPattern&);
+      SparsityPattern& operator=(const SparsityPattern&);
+
+      unsigned int size;
+      int* Ap;
+      int* Ai;
+      bool row_wise;
+      bool symmetric_storage;
+    };
+
+    typedef std::tr1::shared_ptr<SparsityPattern> SparsityPatternSharedPtr;
+
     /// \brief General CS Matrix class.
     /// Either row- or column- specific (see subclassses).
     template <typename Scalar>
@@ -67,6 +101,8 @@ namespace Hermes
 
       /// Allocate utility storage (row, column indices, etc.).
       virtual void alloc();
+      /// Take over the pattern as Ap, Ai (with symmetric storage only its lower triangle, including the mirror image of the upper one).
+      virtual void alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows);
       // Allocate data storage.
       virtual void alloc_data();
       /// Utility method.
@@ -86,6 +122,15 @@ namespace Hermes
       /// \See Matrix<Scalar>::import_from_file.
       void import_from_file(const char *filename, const char *var_name, MatrixExportFormat fmt, bool invert_storage = false);
 
+      /// Computes the structure fingerprint (see get_structure_fingerprint()).
+      virtual void finish();
+
+      /// Fingerprint (hash of the size and the Ap, Ai arrays) of the sparsity structure, computed in finish().
+      /// Two matrices with the same fingerprint have (up to hash collisions) the same structure, so that the symbolic
+      /// factorization of one can be used for the other.
+      /// @return The fingerprint, 0 if not available (the structure changed since the last finish()).
+      unsigned long long get_structure_fingerprint() const;
+
       /// Utility method.
       virtual unsigned int get_nnz() const;
       /// Utility method.
@@ -109,8 +154,24 @@ namespace Hermes
       /// @param[in] j column in target matrix coresponding with lef column of added matrix
       /// @param[in] mat added matrix.
       using SparseMatrix<Scalar>::add_as_block;
+      /// If both matrices have the same structure (see has_same_sparsity_pattern()) and i == j == 0,
+      /// the values are added directly (as vectors).
       virtual void add_as_block(unsigned int i, unsigned int j, SparseMatrix<Scalar>* mat);
 
+      /// The sparsity pattern of this matrix, to be shared with other matrices (see share_sparsity_pattern()).
+      /// The first call hands the ownership of Ap, Ai over to the (reference-counted) pattern, the arrays are not copied.
+      /// @return The pattern, empty if the matrix has no structure.
+      SparsityPatternSharedPtr get_sparsity_pattern() const;
+
+      /// Use the pattern as Ap, Ai (no copy), and allocate the values (zero).
+      /// The previous contents of the matrix are discarded.
+      /// @return false (and nothing happens) if the pattern has a different orientation or storage than this matrix.
+      virtual bool share_sparsity_pattern(SparsityPatternSharedPtr pattern);
+
+      /// Whether the matrices have the same (orientation, storage and) Ap, Ai arrays.
+      /// Cheap if the pattern is shared or the structure fingerprints differ, a comparison of the arrays otherwise.
+      bool has_same_sparsity_pattern(const CSMatrix<Scalar>* other) const;
+
     protected:
       /// UMFPack specific data structures for storing the system matrix (CSC format).
       /// Matrix entries (column-wise).
@@ -121,6 +182,18 @@ namespace Hermes
       int *Ap;
       /// Number of non-zero entries ( =  Ap[size]).
       unsigned int nnz;
+      /// Fingerprint of Ap, Ai.
+      unsigned long long structure_fingerprint;
+      /// Calculates structure_fingerprint.
+      void calculate_structure_fingerprint();
+
+      /// Owner of Ap, Ai if they are shared with other matrices (or handed out by get_sparsity_pattern()), empty otherwise.
+      mutable SparsityPatternSharedPtr pattern;
+      /// Copy the shared Ap, Ai into arrays owned by this matrix (before they are modified in place).
+      void detach_sparsity_pattern();
+      /// Ap indexed by rows.
+      bool is_row_wise() const;
+
       template<typename T> friend SparseMatrix<T>*  create_matrix();
     };
 
@@ -154,6 +227,47 @@ namespace Hermes
       SparseMatrix<Scalar>* duplicate() const;
     };
 
+    /// \brief Symmetric CSC Matrix class - only the lower triangle (including the diagonal) is stored.
+    /// Meant for symmetric weak forms (HERMES_SYM), it halves the memory, the insertion work and the matrix-vector product bandwidth.
+    /// The matrix is symmetric (A = A^T), also in the complex case (no conjugation).
+    /// - pre_add_ij() registers the lower counterpart of every entry,
+    /// - add() ignores the entries above the diagonal (the assembling adds both triangles of a symmetric form),
+    /// - get() and multiply_with_vector() work with the whole (symmetric) matrix.
+    /// The CSC arrays (get_Ap(), get_Ai(), get_Ax()) only contain the lower triangle, solvers needing the full matrix use expand().
+    template <typename Scalar>
+    class HERMES_API SymmetricCSCMatrix : public CSCMatrix < Scalar >
+    {
+    public:
+      /// \brief Default constructor.
+      SymmetricCSCMatrix();
+
+      /// \brief Constructor with specific size
+      /// Calls alloc.
+      /// @param[in] size size of matrix (number of rows and columns)
+      SymmetricCSCMatrix(unsigned int size);
+
+      virtual ~SymmetricCSCMatrix();
+
+      virtual void pre_add_ij(unsigned int row, unsigned int col);
+
+      virtual Scalar get(unsigned int m, unsigned int n) const;
+
+      virtual void add(unsigned int m, unsigned int n, Scalar v);
+
+      virtual void multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized = false) const;
+
+      /// Matrix Market is exported as "symmetric" (the lower triangle), the other formats as the full matrix.
+      virtual void export_to_file(const char *filename, const char *var_name, MatrixExportFormat fmt, char* number_format = "%lf");
+
+      virtual bool has_symmetric_storage() const;
+
+      /// Fill the full matrix (both triangles) into target, its previous contents are discarded.
+      void expand(CSCMatrix<Scalar>* target) const;
+
+      /// Duplicates a matrix (including allocation).
+      SparseMatrix<Scalar>* duplicate() const;
+    };
+
     /// \brief General CSR Matrix class.
     /// (can be used in umfpack, in that case use the
     /// CSCMatrix subclass, or with EigenSolver, or anything else).
@@ -188,6 +302,9 @@ namespace Hermes
       /// @param[in] row  - row index
       /// @param[in] col  - column index
       virtual void pre_add_ij(unsigned int row, unsigned int col);
+
+      /// The pattern is transposed, Ap, Ai are row-wise.
+      virtual void alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows);
     };
   }
 }
@@ -121,6 +121,13 @@ namespace Hermes
       /// @param[in] col  - column index
       virtual void pre_add_ij(unsigned int row, unsigned int col);
 
+      /// Allocate the structure directly from a sparsity pattern, this replaces prealloc(), pre_add_ij() and alloc().
+      /// The default implementation feeds the pattern to pre_add_ij(), the CS matrices take it over as it is.
+      /// @param[in] size size of matrix
+      /// @param[in] pattern_ptr where the row indices of each column start in pattern_rows (size + 1 entries)
+      /// @param[in] pattern_rows row indices, sorted and without duplicities within each column
+      virtual void alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows);
+
       /// Finish manipulation with matrix (called before solving)
       virtual void finish();
 
@@ -182,6 +189,10 @@ namespace Hermes
       /// @return number of nonzero numbers in matrix
       virtual unsigned int get_nnz() const;
 
+      /// Whether only the lower triangle of a symmetric matrix (A = A^T) is stored.
+      /// Such matrices ignore additions above the diagonal (see SymmetricCSCMatrix).
+      virtual bool has_symmetric_storage() const;
+
     protected:
       /// Size of page (max number of indices stored in one page).
       /// DO NOT CHANGE, otherwise the data types in Page struct needs to be revisited.
@@ -0,0 +1,140 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file static_condensation.h
+\brief Static condensation (Schur complement elimination) of interior unknowns.
+*/
+#ifndef __HERMES_COMMON_STATIC_CONDENSATION_H
+#define __HERMES_COMMON_STATIC_CONDENSATION_H
+
+#include "algebra/cs_matrix.h"
+#include "algebra/vector.h"
+
+namespace Hermes
+{
+  namespace Algebra
+  {
+    /// \brief Static condensation of a linear system.
+    /// The unknowns marked as condensable (typically the element-interior - bubble - DOFs) are split into
+    /// independent groups (connected components of their mutual coupling in the matrix), each group is
+    /// eliminated by a dense LU decomposition of its diagonal block, and the Schur complement is stored
+    /// in a reduced matrix that only contains the remaining (skeleton) unknowns.
+    /// After the reduced system is solved, expand() recovers the full solution vector.
+    /// The factorized blocks are kept, so that a new right-hand side with the same matrix can be condensed cheaply (condense_rhs()).
+    template <typename Scalar>
+    class HERMES_API StaticCondensation : public Hermes::Mixins::Loggable
+    {
+    public:
+      StaticCondensation();
+      virtual ~StaticCondensation();
+
+      /// Groups of condensable unknowns larger than this are left in the reduced system.
+      /// Default: 256.
+      void set_max_block_size(int max_block_size);
+
+      /// Condense the system (matrix, rhs) into (reduced_matrix, reduced_rhs).
+      /// \param[in] matrix The full matrix, must be in one of the CS formats (with symmetric storage, the stored triangle is mirrored).
+      /// \param[in] rhs The full right-hand side.
+      /// \param[in] condensable Flags of the unknowns that may be eliminated (size = matrix size).
+      /// \param[out] reduced_matrix The reduced (Schur complement) matrix, its previous contents are discarded.
+      /// \param[out] reduced_rhs The reduced right-hand side, its previous contents are discarded.
+      void condense(CSMatrix<Scalar>* matrix, Vector<Scalar>* rhs, const bool* condensable, SparseMatrix<Scalar>* reduced_matrix, Vector<Scalar>* reduced_rhs);
+
+      /// Condense a new right-hand side using the factors from the last call to condense().
+      void condense_rhs(Vector<Scalar>* rhs, Vector<Scalar>* reduced_rhs);
+
+      /// Recover the full solution from the solution of the reduced system.
+      /// \return Full solution vector, owned by this instance (valid until the next call to condense() / expand()).
+      Scalar* expand(const Scalar* reduced_sln);
+
+      /// Restrict a full vector (e.g. an initial guess) to the reduced unknowns.
+      /// \return Reduced vector, owned by this instance (valid until the next call to condense() / restrict_vector()).
+      Scalar* restrict_vector(const Scalar* full_vector);
+
+      /// Size of the full system.
+      int get_size() const;
+      /// Size of the reduced system.
+      int get_reduced_size() const;
+      /// Whether condense() has been called and the data are available.
+      bool is_condensed() const;
+
+      /// Release all data.
+      void free();
+
+    protected:
+      /// One independent group of condensed unknowns.
+      struct Block
+      {
+        /// Condensed unknowns of this block (full indices).
+        std::vector<int> dofs;
+        /// Skeleton unknowns coupled to this block (reduced indices).
+        std::vector<int> skeleton;
+        /// LU decomposition of the diagonal block (dofs x dofs).
+        Scalar** lu;
+        /// Pivoting of the LU decomposition.
+        int* perm;
+        /// Coupling skeleton -> block (skeleton x dofs).
+        Scalar** coupling;
+        /// Inverse of the diagonal block times the coupling block -> skeleton (dofs x skeleton).
+        Scalar** solved_coupling;
+        /// Inverse of the diagonal block times the block part of the rhs.
+        Scalar* solved_rhs;
+      };
+
+      /// Factorize the diagonal block, false if it is singular.
+      bool factorize_block(Block& block, int* local_index);
+
+      /// Fill in coupling, solved_coupling, solved_rhs of the block, and the Schur complement contributions.
+      void process_block(Block& block, const Scalar* rhs_values, int* skeleton_index, std::vector<int>& contribution_rows, std::vector<int>& contribution_cols, std::vector<Scalar>& contribution_values);
+
+      /// Build the row-wise and column-wise views of the (whole) matrix.
+      void build_views(CSMatrix<Scalar>* matrix);
+
+      void free_blocks();
+      void free_views();
+
+      /// Sizes.
+      int size;
+      int reduced_size;
+      int max_block_size;
+
+      /// Reduced index of every unknown, -1 for the condensed ones.
+      int* reduced_index;
+      /// Block of every unknown, -1 for the skeleton ones.
+      int* block_index;
+
+      std::vector<Block> blocks;
+
+      /// Row-wise view of the matrix.
+      int* row_ptr;
+      int* row_idx;
+      Scalar* row_val;
+      /// Column-wise view of the matrix.
+      int* col_ptr;
+      int* col_idx;
+      Scalar* col_val;
+      /// Which views are owned (the native one points into the matrix).
+      bool row_view_owned, col_view_owned;
+
+      /// Output arrays.
+      Scalar* full_sln;
+      Scalar* reduced_vector;
+    };
+  }
+}
+#endif
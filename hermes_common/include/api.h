@@ -37,7 +37,11 @@ namespace Hermes
     directMatrixSolverType,
     showInternalWarnings,
     checkMeshesOnLoad,
-    useAccelerators
+    useAccelerators,
+    spaceFillingCurveOrdering,
+    /// Matrices for the solvers supporting it (UMFPACK, MUMPS, Cholesky, external) only store the lower triangle.
+    /// Only for problems with symmetric matrices (all matrix forms HERMES_SYM).
+    symmetricMatrixStorage
   };
 
   /// API Class containing settings for the whole HermesCommon.
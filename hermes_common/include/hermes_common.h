@@ -23,11 +23,15 @@
 #include "exceptions.h"
 #include "algebra/vector.h"
 #include "algebra/cs_matrix.h"
+#include "algebra/bsr_matrix.h"
 #include "algebra/dense_matrix_operations.h"
+#include "algebra/static_condensation.h"
 #include "solvers/linear_matrix_solver.h"
 #include "solvers/nonlinear_matrix_solver.h"
 #include "solvers/picard_matrix_solver.h"
 #include "solvers/newton_matrix_solver.h"
+#include "solvers/krylov_solver.h"
+#include "solvers/cholesky_solver.h"
 #include "solvers/interfaces/amesos_solver.h"
 #include "solvers/interfaces/aztecoo_solver.h"
 #include "solvers/interfaces/epetra.h"
@@ -61,6 +61,13 @@ namespace Hermes
     /// One-dimensional function derivative integration order.
     virtual Hermes::Ord derivative(Hermes::Ord x) const;
 
+    /// One-dimensional function values (and derivatives) in n points at once.
+    /// The default calls value() and derivative() point by point, descendants with a cheaper batched
+    /// evaluation (lookup tables, splines, ...) override this.
+    /// \param[out] out Values, n of them.
+    /// \param[out] dout Derivatives, n of them, nullptr if not needed.
+    virtual void values(int n, const Scalar* x, Scalar* out, Scalar* dout) const;
+
     /// The function is constant.
     /// Returns the value of is_const.
     bool is_constant() const;
@@ -106,6 +113,11 @@ namespace Hermes
     virtual Hermes::Ord derivative_x(Hermes::Ord x, Hermes::Ord y) const;
     virtual Hermes::Ord derivative_y(Hermes::Ord x, Hermes::Ord y) const;
 
+    /// Two-dimensional function values (and derivatives) in n points at once, see Hermes1DFunction::values().
+    /// \param[out] out Values, n of them.
+    /// \param[out] dout_x Derivatives with respect to x, n of them, nullptr if not needed (together with dout_y).
+    virtual void values(int n, const double* x, const double* y, Scalar* out, Scalar* dout_x, Scalar* dout_y) const;
+
     /// The function is constant.
     /// Returns the value of is_const.
     bool is_constant() const;
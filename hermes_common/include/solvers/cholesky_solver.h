@@ -0,0 +1,130 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file cholesky_solver.h
+\brief Built-in sparse (supernodal) Cholesky solver for symmetric positive definite systems.
+*/
+#ifndef __HERMES_COMMON_CHOLESKY_SOLVER_H_
+#define __HERMES_COMMON_CHOLESKY_SOLVER_H_
+
+#include "solvers/linear_matrix_solver.h"
+#include "algebra/cs_matrix.h"
+
+using namespace Hermes::Algebra;
+
+namespace Hermes
+{
+  namespace Solvers
+  {
+    /// \brief Sparse Cholesky solver (A = L L^T), no external library needed.
+    /// Only the lower triangle of the (CSC) matrix is used, the matrix must be symmetric positive definite.
+    /// Complex matrices must be complex symmetric (A = A^T, as assembled from symmetric forms, not Hermitian), they are
+    /// factorized without conjugation and without pivoting, i.e. the factorization may break down if the matrix is not definite.
+    /// - Symbolic phase: nested dissection ordering, elimination tree, supernodes and their structure.
+    /// - Numeric phase: multifrontal, each supernode is a dense panel factorized by blocked kernels, the supernodes
+    ///   on the same level of the elimination tree are factorized in parallel.
+    /// The symbolic phase is reused according to the MatrixStructureReuseScheme (HERMES_REUSE_MATRIX_REORDERING
+    /// and HERMES_REUSE_MATRIX_REORDERING_AND_SCALING only repeat the numeric phase, HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY
+    /// only the triangular solves).
+    template <typename Scalar>
+    class HERMES_API CholeskySolver : public DirectSolver < Scalar >
+    {
+    public:
+      /// Constructor of the Cholesky solver.
+      /// @param[in] m pointer to matrix
+      /// @param[in] rhs pointer to right hand side vector
+      CholeskySolver(CSCMatrix<Scalar> *m, SimpleVector<Scalar> *rhs);
+      virtual ~CholeskySolver();
+      virtual void solve();
+      virtual int get_matrix_size();
+      virtual void free();
+
+      /// Subgraphs up to this size are not dissected further.
+      /// Default: 64.
+      void set_nested_dissection_leaf_size(int leaf_size);
+
+      /// Number of nonzeros in the factor L (after the last symbolic phase).
+      long long get_factor_nnz() const;
+
+      /// Number of supernodes (after the last symbolic phase).
+      int get_num_supernodes() const;
+
+    protected:
+      /// Ordering, elimination tree, supernodes.
+      void symbolic_factorization();
+      /// Factorization of all supernodes.
+      void numeric_factorization();
+      /// Assembly and partial factorization of one supernode (frontal matrix).
+      void factorize_supernode(int supernode);
+      /// Forward and backward substitution, in place (permuted ordering).
+      void substitute(Scalar* x) const;
+
+      /// Nested dissection ordering of the graph (symmetric, without the diagonal).
+      /// \param[out] order order[new index] = old index.
+      void nested_dissection(const int* adjacency_ptr, const int* adjacency, int* order) const;
+
+      void free_symbolic();
+      void free_numeric();
+
+      /// Matrix to solve.
+      CSCMatrix<Scalar> *m;
+      /// Right hand side vector.
+      SimpleVector<Scalar> *rhs;
+
+      int leaf_size;
+
+      /// Size of the factorized matrix.
+      int size;
+      /// perm[new index] = old index.
+      int* perm;
+
+      /// Lower triangle of the permuted matrix (column-wise, sorted rows), values are taken from the matrix
+      /// through the map (index into Ax, -1 - index for the entries taken from the upper triangle, i.e. transposed).
+      int* a_ptr;
+      int* a_rows;
+      int* a_map;
+
+      /// Supernodes - first columns (num_supernodes + 1), parents (-1 for roots), children (CSR-like).
+      int num_supernodes;
+      int* super_start;
+      int* super_parent;
+      int* children_ptr;
+      int* children;
+
+      /// Row structure of each supernode (its own columns first, sorted).
+      int* struct_ptr;
+      int* struct_rows;
+
+      /// Supernodes grouped by their height in the tree - those in a group are independent.
+      int num_levels;
+      int* level_ptr;
+      int* level_nodes;
+
+      /// Factor - a dense column-major panel (rows of struct x columns of the supernode) per supernode.
+      long long* factor_ptr;
+      Scalar* factor;
+
+      /// Update (Schur complement) matrices passed from the supernodes to their parents during the numeric phase.
+      Scalar** updates;
+
+      bool symbolic_done;
+      bool numeric_done;
+    };
+  }
+}
+#endif
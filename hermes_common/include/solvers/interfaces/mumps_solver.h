@@ -77,7 +77,9 @@ namespace Hermes
     class MumpsMatrix : public CSCMatrix < Scalar >
     {
     public:
-      MumpsMatrix();
+      /// \param[in] symmetric_storage Only store the lower triangle of a symmetric matrix (MUMPS is then run
+      /// in the symmetric mode), see SymmetricCSCMatrix.
+      MumpsMatrix(bool symmetric_storage = false);
       virtual ~MumpsMatrix();
 
       void alloc_data();
@@ -87,6 +89,10 @@ namespace Hermes
 
       void add(unsigned int m, unsigned int n, Scalar v);
 
+      void pre_add_ij(unsigned int row, unsigned int col);
+
+      bool has_symmetric_storage() const;
+
       /// Matrix export method.
       /// Utility version
       /// \See MatrixRhsImportExport<Scalar>::export_to_file.
@@ -116,6 +122,8 @@ namespace Hermes
       int *jcn;
       /// Matrix entries (column-wise).
       typename mumps_type<Scalar>::mumps_Scalar *Ax;
+      /// Only the lower triangle is stored.
+      bool symmetric_storage;
 
       friend class Solvers::MumpsSolver < Scalar > ;
       template<typename T> friend SparseMatrix<T>*  create_matrix();
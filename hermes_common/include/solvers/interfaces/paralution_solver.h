@@ -62,6 +62,8 @@ namespace Hermes
       virtual void free();
       virtual void zero();
       virtual void alloc();
+      virtual void alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows);
+      virtual bool share_sparsity_pattern(SparsityPatternSharedPtr pattern);
 
       paralution::LocalMatrix<Scalar>& get_paralutionMatrix();
 
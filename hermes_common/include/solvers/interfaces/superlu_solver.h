@@ -124,6 +124,8 @@ namespace Hermes
       bool inited;
       /// Indicates that the system matrix has been changed.
       bool A_changed;
+      /// Reuse scheme of the last factorization (see DirectSolver::get_effective_reuse_scheme()).
+      MatrixStructureReuseScheme eff_fact_scheme;
       // internally during factorization or externally by
       // the user.
 
@@ -62,6 +62,13 @@ namespace Hermes
       /// Right hand side vector.
       SimpleVector<Scalar> *rhs;
 
+      /// Full matrix passed to UMFPACK if m only stores the lower triangle (SymmetricCSCMatrix).
+      CSCMatrix<Scalar> *expanded_matrix;
+      /// The matrix factorized in the current solve() - m, or expanded_matrix.
+      CSCMatrix<Scalar> *factorized_matrix;
+      /// Sets factorized_matrix, expands m if necessary.
+      void prepare_factorized_matrix();
+
       /// \brief Reusable factorization information (A denotes matrix represented by the pointer 'm').
       /// Reordering of matrix A to reduce fill-in during factorization.
       void *symbolic;
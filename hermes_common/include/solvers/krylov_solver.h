@@ -0,0 +1,135 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file krylov_solver.h
+\brief Built-in Krylov solvers working with abstract operators (no external library needed).
+*/
+#ifndef __HERMES_COMMON_KRYLOV_SOLVER_H_
+#define __HERMES_COMMON_KRYLOV_SOLVER_H_
+
+#include "common.h"
+#include "util/compat.h"
+
+namespace Hermes
+{
+  namespace Solvers
+  {
+    /// \brief Abstract linear operator for the Krylov solvers.
+    /// Only the action on a vector is needed, the operator does not have to be assembled.
+    template <typename Scalar>
+    class HERMES_API KrylovOperator
+    {
+    public:
+      virtual ~KrylovOperator() {};
+
+      /// out = Operator(in), both of the length passed to the Krylov solver.
+      virtual void apply(const Scalar* in, Scalar* out) = 0;
+    };
+
+    /// \brief Restarted GMRES with (optional) right preconditioning.
+    /// The preconditioner is applied to each Krylov vector separately (flexible variant), so it may even change
+    /// between the iterations (e.g. an inner iterative solver).
+    template <typename Scalar>
+    class HERMES_API GMRESSolver
+    {
+    public:
+      GMRESSolver();
+      virtual ~GMRESSolver();
+
+      /// Krylov subspace dimension before a restart.
+      /// Default: 30.
+      void set_restart(int restart);
+
+      /// Maximum number of (inner) iterations in total.
+      /// Default: 1000.
+      void set_max_iterations(int max_iterations);
+
+      /// Solve operator * x = rhs.
+      /// \param[in] op The operator.
+      /// \param[in] preconditioner The right preconditioner (approximation of the inverse), may be nullptr.
+      /// \param[in] rhs The right-hand side.
+      /// \param[in, out] x The initial guess on input, the solution on output.
+      /// \param[in] size The size of the vectors.
+      /// \param[in] relative_tolerance The iterations stop when |rhs - operator * x| <= relative_tolerance * |rhs|.
+      /// \return Whether the tolerance was reached.
+      bool solve(KrylovOperator<Scalar>* op, KrylovOperator<Scalar>* preconditioner, const Scalar* rhs, Scalar* x, int size, double relative_tolerance);
+
+      /// Number of iterations of the last solve().
+      int get_num_iters() const;
+
+      /// Relative residual norm reached by the last solve().
+      double get_relative_residual() const;
+
+    protected:
+      /// Release the Krylov basis.
+      void free();
+
+      int restart;
+      int max_iterations;
+
+      /// Krylov basis, preconditioned basis (both (restart + 1) x size), Hessenberg matrix.
+      Scalar** V;
+      Scalar** Z;
+      Scalar** H;
+      /// Allocated sizes.
+      int allocated_size;
+      int allocated_restart;
+
+      int num_iters;
+      double relative_residual;
+    };
+
+    /// \brief Preconditioned conjugate gradients.
+    /// For Hermitian positive definite operators (and preconditioners), such as the matrices of (symmetric) elliptic
+    /// problems. Only the work vectors are needed on top of the operator, no Krylov basis is stored.
+    template <typename Scalar>
+    class HERMES_API CGSolver
+    {
+    public:
+      CGSolver();
+      virtual ~CGSolver();
+
+      /// Maximum number of iterations.
+      /// Default: 1000.
+      void set_max_iterations(int max_iterations);
+
+      /// Solve operator * x = rhs.
+      /// \param[in] op The operator.
+      /// \param[in] preconditioner The preconditioner (approximation of the inverse), may be nullptr.
+      /// \param[in] rhs The right-hand side.
+      /// \param[in, out] x The initial guess on input, the solution on output.
+      /// \param[in] size The size of the vectors.
+      /// \param[in] relative_tolerance The iterations stop when |rhs - operator * x| <= relative_tolerance * |rhs|.
+      /// \return Whether the tolerance was reached.
+      bool solve(KrylovOperator<Scalar>* op, KrylovOperator<Scalar>* preconditioner, const Scalar* rhs, Scalar* x, int size, double relative_tolerance);
+
+      /// Number of iterations of the last solve().
+      int get_num_iters() const;
+
+      /// Relative residual norm reached by the last solve().
+      double get_relative_residual() const;
+
+    protected:
+      int max_iterations;
+
+      int num_iters;
+      double relative_residual;
+    };
+  }
+}
+#endif
@@ -222,6 +222,37 @@ namespace Hermes
 
       /// Returns 0. - for compatibility
       virtual double get_residual_norm() { return 0.; };
+
+      /// Decide about reusing the symbolic factorization (reordering) by the sparsity structure of the matrix (CSMatrix::get_structure_fingerprint()).
+      /// If the structure did not change, HERMES_CREATE_STRUCTURE_FROM_SCRATCH is turned into HERMES_REUSE_MATRIX_REORDERING,
+      /// if it did change, any reuse scheme is turned into HERMES_CREATE_STRUCTURE_FROM_SCRATCH.
+      /// Used by UMFPACK, SuperLU, MUMPS.
+      /// Default: true.
+      void set_automatic_structure_reuse(bool to_set = true);
+
+      /// Number of factorizations that reused the symbolic factorization.
+      unsigned int get_structure_reuse_hits() const;
+      /// Number of factorizations that had to perform the symbolic factorization.
+      unsigned int get_structure_reuse_misses() const;
+      /// Estimate of the time (in seconds) saved by the reuse - hits times the average duration of the symbolic factorization.
+      /// Only available for the solvers with a separate symbolic phase (UMFPACK), 0 otherwise.
+      double get_structure_reuse_time_saved() const;
+
+    protected:
+      /// The reuse scheme to be actually used for the matrix with the given structure.
+      /// Updates the statistics, and stores the fingerprint of the structure factorized from scratch.
+      /// \param[in] structure_fingerprint CSMatrix::get_structure_fingerprint(), 0 for an unknown structure (then reuse_scheme is used as it is).
+      /// \param[in] factorization_available Whether there is a symbolic factorization to reuse.
+      MatrixStructureReuseScheme get_effective_reuse_scheme(unsigned long long structure_fingerprint, bool factorization_available);
+
+      /// The solvers measure their symbolic factorization by ticking this one (tick(HERMES_SKIP) before, tick() after).
+      Hermes::Mixins::TimeMeasurable symbolic_factorization_timer;
+
+      bool automatic_structure_reuse;
+      /// Fingerprint of the structure of the last symbolic factorization.
+      unsigned long long factorized_structure_fingerprint;
+      unsigned int structure_reuse_hits;
+      unsigned int structure_reuse_misses;
     };
 
     /// Various tolerances.
@@ -25,6 +25,7 @@
 #include "mixins.h"
 #include "util/compat.h"
 #include "linear_matrix_solver.h"
+#include "algebra/static_condensation.h"
 
 namespace Hermes
 {
@@ -72,13 +73,38 @@ namespace Hermes
       /// Verbose output.
       virtual void set_verbose_output(bool to_set);
 
+      /// Eliminate the condensable unknowns (element-interior ones in FEM) before solving.
+      /// The linear system is condensed to the remaining unknowns (Schur complement), that one is
+      /// solved by a linear solver of the same type, and the condensed unknowns are recovered afterwards.
+      /// The condensation is purely algebraic: the full matrix (including the rows and columns of the condensed unknowns)
+      /// is still assembled and stored, it is condensed only at solve time. So it saves the solver time and memory
+      /// (the factorization of the smaller reduced matrix), not the assembling time or the memory of the global matrix.
+      /// Requires the matrix to be in one of the CS formats (the symmetric storage included), and the condensable unknowns to be set (set_condensable_dofs()).
+      void use_static_condensation(bool to_set = true);
+
       /// The solution vector.
       Scalar* sln_vector;
 
     protected:
+      /// Solve the assembled linear system, possibly using the static condensation.
+      /// \return The solution vector (owned by the linear solver / the condensation).
+      virtual Scalar* solve_linear_matrix_system(Scalar* initial_guess);
+
+      /// Set the flags of the unknowns that may be condensed, this instance takes ownership of the array.
+      void set_condensable_dofs(bool* condensable_dofs);
+
       /// Linear solver.
       Hermes::Solvers::LinearMatrixSolver<Scalar>* linear_matrix_solver;
 
+      /// Static condensation.
+      bool static_condensation_used;
+      bool* condensable_dofs;
+      Hermes::Algebra::StaticCondensation<Scalar> static_condensation;
+      /// Linear solver for the reduced system, created on demand.
+      Hermes::Solvers::LinearMatrixSolver<Scalar>* reduced_linear_matrix_solver;
+      /// Whether a direct solver was requested (for the reduced solver).
+      bool force_use_direct_solver;
+
       /// Jacobian can be reused if possible.
       bool constant_jacobian;
 
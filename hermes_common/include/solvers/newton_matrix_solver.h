@@ -23,6 +23,7 @@
 #define __HERMES_COMMON_NEWTON_MATRIX_SOLVER_H_
 
 #include "solvers/nonlinear_matrix_solver.h"
+#include "solvers/krylov_solver.h"
 
 namespace Hermes
 {
@@ -33,11 +34,76 @@ namespace Hermes
     {
     public:
       NewtonMatrixSolver();
-      virtual ~NewtonMatrixSolver() {};
+      virtual ~NewtonMatrixSolver();
+
+#pragma region jacobian_free-public
+      /// Use the Jacobian-free Newton-Krylov method.
+      /// The Newton step is then found by (built-in) GMRES, where the action of the Jacobian is approximated by
+      /// finite differences of the residual, and the assembled Jacobian serves only as a (right) preconditioner.
+      /// Its factorization is reused (lagged) for up to set_max_steps_with_reused_jacobian() steps as long as the residual decreases.
+      /// The accuracy of the linear solves follows the Eisenstat-Walker forcing terms.
+      void set_jacobian_free(bool to_set = true);
+
+      /// GMRES parameters for the Jacobian-free mode.
+      /// Default: restart 30, max_iterations 200.
+      void set_jacobian_free_gmres_parameters(int restart, int max_iterations);
+
+      /// Bound for the Eisenstat-Walker forcing terms (relative tolerance of the linear solves in the Jacobian-free mode).
+      /// Default: 0.9.
+      void set_max_forcing_term(double max_forcing_term);
+#pragma endregion
 
     protected:
       virtual double update_solution_return_change_norm(Scalar* linear_system_solution);
 
+      virtual void init_solving(Scalar* coeff_vec);
+      virtual void deinit_solving();
+
+#pragma region jacobian_free-private
+      /// Jacobian-free Newton step in place of the linear solve with the Jacobian.
+      virtual Scalar* solve_linear_matrix_system(Scalar* initial_guess);
+
+      /// With the Jacobian only as a preconditioner, its reuse is okay as long as the residual decreases.
+      virtual bool jacobian_reused_okay(unsigned int& successful_steps_with_reused_jacobian);
+
+      /// Eisenstat-Walker forcing term for the current step.
+      double calculate_forcing_term();
+
+      /// Jacobian (action) approximated by finite differences of the residual.
+      class JacobianFreeOperator : public KrylovOperator < Scalar >
+      {
+      public:
+        JacobianFreeOperator(NewtonMatrixSolver<Scalar>* solver, const Scalar* residual);
+        virtual void apply(const Scalar* in, Scalar* out);
+      protected:
+        NewtonMatrixSolver<Scalar>* solver;
+        /// Residual (minus the nonlinear function) in the current solution.
+        const Scalar* residual;
+        /// Solution backup.
+        Scalar* solution;
+        double solution_norm;
+      };
+
+      /// Preconditioner using the (lagged) Jacobian.
+      class JacobianPreconditioner : public KrylovOperator < Scalar >
+      {
+      public:
+        JacobianPreconditioner(NewtonMatrixSolver<Scalar>* solver);
+        virtual void apply(const Scalar* in, Scalar* out);
+      protected:
+        NewtonMatrixSolver<Scalar>* solver;
+      };
+
+      bool jacobian_free;
+      GMRESSolver<Scalar> gmres;
+      double max_forcing_term;
+      /// The previous forcing term (for the safeguards).
+      double previous_forcing_term;
+      /// Newton step and residual buffers.
+      Scalar* jacobian_free_step;
+      Scalar* jacobian_free_residual;
+#pragma endregion
+
       /// Find out the convergence state.
       virtual NonlinearConvergenceState get_convergence_state();
 
@@ -0,0 +1,557 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file bsr_matrix.cpp
+\brief Block compressed sparse row (BSR) matrix for systems of equations.
+*/
+#include "bsr_matrix.h"
+#include "util/memory_handling.h"
+#include "api.h"
+
+namespace Hermes
+{
+  namespace Algebra
+  {
+    static inline void bsr_add_value(double& target, double v)
+    {
+#pragma omp atomic
+      target += v;
+    }
+
+    static inline void bsr_add_value(std::complex<double>& target, std::complex<double> v)
+    {
+#pragma omp critical (BSRMatrixAdd)
+      target += v;
+    }
+
+    /// One block row of the matrix-vector product, the block size fixed at compile time for the common small sizes (0 = general).
+    template<typename Scalar, int fixed_size>
+    static void bsr_multiply_block_row(const Scalar* values, const int* col_idx, int start, int end, unsigned int general_size, const Scalar* block_in, Scalar* block_out)
+    {
+      const int k = fixed_size ? fixed_size : general_size;
+      for (int i = 0; i < k; i++)
+        block_out[i] = Scalar(0);
+      for (int block = start; block < end; block++)
+      {
+        const Scalar* block_values = values + block * k * k;
+        const Scalar* x = block_in + col_idx[block] * k;
+        for (int i = 0; i < k; i++)
+        {
+          Scalar sum = Scalar(0);
+          for (int j = 0; j < k; j++)
+            sum += block_values[i * k + j] * x[j];
+          block_out[i] += sum;
+        }
+      }
+    }
+
+    template<typename Scalar>
+    BSRMatrix<Scalar>::BSRMatrix(unsigned int block_size) : SparseMatrix<Scalar>(), block_size(block_size), num_blocks(0),
+      dof_block(nullptr), dof_component(nullptr), block_dofs(nullptr), layout_set(false),
+      row_ptr(nullptr), col_idx(nullptr), nnz_blocks(0), values(nullptr)
+    {
+      if (block_size < 1)
+        throw Exceptions::ValueException("block_size", block_size, 1);
+    }
+
+    template<typename Scalar>
+    BSRMatrix<Scalar>::~BSRMatrix()
+    {
+      this->free();
+      this->free_layout();
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::free_layout()
+    {
+      free_with_check(this->dof_block);
+      free_with_check(this->dof_component);
+      free_with_check(this->block_dofs);
+      this->num_blocks = 0;
+      this->layout_set = false;
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::set_block_layout(unsigned int size, unsigned int num_blocks, const int* dof_block, const int* dof_component)
+    {
+      this->free();
+      this->free_layout();
+
+      this->num_blocks = num_blocks;
+      this->dof_block = malloc_with_check<BSRMatrix<Scalar>, int>(size, this);
+      this->dof_component = malloc_with_check<BSRMatrix<Scalar>, int>(size, this);
+      this->block_dofs = malloc_with_check<BSRMatrix<Scalar>, int>(num_blocks * this->block_size, this);
+      memcpy(this->dof_block, dof_block, size * sizeof(int));
+      memcpy(this->dof_component, dof_component, size * sizeof(int));
+      for (unsigned int i = 0; i < num_blocks * this->block_size; i++)
+        this->block_dofs[i] = -1;
+
+      for (unsigned int i = 0; i < size; i++)
+      {
+        if (dof_block[i] < 0 || dof_block[i] >= (int)num_blocks || dof_component[i] < 0 || dof_component[i] >= (int)this->block_size)
+          throw Exceptions::Exception("BSRMatrix::set_block_layout(): invalid block / component of the unknown %i.", i);
+        int& block_dof = this->block_dofs[dof_block[i] * this->block_size + dof_component[i]];
+        if (block_dof != -1)
+          throw Exceptions::Exception("BSRMatrix::set_block_layout(): unknowns %i and %i share the block %i, component %i.", block_dof, i, dof_block[i], dof_component[i]);
+        block_dof = i;
+      }
+
+      this->size = size;
+      this->layout_set = true;
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::reset_block_layout()
+    {
+      this->free();
+      this->free_layout();
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::ensure_block_layout(unsigned int size)
+    {
+      if (this->layout_set)
+      {
+        if (this->size != size)
+          throw Exceptions::Exception("BSRMatrix: the size %i does not correspond to the block layout (size %i).", size, this->size);
+        return;
+      }
+
+      if (size % this->block_size)
+        throw Exceptions::Exception("BSRMatrix: the size %i is not a multiple of the block size %i, set_block_layout() is needed.", size, this->block_size);
+
+      // Equation-wise layout.
+      free_with_check(this->dof_block);
+      free_with_check(this->dof_component);
+      free_with_check(this->block_dofs);
+      this->num_blocks = size / this->block_size;
+      this->dof_block = malloc_with_check<BSRMatrix<Scalar>, int>(size, this);
+      this->dof_component = malloc_with_check<BSRMatrix<Scalar>, int>(size, this);
+      this->block_dofs = malloc_with_check<BSRMatrix<Scalar>, int>(size, this);
+      for (unsigned int i = 0; i < size; i++)
+      {
+        this->dof_block[i] = i % this->num_blocks;
+        this->dof_component[i] = i / this->num_blocks;
+        this->block_dofs[this->dof_block[i] * this->block_size + this->dof_component[i]] = i;
+      }
+      this->size = size;
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::prealloc(unsigned int n)
+    {
+      this->ensure_block_layout(n);
+      // The pages are kept per block rows.
+      SparseMatrix<Scalar>::prealloc(this->num_blocks);
+      this->size = n;
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::pre_add_ij(unsigned int row, unsigned int col)
+    {
+      // The pages are indexed by the second argument.
+      SparseMatrix<Scalar>::pre_add_ij(this->dof_block[col], this->dof_block[row]);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::alloc()
+    {
+      int total = 0;
+      for (unsigned int i = 0; i < this->num_blocks; i++)
+        for (typename SparseMatrix<Scalar>::Page *page = &this->pages[i]; page != nullptr; page = page->next)
+          total += page->count;
+
+      this->row_ptr = malloc_with_check<BSRMatrix<Scalar>, int>(this->num_blocks + 1, this);
+      this->col_idx = malloc_with_check<BSRMatrix<Scalar>, int>(total, this);
+
+      int pos = 0;
+      for (unsigned int i = 0; i < this->num_blocks; i++)
+      {
+        this->row_ptr[i] = pos;
+        pos += this->sort_and_store_indices(&this->pages[i], this->col_idx + pos, this->col_idx + total);
+      }
+      this->row_ptr[this->num_blocks] = pos;
+
+      free_with_check(this->pages);
+
+      this->nnz_blocks = pos;
+      this->values = calloc_with_check<BSRMatrix<Scalar>, Scalar>(this->nnz_blocks * this->block_size * this->block_size, this);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows)
+    {
+      this->free();
+      this->ensure_block_layout(size);
+
+      // Block columns in the ascending order, each block row gets its block columns sorted.
+      int* marker = malloc_with_check<BSRMatrix<Scalar>, int>(this->num_blocks, this);
+      this->row_ptr = calloc_with_check<BSRMatrix<Scalar>, int>(this->num_blocks + 1, this);
+      for (int pass = 0; pass < 2; pass++)
+      {
+        int* next = nullptr;
+        if (pass == 1)
+        {
+          for (unsigned int i = 0; i < this->num_blocks; i++)
+            this->row_ptr[i + 1] += this->row_ptr[i];
+          this->nnz_blocks = this->row_ptr[this->num_blocks];
+          this->col_idx = malloc_with_check<BSRMatrix<Scalar>, int>(this->nnz_blocks, this);
+          next = malloc_with_check<BSRMatrix<Scalar>, int>(this->num_blocks, this);
+          memcpy(next, this->row_ptr, this->num_blocks * sizeof(int));
+        }
+
+        for (unsigned int i = 0; i < this->num_blocks; i++)
+          marker[i] = -1;
+
+        for (unsigned int block_col = 0; block_col < this->num_blocks; block_col++)
+        {
+          for (unsigned int component = 0; component < this->block_size; component++)
+          {
+            int col = this->block_dofs[block_col * this->block_size + component];
+            if (col < 0)
+              continue;
+            for (int i = pattern_ptr[col]; i < pattern_ptr[col + 1]; i++)
+            {
+              int block_row = this->dof_block[pattern_rows[i]];
+              if (marker[block_row] == (int)block_col)
+                continue;
+              marker[block_row] = block_col;
+              if (pass == 0)
+                this->row_ptr[block_row + 1]++;
+              else
+                this->col_idx[next[block_row]++] = block_col;
+            }
+          }
+        }
+        free_with_check(next);
+      }
+      free_with_check(marker);
+
+      this->values = calloc_with_check<BSRMatrix<Scalar>, Scalar>(this->nnz_blocks * this->block_size * this->block_size, this);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::free()
+    {
+      SparseMatrix<Scalar>::free();
+      free_with_check(this->row_ptr);
+      free_with_check(this->col_idx);
+      free_with_check(this->values);
+      this->nnz_blocks = 0;
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::zero()
+    {
+      memset(this->values, 0, this->nnz_blocks * this->block_size * this->block_size * sizeof(Scalar));
+    }
+
+    template<typename Scalar>
+    int BSRMatrix<Scalar>::find_block(int block_row, int block_col) const
+    {
+      int pos = CSMatrix<Scalar>::find_position(this->col_idx + this->row_ptr[block_row], this->row_ptr[block_row + 1] - this->row_ptr[block_row], block_col);
+      return pos < 0 ? -1 : this->row_ptr[block_row] + pos;
+    }
+
+    template<typename Scalar>
+    Scalar BSRMatrix<Scalar>::get(unsigned int m, unsigned int n) const
+    {
+      int block = this->find_block(this->dof_block[m], this->dof_block[n]);
+      if (block < 0)
+        return 0.0;
+      return this->values[(block * this->block_size + this->dof_component[m]) * this->block_size + this->dof_component[n]];
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::add(unsigned int m, unsigned int n, Scalar v)
+    {
+      if (v == 0.0)
+        return;
+
+      int block = this->find_block(this->dof_block[m], this->dof_block[n]);
+      if (block < 0)
+        throw Exceptions::Exception("Sparse matrix entry not found: [%i, %i]", m, n);
+      bsr_add_value(this->values[(block * this->block_size + this->dof_component[m]) * this->block_size + this->dof_component[n]], v);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::add(unsigned int m, unsigned int n, Scalar *mat, int *rows, int *cols, const int size)
+    {
+      for (unsigned int i = 0; i < m; i++)
+      {
+        if (rows[i] < 0)
+          continue;
+        int block_row = this->dof_block[rows[i]];
+        int row_offset = this->dof_component[rows[i]] * this->block_size;
+        int last_block_col = -1, block = -1;
+        for (unsigned int j = 0; j < n; j++)
+        {
+          Scalar entry = mat[i * size + j];
+          if (entry == 0.0 || cols[j] < 0)
+            continue;
+
+          // The columns of a local matrix are mostly grouped by nodes.
+          int block_col = this->dof_block[cols[j]];
+          if (block_col != last_block_col)
+          {
+            block = this->find_block(block_row, block_col);
+            if (block < 0)
+              throw Exceptions::Exception("Sparse matrix entry not found: [%i, %i]", rows[i], cols[j]);
+            last_block_col = block_col;
+          }
+          bsr_add_value(this->values[block * this->block_size * this->block_size + row_offset + this->dof_component[cols[j]]], entry);
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::set_row_zero(unsigned int n)
+    {
+      int block_row = this->dof_block[n];
+      int row_offset = this->dof_component[n] * this->block_size;
+      for (int block = this->row_ptr[block_row]; block < this->row_ptr[block_row + 1]; block++)
+        for (unsigned int j = 0; j < this->block_size; j++)
+          this->values[block * this->block_size * this->block_size + row_offset + j] = Scalar(0);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized) const
+    {
+      if (!vector_out_initialized)
+        vector_out = malloc_with_check<Scalar>(this->size);
+
+      unsigned int k = this->block_size;
+      // Block ordering of the input.
+      Scalar* block_in = malloc_with_check<Scalar>(this->num_blocks * k);
+      for (unsigned int i = 0; i < this->num_blocks * k; i++)
+        block_in[i] = this->block_dofs[i] < 0 ? Scalar(0) : vector_in[this->block_dofs[i]];
+
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+#pragma omp parallel num_threads(num_threads_used)
+      {
+        Scalar* block_out = malloc_with_check<Scalar>(k);
+#pragma omp for schedule(static)
+        for (int block_row = 0; block_row < (int)this->num_blocks; block_row++)
+        {
+          int start = this->row_ptr[block_row], end = this->row_ptr[block_row + 1];
+          switch (k)
+          {
+          case 2:
+            bsr_multiply_block_row<Scalar, 2>(this->values, this->col_idx, start, end, k, block_in, block_out);
+            break;
+          case 3:
+            bsr_multiply_block_row<Scalar, 3>(this->values, this->col_idx, start, end, k, block_in, block_out);
+            break;
+          case 4:
+            bsr_multiply_block_row<Scalar, 4>(this->values, this->col_idx, start, end, k, block_in, block_out);
+            break;
+          default:
+            bsr_multiply_block_row<Scalar, 0>(this->values, this->col_idx, start, end, k, block_in, block_out);
+          }
+          for (unsigned int i = 0; i < k; i++)
+          {
+            int dof = this->block_dofs[block_row * k + i];
+            if (dof >= 0)
+              vector_out[dof] = block_out[i];
+          }
+        }
+        free_with_check(block_out);
+      }
+
+      free_with_check(block_in);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::multiply_with_Scalar(Scalar value)
+    {
+      unsigned int num_values = this->nnz_blocks * this->block_size * this->block_size;
+      for (unsigned int i = 0; i < num_values; i++)
+        this->values[i] *= value;
+    }
+
+    template<typename Scalar>
+    bool BSRMatrix<Scalar>::has_same_structure(const BSRMatrix<Scalar>* other) const
+    {
+      if (this->size != other->size || this->block_size != other->block_size || this->num_blocks != other->num_blocks || this->nnz_blocks != other->nnz_blocks)
+        return false;
+      if (!this->row_ptr || !other->row_ptr)
+        return false;
+      return !memcmp(this->block_dofs, other->block_dofs, this->num_blocks * this->block_size * sizeof(int))
+        && !memcmp(this->row_ptr, other->row_ptr, (this->num_blocks + 1) * sizeof(int))
+        && !memcmp(this->col_idx, other->col_idx, this->nnz_blocks * sizeof(int));
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::add_as_block(unsigned int offset_i, unsigned int offset_j, SparseMatrix<Scalar>* mat)
+    {
+      BSRMatrix<Scalar>* bsr_mat = dynamic_cast<BSRMatrix<Scalar>*>(mat);
+      if (offset_i == 0 && offset_j == 0 && bsr_mat && this->has_same_structure(bsr_mat))
+      {
+        unsigned int num_values = this->nnz_blocks * this->block_size * this->block_size;
+        for (unsigned int i = 0; i < num_values; i++)
+          this->values[i] += bsr_mat->values[i];
+      }
+      else
+        SparseMatrix<Scalar>::add_as_block(offset_i, offset_j, mat);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::to_csc(CSCMatrix<Scalar>* target) const
+    {
+      unsigned int k = this->block_size;
+      bool lower_only = target->has_symmetric_storage();
+
+      // Rows are visited in the ascending order, so that the rows in each column come out sorted.
+      int* Ap = calloc_with_check<int>(this->size + 1);
+      for (int pass = 0; pass < 2; pass++)
+      {
+        int* Ai = nullptr;
+        Scalar* Ax = nullptr;
+        int* next = nullptr;
+        if (pass == 1)
+        {
+          for (unsigned int i = 0; i < this->size; i++)
+            Ap[i + 1] += Ap[i];
+          Ai = malloc_with_check<int>(Ap[this->size]);
+          Ax = malloc_with_check<Scalar>(Ap[this->size]);
+          next = malloc_with_check<int>(this->size);
+          memcpy(next, Ap, this->size * sizeof(int));
+        }
+
+        for (unsigned int row = 0; row < this->size; row++)
+        {
+          int block_row = this->dof_block[row];
+          int row_offset = this->dof_component[row] * k;
+          for (int block = this->row_ptr[block_row]; block < this->row_ptr[block_row + 1]; block++)
+          {
+            for (unsigned int j = 0; j < k; j++)
+            {
+              int col = this->block_dofs[this->col_idx[block] * k + j];
+              if (col < 0 || (lower_only && (int)row < col))
+                continue;
+              if (pass == 0)
+                Ap[col + 1]++;
+              else
+              {
+                Ai[next[col]] = row;
+                Ax[next[col]++] = this->values[block * k * k + row_offset + j];
+              }
+            }
+          }
+        }
+
+        if (pass == 1)
+        {
+          target->create(this->size, Ap[this->size], Ap, Ai, Ax);
+          free_with_check(Ai);
+          free_with_check(Ax);
+          free_with_check(next);
+        }
+      }
+      free_with_check(Ap);
+    }
+
+    template<typename Scalar>
+    void BSRMatrix<Scalar>::export_to_file(const char *filename, const char *var_name, MatrixExportFormat fmt, char* number_format)
+    {
+      CSCMatrix<Scalar> csc_matrix;
+      this->to_csc(&csc_matrix);
+      csc_matrix.export_to_file(filename, var_name, fmt, number_format);
+    }
+
+    template<typename Scalar>
+    SparseMatrix<Scalar>* BSRMatrix<Scalar>::duplicate() const
+    {
+      BSRMatrix<Scalar>* new_matrix = new BSRMatrix<Scalar>(this->block_size);
+      if (this->dof_block)
+      {
+        new_matrix->set_block_layout(this->size, this->num_blocks, this->dof_block, this->dof_component);
+        new_matrix->layout_set = this->layout_set;
+      }
+      if (this->row_ptr)
+      {
+        unsigned int num_values = this->nnz_blocks * this->block_size * this->block_size;
+        new_matrix->nnz_blocks = this->nnz_blocks;
+        new_matrix->row_ptr = malloc_with_check<BSRMatrix<Scalar>, int>(this->num_blocks + 1, new_matrix);
+        new_matrix->col_idx = malloc_with_check<BSRMatrix<Scalar>, int>(this->nnz_blocks, new_matrix);
+        new_matrix->values = malloc_with_check<BSRMatrix<Scalar>, Scalar>(num_values, new_matrix);
+        memcpy(new_matrix->row_ptr, this->row_ptr, (this->num_blocks + 1) * sizeof(int));
+        memcpy(new_matrix->col_idx, this->col_idx, this->nnz_blocks * sizeof(int));
+        memcpy(new_matrix->values, this->values, num_values * sizeof(Scalar));
+      }
+      return new_matrix;
+    }
+
+    template<typename Scalar>
+    unsigned int BSRMatrix<Scalar>::get_nnz() const
+    {
+      return this->nnz_blocks * this->block_size * this->block_size;
+    }
+
+    template<typename Scalar>
+    double BSRMatrix<Scalar>::get_fill_in() const
+    {
+      return this->get_nnz() / (double)(this->size * this->size);
+    }
+
+    template<typename Scalar>
+    unsigned int BSRMatrix<Scalar>::get_block_size() const
+    {
+      return this->block_size;
+    }
+
+    template<typename Scalar>
+    unsigned int BSRMatrix<Scalar>::get_num_blocks() const
+    {
+      return this->num_blocks;
+    }
+
+    template<typename Scalar>
+    unsigned int BSRMatrix<Scalar>::get_num_nonzero_blocks() const
+    {
+      return this->nnz_blocks;
+    }
+
+    template<typename Scalar>
+    int* BSRMatrix<Scalar>::get_row_ptr() const
+    {
+      return this->row_ptr;
+    }
+
+    template<typename Scalar>
+    int* BSRMatrix<Scalar>::get_col_idx() const
+    {
+      return this->col_idx;
+    }
+
+    template<typename Scalar>
+    Scalar* BSRMatrix<Scalar>::get_values() const
+    {
+      return this->values;
+    }
+
+    template<typename Scalar>
+    int* BSRMatrix<Scalar>::get_block_dofs() const
+    {
+      return this->block_dofs;
+    }
+
+    template class HERMES_API BSRMatrix < double > ;
+    template class HERMES_API BSRMatrix < std::complex<double> > ;
+  }
+}
@@ -21,6 +21,7 @@
 */
 #include "cs_matrix.h"
 #include "util/memory_handling.h"
+#include "util/qsort.h"
 
 namespace Hermes
 {
@@ -46,6 +47,47 @@ namespace Hermes
       return x.imag();
     }
 
+    SparsityPattern::SparsityPattern(unsigned int size, int* Ap, int* Ai, bool row_wise, bool symmetric_storage)
+      : size(size), Ap(Ap), Ai(Ai), row_wise(row_wise), symmetric_storage(symmetric_storage)
+    {
+    }
+
+    SparsityPattern::~SparsityPattern()
+    {
+      free_with_check(Ap);
+      free_with_check(Ai);
+    }
+
+    unsigned int SparsityPattern::get_size() const
+    {
+      return this->size;
+    }
+
+    unsigned int SparsityPattern::get_nnz() const
+    {
+      return this->Ap[this->size];
+    }
+
+    const int* SparsityPattern::get_Ap() const
+    {
+      return this->Ap;
+    }
+
+    const int* SparsityPattern::get_Ai() const
+    {
+      return this->Ai;
+    }
+
+    bool SparsityPattern::is_row_wise() const
+    {
+      return this->row_wise;
+    }
+
+    bool SparsityPattern::has_symmetric_storage() const
+    {
+      return this->symmetric_storage;
+    }
+
     template<typename Scalar>
     int CSMatrix<Scalar>::find_position(int *Ai, int Alen, unsigned int idx)
     {
@@ -73,12 +115,12 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    CSMatrix<Scalar>::CSMatrix() : SparseMatrix<Scalar>(), nnz(0), Ap(nullptr), Ai(nullptr), Ax(nullptr)
+    CSMatrix<Scalar>::CSMatrix() : SparseMatrix<Scalar>(), nnz(0), Ap(nullptr), Ai(nullptr), Ax(nullptr), structure_fingerprint(0)
     {
     }
 
     template<typename Scalar>
-    CSMatrix<Scalar>::CSMatrix(unsigned int size)
+    CSMatrix<Scalar>::CSMatrix(unsigned int size) : structure_fingerprint(0)
     {
       this->size = size;
       this->alloc();
@@ -100,6 +142,8 @@ namespace Hermes
     template<typename Scalar>
     void CSMatrix<Scalar>::alloc()
     {
+      this->pattern.reset();
+
       // initialize the arrays Ap and Ai
       Ap = malloc_with_check<CSMatrix<Scalar>, int>(this->size + 1, this);
       int aisize = this->get_num_indices();
@@ -119,6 +163,65 @@ namespace Hermes
       free_with_check(this->next_pages);
 
       nnz = Ap[this->size];
+      this->structure_fingerprint = 0;
+
+      this->alloc_data();
+    }
+
+    template<typename Scalar>
+    void CSMatrix<Scalar>::alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows)
+    {
+      this->free();
+      this->size = size;
+      Ap = malloc_with_check<CSMatrix<Scalar>, int>(this->size + 1, this);
+
+      if (!this->has_symmetric_storage())
+      {
+        memcpy(Ap, pattern_ptr, (this->size + 1) * sizeof(int));
+        Ai = malloc_with_check<CSMatrix<Scalar>, int>(Ap[this->size], this);
+        memcpy(Ai, pattern_rows, Ap[this->size] * sizeof(int));
+      }
+      else
+      {
+        // Lower triangle: (row, col) for row >= col, (col, row) otherwise - count, fill, sort and remove duplicities.
+        memset(Ap, 0, (this->size + 1) * sizeof(int));
+        for (unsigned int col = 0; col < this->size; col++)
+          for (int i = pattern_ptr[col]; i < pattern_ptr[col + 1]; i++)
+            Ap[std::min<unsigned int>(pattern_rows[i], col) + 1]++;
+        for (unsigned int col = 0; col < this->size; col++)
+          Ap[col + 1] += Ap[col];
+
+        Ai = malloc_with_check<CSMatrix<Scalar>, int>(Ap[this->size], this);
+        int* next = malloc_with_check<CSMatrix<Scalar>, int>(this->size, this);
+        memcpy(next, Ap, this->size * sizeof(int));
+        for (unsigned int col = 0; col < this->size; col++)
+        {
+          for (int i = pattern_ptr[col]; i < pattern_ptr[col + 1]; i++)
+          {
+            unsigned int row = pattern_rows[i];
+            if (row >= col)
+              Ai[next[col]++] = row;
+            else
+              Ai[next[row]++] = col;
+          }
+        }
+        free_with_check(next);
+
+        int pos = 0;
+        for (unsigned int col = 0; col < this->size; col++)
+        {
+          int start = Ap[col], end = Ap[col + 1];
+          Ap[col] = pos;
+          qsort_int(Ai + start, end - start);
+          for (int i = start, last = -1; i < end; i++)
+            if (Ai[i] != last)
+              Ai[pos++] = last = Ai[i];
+        }
+        Ap[this->size] = pos;
+      }
+
+      nnz = Ap[this->size];
+      this->structure_fingerprint = 0;
 
       this->alloc_data();
     }
@@ -133,8 +236,19 @@ namespace Hermes
     void CSMatrix<Scalar>::free()
     {
       nnz = 0;
-      free_with_check(Ap);
-      free_with_check(Ai);
+      this->structure_fingerprint = 0;
+      if (this->pattern)
+      {
+        // The arrays belong to the pattern.
+        this->pattern.reset();
+        Ap = nullptr;
+        Ai = nullptr;
+      }
+      else
+      {
+        free_with_check(Ap);
+        free_with_check(Ai);
+      }
       free_with_check(Ax);
     }
 
@@ -151,6 +265,42 @@ namespace Hermes
       memset(Ax, 0, sizeof(Scalar)* nnz);
     }
 
+    template<typename Scalar>
+    void CSMatrix<Scalar>::finish()
+    {
+      SparseMatrix<Scalar>::finish();
+      this->calculate_structure_fingerprint();
+    }
+
+    template<typename Scalar>
+    unsigned long long CSMatrix<Scalar>::get_structure_fingerprint() const
+    {
+      return this->structure_fingerprint;
+    }
+
+    template<typename Scalar>
+    void CSMatrix<Scalar>::calculate_structure_fingerprint()
+    {
+      if (!this->Ap || !this->Ai)
+      {
+        this->structure_fingerprint = 0;
+        return;
+      }
+
+      // FNV-1a over the whole integers, Ap is included so that moving entries between rows / columns changes the result.
+      const unsigned long long prime = 1099511628211ULL;
+      unsigned long long hash = 14695981039346656037ULL;
+      hash = (hash ^ this->size) * prime;
+      hash = (hash ^ this->nnz) * prime;
+      for (unsigned int i = 0; i <= this->size; i++)
+        hash = (hash ^ (unsigned int)this->Ap[i]) * prime;
+      for (unsigned int i = 0; i < this->nnz; i++)
+        hash = (hash ^ (unsigned int)this->Ai[i]) * prime;
+
+      // 0 is reserved for "not available".
+      this->structure_fingerprint = hash ? hash : 1;
+    }
+
     template<typename Scalar>
     unsigned int CSMatrix<Scalar>::get_nnz() const
     {
@@ -166,6 +316,7 @@ namespace Hermes
     template<typename Scalar>
     void CSMatrix<Scalar>::create(unsigned int size, unsigned int nnz, int* ap, int* ai, Scalar* ax)
     {
+      this->free();
       this->nnz = nnz;
       this->size = size;
       this->Ap = malloc_with_check<CSMatrix<Scalar>, int>(this->size + 1, this);
@@ -174,11 +325,15 @@ namespace Hermes
       memcpy(this->Ap, ap, (this->size + 1) * sizeof(int));
       memcpy(this->Ai, ai, this->nnz * sizeof(int));
       memcpy(this->Ax, ax, this->nnz * sizeof(Scalar));
+      this->calculate_structure_fingerprint();
     }
 
     template<typename Scalar>
     void CSMatrix<Scalar>::switch_orientation()
     {
+      // Ap, Ai are modified in place.
+      this->detach_sparsity_pattern();
+
       // The variable names are so to reflect CSC -> CSR direction.
       // From the "Ap indexed by columns" to "Ap indexed by rows".
       int* tempAp = malloc_with_check<CSMatrix<Scalar>, int>(this->size + 1, this);
@@ -209,6 +364,9 @@ namespace Hermes
       free_with_check(tempAi);
       free_with_check(tempAx);
       free_with_check(tempAp);
+
+      if (this->structure_fingerprint)
+        this->calculate_structure_fingerprint();
     }
 
     template<typename Scalar>
@@ -229,6 +387,70 @@ namespace Hermes
       return this->Ax;
     }
 
+    template<typename Scalar>
+    bool CSMatrix<Scalar>::is_row_wise() const
+    {
+      return dynamic_cast<const CSRMatrix<Scalar>*>(this) != nullptr;
+    }
+
+    template<typename Scalar>
+    SparsityPatternSharedPtr CSMatrix<Scalar>::get_sparsity_pattern() const
+    {
+      if (!this->pattern && this->Ap && this->Ai)
+        this->pattern = SparsityPatternSharedPtr(new SparsityPattern(this->size, this->Ap, this->Ai, this->is_row_wise(), this->has_symmetric_storage()));
+      return this->pattern;
+    }
+
+    template<typename Scalar>
+    bool CSMatrix<Scalar>::share_sparsity_pattern(SparsityPatternSharedPtr pattern)
+    {
+      if (!pattern || pattern->is_row_wise() != this->is_row_wise() || pattern->has_symmetric_storage() != this->has_symmetric_storage())
+        return false;
+
+      this->free();
+      this->pattern = pattern;
+      this->size = pattern->get_size();
+      this->nnz = pattern->get_nnz();
+      // Never written to while shared, see detach_sparsity_pattern().
+      this->Ap = const_cast<int*>(pattern->get_Ap());
+      this->Ai = const_cast<int*>(pattern->get_Ai());
+      this->structure_fingerprint = 0;
+
+      this->alloc_data();
+      return true;
+    }
+
+    template<typename Scalar>
+    void CSMatrix<Scalar>::detach_sparsity_pattern()
+    {
+      if (!this->pattern)
+        return;
+
+      int* own_Ap = malloc_with_check<CSMatrix<Scalar>, int>(this->size + 1, this);
+      int* own_Ai = malloc_with_check<CSMatrix<Scalar>, int>(this->nnz, this);
+      memcpy(own_Ap, this->Ap, (this->size + 1) * sizeof(int));
+      memcpy(own_Ai, this->Ai, this->nnz * sizeof(int));
+      this->pattern.reset();
+      this->Ap = own_Ap;
+      this->Ai = own_Ai;
+    }
+
+    template<typename Scalar>
+    bool CSMatrix<Scalar>::has_same_sparsity_pattern(const CSMatrix<Scalar>* other) const
+    {
+      if (this->Ap == other->Ap && this->Ai == other->Ai)
+        return this->size == other->size;
+
+      if (this->size != other->size || this->nnz != other->nnz || !this->Ap || !other->Ap)
+        return false;
+      if (this->structure_fingerprint && other->structure_fingerprint && this->structure_fingerprint != other->structure_fingerprint)
+        return false;
+      if (this->is_row_wise() != other->is_row_wise() || this->has_symmetric_storage() != other->has_symmetric_storage())
+        return false;
+
+      return !memcmp(this->Ap, other->Ap, (this->size + 1) * sizeof(int)) && !memcmp(this->Ai, other->Ai, this->nnz * sizeof(int));
+    }
+
     template<typename Scalar>
     void CSMatrix<Scalar>::add_as_block(unsigned int offset_i, unsigned int offset_j, SparseMatrix<Scalar>* mat)
     {
@@ -236,10 +458,16 @@ namespace Hermes
         throw Hermes::Exceptions::Exception("Incompatible matrix sizes in SparseMatrix<Scalar>::add_as_block()");
 
       CSMatrix<Scalar>* csMatrix = dynamic_cast<CSMatrix<Scalar>*>(mat);
-      if (!mat)
+      if (!csMatrix)
       {
         SparseMatrix<Scalar>::add_as_block(offset_i, offset_j, mat);
       }
+      // Same structure: the values correspond one to one (matrices keeping the values elsewhere do not use Ax).
+      else if (offset_i == 0 && offset_j == 0 && this->Ax && csMatrix->Ax && this->has_same_sparsity_pattern(csMatrix))
+      {
+        for (unsigned int i = 0; i < this->nnz; i++)
+          this->Ax[i] += csMatrix->Ax[i];
+      }
       else
       {
         for (unsigned short i = 0; i < csMatrix->get_size(); i++)
@@ -248,6 +476,9 @@ namespace Hermes
           for (int j = 0; j < csMatrix->Ap[i + 1] - index; j++)
           {
             this->add(offset_i + csMatrix->Ai[index + j], offset_j + i, csMatrix->Ax[index + j]);
+            // Only the lower triangle of a symmetric matrix is stored.
+            if (csMatrix->has_symmetric_storage() && csMatrix->Ai[index + j] != i)
+              this->add(offset_i + i, offset_j + csMatrix->Ai[index + j], csMatrix->Ax[index + j]);
           }
         }
       }
@@ -740,7 +971,179 @@ namespace Hermes
     SparseMatrix<Scalar>* CSCMatrix<Scalar>::duplicate() const
     {
       CSCMatrix<Scalar>* new_matrix = new CSCMatrix<Scalar>();
-      new_matrix->create(this->get_size(), this->get_nnz(), this->get_Ap(), this->get_Ai(), this->get_Ax());
+      if (!new_matrix->share_sparsity_pattern(this->get_sparsity_pattern()))
+        return new_matrix;
+      memcpy(new_matrix->Ax, this->Ax, this->nnz * sizeof(Scalar));
+      new_matrix->structure_fingerprint = this->structure_fingerprint;
+      return new_matrix;
+    }
+
+    template<typename Scalar>
+    SymmetricCSCMatrix<Scalar>::SymmetricCSCMatrix() : CSCMatrix<Scalar>()
+    {
+    }
+
+    template<typename Scalar>
+    SymmetricCSCMatrix<Scalar>::SymmetricCSCMatrix(unsigned int size) : CSCMatrix<Scalar>(size)
+    {
+    }
+
+    template<typename Scalar>
+    SymmetricCSCMatrix<Scalar>::~SymmetricCSCMatrix()
+    {
+    }
+
+    template<typename Scalar>
+    void SymmetricCSCMatrix<Scalar>::pre_add_ij(unsigned int row, unsigned int col)
+    {
+      if (row < col)
+        std::swap(row, col);
+      SparseMatrix<Scalar>::pre_add_ij(row, col);
+    }
+
+    template<typename Scalar>
+    Scalar SymmetricCSCMatrix<Scalar>::get(unsigned int m, unsigned int n) const
+    {
+      if (m < n)
+        return CSMatrix<Scalar>::get(n, m);
+      else
+        return CSMatrix<Scalar>::get(m, n);
+    }
+
+    template<typename Scalar>
+    void SymmetricCSCMatrix<Scalar>::add(unsigned int m, unsigned int n, Scalar v)
+    {
+      // The upper triangle is the mirror image of the lower one.
+      if (m < n)
+        return;
+      CSCMatrix<Scalar>::add(m, n, v);
+    }
+
+    template<typename Scalar>
+    void SymmetricCSCMatrix<Scalar>::multiply_with_vector(Scalar* vector_in, Scalar*& vector_out, bool vector_out_initialized) const
+    {
+      if (!vector_out_initialized)
+        vector_out = malloc_with_check<Scalar>(this->size);
+      memset(vector_out, 0, sizeof(Scalar)* this->size);
+
+      // Each stored entry acts as itself (column j) and as its mirror image (row j).
+      for (unsigned int j = 0; j < this->size; j++)
+      {
+        Scalar in_j = vector_in[j];
+        Scalar out_j = 0.;
+        for (int k = this->Ap[j]; k < this->Ap[j + 1]; k++)
+        {
+          int i = this->Ai[k];
+          vector_out[i] += this->Ax[k] * in_j;
+          if (i != j)
+            out_j += this->Ax[k] * vector_in[i];
+        }
+        vector_out[j] += out_j;
+      }
+    }
+
+    template<typename Scalar>
+    void SymmetricCSCMatrix<Scalar>::expand(CSCMatrix<Scalar>* target) const
+    {
+      // Column counts of the full matrix.
+      int* full_Ap = calloc_with_check<int>(this->size + 1);
+      for (unsigned int j = 0; j < this->size; j++)
+      {
+        for (int k = this->Ap[j]; k < this->Ap[j + 1]; k++)
+        {
+          full_Ap[j + 1]++;
+          if (this->Ai[k] != j)
+            full_Ap[this->Ai[k] + 1]++;
+        }
+      }
+      for (unsigned int j = 0; j < this->size; j++)
+        full_Ap[j + 1] += full_Ap[j];
+
+      int full_nnz = full_Ap[this->size];
+      int* full_Ai = malloc_with_check<int>(full_nnz);
+      Scalar* full_Ax = malloc_with_check<Scalar>(full_nnz);
+      int* next = malloc_with_check<int>(this->size);
+      memcpy(next, full_Ap, this->size * sizeof(int));
+
+      // The upper part of each column first (its rows are the columns of the lower triangle, visited in the ascending order),
+      // then the stored lower part - the rows in every column stay sorted.
+      for (unsigned int j = 0; j < this->size; j++)
+      {
+        for (int k = this->Ap[j]; k < this->Ap[j + 1]; k++)
+        {
+          int i = this->Ai[k];
+          if (i != j)
+          {
+            full_Ai[next[i]] = j;
+            full_Ax[next[i]++] = this->Ax[k];
+          }
+        }
+      }
+      for (unsigned int j = 0; j < this->size; j++)
+      {
+        for (int k = this->Ap[j]; k < this->Ap[j + 1]; k++)
+        {
+          full_Ai[next[j]] = this->Ai[k];
+          full_Ax[next[j]++] = this->Ax[k];
+        }
+      }
+
+      target->free();
+      target->create(this->size, full_nnz, full_Ap, full_Ai, full_Ax);
+
+      free_with_check(full_Ap);
+      free_with_check(full_Ai);
+      free_with_check(full_Ax);
+      free_with_check(next);
+    }
+
+    template<typename Scalar>
+    void SymmetricCSCMatrix<Scalar>::export_to_file(const char *filename, const char *var_name, MatrixExportFormat fmt, char* number_format)
+    {
+      if (fmt != EXPORT_FORMAT_MATRIX_MARKET)
+      {
+        CSCMatrix<Scalar> full_matrix;
+        this->expand(&full_matrix);
+        full_matrix.export_to_file(filename, var_name, fmt, number_format);
+        return;
+      }
+
+      FILE* file = fopen(filename, "w");
+      if (!file)
+        throw Exceptions::IOException(Exceptions::IOException::Write, filename);
+      if (Hermes::Helpers::TypeIsReal<Scalar>::value)
+        fprintf(file, "%%%%MatrixMarket matrix coordinate real symmetric\n");
+      else
+        fprintf(file, "%%%%MatrixMarket matrix coordinate complex symmetric\n");
+
+      fprintf(file, "%d %d %d\n", this->size, this->size, this->nnz);
+
+      for (unsigned int j = 0; j < this->size; j++)
+      {
+        for (int i = this->Ap[j]; i < this->Ap[j + 1]; i++)
+        {
+          Hermes::Helpers::fprint_coordinate_num(file, this->Ai[i] + 1, j + 1, this->Ax[i], number_format);
+          fprintf(file, "\n");
+        }
+      }
+
+      fclose(file);
+    }
+
+    template<typename Scalar>
+    bool SymmetricCSCMatrix<Scalar>::has_symmetric_storage() const
+    {
+      return true;
+    }
+
+    template<typename Scalar>
+    SparseMatrix<Scalar>* SymmetricCSCMatrix<Scalar>::duplicate() const
+    {
+      SymmetricCSCMatrix<Scalar>* new_matrix = new SymmetricCSCMatrix<Scalar>();
+      if (!new_matrix->share_sparsity_pattern(this->get_sparsity_pattern()))
+        return new_matrix;
+      memcpy(new_matrix->Ax, this->Ax, this->nnz * sizeof(Scalar));
+      new_matrix->structure_fingerprint = this->structure_fingerprint;
       return new_matrix;
     }
 
@@ -797,11 +1200,38 @@ namespace Hermes
         this->pages[row].idx[this->pages[row].count++] = col;
     }
 
+    template<typename Scalar>
+    void CSRMatrix<Scalar>::alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows)
+    {
+      // Transpose - the columns are visited in the ascending order, so the transposed rows come out sorted.
+      int nnz = pattern_ptr[size];
+      int* row_ptr = calloc_with_check<CSRMatrix<Scalar>, int>(size + 1, this);
+      int* row_cols = malloc_with_check<CSRMatrix<Scalar>, int>(nnz, this);
+      for (int i = 0; i < nnz; i++)
+        row_ptr[pattern_rows[i] + 1]++;
+      for (unsigned int row = 0; row < size; row++)
+        row_ptr[row + 1] += row_ptr[row];
+      int* next = malloc_with_check<CSRMatrix<Scalar>, int>(size, this);
+      memcpy(next, row_ptr, size * sizeof(int));
+      for (unsigned int col = 0; col < size; col++)
+        for (int i = pattern_ptr[col]; i < pattern_ptr[col + 1]; i++)
+          row_cols[next[pattern_rows[i]]++] = col;
+      free_with_check(next);
+
+      CSMatrix<Scalar>::alloc_with_pattern(size, row_ptr, row_cols);
+
+      free_with_check(row_ptr);
+      free_with_check(row_cols);
+    }
+
     template<typename Scalar>
     SparseMatrix<Scalar>* CSRMatrix<Scalar>::duplicate() const
     {
       CSRMatrix<Scalar>* new_matrix = new CSRMatrix<Scalar>();
-      new_matrix->create(this->get_size(), this->get_nnz(), this->get_Ap(), this->get_Ai(), this->get_Ax());
+      if (!new_matrix->share_sparsity_pattern(this->get_sparsity_pattern()))
+        return new_matrix;
+      memcpy(new_matrix->Ax, this->Ax, this->nnz * sizeof(Scalar));
+      new_matrix->structure_fingerprint = this->structure_fingerprint;
       return new_matrix;
     }
   }
@@ -813,5 +1243,8 @@ template class HERMES_API Hermes::Algebra::CSMatrix < std::complex<double> > ;
 template class HERMES_API Hermes::Algebra::CSCMatrix < double > ;
 template class HERMES_API Hermes::Algebra::CSCMatrix < std::complex<double> > ;
 
+template class HERMES_API Hermes::Algebra::SymmetricCSCMatrix < double > ;
+template class HERMES_API Hermes::Algebra::SymmetricCSCMatrix < std::complex<double> > ;
+
 template class HERMES_API Hermes::Algebra::CSRMatrix < double > ;
 template class HERMES_API Hermes::Algebra::CSRMatrix < std::complex<double> > ;
@@ -231,6 +231,22 @@ namespace Hermes
       return 0;
     }
 
+    template<typename Scalar>
+    void SparseMatrix<Scalar>::alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows)
+    {
+      this->prealloc(size);
+      for (unsigned int col = 0; col < size; col++)
+        for (int i = pattern_ptr[col]; i < pattern_ptr[col + 1]; i++)
+          this->pre_add_ij(pattern_rows[i], col);
+      this->alloc();
+    }
+
+    template<typename Scalar>
+    bool SparseMatrix<Scalar>::has_symmetric_storage() const
+    {
+      return false;
+    }
+
     template<typename Scalar>
     void SparseMatrix<Scalar>::prealloc(unsigned int n)
     {
@@ -301,6 +317,8 @@ namespace Hermes
       {
       case Hermes::SOLVER_EXTERNAL:
       {
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < double > ;
         return new CSCMatrix < double > ;
       }
 
@@ -327,7 +345,7 @@ namespace Hermes
       case Hermes::SOLVER_MUMPS:
       {
 #ifdef WITH_MUMPS
-        return new MumpsMatrix < double > ;
+        return new MumpsMatrix < double >(Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage) != 0);
 #else
         throw Hermes::Exceptions::Exception("MUMPS not installed.");
 #endif
@@ -347,6 +365,8 @@ namespace Hermes
       case Hermes::SOLVER_UMFPACK:
       {
 #ifdef WITH_UMFPACK
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < double > ;
         return new CSCMatrix < double > ;
 #else
         throw Hermes::Exceptions::Exception("UMFPACK was not installed.");
@@ -365,6 +385,13 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < double > ;
+        return new CSCMatrix < double > ;
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
@@ -387,6 +414,8 @@ namespace Hermes
       {
       case Hermes::SOLVER_EXTERNAL:
       {
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < std::complex<double> > ;
         return new CSCMatrix < std::complex<double> > ;
       }
       case Hermes::SOLVER_AMESOS:
@@ -412,7 +441,7 @@ namespace Hermes
       case Hermes::SOLVER_MUMPS:
       {
 #ifdef WITH_MUMPS
-        return new MumpsMatrix < std::complex<double> > ;
+        return new MumpsMatrix < std::complex<double> >(Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage) != 0);
 #else
         throw Hermes::Exceptions::Exception("MUMPS not installed.");
 #endif
@@ -432,6 +461,8 @@ namespace Hermes
       case Hermes::SOLVER_UMFPACK:
       {
 #ifdef WITH_UMFPACK
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < std::complex<double> > ;
         return new CSCMatrix < std::complex<double> > ;
 #else
         throw Hermes::Exceptions::Exception("UMFPACK was not installed.");
@@ -450,6 +481,14 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        // Complex symmetric (A = A^T) in both the storage and the factorization (L L^T).
+        if (Hermes::HermesCommonApi.get_integral_param_value(Hermes::symmetricMatrixStorage))
+          return new SymmetricCSCMatrix < std::complex<double> > ;
+        return new CSCMatrix < std::complex<double> > ;
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
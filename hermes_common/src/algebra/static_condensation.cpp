@@ -0,0 +1,584 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file static_condensation.cpp
+\brief Static condensation (Schur complement elimination) of interior unknowns.
+*/
+#include "static_condensation.h"
+#include "dense_matrix_operations.h"
+#include "util/memory_handling.h"
+#include "api.h"
+
+namespace Hermes
+{
+  namespace Algebra
+  {
+    static const int H2D_STATIC_CONDENSATION_DEFAULT_MAX_BLOCK_SIZE = 256;
+
+    template<typename Scalar>
+    StaticCondensation<Scalar>::StaticCondensation() : Hermes::Mixins::Loggable(true), size(0), reduced_size(0), max_block_size(H2D_STATIC_CONDENSATION_DEFAULT_MAX_BLOCK_SIZE),
+      reduced_index(nullptr), block_index(nullptr), row_ptr(nullptr), row_idx(nullptr), row_val(nullptr), col_ptr(nullptr), col_idx(nullptr), col_val(nullptr),
+      row_view_owned(false), col_view_owned(false), full_sln(nullptr), reduced_vector(nullptr)
+    {
+    }
+
+    template<typename Scalar>
+    StaticCondensation<Scalar>::~StaticCondensation()
+    {
+      this->free();
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::set_max_block_size(int max_block_size)
+    {
+      if (max_block_size < 1)
+        throw Hermes::Exceptions::ValueException("max_block_size", max_block_size, 1);
+      this->max_block_size = max_block_size;
+    }
+
+    template<typename Scalar>
+    int StaticCondensation<Scalar>::get_size() const
+    {
+      return this->size;
+    }
+
+    template<typename Scalar>
+    int StaticCondensation<Scalar>::get_reduced_size() const
+    {
+      return this->reduced_size;
+    }
+
+    template<typename Scalar>
+    bool StaticCondensation<Scalar>::is_condensed() const
+    {
+      return this->reduced_index != nullptr;
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::free_blocks()
+    {
+      for (unsigned int i = 0; i < this->blocks.size(); i++)
+      {
+        Block& block = this->blocks[i];
+        free_with_check(block.lu, true);
+        free_with_check(block.perm);
+        free_with_check(block.coupling, true);
+        free_with_check(block.solved_coupling, true);
+        free_with_check(block.solved_rhs);
+      }
+      this->blocks.clear();
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::free_views()
+    {
+      if (this->row_view_owned)
+      {
+        free_with_check(this->row_ptr);
+        free_with_check(this->row_idx);
+        free_with_check(this->row_val);
+      }
+      if (this->col_view_owned)
+      {
+        free_with_check(this->col_ptr);
+        free_with_check(this->col_idx);
+        free_with_check(this->col_val);
+      }
+      this->row_ptr = this->row_idx = this->col_ptr = this->col_idx = nullptr;
+      this->row_val = this->col_val = nullptr;
+      this->row_view_owned = this->col_view_owned = false;
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::free()
+    {
+      this->free_blocks();
+      this->free_views();
+      free_with_check(this->reduced_index);
+      free_with_check(this->block_index);
+      free_with_check(this->full_sln, true);
+      free_with_check(this->reduced_vector, true);
+      this->size = this->reduced_size = 0;
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::build_views(CSMatrix<Scalar>* matrix)
+    {
+      int* native_ptr = matrix->get_Ap();
+      int* native_idx = matrix->get_Ai();
+      Scalar* native_val = matrix->get_Ax();
+      int nnz = native_ptr[this->size];
+
+      // Symmetric storage (only one triangle, e.g. SymmetricCSCMatrix): the views need the whole matrix,
+      // so the native view is replaced by an owned copy with the mirrored off-diagonal entries.
+      bool native_owned = false;
+      if (matrix->has_symmetric_storage())
+      {
+        int* full_ptr = calloc_with_check<int>(this->size + 1);
+        for (int outer = 0; outer < this->size; outer++)
+        {
+          for (int i = native_ptr[outer]; i < native_ptr[outer + 1]; i++)
+          {
+            full_ptr[outer + 1]++;
+            if (native_idx[i] != outer)
+              full_ptr[native_idx[i] + 1]++;
+          }
+        }
+        for (int i = 0; i < this->size; i++)
+          full_ptr[i + 1] += full_ptr[i];
+        int full_nnz = full_ptr[this->size];
+        int* full_idx = malloc_with_check<int>(full_nnz);
+        Scalar* full_val = malloc_with_check<Scalar>(full_nnz);
+        int* position = malloc_with_check<int>(this->size);
+        memcpy(position, full_ptr, this->size * sizeof(int));
+        // Going through the outer indices in order keeps the inner indices sorted.
+        for (int outer = 0; outer < this->size; outer++)
+        {
+          for (int i = native_ptr[outer]; i < native_ptr[outer + 1]; i++)
+          {
+            int target = position[outer]++;
+            full_idx[target] = native_idx[i];
+            full_val[target] = native_val[i];
+            if (native_idx[i] != outer)
+            {
+              target = position[native_idx[i]]++;
+              full_idx[target] = outer;
+              full_val[target] = native_val[i];
+            }
+          }
+        }
+        free_with_check(position);
+        native_ptr = full_ptr, native_idx = full_idx, native_val = full_val;
+        nnz = full_nnz;
+        native_owned = true;
+      }
+
+      // Transpose of the native storage (counting sort by the inner index).
+      int* transposed_ptr = calloc_with_check<int>(this->size + 1);
+      int* transposed_idx = malloc_with_check<int>(nnz);
+      Scalar* transposed_val = malloc_with_check<Scalar>(nnz);
+      for (int i = 0; i < nnz; i++)
+        transposed_ptr[native_idx[i] + 1]++;
+      for (int i = 0; i < this->size; i++)
+        transposed_ptr[i + 1] += transposed_ptr[i];
+      int* position = malloc_with_check<int>(this->size);
+      memcpy(position, transposed_ptr, this->size * sizeof(int));
+      for (int outer = 0; outer < this->size; outer++)
+      {
+        for (int i = native_ptr[outer]; i < native_ptr[outer + 1]; i++)
+        {
+          int target = position[native_idx[i]]++;
+          transposed_idx[target] = outer;
+          transposed_val[target] = native_val[i];
+        }
+      }
+      free_with_check(position);
+
+      if (dynamic_cast<CSRMatrix<Scalar>*>(matrix))
+      {
+        this->row_ptr = native_ptr, this->row_idx = native_idx, this->row_val = native_val;
+        this->col_ptr = transposed_ptr, this->col_idx = transposed_idx, this->col_val = transposed_val;
+        this->col_view_owned = true;
+        this->row_view_owned = native_owned;
+      }
+      else
+      {
+        this->col_ptr = native_ptr, this->col_idx = native_idx, this->col_val = native_val;
+        this->row_ptr = transposed_ptr, this->row_idx = transposed_idx, this->row_val = transposed_val;
+        this->row_view_owned = true;
+        this->col_view_owned = native_owned;
+      }
+    }
+
+    template<typename Scalar>
+    bool StaticCondensation<Scalar>::factorize_block(Block& block, int* local_index)
+    {
+      int block_size = block.dofs.size();
+      for (int i = 0; i < block_size; i++)
+        local_index[block.dofs[i]] = i;
+
+      block.lu = DenseMatrixOperations::new_matrix<Scalar>(block_size, block_size);
+      block.perm = malloc_with_check<int>(block_size);
+      for (int i = 0; i < block_size; i++)
+      {
+        int dof = block.dofs[i];
+        for (int j = this->row_ptr[dof]; j < this->row_ptr[dof + 1]; j++)
+          if (local_index[this->row_idx[j]] >= 0)
+            block.lu[i][local_index[this->row_idx[j]]] += this->row_val[j];
+      }
+
+      for (int i = 0; i < block_size; i++)
+        local_index[block.dofs[i]] = -1;
+
+      try
+      {
+        double d;
+        DenseMatrixOperations::ludcmp(block.lu, block_size, block.perm, &d);
+      }
+      catch (Hermes::Exceptions::Exception&)
+      {
+        free_with_check(block.lu, true);
+        free_with_check(block.perm);
+        return false;
+      }
+      return true;
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::process_block(Block& block, const Scalar* rhs_values, int* skeleton_index, std::vector<int>& contribution_rows, std::vector<int>& contribution_cols, std::vector<Scalar>& contribution_values)
+    {
+      int block_size = block.dofs.size();
+
+      // Skeleton unknowns coupled to the block (in either direction).
+      std::vector<int> skeleton_dofs;
+      for (int i = 0; i < block_size; i++)
+      {
+        int dof = block.dofs[i];
+        for (int j = this->row_ptr[dof]; j < this->row_ptr[dof + 1]; j++)
+        {
+          int other = this->row_idx[j];
+          if (this->block_index[other] == -1 && skeleton_index[other] == -1)
+          {
+            skeleton_index[other] = skeleton_dofs.size();
+            skeleton_dofs.push_back(other);
+          }
+        }
+        for (int j = this->col_ptr[dof]; j < this->col_ptr[dof + 1]; j++)
+        {
+          int other = this->col_idx[j];
+          if (this->block_index[other] == -1 && skeleton_index[other] == -1)
+          {
+            skeleton_index[other] = skeleton_dofs.size();
+            skeleton_dofs.push_back(other);
+          }
+        }
+      }
+      int skeleton_size = skeleton_dofs.size();
+      block.skeleton.resize(skeleton_size);
+      for (int i = 0; i < skeleton_size; i++)
+        block.skeleton[i] = this->reduced_index[skeleton_dofs[i]];
+
+      // Inverse of the diagonal block times the block part of the rhs.
+      block.solved_rhs = malloc_with_check<Scalar>(block_size);
+      for (int i = 0; i < block_size; i++)
+        block.solved_rhs[i] = rhs_values[block.dofs[i]];
+      DenseMatrixOperations::lubksb(block.lu, block_size, block.perm, block.solved_rhs);
+
+      if (skeleton_size > 0)
+      {
+        // Coupling skeleton -> block, and block -> skeleton.
+        block.coupling = DenseMatrixOperations::new_matrix<Scalar>(skeleton_size, block_size);
+        Scalar** coupling_transposed = DenseMatrixOperations::new_matrix<Scalar>(skeleton_size, block_size);
+        for (int i = 0; i < block_size; i++)
+        {
+          int dof = block.dofs[i];
+          for (int j = this->col_ptr[dof]; j < this->col_ptr[dof + 1]; j++)
+            if (skeleton_index[this->col_idx[j]] >= 0)
+              block.coupling[skeleton_index[this->col_idx[j]]][i] += this->col_val[j];
+          for (int j = this->row_ptr[dof]; j < this->row_ptr[dof + 1]; j++)
+            if (skeleton_index[this->row_idx[j]] >= 0)
+              coupling_transposed[skeleton_index[this->row_idx[j]]][i] += this->row_val[j];
+        }
+
+        // Every row of coupling_transposed is one right-hand side for the diagonal block.
+        block.solved_coupling = DenseMatrixOperations::new_matrix<Scalar>(block_size, skeleton_size);
+        for (int s = 0; s < skeleton_size; s++)
+        {
+          DenseMatrixOperations::lubksb(block.lu, block_size, block.perm, coupling_transposed[s]);
+          for (int i = 0; i < block_size; i++)
+            block.solved_coupling[i][s] = coupling_transposed[s][i];
+        }
+        free_with_check(coupling_transposed, true);
+
+        // Schur complement contribution: - coupling * solved_coupling.
+        for (int r = 0; r < skeleton_size; r++)
+        {
+          for (int c = 0; c < skeleton_size; c++)
+          {
+            Scalar value = 0.;
+            for (int i = 0; i < block_size; i++)
+              value += block.coupling[r][i] * block.solved_coupling[i][c];
+            contribution_rows.push_back(block.skeleton[r]);
+            contribution_cols.push_back(block.skeleton[c]);
+            contribution_values.push_back(-value);
+          }
+        }
+      }
+      else
+      {
+        block.coupling = nullptr;
+        block.solved_coupling = nullptr;
+      }
+
+      for (int i = 0; i < skeleton_size; i++)
+        skeleton_index[skeleton_dofs[i]] = -1;
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::condense(CSMatrix<Scalar>* matrix, Vector<Scalar>* rhs, const bool* condensable, SparseMatrix<Scalar>* reduced_matrix, Vector<Scalar>* reduced_rhs)
+    {
+      this->free();
+      this->size = matrix->get_size();
+      if (rhs->get_size() != this->size)
+        throw Hermes::Exceptions::LengthException(2, rhs->get_size(), this->size);
+
+      this->build_views(matrix);
+
+      // 1. Groups of condensable unknowns = connected components of their mutual coupling (union-find).
+      int* parent = malloc_with_check<int>(this->size);
+      for (int i = 0; i < this->size; i++)
+        parent[i] = i;
+      for (int i = 0; i < this->size; i++)
+      {
+        if (!condensable[i])
+          continue;
+        for (int j = this->row_ptr[i]; j < this->row_ptr[i + 1]; j++)
+        {
+          int other = this->row_idx[j];
+          if (other == i || !condensable[other])
+            continue;
+          int root_i = i, root_other = other;
+          while (parent[root_i] != root_i)
+            root_i = parent[root_i] = parent[parent[root_i]];
+          while (parent[root_other] != root_other)
+            root_other = parent[root_other] = parent[parent[root_other]];
+          if (root_i != root_other)
+            parent[std::max(root_i, root_other)] = std::min(root_i, root_other);
+        }
+      }
+
+      this->block_index = malloc_with_check<int>(this->size);
+      int* root_block = malloc_with_check<int>(this->size);
+      for (int i = 0; i < this->size; i++)
+        root_block[i] = -1;
+      for (int i = 0; i < this->size; i++)
+      {
+        this->block_index[i] = -1;
+        if (!condensable[i])
+          continue;
+        int root = i;
+        while (parent[root] != root)
+          root = parent[root];
+        if (root_block[root] == -1)
+        {
+          root_block[root] = this->blocks.size();
+          Block block;
+          block.lu = block.coupling = block.solved_coupling = nullptr;
+          block.perm = nullptr;
+          block.solved_rhs = nullptr;
+          this->blocks.push_back(block);
+        }
+        this->blocks[root_block[root]].dofs.push_back(i);
+      }
+      free_with_check(parent);
+      free_with_check(root_block);
+
+      // 2. Factorize the diagonal blocks, drop those too large or singular.
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+      int num_blocks = this->blocks.size();
+      bool* block_ok = malloc_with_check<bool>(num_blocks);
+#pragma omp parallel num_threads(num_threads_used)
+      {
+        int* local_index = malloc_with_check<int>(this->size);
+        for (int i = 0; i < this->size; i++)
+          local_index[i] = -1;
+#pragma omp for schedule(dynamic, 64)
+        for (int i = 0; i < num_blocks; i++)
+          block_ok[i] = (int)this->blocks[i].dofs.size() <= this->max_block_size && this->factorize_block(this->blocks[i], local_index);
+        free_with_check(local_index);
+      }
+
+      int kept_blocks = 0, dropped_blocks = 0;
+      for (int i = 0; i < num_blocks; i++)
+      {
+        if (!block_ok[i])
+        {
+          dropped_blocks++;
+          continue;
+        }
+        if (kept_blocks != i)
+          this->blocks[kept_blocks] = this->blocks[i];
+        for (unsigned int j = 0; j < this->blocks[kept_blocks].dofs.size(); j++)
+          this->block_index[this->blocks[kept_blocks].dofs[j]] = kept_blocks;
+        kept_blocks++;
+      }
+      this->blocks.resize(kept_blocks);
+      free_with_check(block_ok);
+      if (dropped_blocks > 0)
+        this->warn("StaticCondensation: %i groups of condensable unknowns were too large or singular and are kept in the reduced system.", dropped_blocks);
+
+      // 3. Numbering of the reduced system.
+      this->reduced_index = malloc_with_check<int>(this->size);
+      this->reduced_size = 0;
+      for (int i = 0; i < this->size; i++)
+        this->reduced_index[i] = (this->block_index[i] == -1) ? this->reduced_size++ : -1;
+
+      // 4. Eliminate the blocks, collect the Schur complement contributions per thread.
+      Scalar* rhs_values = malloc_with_check<Scalar>(this->size);
+      rhs->extract(rhs_values);
+
+      std::vector<std::vector<int> > contribution_rows(num_threads_used), contribution_cols(num_threads_used);
+      std::vector<std::vector<Scalar> > contribution_values(num_threads_used);
+#pragma omp parallel num_threads(num_threads_used)
+      {
+        int thread_number = omp_get_thread_num();
+        int* skeleton_index = malloc_with_check<int>(this->size);
+        for (int i = 0; i < this->size; i++)
+          skeleton_index[i] = -1;
+#pragma omp for schedule(dynamic, 64)
+        for (int i = 0; i < kept_blocks; i++)
+          this->process_block(this->blocks[i], rhs_values, skeleton_index, contribution_rows[thread_number], contribution_cols[thread_number], contribution_values[thread_number]);
+        free_with_check(skeleton_index);
+      }
+
+      // 5. Reduced matrix = skeleton part of the original one + the contributions.
+      reduced_matrix->free();
+      reduced_matrix->prealloc(this->reduced_size);
+      for (int i = 0; i < this->size; i++)
+      {
+        if (this->reduced_index[i] == -1)
+          continue;
+        for (int j = this->row_ptr[i]; j < this->row_ptr[i + 1]; j++)
+          if (this->reduced_index[this->row_idx[j]] != -1)
+            reduced_matrix->pre_add_ij(this->reduced_index[i], this->reduced_index[this->row_idx[j]]);
+      }
+      for (int thread_i = 0; thread_i < num_threads_used; thread_i++)
+        for (unsigned int i = 0; i < contribution_rows[thread_i].size(); i++)
+          reduced_matrix->pre_add_ij(contribution_rows[thread_i][i], contribution_cols[thread_i][i]);
+      reduced_matrix->alloc();
+
+      for (int i = 0; i < this->size; i++)
+      {
+        if (this->reduced_index[i] == -1)
+          continue;
+        for (int j = this->row_ptr[i]; j < this->row_ptr[i + 1]; j++)
+          if (this->reduced_index[this->row_idx[j]] != -1)
+            reduced_matrix->add(this->reduced_index[i], this->reduced_index[this->row_idx[j]], this->row_val[j]);
+      }
+      for (int thread_i = 0; thread_i < num_threads_used; thread_i++)
+        for (unsigned int i = 0; i < contribution_rows[thread_i].size(); i++)
+          reduced_matrix->add(contribution_rows[thread_i][i], contribution_cols[thread_i][i], contribution_values[thread_i][i]);
+      reduced_matrix->finish();
+
+      // 6. Reduced rhs.
+      reduced_rhs->alloc(this->reduced_size);
+      for (int i = 0; i < this->size; i++)
+        if (this->reduced_index[i] != -1)
+          reduced_rhs->set(this->reduced_index[i], rhs_values[i]);
+      for (int i = 0; i < kept_blocks; i++)
+      {
+        Block& block = this->blocks[i];
+        int block_size = block.dofs.size();
+        for (unsigned int s = 0; s < block.skeleton.size(); s++)
+        {
+          Scalar value = 0.;
+          for (int j = 0; j < block_size; j++)
+            value += block.coupling[s][j] * block.solved_rhs[j];
+          reduced_rhs->add(block.skeleton[s], -value);
+        }
+      }
+      reduced_rhs->finish();
+
+      free_with_check(rhs_values);
+      this->free_views();
+    }
+
+    template<typename Scalar>
+    void StaticCondensation<Scalar>::condense_rhs(Vector<Scalar>* rhs, Vector<Scalar>* reduced_rhs)
+    {
+      if (!this->is_condensed())
+        throw Hermes::Exceptions::Exception("StaticCondensation::condense_rhs() called before condense().");
+      if (rhs->get_size() != this->size)
+        throw Hermes::Exceptions::LengthException(1, rhs->get_size(), this->size);
+
+      Scalar* rhs_values = malloc_with_check<Scalar>(this->size);
+      rhs->extract(rhs_values);
+
+      reduced_rhs->alloc(this->reduced_size);
+      for (int i = 0; i < this->size; i++)
+        if (this->reduced_index[i] != -1)
+          reduced_rhs->set(this->reduced_index[i], rhs_values[i]);
+
+      for (unsigned int i = 0; i < this->blocks.size(); i++)
+      {
+        Block& block = this->blocks[i];
+        int block_size = block.dofs.size();
+        for (int j = 0; j < block_size; j++)
+          block.solved_rhs[j] = rhs_values[block.dofs[j]];
+        DenseMatrixOperations::lubksb(block.lu, block_size, block.perm, block.solved_rhs);
+
+        for (unsigned int s = 0; s < block.skeleton.size(); s++)
+        {
+          Scalar value = 0.;
+          for (int j = 0; j < block_size; j++)
+            value += block.coupling[s][j] * block.solved_rhs[j];
+          reduced_rhs->add(block.skeleton[s], -value);
+        }
+      }
+      reduced_rhs->finish();
+
+      free_with_check(rhs_values);
+    }
+
+    template<typename Scalar>
+    Scalar* StaticCondensation<Scalar>::expand(const Scalar* reduced_sln)
+    {
+      if (!this->is_condensed())
+        throw Hermes::Exceptions::Exception("StaticCondensation::expand() called before condense().");
+
+      this->full_sln = realloc_with_check<Scalar>(this->full_sln, this->size);
+      for (int i = 0; i < this->size; i++)
+        if (this->reduced_index[i] != -1)
+          this->full_sln[i] = reduced_sln[this->reduced_index[i]];
+
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+      int num_blocks = this->blocks.size();
+#pragma omp parallel for num_threads(num_threads_used) schedule(dynamic, 64)
+      for (int i = 0; i < num_blocks; i++)
+      {
+        Block& block = this->blocks[i];
+        int skeleton_size = block.skeleton.size();
+        for (unsigned int j = 0; j < block.dofs.size(); j++)
+        {
+          Scalar value = block.solved_rhs[j];
+          for (int s = 0; s < skeleton_size; s++)
+            value -= block.solved_coupling[j][s] * reduced_sln[block.skeleton[s]];
+          this->full_sln[block.dofs[j]] = value;
+        }
+      }
+
+      return this->full_sln;
+    }
+
+    template<typename Scalar>
+    Scalar* StaticCondensation<Scalar>::restrict_vector(const Scalar* full_vector)
+    {
+      if (!this->is_condensed())
+        throw Hermes::Exceptions::Exception("StaticCondensation::restrict_vector() called before condense().");
+
+      this->reduced_vector = realloc_with_check<Scalar>(this->reduced_vector, this->reduced_size);
+      for (int i = 0; i < this->size; i++)
+        if (this->reduced_index[i] != -1)
+          this->reduced_vector[this->reduced_index[i]] = full_vector[i];
+      return this->reduced_vector;
+    }
+
+    template class HERMES_API StaticCondensation < double > ;
+    template class HERMES_API StaticCondensation < std::complex<double> > ;
+  }
+}
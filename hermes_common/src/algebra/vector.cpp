@@ -596,6 +596,11 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        return new SimpleVector < double > ;
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
@@ -683,6 +688,11 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        return new SimpleVector < std::complex<double> > ;
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
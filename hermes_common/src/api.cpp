@@ -74,6 +74,8 @@ namespace Hermes
 #endif
     this->parameters.insert(std::pair<HermesCommonApiParam, Parameter*>(Hermes::useAccelerators, new Parameter(1)));
     this->parameters.insert(std::pair<HermesCommonApiParam, Parameter*>(Hermes::checkMeshesOnLoad, new Parameter(1)));
+    this->parameters.insert(std::pair<HermesCommonApiParam, Parameter*>(Hermes::spaceFillingCurveOrdering, new Parameter(0)));
+    this->parameters.insert(std::pair<HermesCommonApiParam, Parameter*>(Hermes::symmetricMatrixStorage, new Parameter(0)));
 
     // Set handlers.
 #ifdef WITH_PARALUTION
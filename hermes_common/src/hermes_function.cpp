@@ -118,6 +118,18 @@ namespace Hermes
     }
   };
 
+  template<typename Scalar>
+  void Hermes1DFunction<Scalar>::values(int n, const Scalar* x, Scalar* out, Scalar* dout) const
+  {
+    for (int i = 0; i < n; i++)
+      out[i] = this->value(x[i]);
+    if (dout)
+    {
+      for (int i = 0; i < n; i++)
+        dout[i] = this->derivative(x[i]);
+    }
+  };
+
   template<typename Scalar>
   Hermes2DFunction<Scalar>::Hermes2DFunction()
   {
@@ -237,6 +249,21 @@ namespace Hermes
     }
   };
 
+  template<typename Scalar>
+  void Hermes2DFunction<Scalar>::values(int n, const double* x, const double* y, Scalar* out, Scalar* dout_x, Scalar* dout_y) const
+  {
+    for (int i = 0; i < n; i++)
+      out[i] = this->value(Scalar(x[i]), Scalar(y[i]));
+    if (dout_x)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        dout_x[i] = this->derivative_x(Scalar(x[i]), Scalar(y[i]));
+        dout_y[i] = this->derivative_y(Scalar(x[i]), Scalar(y[i]));
+      }
+    }
+  };
+
   template<typename Scalar>
   Hermes3DFunction<Scalar>::Hermes3DFunction()
   {
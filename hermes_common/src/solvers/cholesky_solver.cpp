@@ -0,0 +1,945 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file cholesky_solver.cpp
+\brief Built-in sparse (supernodal) Cholesky solver for symmetric positive definite systems.
+*/
+#include "cholesky_solver.h"
+#include "common.h"
+#include "api.h"
+#include "util/memory_handling.h"
+
+namespace Hermes
+{
+  namespace Solvers
+  {
+    static const int HERMES_CHOLESKY_DEFAULT_LEAF_SIZE = 64;
+    /// Column block size of the dense kernels.
+    static const int HERMES_CHOLESKY_BLOCK_SIZE = 32;
+
+    /// Square root of the pivot, false if the factorization breaks down.
+    /// Real matrices have to be positive definite, complex ones are factorized as complex symmetric (LL^T, not LL^H).
+    static inline bool cholesky_pivot(double& a)
+    {
+      if (!(a > 0.))
+        return false;
+      a = std::sqrt(a);
+      return true;
+    }
+    static inline bool cholesky_pivot(std::complex<double>& a)
+    {
+      if (a == 0.)
+        return false;
+      a = std::sqrt(a);
+      return true;
+    }
+
+    template<typename Scalar>
+    CholeskySolver<Scalar>::CholeskySolver(CSCMatrix<Scalar> *m, SimpleVector<Scalar> *rhs)
+      : DirectSolver<Scalar>(m, rhs), m(m), rhs(rhs), leaf_size(HERMES_CHOLESKY_DEFAULT_LEAF_SIZE), size(0), perm(nullptr),
+      a_ptr(nullptr), a_rows(nullptr), a_map(nullptr), num_supernodes(0), super_start(nullptr), super_parent(nullptr), children_ptr(nullptr), children(nullptr),
+      struct_ptr(nullptr), struct_rows(nullptr), num_levels(0), level_ptr(nullptr), level_nodes(nullptr), factor_ptr(nullptr), factor(nullptr), updates(nullptr),
+      symbolic_done(false), numeric_done(false)
+    {
+    }
+
+    template<typename Scalar>
+    CholeskySolver<Scalar>::~CholeskySolver()
+    {
+      this->free();
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::free()
+    {
+      this->free_numeric();
+      this->free_symbolic();
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::free_symbolic()
+    {
+      free_with_check(this->perm);
+      free_with_check(this->a_ptr);
+      free_with_check(this->a_rows);
+      free_with_check(this->a_map);
+      free_with_check(this->super_start);
+      free_with_check(this->super_parent);
+      free_with_check(this->children_ptr);
+      free_with_check(this->children);
+      free_with_check(this->struct_ptr);
+      free_with_check(this->struct_rows);
+      free_with_check(this->level_ptr);
+      free_with_check(this->level_nodes);
+      free_with_check(this->factor_ptr);
+      this->num_supernodes = this->num_levels = this->size = 0;
+      this->symbolic_done = false;
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::free_numeric()
+    {
+      free_with_check(this->factor);
+      if (this->updates)
+      {
+        for (int i = 0; i < this->num_supernodes; i++)
+          free_with_check(this->updates[i]);
+        free_with_check(this->updates);
+      }
+      this->numeric_done = false;
+    }
+
+    template<typename Scalar>
+    int CholeskySolver<Scalar>::get_matrix_size()
+    {
+      return m->get_size();
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::set_nested_dissection_leaf_size(int leaf_size)
+    {
+      if (leaf_size < 1)
+        throw Exceptions::ValueException("leaf_size", leaf_size, 1);
+      this->leaf_size = leaf_size;
+    }
+
+    template<typename Scalar>
+    long long CholeskySolver<Scalar>::get_factor_nnz() const
+    {
+      if (!this->symbolic_done)
+        return 0;
+      long long nnz = 0;
+      for (int s = 0; s < this->num_supernodes; s++)
+      {
+        long long rows = this->struct_ptr[s + 1] - this->struct_ptr[s];
+        long long cols = this->super_start[s + 1] - this->super_start[s];
+        nnz += rows * cols - cols * (cols - 1) / 2;
+      }
+      return nnz;
+    }
+
+    template<typename Scalar>
+    int CholeskySolver<Scalar>::get_num_supernodes() const
+    {
+      return this->num_supernodes;
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::nested_dissection(const int* adjacency_ptr, const int* adjacency, int* order) const
+    {
+      int n = this->size;
+      // Subgraph membership, BFS levels, BFS queue.
+      int* label = malloc_with_check<int>(n);
+      int* level = malloc_with_check<int>(n);
+      int* queue = malloc_with_check<int>(n);
+      for (int i = 0; i < n; i++)
+      {
+        order[i] = i;
+        label[i] = 0;
+      }
+      int label_count = 1;
+
+      // Subproblems: ranges of order[], all vertices in a range have the same label.
+      std::vector<std::pair<int, int> > ranges;
+      ranges.push_back(std::pair<int, int>(0, n));
+      std::vector<int> part_a, part_b, separator, component_starts;
+
+      while (!ranges.empty())
+      {
+        int begin = ranges.back().first, end = ranges.back().second;
+        ranges.pop_back();
+        int count = end - begin;
+        if (count <= this->leaf_size)
+          continue;
+        int current_label = label[order[begin]];
+
+        // Connected components, in BFS order - a disconnected subgraph is split without any separator.
+        for (int i = begin; i < end; i++)
+          level[order[i]] = -1;
+        int tail = 0;
+        component_starts.clear();
+        for (int i = begin; i < end; i++)
+        {
+          if (level[order[i]] != -1)
+            continue;
+          component_starts.push_back(tail);
+          int head = tail;
+          queue[tail++] = order[i];
+          level[order[i]] = 0;
+          while (head < tail)
+          {
+            int v = queue[head++];
+            for (int k = adjacency_ptr[v]; k < adjacency_ptr[v + 1]; k++)
+            {
+              int w = adjacency[k];
+              if (label[w] == current_label && level[w] == -1)
+              {
+                level[w] = 0;
+                queue[tail++] = w;
+              }
+            }
+          }
+        }
+        if (component_starts.size() > 1)
+        {
+          component_starts.push_back(tail);
+          memcpy(order + begin, queue, count * sizeof(int));
+          for (unsigned int c = 0; c + 1 < component_starts.size(); c++)
+          {
+            int component_label = label_count++;
+            for (int i = component_starts[c]; i < component_starts[c + 1]; i++)
+              label[queue[i]] = component_label;
+            if (component_starts[c + 1] - component_starts[c] > this->leaf_size)
+              ranges.push_back(std::pair<int, int>(begin + component_starts[c], begin + component_starts[c + 1]));
+          }
+          continue;
+        }
+
+        // Pseudo-peripheral vertex: repeated BFS from the last vertex of the previous one.
+        int start = order[begin];
+        int num_levels = 0;
+        for (int attempt = 0; attempt < 3; attempt++)
+        {
+          for (int i = begin; i < end; i++)
+            level[order[i]] = -1;
+          int head = 0;
+          tail = 0;
+          queue[tail++] = start;
+          level[start] = 0;
+          while (head < tail)
+          {
+            int v = queue[head++];
+            for (int k = adjacency_ptr[v]; k < adjacency_ptr[v + 1]; k++)
+            {
+              int w = adjacency[k];
+              if (label[w] == current_label && level[w] == -1)
+              {
+                level[w] = level[v] + 1;
+                queue[tail++] = w;
+              }
+            }
+          }
+          int new_num_levels = level[queue[tail - 1]] + 1;
+          if (attempt > 0 && new_num_levels <= num_levels)
+          {
+            num_levels = new_num_levels;
+            break;
+          }
+          num_levels = new_num_levels;
+          start = queue[tail - 1];
+        }
+
+        // No sensible separator (e.g. a clique).
+        if (num_levels < 3)
+          continue;
+
+        // Separator = the level splitting the vertices (in the BFS order in queue) in halves.
+        int separator_level = std::max(1, std::min(num_levels - 2, level[queue[count / 2]]));
+
+        part_a.clear();
+        part_b.clear();
+        separator.clear();
+        for (int i = begin; i < end; i++)
+        {
+          int v = order[i];
+          if (level[v] < separator_level)
+            part_a.push_back(v);
+          else if (level[v] > separator_level)
+            part_b.push_back(v);
+          else
+          {
+            // Separator vertices not adjacent to the other side are moved to part A.
+            bool separating = false;
+            for (int k = adjacency_ptr[v]; k < adjacency_ptr[v + 1]; k++)
+            {
+              int w = adjacency[k];
+              if (label[w] == current_label && level[w] == separator_level + 1)
+              {
+                separating = true;
+                break;
+              }
+            }
+            if (separating)
+              separator.push_back(v);
+            else
+              part_a.push_back(v);
+          }
+        }
+
+        // Order: A, B, separator last.
+        int position = begin;
+        std::vector<int>* parts[2] = { &part_a, &part_b };
+        for (int part_i = 0; part_i < 2; part_i++)
+        {
+          std::vector<int>& part = *parts[part_i];
+          int part_label = label_count++;
+          for (unsigned int i = 0; i < part.size(); i++)
+          {
+            label[part[i]] = part_label;
+            order[position + i] = part[i];
+          }
+          ranges.push_back(std::pair<int, int>(position, position + (int)part.size()));
+          position += part.size();
+        }
+        for (unsigned int i = 0; i < separator.size(); i++)
+        {
+          label[separator[i]] = -1;
+          order[position++] = separator[i];
+        }
+      }
+
+      free_with_check(label);
+      free_with_check(level);
+      free_with_check(queue);
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::symbolic_factorization()
+    {
+      this->free_numeric();
+      this->free_symbolic();
+
+      int n = this->size = m->get_size();
+      int* Ap = m->get_Ap();
+      int* Ai = m->get_Ai();
+
+      // 1. Graph of the matrix (lower triangle and its transpose, without the diagonal).
+      int* adjacency_ptr = calloc_with_check<int>(n + 1);
+      for (int j = 0; j < n; j++)
+      {
+        for (int k = Ap[j]; k < Ap[j + 1]; k++)
+        {
+          int i = Ai[k];
+          if (i > j)
+          {
+            adjacency_ptr[i + 1]++;
+            adjacency_ptr[j + 1]++;
+          }
+        }
+      }
+      for (int i = 0; i < n; i++)
+        adjacency_ptr[i + 1] += adjacency_ptr[i];
+      int* adjacency = malloc_with_check<int>(std::max(1, adjacency_ptr[n]));
+      int* fill = malloc_with_check<int>(n);
+      memcpy(fill, adjacency_ptr, n * sizeof(int));
+      for (int j = 0; j < n; j++)
+      {
+        for (int k = Ap[j]; k < Ap[j + 1]; k++)
+        {
+          int i = Ai[k];
+          if (i > j)
+          {
+            adjacency[fill[i]++] = j;
+            adjacency[fill[j]++] = i;
+          }
+        }
+      }
+
+      // 2. Nested dissection.
+      int* order = malloc_with_check<int>(n);
+      this->nested_dissection(adjacency_ptr, adjacency, order);
+      int* inverse = malloc_with_check<int>(n);
+      for (int i = 0; i < n; i++)
+        inverse[order[i]] = i;
+
+      // 3. Elimination tree (Liu, with path compression).
+      int* parent = malloc_with_check<int>(n);
+      int* ancestor = malloc_with_check<int>(n);
+      for (int i = 0; i < n; i++)
+      {
+        parent[i] = ancestor[i] = -1;
+        int v = order[i];
+        for (int k = adjacency_ptr[v]; k < adjacency_ptr[v + 1]; k++)
+        {
+          int r = inverse[adjacency[k]];
+          if (r >= i)
+            continue;
+          while (ancestor[r] != -1 && ancestor[r] != i)
+          {
+            int t = ancestor[r];
+            ancestor[r] = i;
+            r = t;
+          }
+          if (ancestor[r] == -1)
+          {
+            ancestor[r] = i;
+            parent[r] = i;
+          }
+        }
+      }
+
+      // 4. Postorder of the tree, so that the supernodes are contiguous; renumber everything.
+      int* first_child = fill;
+      int* next_sibling = ancestor;
+      for (int i = 0; i < n; i++)
+        first_child[i] = next_sibling[i] = -1;
+      for (int i = n - 1; i >= 0; i--)
+      {
+        if (parent[i] != -1)
+        {
+          next_sibling[i] = first_child[parent[i]];
+          first_child[parent[i]] = i;
+        }
+      }
+      int* post = malloc_with_check<int>(n);
+      int* stack = malloc_with_check<int>(n);
+      int post_count = 0;
+      for (int root = 0; root < n; root++)
+      {
+        if (parent[root] != -1)
+          continue;
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0)
+        {
+          int v = stack[top - 1];
+          int child = first_child[v];
+          if (child != -1)
+          {
+            // Descend, detach the child so that it is not visited again.
+            first_child[v] = next_sibling[child];
+            stack[top++] = child;
+          }
+          else
+          {
+            post[post_count++] = v;
+            top--;
+          }
+        }
+      }
+      // post[new] = old (in the ND numbering) -> compose.
+      this->perm = malloc_with_check<int>(n);
+      int* post_inverse = stack;
+      for (int i = 0; i < n; i++)
+      {
+        this->perm[i] = order[post[i]];
+        post_inverse[post[i]] = i;
+      }
+      int* new_parent = first_child;
+      for (int i = 0; i < n; i++)
+        new_parent[i] = parent[post[i]] == -1 ? -1 : post_inverse[parent[post[i]]];
+      memcpy(parent, new_parent, n * sizeof(int));
+      for (int i = 0; i < n; i++)
+        inverse[this->perm[i]] = i;
+      free_with_check(order);
+      free_with_check(post);
+      free_with_check(stack);
+
+      // 5. Column counts (including the diagonal) by the row subtrees: L(i, j) != 0 iff j is on a path from some k (A(i, k) != 0, k < i) to i.
+      int* column_count = malloc_with_check<int>(n);
+      int* mark = fill;
+      for (int i = 0; i < n; i++)
+      {
+        column_count[i] = 1;
+        mark[i] = -1;
+      }
+      for (int i = 0; i < n; i++)
+      {
+        mark[i] = i;
+        int v = this->perm[i];
+        for (int k = adjacency_ptr[v]; k < adjacency_ptr[v + 1]; k++)
+        {
+          int j = inverse[adjacency[k]];
+          if (j >= i)
+            continue;
+          while (mark[j] != i)
+          {
+            column_count[j]++;
+            mark[j] = i;
+            j = parent[j];
+          }
+        }
+      }
+
+      // 6. Fundamental supernodes: j + 1 joins j if it is the only child of j + 1 and the structures nest.
+      int* child_count = calloc_with_check<int>(n);
+      for (int i = 0; i < n; i++)
+        if (parent[i] != -1)
+          child_count[parent[i]]++;
+      std::vector<int> fundamental_starts;
+      for (int j = 0; j < n; j++)
+        if (j == 0 || !(parent[j - 1] == j && child_count[j] == 1 && column_count[j - 1] == column_count[j] + 1))
+          fundamental_starts.push_back(j);
+      fundamental_starts.push_back(n);
+      free_with_check(child_count);
+
+      // Relaxed supernodes: a supernode is merged with its parent if that immediately follows, and the merged
+      // supernode is small or does not store too many zeros - larger dense blocks pay off.
+      std::vector<int> starts;
+      long long group_nnz = 0;
+      int group_cols = 0;
+      for (unsigned int f = 0; f + 1 < fundamental_starts.size(); f++)
+      {
+        int first = fundamental_starts[f], last = fundamental_starts[f + 1] - 1;
+        long long cols = last - first + 1, rows = cols + column_count[last] - 1;
+        long long nnz = rows * cols - cols * (cols - 1) / 2;
+        if (f > 0 && parent[first - 1] == first)
+        {
+          long long merged_cols = group_cols + cols, merged_rows = group_cols + rows;
+          long long merged_nnz = merged_rows * merged_cols - merged_cols * (merged_cols - 1) / 2;
+          long long zeros = merged_nnz - group_nnz - nnz;
+          if (merged_cols <= 4 || (merged_cols <= 64 && zeros <= merged_nnz / 5))
+          {
+            group_cols = merged_cols;
+            group_nnz += nnz;
+            continue;
+          }
+        }
+        starts.push_back(first);
+        group_cols = cols;
+        group_nnz = nnz;
+      }
+
+      int* supernode_of = mark;
+      for (unsigned int s = 0; s < starts.size(); s++)
+        for (int j = starts[s]; j < (s + 1 < starts.size() ? starts[s + 1] : n); j++)
+          supernode_of[j] = s;
+      int ns = this->num_supernodes = starts.size();
+      this->super_start = malloc_with_check<int>(ns + 1);
+      for (int s = 0; s < ns; s++)
+        this->super_start[s] = starts[s];
+      this->super_start[ns] = n;
+      this->super_parent = malloc_with_check<int>(ns);
+      for (int s = 0; s < ns; s++)
+      {
+        int p = parent[this->super_start[s + 1] - 1];
+        this->super_parent[s] = p == -1 ? -1 : supernode_of[p];
+      }
+
+      // Children lists.
+      this->children_ptr = calloc_with_check<int>(ns + 1);
+      for (int s = 0; s < ns; s++)
+        if (this->super_parent[s] != -1)
+          this->children_ptr[this->super_parent[s] + 1]++;
+      for (int s = 0; s < ns; s++)
+        this->children_ptr[s + 1] += this->children_ptr[s];
+      this->children = malloc_with_check<int>(std::max(1, this->children_ptr[ns]));
+      int* children_fill = malloc_with_check<int>(ns);
+      memcpy(children_fill, this->children_ptr, ns * sizeof(int));
+      for (int s = 0; s < ns; s++)
+        if (this->super_parent[s] != -1)
+          this->children[children_fill[this->super_parent[s]]++] = s;
+      free_with_check(children_fill);
+
+      // 7. Permuted lower triangle of the matrix.
+      this->a_ptr = calloc_with_check<int>(n + 1);
+      for (int j = 0; j < n; j++)
+      {
+        for (int k = Ap[j]; k < Ap[j + 1]; k++)
+        {
+          if (Ai[k] < j)
+            continue;
+          int new_i = inverse[Ai[k]], new_j = inverse[j];
+          this->a_ptr[std::min(new_i, new_j) + 1]++;
+        }
+      }
+      for (int j = 0; j < n; j++)
+        this->a_ptr[j + 1] += this->a_ptr[j];
+      int a_nnz = this->a_ptr[n];
+      this->a_rows = malloc_with_check<int>(std::max(1, a_nnz));
+      this->a_map = malloc_with_check<int>(std::max(1, a_nnz));
+      int* a_fill = malloc_with_check<int>(n);
+      memcpy(a_fill, this->a_ptr, n * sizeof(int));
+      for (int j = 0; j < n; j++)
+      {
+        for (int k = Ap[j]; k < Ap[j + 1]; k++)
+        {
+          if (Ai[k] < j)
+            continue;
+          int new_i = inverse[Ai[k]], new_j = inverse[j];
+          int column = std::min(new_i, new_j);
+          this->a_rows[a_fill[column]] = std::max(new_i, new_j);
+          // Entries that moved to the upper triangle by the permutation are used transposed.
+          this->a_map[a_fill[column]++] = new_i >= new_j ? k : -1 - k;
+        }
+      }
+      free_with_check(a_fill);
+      std::vector<std::pair<int, int> > column_entries;
+      for (int j = 0; j < n; j++)
+      {
+        column_entries.clear();
+        for (int k = this->a_ptr[j]; k < this->a_ptr[j + 1]; k++)
+          column_entries.push_back(std::pair<int, int>(this->a_rows[k], this->a_map[k]));
+        std::sort(column_entries.begin(), column_entries.end());
+        for (int k = this->a_ptr[j]; k < this->a_ptr[j + 1]; k++)
+        {
+          this->a_rows[k] = column_entries[k - this->a_ptr[j]].first;
+          this->a_map[k] = column_entries[k - this->a_ptr[j]].second;
+        }
+      }
+
+      // 8. Structure of the supernodes: own columns, rows of the matrix below, structures of the children below.
+      this->struct_ptr = malloc_with_check<int>(ns + 1);
+      this->struct_ptr[0] = 0;
+      for (int s = 0; s < ns; s++)
+        this->struct_ptr[s + 1] = this->struct_ptr[s] + this->super_start[s + 1] - this->super_start[s] + column_count[this->super_start[s + 1] - 1] - 1;
+      this->struct_rows = malloc_with_check<int>(std::max(1, this->struct_ptr[ns]));
+      int* row_mark = fill;
+      for (int i = 0; i < n; i++)
+        row_mark[i] = -1;
+      std::vector<int> below;
+      for (int s = 0; s < ns; s++)
+      {
+        int first = this->super_start[s], last = this->super_start[s + 1] - 1;
+        below.clear();
+        for (int j = first; j <= last; j++)
+        {
+          for (int k = this->a_ptr[j]; k < this->a_ptr[j + 1]; k++)
+          {
+            int i = this->a_rows[k];
+            if (i > last && row_mark[i] != s)
+            {
+              row_mark[i] = s;
+              below.push_back(i);
+            }
+          }
+        }
+        for (int c = this->children_ptr[s]; c < this->children_ptr[s + 1]; c++)
+        {
+          int child = this->children[c];
+          for (int k = this->struct_ptr[child]; k < this->struct_ptr[child + 1]; k++)
+          {
+            int i = this->struct_rows[k];
+            if (i > last && row_mark[i] != s)
+            {
+              row_mark[i] = s;
+              below.push_back(i);
+            }
+          }
+        }
+        std::sort(below.begin(), below.end());
+        if ((int)below.size() + last - first + 1 != this->struct_ptr[s + 1] - this->struct_ptr[s])
+          throw Exceptions::LinearMatrixSolverException("Cholesky: inconsistent symbolic factorization.");
+        int position = this->struct_ptr[s];
+        for (int j = first; j <= last; j++)
+          this->struct_rows[position++] = j;
+        for (unsigned int i = 0; i < below.size(); i++)
+          this->struct_rows[position++] = below[i];
+      }
+
+      // 9. Levels (height in the supernodal tree), supernodes on one level are independent.
+      int* height = calloc_with_check<int>(ns);
+      this->num_levels = 0;
+      for (int s = 0; s < ns; s++)
+      {
+        if (this->super_parent[s] != -1)
+          height[this->super_parent[s]] = std::max(height[this->super_parent[s]], height[s] + 1);
+        this->num_levels = std::max(this->num_levels, height[s] + 1);
+      }
+      this->level_ptr = calloc_with_check<int>(this->num_levels + 1);
+      for (int s = 0; s < ns; s++)
+        this->level_ptr[height[s] + 1]++;
+      for (int l = 0; l < this->num_levels; l++)
+        this->level_ptr[l + 1] += this->level_ptr[l];
+      this->level_nodes = malloc_with_check<int>(std::max(1, ns));
+      int* level_fill = malloc_with_check<int>(std::max(1, this->num_levels));
+      memcpy(level_fill, this->level_ptr, this->num_levels * sizeof(int));
+      for (int s = 0; s < ns; s++)
+        this->level_nodes[level_fill[height[s]]++] = s;
+      free_with_check(level_fill);
+      free_with_check(height);
+
+      // 10. Factor storage.
+      this->factor_ptr = malloc_with_check<long long>(ns + 1);
+      this->factor_ptr[0] = 0;
+      for (int s = 0; s < ns; s++)
+        this->factor_ptr[s + 1] = this->factor_ptr[s] + (long long)(this->struct_ptr[s + 1] - this->struct_ptr[s]) * (this->super_start[s + 1] - this->super_start[s]);
+
+      free_with_check(adjacency_ptr);
+      free_with_check(adjacency);
+      free_with_check(fill);
+      free_with_check(inverse);
+      free_with_check(parent);
+      free_with_check(ancestor);
+      free_with_check(column_count);
+
+      this->symbolic_done = true;
+      this->info("\tCholesky: %i unknowns, %i supernodes, %i levels, %lli nonzeros in the factor.", n, ns, this->num_levels, this->get_factor_nnz());
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::factorize_supernode(int s)
+    {
+      int first = this->super_start[s];
+      int cols = this->super_start[s + 1] - first;
+      int rows = this->struct_ptr[s + 1] - this->struct_ptr[s];
+      int update_size = rows - cols;
+      const int* structure = this->struct_rows + this->struct_ptr[s];
+      Scalar* panel = this->factor + this->factor_ptr[s];
+      Scalar* Ax = m->get_Ax();
+
+      // 1. Assemble the frontal matrix - the panel and the update matrix.
+      memset(panel, 0, (long long)rows * cols * sizeof(Scalar));
+      Scalar* update = nullptr;
+      if (update_size > 0)
+        update = calloc_with_check<Scalar>((long long)update_size * update_size);
+
+      for (int c = 0; c < cols; c++)
+      {
+        int j = first + c;
+        int position = c;
+        for (int k = this->a_ptr[j]; k < this->a_ptr[j + 1]; k++)
+        {
+          int i = this->a_rows[k];
+          while (structure[position] < i)
+            position++;
+          int map = this->a_map[k];
+          panel[(long long)c * rows + position] += Ax[map >= 0 ? map : -1 - map];
+        }
+      }
+
+      std::vector<int> relative;
+      for (int c = this->children_ptr[s]; c < this->children_ptr[s + 1]; c++)
+      {
+        int child = this->children[c];
+        int child_cols = this->super_start[child + 1] - this->super_start[child];
+        int child_update_size = this->struct_ptr[child + 1] - this->struct_ptr[child] - child_cols;
+        Scalar* child_update = this->updates[child];
+        if (child_update_size == 0)
+          continue;
+
+        // Positions of the child's update rows in this structure.
+        const int* child_rows = this->struct_rows + this->struct_ptr[child] + child_cols;
+        relative.resize(child_update_size);
+        int position = 0;
+        for (int i = 0; i < child_update_size; i++)
+        {
+          while (structure[position] < child_rows[i])
+            position++;
+          relative[i] = position;
+        }
+
+        for (int q = 0; q < child_update_size; q++)
+        {
+          const Scalar* child_column = child_update + (long long)q * child_update_size;
+          int target_column = relative[q];
+          if (target_column < cols)
+          {
+            Scalar* target = panel + (long long)target_column * rows;
+            for (int p = q; p < child_update_size; p++)
+              target[relative[p]] += child_column[p];
+          }
+          else
+          {
+            Scalar* target = update + (long long)(target_column - cols) * update_size - cols;
+            for (int p = q; p < child_update_size; p++)
+              target[relative[p]] += child_column[p];
+          }
+        }
+
+        free_with_check(this->updates[child]);
+      }
+
+      // 2. Dense Cholesky of the panel (column blocks: left-looking update of the block, factorization of its columns).
+      for (int block_start = 0; block_start < cols; block_start += HERMES_CHOLESKY_BLOCK_SIZE)
+      {
+        int block_end = std::min(cols, block_start + HERMES_CHOLESKY_BLOCK_SIZE);
+        for (int j = block_start; j < block_end; j++)
+        {
+          Scalar* column = panel + (long long)j * rows;
+          // Update by the previous columns of this block (the previous blocks were applied below).
+          for (int l = block_start; l < j; l++)
+          {
+            const Scalar* previous = panel + (long long)l * rows;
+            Scalar factor_l = previous[j];
+            if (factor_l == 0.)
+              continue;
+            for (int i = j; i < rows; i++)
+              column[i] -= previous[i] * factor_l;
+          }
+
+          Scalar diagonal = column[j];
+          if (!cholesky_pivot(diagonal))
+            throw Exceptions::LinearMatrixSolverException("Cholesky: the matrix is not positive definite (pivot %i).", this->perm[first + j]);
+          column[j] = diagonal;
+          for (int i = j + 1; i < rows; i++)
+            column[i] /= diagonal;
+        }
+
+        // Update the following columns of the panel by this block.
+        for (int j = block_end; j < cols; j++)
+        {
+          Scalar* column = panel + (long long)j * rows;
+          for (int l = block_start; l < block_end; l++)
+          {
+            const Scalar* previous = panel + (long long)l * rows;
+            Scalar factor_l = previous[j];
+            if (factor_l == 0.)
+              continue;
+            for (int i = j; i < rows; i++)
+              column[i] -= previous[i] * factor_l;
+          }
+        }
+      }
+
+      // 3. Update matrix -= L21 * L21^T (lower triangle).
+      for (int q = 0; q < update_size; q++)
+      {
+        Scalar* column = update + (long long)q * update_size;
+        for (int l = 0; l < cols; l++)
+        {
+          const Scalar* l21 = panel + (long long)l * rows + cols;
+          Scalar factor_l = l21[q];
+          if (factor_l == 0.)
+            continue;
+          for (int p = q; p < update_size; p++)
+            column[p] -= l21[p] * factor_l;
+        }
+      }
+
+      this->updates[s] = update;
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::numeric_factorization()
+    {
+      this->free_numeric();
+      this->factor = malloc_with_check<Scalar>(std::max(1LL, this->factor_ptr[this->num_supernodes]));
+      this->updates = calloc_with_check<Scalar*>(std::max(1, this->num_supernodes));
+
+      int num_threads_used = Hermes::HermesCommonApi.get_integral_param_value(Hermes::numThreads);
+      std::string exceptionMessageCaughtInParallelBlock;
+
+      for (int l = 0; l < this->num_levels; l++)
+      {
+        int level_begin = this->level_ptr[l], level_end = this->level_ptr[l + 1];
+        if (num_threads_used == 1 || level_end - level_begin == 1)
+        {
+          for (int i = level_begin; i < level_end; i++)
+            this->factorize_supernode(this->level_nodes[i]);
+          continue;
+        }
+
+#pragma omp parallel for num_threads(num_threads_used) schedule(dynamic, 1)
+        for (int i = level_begin; i < level_end; i++)
+        {
+          if (!exceptionMessageCaughtInParallelBlock.empty())
+            continue;
+          try
+          {
+            this->factorize_supernode(this->level_nodes[i]);
+          }
+          catch (Hermes::Exceptions::Exception& e)
+          {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+            exceptionMessageCaughtInParallelBlock = e.info();
+          }
+          catch (std::exception& e)
+          {
+#pragma omp critical (exceptionMessageCaughtInParallelBlock)
+            exceptionMessageCaughtInParallelBlock = e.what();
+          }
+        }
+
+        if (!exceptionMessageCaughtInParallelBlock.empty())
+        {
+          this->free_numeric();
+          throw Exceptions::LinearMatrixSolverException(exceptionMessageCaughtInParallelBlock.c_str());
+        }
+      }
+
+      this->numeric_done = true;
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::substitute(Scalar* x) const
+    {
+      // L y = b.
+      for (int s = 0; s < this->num_supernodes; s++)
+      {
+        int first = this->super_start[s];
+        int cols = this->super_start[s + 1] - first;
+        int rows = this->struct_ptr[s + 1] - this->struct_ptr[s];
+        const int* structure = this->struct_rows + this->struct_ptr[s];
+        const Scalar* panel = this->factor + this->factor_ptr[s];
+        for (int c = 0; c < cols; c++)
+        {
+          const Scalar* column = panel + (long long)c * rows;
+          Scalar value = x[first + c] /= column[c];
+          if (value == 0.)
+            continue;
+          for (int p = c + 1; p < rows; p++)
+            x[structure[p]] -= column[p] * value;
+        }
+      }
+
+      // L^T x = y.
+      for (int s = this->num_supernodes - 1; s >= 0; s--)
+      {
+        int first = this->super_start[s];
+        int cols = this->super_start[s + 1] - first;
+        int rows = this->struct_ptr[s + 1] - this->struct_ptr[s];
+        const int* structure = this->struct_rows + this->struct_ptr[s];
+        const Scalar* panel = this->factor + this->factor_ptr[s];
+        for (int c = cols - 1; c >= 0; c--)
+        {
+          const Scalar* column = panel + (long long)c * rows;
+          Scalar value = x[first + c];
+          for (int p = c + 1; p < rows; p++)
+            value -= column[p] * x[structure[p]];
+          x[first + c] = value / column[c];
+        }
+      }
+    }
+
+    template<typename Scalar>
+    void CholeskySolver<Scalar>::solve()
+    {
+      assert(m != nullptr);
+      assert(rhs != nullptr);
+      assert(m->get_size() == rhs->get_size());
+
+      this->tick();
+
+      MatrixStructureReuseScheme eff_fact_scheme = this->get_effective_reuse_scheme(m->get_structure_fingerprint(), this->symbolic_done && this->size == (int)m->get_size());
+      if (eff_fact_scheme == HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY && !this->numeric_done)
+        eff_fact_scheme = HERMES_REUSE_MATRIX_REORDERING;
+
+      switch (eff_fact_scheme)
+      {
+      case HERMES_CREATE_STRUCTURE_FROM_SCRATCH:
+        this->symbolic_factorization_timer.tick(Hermes::Mixins::TimeMeasurable::HERMES_SKIP);
+        this->symbolic_factorization();
+        this->symbolic_factorization_timer.tick();
+      case HERMES_REUSE_MATRIX_REORDERING:
+      case HERMES_REUSE_MATRIX_REORDERING_AND_SCALING:
+        this->numeric_factorization();
+      case HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY:
+        break;
+      }
+
+      int n = this->size;
+      Scalar* x = malloc_with_check<Scalar>(std::max(1, n));
+      for (int i = 0; i < n; i++)
+        x[i] = rhs->v[this->perm[i]];
+      this->substitute(x);
+
+      free_with_check(this->sln);
+      this->sln = malloc_with_check<CholeskySolver<Scalar>, Scalar>(n, this);
+      for (int i = 0; i < n; i++)
+        this->sln[this->perm[i]] = x[i];
+      free_with_check(x);
+
+      this->tick();
+      this->time = this->accumulated();
+    }
+
+    template class HERMES_API CholeskySolver < double > ;
+    template class HERMES_API CholeskySolver < std::complex<double> > ;
+  }
+}
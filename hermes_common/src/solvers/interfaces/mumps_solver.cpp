@@ -110,7 +110,7 @@ namespace Hermes
     }
 
     template<typename Scalar>
-    MumpsMatrix<Scalar>::MumpsMatrix() : CSCMatrix<Scalar>(), irn(nullptr), jcn(nullptr), Ax(nullptr)
+    MumpsMatrix<Scalar>::MumpsMatrix(bool symmetric_storage) : CSCMatrix<Scalar>(), irn(nullptr), jcn(nullptr), Ax(nullptr), symmetric_storage(symmetric_storage)
     {
     }
 
@@ -143,9 +143,26 @@ namespace Hermes
       free_with_check(jcn);
     }
 
+    template<typename Scalar>
+    void MumpsMatrix<Scalar>::pre_add_ij(unsigned int row, unsigned int col)
+    {
+      if (this->symmetric_storage && row < col)
+        std::swap(row, col);
+      CSCMatrix<Scalar>::pre_add_ij(row, col);
+    }
+
+    template<typename Scalar>
+    bool MumpsMatrix<Scalar>::has_symmetric_storage() const
+    {
+      return this->symmetric_storage;
+    }
+
     template<typename Scalar>
     Scalar MumpsMatrix<Scalar>::get(unsigned int m, unsigned int n) const
     {
+      if (this->symmetric_storage && m < n)
+        std::swap(m, n);
+
       // Find m-th row in the n-th column.
       int mid = CSMatrix<Scalar>::find_position(this->Ai + this->Ap[n], this->Ap[n + 1] - this->Ap[n], m);
       // Return 0 if the entry has not been found.
@@ -166,6 +183,10 @@ namespace Hermes
     template<>
     void MumpsMatrix<double>::add(unsigned int m, unsigned int n, double v)
     {
+      // The upper triangle is the mirror image of the lower one.
+      if (this->symmetric_storage && m < n)
+        return;
+
       // Find m-th row in the n-th column.
       int pos = CSMatrix<double>::find_position(this->Ai + this->Ap[n], this->Ap[n + 1] - this->Ap[n], m);
       // Make sure we are adding to an existing non-zero entry.
@@ -183,6 +204,10 @@ namespace Hermes
     template<>
     void MumpsMatrix<std::complex<double> >::add(unsigned int m, unsigned int n, std::complex<double> v)
     {
+      // The upper triangle is the mirror image of the lower one.
+      if (this->symmetric_storage && m < n)
+        return;
+
       // Find m-th row in the n-th column.
       int pos = CSMatrix<std::complex<double> >::find_position(this->Ai + this->Ap[n], this->Ap[n + 1] - this->Ap[n], m);
       // Make sure we are adding to an existing non-zero entry.
@@ -209,9 +234,9 @@ namespace Hermes
         if (!file)
           throw Exceptions::IOException(Exceptions::IOException::Write, filename);
         if (Hermes::Helpers::TypeIsReal<Scalar>::value)
-          fprintf(file, "%%%%MatrixMarket matrix coordinate real general\n");
+          fprintf(file, "%%%%MatrixMarket matrix coordinate real %s\n", this->symmetric_storage ? "symmetric" : "general");
         else
-          fprintf(file, "%%%%MatrixMarket matrix coordinate complex general\n");
+          fprintf(file, "%%%%MatrixMarket matrix coordinate complex %s\n", this->symmetric_storage ? "symmetric" : "general");
 
         fprintf(file, "%d %d %d\n", this->size, this->size, this->nnz);
 
@@ -382,6 +407,8 @@ namespace Hermes
     template<typename Scalar>
     void MumpsMatrix<Scalar>::import_from_file(const char *filename, const char *var_name, MatrixExportFormat fmt)
     {
+      this->free();
+
       bool invert_storage = false;
       switch (fmt)
       {
@@ -555,6 +582,8 @@ namespace Hermes
       {
         a = mumps_to_Scalar(Ax[i]);
         vector_out[jcn[i] - 1] += vector_in[irn[i] - 1] * a;
+        if (this->symmetric_storage && irn[i] != jcn[i])
+          vector_out[irn[i] - 1] += vector_in[jcn[i] - 1] * a;
       }
     }
 
@@ -570,6 +599,7 @@ namespace Hermes
     template<typename Scalar>
     void MumpsMatrix<Scalar>::create(unsigned int size, unsigned int nnz_, int* ap, int* ai, Scalar* ax)
     {
+      this->free();
       this->nnz = nnz_;
       this->size = size;
       this->Ap = malloc_with_check<MumpsMatrix<Scalar>, int>(this->size + 1, this);
@@ -591,31 +621,20 @@ namespace Hermes
         this->Ai[i] = ai[i];
         irn[i] = ai[i];
       }
+      this->calculate_structure_fingerprint();
     }
 
     template<typename Scalar>
     CSMatrix<Scalar>* MumpsMatrix<Scalar>::duplicate() const
     {
-      MumpsMatrix<Scalar> * nmat = new MumpsMatrix<Scalar>();
+      MumpsMatrix<Scalar> * nmat = new MumpsMatrix<Scalar>(this->symmetric_storage);
+      if (!nmat->share_sparsity_pattern(this->get_sparsity_pattern()))
+        return nmat;
 
-      nmat->nnz = this->nnz;
-      nmat->size = this->size;
-      nmat->Ap = malloc_with_check<MumpsMatrix<Scalar>, int>(this->size + 1, nmat);
-      nmat->Ai = malloc_with_check<MumpsMatrix<Scalar>, int>(this->nnz, nmat);
-      nmat->Ax = malloc_with_check<MumpsMatrix<Scalar>, typename mumps_type<Scalar>::mumps_Scalar>(this->nnz, nmat);
-      nmat->irn = malloc_with_check<MumpsMatrix<Scalar>, int>(this->nnz, nmat);
-      nmat->jcn = malloc_with_check<MumpsMatrix<Scalar>, int>(this->nnz, nmat);
-      for (unsigned int i = 0; i < this->nnz; i++)
-      {
-        nmat->Ai[i] = this->Ai[i];
-        nmat->Ax[i] = Ax[i];
-        nmat->irn[i] = irn[i];
-        nmat->jcn[i] = jcn[i];
-      }
-      for (unsigned int i = 0; i < this->size + 1; i++)
-      {
-        nmat->Ap[i] = this->Ap[i];
-      }
+      memcpy(nmat->Ax, Ax, this->nnz * sizeof(typename mumps_type<Scalar>::mumps_Scalar));
+      memcpy(nmat->irn, irn, this->nnz * sizeof(int));
+      memcpy(nmat->jcn, jcn, this->nnz * sizeof(int));
+      nmat->structure_fingerprint = this->structure_fingerprint;
       return nmat;
     }
 
@@ -718,8 +737,8 @@ namespace Hermes
       param.job = JOB_INIT;
       // host also performs calculations
       param.par = 1;
-      // 0 = unsymmetric
-      param.sym = 0;
+      // 0 = unsymmetric, 2 = general symmetric (only one triangle is passed)
+      param.sym = m->symmetric_storage ? 2 : 0;
       param.comm_fortran = USE_COMM_WORLD;
 
       mumps_c(&param);
@@ -832,12 +851,9 @@ namespace Hermes
     template<typename Scalar>
     bool MumpsSolver<Scalar>::setup_factorization()
     {
-      // When called for the first time, all three phases (analysis, factorization,
-      // solution) must be performed.
-      int eff_fact_scheme = this->reuse_scheme;
-      if (!inited)
-        if (this->reuse_scheme == HERMES_REUSE_MATRIX_REORDERING || this->reuse_scheme == HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY)
-          eff_fact_scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
+      // When called for the first time, or when the structure changed, all three phases
+      // (analysis, factorization, solution) must be performed.
+      MatrixStructureReuseScheme eff_fact_scheme = this->get_effective_reuse_scheme(m->get_structure_fingerprint(), inited);
 
       switch (eff_fact_scheme)
       {
@@ -72,6 +72,24 @@ namespace Hermes
       this->paralutionMatrix.SetDataPtrCSR(&this->Ap, &this->Ai, &this->Ax, "paralutionMatrix", this->nnz, this->size, this->size);
     }
 
+    template<typename Scalar>
+    bool ParalutionMatrix<Scalar>::share_sparsity_pattern(SparsityPatternSharedPtr pattern)
+    {
+      if (!CSRMatrix<Scalar>::share_sparsity_pattern(pattern))
+        return false;
+      // Paralution takes over the arrays.
+      this->detach_sparsity_pattern();
+      this->paralutionMatrix.SetDataPtrCSR(&this->Ap, &this->Ai, &this->Ax, "paralutionMatrix", this->nnz, this->size, this->size);
+      return true;
+    }
+
+    template<typename Scalar>
+    void ParalutionMatrix<Scalar>::alloc_with_pattern(unsigned int size, const int* pattern_ptr, const int* pattern_rows)
+    {
+      CSRMatrix<Scalar>::alloc_with_pattern(size, pattern_ptr, pattern_rows);
+      this->paralutionMatrix.SetDataPtrCSR(&this->Ap, &this->Ai, &this->Ax, "paralutionMatrix", this->nnz, this->size, this->size);
+    }
+
     template<typename Scalar>
     ParalutionVector<Scalar>::ParalutionVector() : SimpleVector<Scalar>(), paralutionVector(new paralution::LocalVector<Scalar>)
     {
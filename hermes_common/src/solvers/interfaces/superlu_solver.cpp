@@ -176,6 +176,7 @@ namespace Hermes
       options.PrintStat = YES;
 
       has_A = has_B = inited = false;
+      eff_fact_scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
     }
 
     inline SuperLuType<std::complex<double> >::Scalar to_superlu(SuperLuType<std::complex<double> >::Scalar &a, std::complex<double>b)
@@ -247,7 +248,7 @@ namespace Hermes
       // keep the (possibly rescaled) matrix from the last factorization, otherwise recreate it
       // from the master CSCMatrix<Scalar> pointed to by this->m (this also applies to the case when
       // A does not yet exist).
-      if (!has_A || this->reuse_scheme != HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY)
+      if (!has_A || eff_fact_scheme != HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY)
       {
         if (A_changed)
           free_matrix();
@@ -384,20 +385,16 @@ namespace Hermes
     template<typename Scalar>
     bool SuperLUSolver<Scalar>::setup_factorization()
     {
+      // Always factorize from scratch for the first time, and whenever the structure changed.
+      eff_fact_scheme = this->get_effective_reuse_scheme(m->get_structure_fingerprint(), inited);
+
       unsigned int A_size = A.nrow < 0 ? 0 : A.nrow;
-      if (has_A && this->reuse_scheme != HERMES_CREATE_STRUCTURE_FROM_SCRATCH && A_size != m->get_size())
+      if (has_A && eff_fact_scheme != HERMES_CREATE_STRUCTURE_FROM_SCRATCH && A_size != m->get_size())
       {
         this->warn("You cannot reuse factorization structures for factorizing matrices of different sizes.");
         return false;
       }
 
-      // Always factorize from scratch for the first time.
-      int eff_fact_scheme;
-      if (!inited)
-        eff_fact_scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
-      else
-        eff_fact_scheme = this->reuse_scheme;
-
       // Prepare factorization structures. In case of a particular reuse scheme, comments are given
       // to clarify which arguments will be reused and which will be reset by the dgssvx (zgssvx) routine.
       // It was determined empirically by running the dlinsolx2 example from SuperLU, setting options.Fact
@@ -45,7 +45,7 @@ namespace Hermes
 
     template<typename Scalar>
     UMFPackLinearMatrixSolver<Scalar>::UMFPackLinearMatrixSolver(CSCMatrix<Scalar> *m, SimpleVector<Scalar> *rhs)
-      : DirectSolver<Scalar>(m, rhs), m(m), rhs(rhs), symbolic(nullptr), numeric(nullptr)
+      : DirectSolver<Scalar>(m, rhs), m(m), rhs(rhs), expanded_matrix(nullptr), factorized_matrix(m), symbolic(nullptr), numeric(nullptr)
     {
       umfpack_di_defaults(Control);
     }
@@ -60,6 +60,33 @@ namespace Hermes
     void UMFPackLinearMatrixSolver<Scalar>::free()
     {
       free_factorization_data();
+      if (this->expanded_matrix)
+      {
+        delete this->expanded_matrix;
+        this->expanded_matrix = nullptr;
+      }
+    }
+
+    template<typename Scalar>
+    void UMFPackLinearMatrixSolver<Scalar>::prepare_factorized_matrix()
+    {
+      SymmetricCSCMatrix<Scalar>* symmetric_matrix = dynamic_cast<SymmetricCSCMatrix<Scalar>*>(m);
+      if (!symmetric_matrix)
+      {
+        this->factorized_matrix = m;
+        return;
+      }
+
+      // UMFPACK needs both triangles, with the same matrix (and an existing factorization) the last expansion is still valid.
+      if (this->expanded_matrix && this->numeric && this->reuse_scheme == HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY)
+      {
+        this->factorized_matrix = this->expanded_matrix;
+        return;
+      }
+      if (!this->expanded_matrix)
+        this->expanded_matrix = new CSCMatrix<Scalar>();
+      symmetric_matrix->expand(this->expanded_matrix);
+      this->factorized_matrix = this->expanded_matrix;
     }
 
     template<typename Scalar>
@@ -71,12 +98,11 @@ namespace Hermes
     template<>
     bool UMFPackLinearMatrixSolver<double>::setup_factorization()
     {
-      // Perform both factorization phases for the first time.
-      if (reuse_scheme != HERMES_CREATE_STRUCTURE_FROM_SCRATCH && symbolic == nullptr && numeric == nullptr)
-        reuse_scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
+      // Perform both factorization phases for the first time, and whenever the structure changed.
+      MatrixStructureReuseScheme eff_fact_scheme = this->get_effective_reuse_scheme(factorized_matrix->get_structure_fingerprint(), symbolic != nullptr);
 
       int status;
-      switch (reuse_scheme)
+      switch (eff_fact_scheme)
       {
       case HERMES_CREATE_STRUCTURE_FROM_SCRATCH:
         if (symbolic != nullptr)
@@ -86,7 +112,9 @@ namespace Hermes
         }
 
         // Factorizing symbolically.
-        status = umfpack_real_symbolic(m->get_size(), m->get_size(), m->get_Ap(), m->get_Ai(), m->get_Ax(), &symbolic, Control, Info);
+        this->symbolic_factorization_timer.tick(Hermes::Mixins::TimeMeasurable::HERMES_SKIP);
+        status = umfpack_real_symbolic(m->get_size(), m->get_size(), factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), factorized_matrix->get_Ax(), &symbolic, Control, Info);
+        this->symbolic_factorization_timer.tick();
         if (status != UMFPACK_OK)
         {
           if (symbolic)
@@ -103,7 +131,7 @@ namespace Hermes
         }
 
         // Factorizing numerically.
-        status = umfpack_real_numeric(m->get_Ap(), m->get_Ai(), m->get_Ax(), symbolic, &numeric, Control, Info);
+        status = umfpack_real_numeric(factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), factorized_matrix->get_Ax(), symbolic, &numeric, Control, Info);
         if (status != UMFPACK_OK)
         {
           if (numeric)
@@ -120,12 +148,8 @@ namespace Hermes
     template<>
     bool UMFPackLinearMatrixSolver<std::complex<double> >::setup_factorization()
     {
-      // Perform both factorization phases for the first time.
-      int eff_fact_scheme;
-      if (reuse_scheme != HERMES_CREATE_STRUCTURE_FROM_SCRATCH && symbolic == nullptr && numeric == nullptr)
-        eff_fact_scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
-      else
-        eff_fact_scheme = reuse_scheme;
+      // Perform both factorization phases for the first time, and whenever the structure changed.
+      MatrixStructureReuseScheme eff_fact_scheme = this->get_effective_reuse_scheme(factorized_matrix->get_structure_fingerprint(), symbolic != nullptr);
 
       int status;
       switch (eff_fact_scheme)
@@ -134,7 +158,9 @@ namespace Hermes
         if (symbolic != nullptr)
           umfpack_zi_free_symbolic(&symbolic);
 
-        status = umfpack_complex_symbolic(m->get_size(), m->get_size(), m->get_Ap(), m->get_Ai(), (double *)m->get_Ax(), nullptr, &symbolic, nullptr, nullptr);
+        this->symbolic_factorization_timer.tick(Hermes::Mixins::TimeMeasurable::HERMES_SKIP);
+        status = umfpack_complex_symbolic(m->get_size(), m->get_size(), factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), (double *)factorized_matrix->get_Ax(), nullptr, &symbolic, nullptr, nullptr);
+        this->symbolic_factorization_timer.tick();
         if (status != UMFPACK_OK)
         {
           if (symbolic)
@@ -147,7 +173,7 @@ namespace Hermes
         if (numeric != nullptr)
           umfpack_zi_free_numeric(&numeric);
 
-        status = umfpack_complex_numeric(m->get_Ap(), m->get_Ai(), (double *)m->get_Ax(), nullptr, symbolic, &numeric, nullptr, nullptr);
+        status = umfpack_complex_numeric(factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), (double *)factorized_matrix->get_Ax(), nullptr, symbolic, &numeric, nullptr, nullptr);
         if (status != UMFPACK_OK)
         {
           if (numeric)
@@ -186,13 +212,15 @@ namespace Hermes
 
       this->tick();
 
+      this->prepare_factorized_matrix();
+
       if (!setup_factorization())
         throw Exceptions::LinearMatrixSolverException("LU factorization could not be completed.");
 
       free_with_check(sln);
 
       sln = calloc_with_check<UMFPackLinearMatrixSolver<double>, double>(m->get_size(), this);
-      int status = umfpack_real_solve(UMFPACK_A, m->get_Ap(), m->get_Ai(), m->get_Ax(), sln, rhs->v, numeric, nullptr, nullptr);
+      int status = umfpack_real_solve(UMFPACK_A, factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), factorized_matrix->get_Ax(), sln, rhs->v, numeric, nullptr, nullptr);
       if (status != UMFPACK_OK)
       {
         this->free_factorization_data();
@@ -210,6 +238,8 @@ namespace Hermes
       assert(m->get_size() == rhs->get_size());
 
       this->tick();
+
+      this->prepare_factorized_matrix();
       if (!setup_factorization())
         this->warn("LU factorization could not be completed.");
 
@@ -217,7 +247,7 @@ namespace Hermes
       sln = malloc_with_check<UMFPackLinearMatrixSolver<std::complex<double> >, std::complex<double> >(m->get_size(), this);
 
       memset(sln, 0, m->get_size() * sizeof(std::complex<double>));
-      int status = umfpack_complex_solve(UMFPACK_A, m->get_Ap(), m->get_Ai(), (double *)m->get_Ax(), nullptr, (double*)sln, nullptr, (double *)rhs->v, nullptr, numeric, nullptr, nullptr);
+      int status = umfpack_complex_solve(UMFPACK_A, factorized_matrix->get_Ap(), factorized_matrix->get_Ai(), (double *)factorized_matrix->get_Ax(), nullptr, (double*)sln, nullptr, (double *)rhs->v, nullptr, numeric, nullptr, nullptr);
       if (status != UMFPACK_OK)
       {
         this->free_factorization_data();
@@ -0,0 +1,355 @@
+// This file is part of HermesCommon
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://www.hpfem.org/.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+/*! \file krylov_solver.cpp
+\brief Built-in Krylov solvers working with abstract operators (no external library needed).
+*/
+#include "krylov_solver.h"
+#include "dense_matrix_operations.h"
+#include "util/memory_handling.h"
+#include "exceptions.h"
+
+namespace Hermes
+{
+  namespace Solvers
+  {
+    template<typename Scalar>
+    static Scalar krylov_dot(const Scalar* a, const Scalar* b, int size)
+    {
+      Scalar result = 0.;
+      for (int i = 0; i < size; i++)
+        result += conj(a[i]) * b[i];
+      return result;
+    }
+
+    template<typename Scalar>
+    static double krylov_norm(const Scalar* a, int size)
+    {
+      double result = 0.;
+      for (int i = 0; i < size; i++)
+        result += std::norm(a[i]);
+      return std::sqrt(result);
+    }
+
+    template<typename Scalar>
+    GMRESSolver<Scalar>::GMRESSolver() : restart(30), max_iterations(1000), V(nullptr), Z(nullptr), H(nullptr),
+      allocated_size(0), allocated_restart(0), num_iters(0), relative_residual(0.)
+    {
+    }
+
+    template<typename Scalar>
+    GMRESSolver<Scalar>::~GMRESSolver()
+    {
+      this->free();
+    }
+
+    template<typename Scalar>
+    void GMRESSolver<Scalar>::free()
+    {
+      free_with_check(this->V, true);
+      free_with_check(this->Z, true);
+      free_with_check(this->H, true);
+      this->allocated_size = this->allocated_restart = 0;
+    }
+
+    template<typename Scalar>
+    void GMRESSolver<Scalar>::set_restart(int restart)
+    {
+      if (restart < 1)
+        throw Exceptions::ValueException("restart", restart, 1);
+      this->restart = restart;
+    }
+
+    template<typename Scalar>
+    void GMRESSolver<Scalar>::set_max_iterations(int max_iterations)
+    {
+      if (max_iterations < 1)
+        throw Exceptions::ValueException("max_iterations", max_iterations, 1);
+      this->max_iterations = max_iterations;
+    }
+
+    template<typename Scalar>
+    int GMRESSolver<Scalar>::get_num_iters() const
+    {
+      return this->num_iters;
+    }
+
+    template<typename Scalar>
+    double GMRESSolver<Scalar>::get_relative_residual() const
+    {
+      return this->relative_residual;
+    }
+
+    template<typename Scalar>
+    bool GMRESSolver<Scalar>::solve(KrylovOperator<Scalar>* op, KrylovOperator<Scalar>* preconditioner, const Scalar* rhs, Scalar* x, int size, double relative_tolerance)
+    {
+      int m = this->restart;
+      if (this->allocated_size != size || this->allocated_restart != m)
+      {
+        this->free();
+        this->V = Algebra::DenseMatrixOperations::new_matrix<Scalar>(m + 1, size);
+        this->Z = Algebra::DenseMatrixOperations::new_matrix<Scalar>(m, size);
+        this->H = Algebra::DenseMatrixOperations::new_matrix<Scalar>(m + 1, m);
+        this->allocated_size = size;
+        this->allocated_restart = m;
+      }
+
+      // Givens rotations (c real, s Scalar), and the transformed rhs of the least squares problem.
+      double* c = malloc_with_check<double>(m);
+      Scalar* s = malloc_with_check<Scalar>(m);
+      Scalar* g = malloc_with_check<Scalar>(m + 1);
+      Scalar* y = malloc_with_check<Scalar>(m);
+
+      this->num_iters = 0;
+      double rhs_norm = krylov_norm(rhs, size);
+      if (rhs_norm == 0.)
+      {
+        memset(x, 0, size * sizeof(Scalar));
+        this->relative_residual = 0.;
+        free_with_check(c);
+        free_with_check(s);
+        free_with_check(g);
+        free_with_check(y);
+        return true;
+      }
+      double target = relative_tolerance * rhs_norm;
+
+      bool converged = false;
+      while (true)
+      {
+        // r = rhs - op * x, stored in V[0].
+        op->apply(x, this->V[0]);
+        for (int i = 0; i < size; i++)
+          this->V[0][i] = rhs[i] - this->V[0][i];
+        double beta = krylov_norm(this->V[0], size);
+        this->relative_residual = beta / rhs_norm;
+        if (beta <= target || this->num_iters >= this->max_iterations)
+        {
+          converged = beta <= target;
+          break;
+        }
+
+        for (int i = 0; i < size; i++)
+          this->V[0][i] /= beta;
+        g[0] = beta;
+
+        int j = 0;
+        for (; j < m && this->num_iters < this->max_iterations; j++)
+        {
+          this->num_iters++;
+
+          // z_j = M^{-1} v_j, w = op * z_j (stored in V[j + 1]).
+          if (preconditioner)
+            preconditioner->apply(this->V[j], this->Z[j]);
+          else
+            memcpy(this->Z[j], this->V[j], size * sizeof(Scalar));
+          op->apply(this->Z[j], this->V[j + 1]);
+
+          // Modified Gram-Schmidt.
+          for (int i = 0; i <= j; i++)
+          {
+            this->H[i][j] = krylov_dot(this->V[i], this->V[j + 1], size);
+            for (int k = 0; k < size; k++)
+              this->V[j + 1][k] -= this->H[i][j] * this->V[i][k];
+          }
+          double h_next = krylov_norm(this->V[j + 1], size);
+          this->H[j + 1][j] = h_next;
+          if (h_next > 0.)
+            for (int k = 0; k < size; k++)
+              this->V[j + 1][k] /= h_next;
+
+          // Apply the previous rotations to the new column.
+          for (int i = 0; i < j; i++)
+          {
+            Scalar temp = c[i] * this->H[i][j] + s[i] * this->H[i + 1][j];
+            this->H[i + 1][j] = -conj(s[i]) * this->H[i][j] + c[i] * this->H[i + 1][j];
+            this->H[i][j] = temp;
+          }
+
+          // New rotation eliminating H[j + 1][j].
+          double a_abs = std::abs(this->H[j][j]);
+          double t = std::sqrt(a_abs * a_abs + h_next * h_next);
+          if (a_abs == 0.)
+          {
+            c[j] = 0.;
+            s[j] = 1.;
+            this->H[j][j] = h_next;
+          }
+          else
+          {
+            Scalar alpha = this->H[j][j] / a_abs;
+            c[j] = a_abs / t;
+            s[j] = alpha * h_next / t;
+            this->H[j][j] = alpha * t;
+          }
+          this->H[j + 1][j] = 0.;
+          g[j + 1] = -conj(s[j]) * g[j];
+          g[j] = c[j] * g[j];
+
+          this->relative_residual = std::abs(g[j + 1]) / rhs_norm;
+          // Converged, or happy breakdown (the Krylov subspace is invariant).
+          if (std::abs(g[j + 1]) <= target || h_next == 0.)
+          {
+            j++;
+            break;
+          }
+        }
+
+        // Solve the triangular system H y = g, update x += Z y.
+        for (int i = j - 1; i >= 0; i--)
+        {
+          y[i] = g[i];
+          for (int k = i + 1; k < j; k++)
+            y[i] -= this->H[i][k] * y[k];
+          y[i] /= this->H[i][i];
+        }
+        for (int i = 0; i < j; i++)
+          for (int k = 0; k < size; k++)
+            x[k] += y[i] * this->Z[i][k];
+
+        // The residual estimate is exact in exact arithmetic, no need to recompute it.
+        if (this->relative_residual * rhs_norm <= target)
+        {
+          converged = true;
+          break;
+        }
+        if (this->num_iters >= this->max_iterations)
+          break;
+      }
+
+      free_with_check(c);
+      free_with_check(s);
+      free_with_check(g);
+      free_with_check(y);
+
+      return converged;
+    }
+
+    template class HERMES_API GMRESSolver < double > ;
+    template class HERMES_API GMRESSolver < std::complex<double> > ;
+
+    template<typename Scalar>
+    CGSolver<Scalar>::CGSolver() : max_iterations(1000), num_iters(0), relative_residual(0.)
+    {
+    }
+
+    template<typename Scalar>
+    CGSolver<Scalar>::~CGSolver()
+    {
+    }
+
+    template<typename Scalar>
+    void CGSolver<Scalar>::set_max_iterations(int max_iterations)
+    {
+      if (max_iterations < 1)
+        throw Exceptions::ValueException("max_iterations", max_iterations, 1);
+      this->max_iterations = max_iterations;
+    }
+
+    template<typename Scalar>
+    int CGSolver<Scalar>::get_num_iters() const
+    {
+      return this->num_iters;
+    }
+
+    template<typename Scalar>
+    double CGSolver<Scalar>::get_relative_residual() const
+    {
+      return this->relative_residual;
+    }
+
+    template<typename Scalar>
+    bool CGSolver<Scalar>::solve(KrylovOperator<Scalar>* op, KrylovOperator<Scalar>* preconditioner, const Scalar* rhs, Scalar* x, int size, double relative_tolerance)
+    {
+      this->num_iters = 0;
+      double rhs_norm = krylov_norm(rhs, size);
+      if (rhs_norm == 0.)
+      {
+        memset(x, 0, size * sizeof(Scalar));
+        this->relative_residual = 0.;
+        return true;
+      }
+      double target = relative_tolerance * rhs_norm;
+
+      // Residual, preconditioned residual, search direction, operator * search direction.
+      Scalar* r = malloc_with_check<Scalar>(size);
+      Scalar* z = malloc_with_check<Scalar>(size);
+      Scalar* p = malloc_with_check<Scalar>(size);
+      Scalar* q = malloc_with_check<Scalar>(size);
+
+      op->apply(x, q);
+      for (int i = 0; i < size; i++)
+        r[i] = rhs[i] - q[i];
+      double r_norm = krylov_norm(r, size);
+      this->relative_residual = r_norm / rhs_norm;
+
+      if (preconditioner)
+        preconditioner->apply(r, z);
+      else
+        memcpy(z, r, size * sizeof(Scalar));
+      memcpy(p, z, size * sizeof(Scalar));
+      Scalar rz = krylov_dot(r, z, size);
+
+      bool converged = r_norm <= target;
+      while (!converged && this->num_iters < this->max_iterations)
+      {
+        this->num_iters++;
+
+        op->apply(p, q);
+        Scalar pq = krylov_dot(p, q, size);
+        // Breakdown - the operator (or the preconditioner) is not positive definite.
+        if (pq == Scalar(0.))
+          break;
+        Scalar alpha = rz / pq;
+        for (int i = 0; i < size; i++)
+        {
+          x[i] += alpha * p[i];
+          r[i] -= alpha * q[i];
+        }
+
+        r_norm = krylov_norm(r, size);
+        this->relative_residual = r_norm / rhs_norm;
+        if (r_norm <= target)
+        {
+          converged = true;
+          break;
+        }
+
+        if (preconditioner)
+          preconditioner->apply(r, z);
+        else
+          memcpy(z, r, size * sizeof(Scalar));
+        Scalar rz_new = krylov_dot(r, z, size);
+        Scalar beta = rz_new / rz;
+        rz = rz_new;
+        for (int i = 0; i < size; i++)
+          p[i] = z[i] + beta * p[i];
+      }
+
+      free_with_check(r);
+      free_with_check(z);
+      free_with_check(p);
+      free_with_check(q);
+
+      return converged;
+    }
+
+    template class HERMES_API CGSolver < double > ;
+    template class HERMES_API CGSolver < std::complex<double> > ;
+  }
+}
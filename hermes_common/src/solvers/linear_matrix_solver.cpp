@@ -27,6 +27,7 @@
 #include "solvers/interfaces/mumps_solver.h"
 #include "solvers/interfaces/aztecoo_solver.h"
 #include "solvers/interfaces/paralution_solver.h"
+#include "solvers/cholesky_solver.h"
 #include "api.h"
 #include "exceptions.h"
 #include "util/memory_handling.h"
@@ -265,6 +266,12 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        if (rhs != nullptr) return new CholeskySolver<double>(static_cast<CSCMatrix<double>*>(matrix), static_cast<SimpleVector<double>*>(rhs));
+        else return new CholeskySolver<double>(static_cast<CSCMatrix<double>*>(matrix), static_cast<SimpleVector<double>*>(rhs_dummy));
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
@@ -360,6 +367,12 @@ namespace Hermes
 #endif
         break;
       }
+      case Hermes::SOLVER_CHOLESKY:
+      {
+        if (rhs != nullptr) return new CholeskySolver<std::complex<double> >(static_cast<CSCMatrix<std::complex<double> >*>(matrix), static_cast<SimpleVector<std::complex<double> >*>(rhs));
+        else return new CholeskySolver<std::complex<double> >(static_cast<CSCMatrix<std::complex<double> >*>(matrix), static_cast<SimpleVector<std::complex<double> >*>(rhs_dummy));
+        break;
+      }
       case Hermes::SOLVER_SUPERLU:
       {
 #ifdef WITH_SUPERLU
@@ -411,7 +424,8 @@ namespace Hermes
     }
 
     template <typename Scalar>
-    DirectSolver<Scalar>::DirectSolver(SparseMatrix<Scalar>* matrix, Vector<Scalar>* rhs) : LinearMatrixSolver<Scalar>(matrix, rhs)
+    DirectSolver<Scalar>::DirectSolver(SparseMatrix<Scalar>* matrix, Vector<Scalar>* rhs) : LinearMatrixSolver<Scalar>(matrix, rhs),
+      automatic_structure_reuse(true), factorized_structure_fingerprint(0), structure_reuse_hits(0), structure_reuse_misses(0)
     {
     }
 
@@ -421,6 +435,64 @@ namespace Hermes
       this->solve();
     }
 
+    template <typename Scalar>
+    void DirectSolver<Scalar>::set_automatic_structure_reuse(bool to_set)
+    {
+      this->automatic_structure_reuse = to_set;
+    }
+
+    template <typename Scalar>
+    unsigned int DirectSolver<Scalar>::get_structure_reuse_hits() const
+    {
+      return this->structure_reuse_hits;
+    }
+
+    template <typename Scalar>
+    unsigned int DirectSolver<Scalar>::get_structure_reuse_misses() const
+    {
+      return this->structure_reuse_misses;
+    }
+
+    template <typename Scalar>
+    double DirectSolver<Scalar>::get_structure_reuse_time_saved() const
+    {
+      if (this->structure_reuse_misses == 0)
+        return 0.;
+      return this->structure_reuse_hits * this->symbolic_factorization_timer.accumulated() / this->structure_reuse_misses;
+    }
+
+    template <typename Scalar>
+    MatrixStructureReuseScheme DirectSolver<Scalar>::get_effective_reuse_scheme(unsigned long long structure_fingerprint, bool factorization_available)
+    {
+      MatrixStructureReuseScheme scheme = this->reuse_scheme;
+
+      if (!factorization_available)
+        scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
+      else if (this->automatic_structure_reuse && structure_fingerprint != 0)
+      {
+        if (structure_fingerprint == this->factorized_structure_fingerprint)
+        {
+          if (scheme == HERMES_CREATE_STRUCTURE_FROM_SCRATCH)
+            scheme = HERMES_REUSE_MATRIX_REORDERING;
+        }
+        else if (scheme != HERMES_CREATE_STRUCTURE_FROM_SCRATCH)
+        {
+          this->warn("DirectSolver: the matrix structure changed, the factorization is not reused.");
+          scheme = HERMES_CREATE_STRUCTURE_FROM_SCRATCH;
+        }
+      }
+
+      if (scheme == HERMES_CREATE_STRUCTURE_FROM_SCRATCH)
+      {
+        this->factorized_structure_fingerprint = structure_fingerprint;
+        this->structure_reuse_misses++;
+      }
+      else
+        this->structure_reuse_hits++;
+
+      return scheme;
+    }
+
     template <typename Scalar>
     LoopSolver<Scalar>::LoopSolver(SparseMatrix<Scalar>* matrix, Vector<Scalar>* rhs) : LinearMatrixSolver<Scalar>(matrix, rhs), max_iters(10000), tolerance(1e-8)
     {
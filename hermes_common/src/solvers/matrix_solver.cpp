@@ -18,6 +18,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "matrix_solver.h"
+#include "util/memory_handling.h"
 #ifdef WITH_UMFPACK
 #include "interfaces/umfpack_solver.h"
 #endif
@@ -33,6 +34,11 @@ namespace Hermes
       SparseMatrix<Scalar>* A = create_matrix<Scalar>(force_use_direct_solver);
       Vector<Scalar>* b = create_vector<Scalar>(force_use_direct_solver);
       this->linear_matrix_solver = create_linear_solver<Scalar>(A, b, force_use_direct_solver);
+      this->force_use_direct_solver = force_use_direct_solver;
+
+      this->static_condensation_used = false;
+      this->condensable_dofs = nullptr;
+      this->reduced_linear_matrix_solver = nullptr;
 
       this->constant_jacobian = false;
 
@@ -59,6 +65,17 @@ namespace Hermes
         delete temp_matrix;
       if (temp_rhs)
         delete temp_rhs;
+
+      if (this->reduced_linear_matrix_solver)
+      {
+        temp_matrix = this->reduced_linear_matrix_solver->get_matrix();
+        temp_rhs = this->reduced_linear_matrix_solver->get_rhs();
+        delete this->reduced_linear_matrix_solver;
+        delete temp_matrix;
+        delete temp_rhs;
+      }
+
+      free_with_check(this->condensable_dofs);
     }
 
     template<typename Scalar>
@@ -66,6 +83,65 @@ namespace Hermes
     {
       Hermes::Mixins::Loggable::set_verbose_output(to_set);
       this->linear_matrix_solver->set_verbose_output(to_set);
+      if (this->reduced_linear_matrix_solver)
+        this->reduced_linear_matrix_solver->set_verbose_output(to_set);
+    }
+
+    template<typename Scalar>
+    void MatrixSolver<Scalar>::use_static_condensation(bool to_set)
+    {
+      this->static_condensation_used = to_set;
+      if (!to_set)
+        this->static_condensation.free();
+    }
+
+    template<typename Scalar>
+    void MatrixSolver<Scalar>::set_condensable_dofs(bool* condensable_dofs)
+    {
+      free_with_check(this->condensable_dofs);
+      this->condensable_dofs = condensable_dofs;
+    }
+
+    template<typename Scalar>
+    Scalar* MatrixSolver<Scalar>::solve_linear_matrix_system(Scalar* initial_guess)
+    {
+      CSMatrix<Scalar>* matrix = dynamic_cast<CSMatrix<Scalar>*>(this->linear_matrix_solver->get_matrix());
+      if (this->static_condensation_used && (!matrix || !this->condensable_dofs))
+        this->warn("MatrixSolver: static condensation requires a matrix in a CS format and condensable DOFs, solving without it.");
+
+      if (!this->static_condensation_used || !matrix || !this->condensable_dofs)
+      {
+        this->linear_matrix_solver->solve(initial_guess);
+        return this->linear_matrix_solver->get_sln_vector();
+      }
+
+      if (!this->reduced_linear_matrix_solver)
+      {
+        SparseMatrix<Scalar>* A = create_matrix<Scalar>(this->force_use_direct_solver);
+        Vector<Scalar>* b = create_vector<Scalar>(this->force_use_direct_solver);
+        this->reduced_linear_matrix_solver = create_linear_solver<Scalar>(A, b, this->force_use_direct_solver);
+        this->reduced_linear_matrix_solver->set_verbose_output(this->get_verbose_output());
+      }
+
+      // With the same matrix, the factorized blocks as well as the reduced matrix are reused.
+      if (this->linear_matrix_solver->get_used_reuse_scheme() == HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY && this->static_condensation.is_condensed() && this->static_condensation.get_size() == matrix->get_size())
+      {
+        this->static_condensation.condense_rhs(this->linear_matrix_solver->get_rhs(), this->reduced_linear_matrix_solver->get_rhs());
+        this->reduced_linear_matrix_solver->set_reuse_scheme(HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY);
+      }
+      else
+      {
+        this->static_condensation.condense(matrix, this->linear_matrix_solver->get_rhs(), this->condensable_dofs, this->reduced_linear_matrix_solver->get_matrix(), this->reduced_linear_matrix_solver->get_rhs());
+        this->reduced_linear_matrix_solver->set_reuse_scheme(HERMES_CREATE_STRUCTURE_FROM_SCRATCH);
+        this->info("\tMatrixSolver: static condensation: %i -> %i unknowns.", this->static_condensation.get_size(), this->static_condensation.get_reduced_size());
+      }
+
+      // Everything condensed (e.g. a discontinuous space without any coupling).
+      if (this->static_condensation.get_reduced_size() == 0)
+        return this->static_condensation.expand(nullptr);
+
+      this->reduced_linear_matrix_solver->solve(initial_guess ? this->static_condensation.restrict_vector(initial_guess) : nullptr);
+      return this->static_condensation.expand(this->reduced_linear_matrix_solver->get_sln_vector());
     }
 
     template<typename Scalar>
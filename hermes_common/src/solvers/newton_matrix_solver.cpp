@@ -18,6 +18,7 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "newton_matrix_solver.h"
+#include "util/memory_handling.h"
 
 using namespace Hermes::Algebra;
 
@@ -26,9 +27,19 @@ namespace Hermes
   namespace Solvers
   {
     template<typename Scalar>
-    NewtonMatrixSolver<Scalar>::NewtonMatrixSolver() : NonlinearMatrixSolver<Scalar>()
+    NewtonMatrixSolver<Scalar>::NewtonMatrixSolver() : NonlinearMatrixSolver<Scalar>(), jacobian_free(false), max_forcing_term(0.9), previous_forcing_term(0.),
+      jacobian_free_step(nullptr), jacobian_free_residual(nullptr)
     {
       init_newton();
+      this->gmres.set_restart(30);
+      this->gmres.set_max_iterations(200);
+    }
+
+    template<typename Scalar>
+    NewtonMatrixSolver<Scalar>::~NewtonMatrixSolver()
+    {
+      free_with_check(this->jacobian_free_step);
+      free_with_check(this->jacobian_free_residual);
     }
 
     template<typename Scalar>
@@ -72,6 +83,175 @@ namespace Hermes
       return std::sqrt(solution_change_norm) * current_damping_factor;
     }
 
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::set_jacobian_free(bool to_set)
+    {
+      this->jacobian_free = to_set;
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::set_jacobian_free_gmres_parameters(int restart, int max_iterations)
+    {
+      this->gmres.set_restart(restart);
+      this->gmres.set_max_iterations(max_iterations);
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::set_max_forcing_term(double max_forcing_term)
+    {
+      if (max_forcing_term <= 0. || max_forcing_term >= 1.)
+        throw Exceptions::ValueException("max_forcing_term", max_forcing_term, 0., 1.);
+      this->max_forcing_term = max_forcing_term;
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::init_solving(Scalar* coeff_vec)
+    {
+      NonlinearMatrixSolver<Scalar>::init_solving(coeff_vec);
+      this->previous_forcing_term = 0.;
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::deinit_solving()
+    {
+      free_with_check(this->jacobian_free_step);
+      free_with_check(this->jacobian_free_residual);
+      NonlinearMatrixSolver<Scalar>::deinit_solving();
+    }
+
+    template<typename Scalar>
+    double NewtonMatrixSolver<Scalar>::calculate_forcing_term()
+    {
+      // Eisenstat, Walker: Choosing the forcing terms in an inexact Newton method, choice 2 (gamma = 0.9, alpha = 2).
+      const double gamma = 0.9;
+      std::vector<double>& residual_norms = this->get_parameter_value(this->p_residual_norms);
+      double residual_norm = residual_norms.back();
+
+      double forcing_term;
+      if (residual_norms.size() < 2 || this->previous_forcing_term == 0.)
+        forcing_term = std::min(0.5, this->max_forcing_term);
+      else
+      {
+        double ratio = residual_norm / *(residual_norms.end() - 2);
+        forcing_term = gamma * ratio * ratio;
+        // Safeguard against a too early decrease.
+        double safeguard = gamma * this->previous_forcing_term * this->previous_forcing_term;
+        if (safeguard > 0.1)
+          forcing_term = std::max(forcing_term, safeguard);
+        forcing_term = std::min(forcing_term, this->max_forcing_term);
+      }
+
+      // No oversolving beyond the absolute residual tolerance.
+      if (this->tolerance_set[3] && residual_norm > 0.)
+        forcing_term = std::max(forcing_term, 0.5 * this->tolerance[3] / residual_norm);
+
+      return std::min(forcing_term, this->max_forcing_term);
+    }
+
+    template<typename Scalar>
+    Scalar* NewtonMatrixSolver<Scalar>::solve_linear_matrix_system(Scalar* initial_guess)
+    {
+      if (!this->jacobian_free)
+        return MatrixSolver<Scalar>::solve_linear_matrix_system(initial_guess);
+
+      if (!this->jacobian_free_step)
+      {
+        this->jacobian_free_step = malloc_with_check<Scalar>(this->problem_size);
+        this->jacobian_free_residual = malloc_with_check<Scalar>(this->problem_size);
+      }
+
+      // The residual is minus the nonlinear function, i.e. the right-hand side of the Newton system.
+      this->get_residual()->extract(this->jacobian_free_residual);
+
+      double forcing_term = this->calculate_forcing_term();
+      this->previous_forcing_term = forcing_term;
+
+      JacobianFreeOperator op(this, this->jacobian_free_residual);
+      JacobianPreconditioner preconditioner(this);
+
+      memset(this->jacobian_free_step, 0, this->problem_size * sizeof(Scalar));
+      bool converged = this->gmres.solve(&op, &preconditioner, this->jacobian_free_residual, this->jacobian_free_step, this->problem_size, forcing_term);
+
+      // The residual in the current solution is expected by the rest of the nonlinear loop.
+      this->get_residual()->set_vector(this->jacobian_free_residual);
+
+      this->info("	Newton: Jacobian-free step: %i GMRES iterations, forcing term %g, relative residual %g.", this->gmres.get_num_iters(), forcing_term, this->gmres.get_relative_residual());
+      if (!converged)
+        this->warn("	Newton: GMRES did not reach the forcing term, using the last iterate.");
+
+      return this->jacobian_free_step;
+    }
+
+    template<typename Scalar>
+    bool NewtonMatrixSolver<Scalar>::jacobian_reused_okay(unsigned int& successful_steps_with_reused_jacobian)
+    {
+      if (!this->jacobian_free)
+        return NonlinearMatrixSolver<Scalar>::jacobian_reused_okay(successful_steps_with_reused_jacobian);
+
+      // The Newton step itself does not depend on the (lagged) preconditioner.
+      double residual_norm = *(this->get_parameter_value(this->p_residual_norms).end() - 1);
+      double previous_residual_norm = *(this->get_parameter_value(this->p_residual_norms).end() - 2);
+
+      if (residual_norm > previous_residual_norm * this->sufficient_improvement_factor)
+      {
+        successful_steps_with_reused_jacobian = 0;
+        return false;
+      }
+      else
+        return true;
+    }
+
+    template<typename Scalar>
+    NewtonMatrixSolver<Scalar>::JacobianFreeOperator::JacobianFreeOperator(NewtonMatrixSolver<Scalar>* solver, const Scalar* residual) : solver(solver), residual(residual)
+    {
+      // previous_sln_vector holds the current solution during the linear solve (see solve_linear_system()).
+      this->solution = solver->previous_sln_vector;
+      this->solution_norm = get_l2_norm(solver->sln_vector, solver->problem_size);
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::JacobianFreeOperator::apply(const Scalar* in, Scalar* out)
+    {
+      int size = this->solver->problem_size;
+      double in_norm = get_l2_norm(const_cast<Scalar*>(in), size);
+      if (in_norm == 0.)
+      {
+        memset(out, 0, size * sizeof(Scalar));
+        return;
+      }
+
+      // J * in ~ (F(u + h * in) - F(u)) / h = (residual(u) - residual(u + h * in)) / h.
+      double h = std::sqrt(std::numeric_limits<double>::epsilon()) * (1. + this->solution_norm) / in_norm;
+
+      Scalar* sln_vector = this->solver->sln_vector;
+      for (int i = 0; i < size; i++)
+        sln_vector[i] = this->solution[i] + h * in[i];
+
+      this->solver->assemble_residual(false);
+      this->solver->get_residual()->extract(out);
+
+      for (int i = 0; i < size; i++)
+        out[i] = (this->residual[i] - out[i]) / h;
+
+      memcpy(sln_vector, this->solution, size * sizeof(Scalar));
+    }
+
+    template<typename Scalar>
+    NewtonMatrixSolver<Scalar>::JacobianPreconditioner::JacobianPreconditioner(NewtonMatrixSolver<Scalar>* solver) : solver(solver)
+    {
+    }
+
+    template<typename Scalar>
+    void NewtonMatrixSolver<Scalar>::JacobianPreconditioner::apply(const Scalar* in, Scalar* out)
+    {
+      this->solver->get_residual()->set_vector(const_cast<Scalar*>(in));
+      Scalar* result = this->solver->MatrixSolver<Scalar>::solve_linear_matrix_system(nullptr);
+      memcpy(out, result, this->solver->problem_size * sizeof(Scalar));
+
+      // The factorization (or the condensation) is done by the first application, reuse it for the rest.
+      this->solver->linear_matrix_solver->set_reuse_scheme(HERMES_REUSE_MATRIX_STRUCTURE_COMPLETELY);
+    }
+
     template class HERMES_API NewtonMatrixSolver < double > ;
     template class HERMES_API NewtonMatrixSolver < std::complex<double> > ;
   }
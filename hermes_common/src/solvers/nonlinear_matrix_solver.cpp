@@ -450,10 +450,10 @@ namespace Hermes
       memcpy(this->previous_sln_vector, this->sln_vector, sizeof(Scalar)*this->problem_size);
 
       // Solve, if the solver is iterative, give him the initial guess.
-      this->linear_matrix_solver->solve(this->use_initial_guess_for_iterative_solvers ? this->sln_vector : nullptr);
+      Scalar* linear_sln = this->solve_linear_matrix_system(this->use_initial_guess_for_iterative_solvers ? this->sln_vector : nullptr);
 
       // 1. store the solution.
-      double solution_change_norm = this->update_solution_return_change_norm(this->linear_matrix_solver->get_sln_vector());
+      double solution_change_norm = this->update_solution_return_change_norm(linear_sln);
 
       // 2. store the solution change.
       this->get_parameter_value(this->p_solution_change_norms).push_back(solution_change_norm);